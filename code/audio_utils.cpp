@@ -4,20 +4,132 @@
 #include <freertos/FreeRTOS.h> 
 #include <freertos/task.h>     
 #include <freertos/queue.h>
+#include <esp_timer.h>
+#include <atomic>
+#include "spsc_ring.h"
+#include "loop_events.h"
+
+// Written by whichever task emits the start beep, taken by the timer modes.
+static int64_t startBeepEmittedUs = 0;
+static bool startBeepViaBluetooth = false;
+static std::atomic<bool> startBeepReported{false};
+
+// Bumped by playTone() and reset_bt_beep_state(). The buzzer task drops the
+// rest of a cue and the A2DP callback drops queued / sounding BT tones once it
+// moves on, so a start beep is never held up or overwritten by feedback.
+static std::atomic<uint32_t> toneGeneration{0};
+
+// BT tones for the A2DP callback. Only the main loop (Core 1) pushes, only
+// get_data_frames() pops.
+static SpscRing<ToneCommand, BT_TONE_RING_SIZE> btToneRing;
+
+static void pushBtTone(int freq, int duration, int64_t startUs, bool reportStart) {
+    ToneCommand command;
+    command.startUs = startUs;
+    command.generation = toneGeneration.load(std::memory_order_relaxed);
+    command.frequency = (uint16_t)freq;
+    command.durationMs = (uint16_t)duration;
+    command.reportStart = reportStart;
+    btToneRing.push(command);
+}
+
+// --- Scheduled Buzzer Tones ---
+// Driven from the esp_timer task straight onto LEDC, so a tone starts within
+// the timer's dispatch latency of its deadline. The list is only written while
+// both timers are stopped.
+static ToneCommand buzzerSchedule[MAX_SCHEDULED_TONES];
+static int buzzerScheduleCount = 0;
+static int buzzerScheduleNext = 0;
+static std::atomic<bool> buzzerScheduleActive{false};
+static esp_timer_handle_t buzzerScheduleTimer = NULL;
+static esp_timer_handle_t buzzerScheduleStopTimer = NULL;
+
+static void buzzerToneOn(int freq) {
+    ledcAttachPin(BUZZER_PIN, BUZZER_LEDC_CHANNEL);
+    ledcAttachPin(BUZZER_PIN_2, BUZZER_LEDC_CHANNEL);
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, freq);
+}
+
+static void buzzerToneOff() {
+    ledcWriteTone(BUZZER_LEDC_CHANNEL, 0);
+    ledcDetachPin(BUZZER_PIN);
+    ledcDetachPin(BUZZER_PIN_2);
+}
+
+static void armBuzzerSchedule() {
+    if (buzzerScheduleNext >= buzzerScheduleCount) {
+        return;
+    }
+    int64_t delayUs = buzzerSchedule[buzzerScheduleNext].startUs - esp_timer_get_time();
+    esp_timer_start_once(buzzerScheduleTimer, (uint64_t)((delayUs > 0) ? delayUs : 0));
+}
+
+static void buzzerScheduleCallback(void*) {
+    if (!buzzerScheduleActive.load(std::memory_order_acquire)) {
+        return; // Cancelled while this callback was being dispatched
+    }
+    const ToneCommand& tone = buzzerSchedule[buzzerScheduleNext++];
+    buzzerToneOn(tone.frequency);
+    esp_timer_stop(buzzerScheduleStopTimer);
+    esp_timer_start_once(buzzerScheduleStopTimer, (uint64_t)tone.durationMs * 1000);
+    armBuzzerSchedule();
+}
+
+static void buzzerScheduleStopCallback(void*) {
+    buzzerToneOff();
+    if (buzzerScheduleNext >= buzzerScheduleCount) {
+        buzzerScheduleActive.store(false, std::memory_order_release);
+    }
+}
+
+static void cancelBuzzerSchedule() {
+    if (!buzzerScheduleActive.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    esp_timer_stop(buzzerScheduleTimer);
+    esp_timer_stop(buzzerScheduleStopTimer);
+    buzzerToneOff();
+}
+
+static void playBuzzerTone(int freq, int duration) {
+    tone(BUZZER_PIN, freq, duration);
+    tone(BUZZER_PIN_2, freq, duration);
+    vTaskDelay(pdMS_TO_TICKS(duration + 5)); 
+    noTone(BUZZER_PIN);
+    noTone(BUZZER_PIN_2);
+}
+
+// Plays a cue on the buzzer note by note.
+static void playCueNotes(const BuzzerRequest& request, uint32_t generation) {
+    for (int i = 0; i < request.noteCount && i < MAX_CUE_NOTES; ++i) {
+        if (toneGeneration.load(std::memory_order_acquire) != generation) {
+            return;
+        }
+        const CueNote& note = request.notes[i];
+        if (note.frequency > 0 && note.duration > 0) {
+            playBuzzerTone(note.frequency, note.duration);
+        } else if (note.duration > 0) {
+            vTaskDelay(pdMS_TO_TICKS(note.duration));
+        }
+        if (note.gap > 0) {
+            vTaskDelay(pdMS_TO_TICKS(note.gap));
+        }
+    }
+}
 
 // --- Buzzer Task (Runs on Core 0) ---
-void buzzerTask(void *pvParameters) {
+void buzzerTask(void *) {
     BuzzerRequest receivedRequest;
-    TickType_t lastWakeTime = xTaskGetTickCount(); 
 
     for (;;) {
         if (xQueueReceive(buzzerQueue, &receivedRequest, portMAX_DELAY) == pdPASS) {
-            if (receivedRequest.frequency > 0 && receivedRequest.duration > 0) {
-                tone(BUZZER_PIN, receivedRequest.frequency, receivedRequest.duration);
-                tone(BUZZER_PIN_2, receivedRequest.frequency, receivedRequest.duration);
-                vTaskDelay(pdMS_TO_TICKS(receivedRequest.duration + 5)); 
-                noTone(BUZZER_PIN);
-                noTone(BUZZER_PIN_2);
+            if (receivedRequest.noteCount > 0) {
+                playCueNotes(receivedRequest, toneGeneration.load(std::memory_order_acquire));
+            } else if (receivedRequest.frequency > 0 && receivedRequest.duration > 0) {
+                if (receivedRequest.reportStart) {
+                    reportStartBeepEmitted(esp_timer_get_time(), false);
+                }
+                playBuzzerTone(receivedRequest.frequency, receivedRequest.duration);
             } else if (receivedRequest.duration > 0) {
                  vTaskDelay(pdMS_TO_TICKS(receivedRequest.duration));
             }
@@ -29,95 +141,179 @@ void buzzerTask(void *pvParameters) {
 
 // --- Audio Control Functions (Called from Core 1) ---
 
-// Resets the Bluetooth beep state variables.
+void reportStartBeepEmitted(int64_t emittedUs, bool viaBluetooth) {
+    startBeepEmittedUs = emittedUs;
+    startBeepViaBluetooth = viaBluetooth;
+    startBeepReported.store(true, std::memory_order_release);
+    postLoopEvent(LOOP_EVENT_START_BEEP);
+}
+
+bool takeStartBeepEmittedUs(int64_t &emittedUs, bool &viaBluetooth) {
+    if (!startBeepReported.exchange(false, std::memory_order_acquire)) {
+        return false;
+    }
+    emittedUs = startBeepEmittedUs;
+    viaBluetooth = startBeepViaBluetooth;
+    return true;
+}
+
+// Cancels queued and sounding tones (BT and buzzer cues).
 void reset_bt_beep_state() {
-    new_bt_beep_request = false;
-    current_bt_beep_is_active = false;
-    btBeepFrequency = 0; 
+    toneGeneration.fetch_add(1, std::memory_order_release);
+    cancelBuzzerSchedule();
+}
+
+bool popBtToneCommand(ToneCommand &command) {
+    return btToneRing.pop(command);
+}
+
+uint32_t getBtToneGeneration() {
+    return toneGeneration.load(std::memory_order_acquire);
 }
 
-// Plays a tone, APPLYING the global Bluetooth audio offset.
-// Used for critical timing sounds like timer start beeps.
+uint32_t getBtToneOverflowCount() {
+    return btToneRing.overflowCount();
+}
+
+// Plays a timing-critical tone (timer start beeps) as soon as possible; the
+// speaker latency is accounted for when the emitted time is taken.
 // Plays ONLY on BT if connected, otherwise ONLY on buzzer.
 void playTone(int freq, int duration) {
-    unsigned long now = millis();
+    int64_t now = esp_timer_get_time();
+    startBeepReported.store(false, std::memory_order_release);
+    // Drop any feedback still queued or playing.
+    reset_bt_beep_state();
+    xQueueReset(buzzerQueue);
     if (a2dp_source.is_connected()) {
         // --- Bluetooth Path Only ---
-        btBeepFrequency = freq;
-        btBeepDurationVolatile = duration; 
-        btBeepScheduledStartTime = now + currentBluetoothAudioOffsetMs; 
-        new_bt_beep_request = true; 
-        current_bt_beep_is_active = false; 
+        pushBtTone(freq, duration, now, true);
         
         // --- DO NOT send to buzzer queue when BT is connected ---
 
     } else {
         // --- Buzzer Only Path ---
-        BuzzerRequest request = {freq, duration};
+        BuzzerRequest request = {};
+        request.frequency = freq;
+        request.duration = duration;
+        request.reportStart = true;
         xQueueSend(buzzerQueue, &request, (TickType_t)0); 
     }
 }
 
-// Plays a tone for immediate UI feedback, IGNORING the global Bluetooth audio offset.
+// Plays a tone for immediate UI feedback.
 // Plays ONLY on BT if connected, otherwise ONLY on buzzer.
 void playFeedbackTone(int freq, int duration) {
-    unsigned long now = millis();
+    int64_t now = esp_timer_get_time();
     if (a2dp_source.is_connected()) {
         // --- Bluetooth Path Only ---
-        btBeepFrequency = freq;
-        btBeepDurationVolatile = duration;
-        btBeepScheduledStartTime = now; // No offset
-        new_bt_beep_request = true;
-        current_bt_beep_is_active = false;
+        pushBtTone(freq, duration, now, false);
 
         // --- DO NOT send to buzzer queue when BT is connected ---
 
     } else {
         // --- Buzzer Only Path ---
-        BuzzerRequest request = {freq, duration};
+        BuzzerRequest request = {};
+        request.frequency = freq;
+        request.duration = duration;
         xQueueSend(buzzerQueue, &request, (TickType_t)0); 
     }
 }
 
 
-// Plays a synchronized tone on buzzer and Bluetooth (with specified offset) for calibration.
-// This function INTENTIONALLY plays on both buzzer and BT simultaneously.
-// 'offsetMs' is the value being tested by the user.
+// Plays a synchronized tone on buzzer and Bluetooth for calibration.
+// This function INTENTIONALLY plays on both buzzer and BT: BT goes out now and
+// the buzzer waits 'offsetMs', the latency being tested by the user.
 void playSyncCalibrationTone(int freq, int duration, int offsetMs) {
-    unsigned long now = millis();
+    int64_t now = esp_timer_get_time();
     reset_bt_beep_state(); 
 
-    // 1. Send request to buzzer task (plays immediately on Core 0)
-    BuzzerRequest buzzerReq = {freq, duration};
+    // 1. Send request to buzzer task (a zero-frequency request is a pause)
+    if (offsetMs > 0) {
+        BuzzerRequest pauseReq = {};
+        pauseReq.duration = offsetMs;
+        xQueueSend(buzzerQueue, &pauseReq, (TickType_t)0);
+    }
+    BuzzerRequest buzzerReq = {};
+    buzzerReq.frequency = freq;
+    buzzerReq.duration = duration;
     xQueueSend(buzzerQueue, &buzzerReq, (TickType_t)0); 
 
-    // 2. Set up Bluetooth tone. Its scheduled start is offset from 'now'.
+    // 2. Set up Bluetooth tone, starting as soon as possible.
     if (a2dp_source.is_connected()) {
-        btBeepFrequency = freq;
-        btBeepDurationVolatile = duration;
-        btBeepScheduledStartTime = now + offsetMs; 
-        new_bt_beep_request = true;
-        current_bt_beep_is_active = false; 
+        pushBtTone(freq, duration, now, false);
     }
 }
 
 
-void playSuccessBeeps() {
-    int octave = 6; 
-    int freqs[] = {1047, 1175, 1319, 1397, 1568}; 
+void scheduleTones(const ToneCommand* tones, int count) {
+    reset_bt_beep_state();
+    if (count > MAX_SCHEDULED_TONES) count = MAX_SCHEDULED_TONES;
+    if (count <= 0) return;
+
+    if (a2dp_source.is_connected()) {
+        for (int i = 0; i < count; ++i) {
+            pushBtTone(tones[i].frequency, tones[i].durationMs, tones[i].startUs, false);
+        }
+        return;
+    }
 
-    for (int f_val : freqs) {
-        playFeedbackTone(f_val, BEEP_NOTE_DURATION_MS); // Use feedback tone (queued or BT)
-        vTaskDelay(pdMS_TO_TICKS(BEEP_NOTE_DURATION_MS + BEEP_NOTE_DELAY_MS)); 
+    if (buzzerScheduleTimer == NULL) {
+        esp_timer_create_args_t args = {};
+        args.callback = buzzerScheduleCallback;
+        args.name = "buzzerSched";
+        esp_timer_create(&args, &buzzerScheduleTimer);
+        args.callback = buzzerScheduleStopCallback;
+        args.name = "buzzerStop";
+        esp_timer_create(&args, &buzzerScheduleStopTimer);
     }
+    xQueueReset(buzzerQueue);
+    for (int i = 0; i < count; ++i) {
+        buzzerSchedule[i] = tones[i];
+    }
+    buzzerScheduleCount = count;
+    buzzerScheduleNext = 0;
+    buzzerScheduleActive.store(true, std::memory_order_release);
+    armBuzzerSchedule();
 }
 
-void playUnsuccessBeeps() {
-    int freq_val = 262; 
-    int repeatTone = 2;
-    unsigned long toneDuration = (unsigned long)(BEEP_NOTE_DURATION_MS * 1.5f);
-    for (int i = 0; i < repeatTone; ++i) {
-        playFeedbackTone(freq_val, toneDuration); // Use feedback tone (queued or BT)
-        vTaskDelay(pdMS_TO_TICKS(toneDuration + BEEP_NOTE_DELAY_MS * 2));
+// On BT the whole cue is queued up front with absolute start times, so the
+// A2DP callback plays it frame-accurately; otherwise the buzzer task plays it.
+void playCue(const CueNote* notes, int count) {
+    if (a2dp_source.is_connected()) {
+        int64_t startUs = esp_timer_get_time();
+        for (int i = 0; i < count && i < MAX_CUE_NOTES; ++i) {
+            if (notes[i].frequency > 0 && notes[i].duration > 0) {
+                pushBtTone(notes[i].frequency, notes[i].duration, startUs, false);
+            }
+            startUs += (int64_t)(notes[i].duration + notes[i].gap) * 1000;
+        }
+        return;
+    }
+
+    BuzzerRequest request = {};
+    request.noteCount = (uint8_t)min(max(count, 0), MAX_CUE_NOTES);
+    for (int i = 0; i < request.noteCount; ++i) {
+        request.notes[i] = notes[i];
+    }
+    if (request.noteCount > 0) {
+        xQueueSend(buzzerQueue, &request, (TickType_t)0);
     }
 }
+
+void playSuccessBeeps() {
+    static const uint16_t freqs[] = {1047, 1175, 1319, 1397, 1568}; 
+    CueNote notes[5];
+    for (int i = 0; i < 5; ++i) {
+        notes[i] = {freqs[i], (uint16_t)BEEP_NOTE_DURATION_MS, (uint16_t)BEEP_NOTE_DELAY_MS};
+    }
+    playCue(notes, 5);
+}
+
+void playUnsuccessBeeps() {
+    uint16_t toneDuration = (uint16_t)(BEEP_NOTE_DURATION_MS * 1.5f);
+    CueNote notes[2] = {
+        {262, toneDuration, (uint16_t)(BEEP_NOTE_DELAY_MS * 2)},
+        {262, toneDuration, (uint16_t)(BEEP_NOTE_DELAY_MS * 2)},
+    };
+    playCue(notes, 2);
+}
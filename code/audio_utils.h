@@ -2,26 +2,60 @@
 #define AUDIO_UTILS_H
 
 #include <M5StickCPlus2.h> // For M5 object if used directly, or Arduino types
+#include "config.h"        // For CueNote
+#include "tone_command.h"
 
-// Function to reset Bluetooth beep state variables
+// Plays buzzer requests from buzzerQueue, one at a time (runs on Core 0).
+void buzzerTask(void *pvParameters);
+
+// Cancels queued and sounding Bluetooth tones and any buzzer cue.
 void reset_bt_beep_state();
 
-// Plays a tone, APPLYING the global Bluetooth audio offset.
-// Used for critical timing sounds like timer start beeps.
+// --- Bluetooth Tone Commands ---
+// Consumer side, for the A2DP callback only. Commands whose generation is
+// older than getBtToneGeneration() have been cancelled.
+bool popBtToneCommand(ToneCommand &command);
+uint32_t getBtToneGeneration();
+
+// Number of BT tone commands dropped because the ring was full.
+uint32_t getBtToneOverflowCount();
+
+// Plays a timing-critical tone (timer start beeps) as soon as possible and
+// reports when it went out (see takeStartBeepEmittedUs). Cancels pending cues.
 void playTone(int freq, int duration);
 
-// Plays a tone for immediate UI feedback, IGNORING the global Bluetooth audio offset.
-// Schedules BT audio to start as soon as possible.
+// Plays a tone for immediate UI feedback. Schedules BT audio to start as soon as possible.
 void playFeedbackTone(int freq, int duration);
 
-// Plays a sequence of tones for success feedback.
+// Plays tones at absolute esp_timer times ('startUs', 'frequency' and
+// 'durationMs' of each command; up to MAX_SCHEDULED_TONES, in time order),
+// independent of the UI loop. On BT they are queued with their start times for
+// the A2DP callback; on the buzzer a one-shot esp_timer fires each one at its
+// deadline. Replaces any earlier schedule; reset_bt_beep_state() cancels it.
+void scheduleTones(const ToneCommand* tones, int count);
+
+// Plays a cue (up to MAX_CUE_NOTES notes) in the background and returns
+// immediately: on BT if connected, otherwise on the buzzer.
+void playCue(const CueNote* notes, int count);
+
+// Plays a sequence of tones for success feedback (non-blocking).
 void playSuccessBeeps();
 
-// Plays a sequence of tones for unsuccessful/error feedback.
+// Plays a sequence of tones for unsuccessful/error feedback (non-blocking).
 void playUnsuccessBeeps();
 
-// Plays a synchronized tone on buzzer and Bluetooth for calibration.
-// 'offsetMs' is the value being tested by the user.
+// --- Start Beep Reporting ---
+// playTone() beeps report the esp_timer time their first sample actually went
+// out (buzzer task or A2DP frame clock). Returns true once per report.
+// 'viaBluetooth' is set when the time is that of the A2DP frame, which the
+// speaker plays currentBluetoothAudioOffsetMs later.
+bool takeStartBeepEmittedUs(int64_t &emittedUs, bool &viaBluetooth);
+
+// Called from the buzzer task / A2DP callback.
+void reportStartBeepEmitted(int64_t emittedUs, bool viaBluetooth);
+
+// Plays a tone on Bluetooth now and on the buzzer 'offsetMs' later, so the two
+// line up when 'offsetMs' matches the speaker latency. Used to check the offset by ear.
 void playSyncCalibrationTone(int freq, int duration, int offsetMs); 
 
 #endif // AUDIO_UTILS_H
@@ -5,13 +5,13 @@
 #include "system_utils.h"
 #include "nvs_utils.h"
 #include "display_utils.h"
+#include "shot_capture.h"
+#include "loop_events.h"
+#include <esp_timer.h>
 #include <math.h>
+#include <algorithm>
 #include <vector> // Ensure vector is included
 
-// **** Ensure this line is COMMENTED OUT for normal beep testing ****
-// #define DEBUG_A2DP_AUDIO_PATH 
-// *******************************************************************
-
 const char *avrc_metadata[] = {
     "title", "ShotTimer Audio", "artist", "M5StickC+", "album", "Timer Sounds",
     "track_num", "1", "num_tracks", "1", "genre", "Utility", NULL
@@ -26,70 +26,13 @@ String bdAddrToString(const esp_bd_addr_t address) {
 }
 
 
-int32_t get_data_frames(Frame *frames, int32_t frame_count) {
-    static float m_time = 0.0f; 
-
-    float m_amplitude;
-    float current_freq;
-    float m_deltaTime = 1.0f / 44100.0f;
-    float m_phase = 0.0f;
-    float pi_2 = PI * 2.0f;
-
-#ifdef DEBUG_A2DP_AUDIO_PATH
-    current_freq = 440.0f;    
-    m_amplitude = 8000.0f;    
-#else
-    unsigned long now = millis();
-
-    if (new_bt_beep_request && !current_bt_beep_is_active && now >= btBeepScheduledStartTime) {
-        m_time = 0.0f; 
-        current_bt_beep_is_active = true;
-        new_bt_beep_request = false; 
-        current_bt_beep_actual_end_time = now + btBeepDurationVolatile; 
-    }
-
-    if (current_bt_beep_is_active) {
-        if (now < current_bt_beep_actual_end_time && btBeepFrequency > 0) {
-            current_freq = (float)btBeepFrequency;
-            m_amplitude = 10000.0f; 
-        } else {
-            current_bt_beep_is_active = false;
-            btBeepFrequency = 0; 
-        }
-    }
-
-    if (!current_bt_beep_is_active) {
-        if (a2dp_source.is_connected()) {
-            current_freq = 1.0f;    
-            m_amplitude = 1.0f;     
-        } else {
-            current_freq = 1.0f;    
-            m_amplitude = 0.0f;     
-        }
-    }
-#endif
-
-    for (int sample = 0; sample < frame_count; ++sample) {
-        float angle = pi_2 * current_freq * m_time + m_phase;
-        int16_t audio_sample = (int16_t)(m_amplitude * sin(angle));
-        frames[sample].channel1 = audio_sample;
-        frames[sample].channel2 = audio_sample;
-        m_time += m_deltaTime;
-        if (m_time >= 1.0f) { 
-            m_time -= 1.0f;
-        }
-    }
-
-    delay(1); 
-    return frame_count;
-}
-
 void a2dp_connection_state_changed_callback(esp_a2d_connection_state_t state, void *object_instance) {
     if (state == ESP_A2D_CONNECTION_STATE_CONNECTED) {
         bluetoothJustConnected = true; 
     } else if (state == ESP_A2D_CONNECTION_STATE_DISCONNECTED) {
         bluetoothJustDisconnected = true; 
     }
+    postLoopEvent(LOOP_EVENT_BLUETOOTH);
 }
 
 // SSID Callback: Used for auto-connect AND discovery/scanning
@@ -126,7 +69,7 @@ bool a2dp_ssid_callback(const char *ssid, esp_bd_addr_t address, int rrsi) {
 // Manages the A2DP discovery process and device selection
 void handleBluetoothScanning() {
     resetActivityTimer(); 
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = MENU_ITEMS_PER_SCREEN_PORTRAIT + 2; 
 
     if (scanInProgress) {
@@ -164,10 +107,9 @@ void handleBluetoothScanning() {
              scanInProgress = false;
              discoveredBtDevices.clear(); 
              setState(stateBeforeScan);   
-             currentMenuSelection = 5;    
-             int btMenuItemsPerScreen = (StickCP2.Lcd.getRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
+             currentMenuSelection = 6;    
+             int btMenuItemsPerScreen = (uiRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
              menuScrollOffset = max(0, currentMenuSelection - btMenuItemsPerScreen + 1);
-             StickCP2.Lcd.fillScreen(BLACK);
              return;
         }
 
@@ -212,10 +154,9 @@ void handleBluetoothScanning() {
         // Discovery is already stopped as scanInProgress is false here
         discoveredBtDevices.clear(); 
         setState(stateBeforeScan);   
-        currentMenuSelection = 5;    
-        int btMenuItemsPerScreen = (StickCP2.Lcd.getRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
+        currentMenuSelection = 6;    
+        int btMenuItemsPerScreen = (uiRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
         menuScrollOffset = max(0, currentMenuSelection - btMenuItemsPerScreen + 1);
-        StickCP2.Lcd.fillScreen(BLACK);
         return;
     }
 
@@ -234,6 +175,7 @@ void handleBluetoothScanning() {
             
             if (!deviceToConnect.isEmpty()) {
                 currentBluetoothDeviceName = deviceToConnect; // Update global variable
+                loadBtLatencyForDevice(currentBluetoothDeviceName, currentBluetoothAudioOffsetMs); // If calibrated before
                 saveSettings(); // Save the newly selected device name to NVS
                 playSuccessBeeps(); // Indicate selection success
 
@@ -253,9 +195,8 @@ void handleBluetoothScanning() {
                 discoveredBtDevices.clear(); // Clear scan results list
                 setState(stateBeforeScan);   // Return to Bluetooth Settings menu
                 currentMenuSelection = 0;    // Highlight "Connect" item
-                int btMenuItemsPerScreen = (StickCP2.Lcd.getRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
+                int btMenuItemsPerScreen = (uiRotation() % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
                 menuScrollOffset = max(0, currentMenuSelection - btMenuItemsPerScreen + 1);
-                StickCP2.Lcd.fillScreen(BLACK); // Prepare for BT settings menu display
 
             } else {
                 playUnsuccessBeeps();
@@ -266,3 +207,146 @@ void handleBluetoothScanning() {
     }
 }
 
+
+// --- Bluetooth Latency Calibration ---
+// Each trial plays a short burst through A2DP, takes the time its first frame
+// went out from the frame clock, and has the capture task look for the burst
+// on the mic. The median of the trials that found it is the speaker latency.
+enum BtLatencyPhase {
+    BTLAT_SEND,
+    BTLAT_WAIT_EMIT,
+    BTLAT_WAIT_PROBE,
+    BTLAT_GAP,
+    BTLAT_DONE
+};
+
+static BtLatencyPhase btLatPhase = BTLAT_DONE;
+static int btLatTrial = 0;
+static int btLatValidCount = 0;
+static int btLatTrialMs[BT_LATENCY_TRIALS];
+static int btLatLastMs = -1;
+static int btLatResultMs = -1;
+static unsigned long btLatPhaseStart = 0;
+static int64_t btLatEmittedUs = 0;
+
+void startBtLatencyCalibration() {
+    btLatPhase = BTLAT_GAP; // Short settle before the first burst
+    btLatTrial = -1;
+    btLatValidCount = 0;
+    btLatLastMs = -1;
+    btLatResultMs = -1;
+    btLatPhaseStart = millis();
+    reset_bt_beep_state();
+    setState(CALIBRATE_BT_LATENCY);
+    redrawMenu = true;
+}
+
+static void finishBtLatencyCalibration() {
+    btLatPhase = BTLAT_DONE;
+    if (btLatValidCount >= BT_LATENCY_MIN_VALID_TRIALS) {
+        std::sort(btLatTrialMs, btLatTrialMs + btLatValidCount);
+        btLatResultMs = btLatTrialMs[btLatValidCount / 2];
+        playSuccessBeeps();
+    } else {
+        btLatResultMs = -1;
+        playUnsuccessBeeps();
+    }
+    redrawMenu = true;
+}
+
+void handleBtLatencyCalibration() {
+    resetActivityTimer();
+    unsigned long now = millis();
+
+    if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
+        reset_bt_beep_state();
+        btLatPhase = BTLAT_DONE;
+        setState(SETTINGS_MENU_BLUETOOTH);
+        redrawMenu = true;
+        return;
+    }
+
+    if (btLatPhase != BTLAT_DONE && !a2dp_source.is_connected()) {
+        btLatValidCount = 0;
+        finishBtLatencyCalibration();
+    }
+
+    switch (btLatPhase) {
+        case BTLAT_SEND:
+            playTone(BT_LATENCY_BURST_HZ, BT_LATENCY_BURST_MS);
+            btLatPhaseStart = now;
+            btLatPhase = BTLAT_WAIT_EMIT;
+            break;
+
+        case BTLAT_WAIT_EMIT: {
+            int64_t emittedUs;
+            bool viaBluetooth;
+            if (takeStartBeepEmittedUs(emittedUs, viaBluetooth) && viaBluetooth) {
+                btLatEmittedUs = emittedUs;
+                btLatPhaseStart = now;
+                // A probe from a trial that timed out may still be running: count this one as failed.
+                if (requestLatencyProbe(emittedUs, emittedUs + (int64_t)(BT_AUDIO_OFFSET_MAX_MS + BT_LATENCY_BURST_MS) * 1000)) {
+                    btLatPhase = BTLAT_WAIT_PROBE;
+                } else {
+                    btLatLastMs = -1;
+                    btLatPhase = BTLAT_GAP;
+                    redrawMenu = true;
+                }
+            } else if (now - btLatPhaseStart > BT_LATENCY_EMIT_TIMEOUT_MS) {
+                btLatPhaseStart = now;
+                btLatPhase = BTLAT_GAP;
+            }
+            break;
+        }
+
+        case BTLAT_WAIT_PROBE: {
+            int64_t onsetUs;
+            float peakToMean;
+            if (takeLatencyProbeResult(onsetUs, peakToMean)) {
+                if (peakToMean >= BT_LATENCY_MIN_PEAK_TO_MEAN && onsetUs >= btLatEmittedUs) {
+                    btLatLastMs = (int)((onsetUs - btLatEmittedUs + 500) / 1000);
+                    btLatTrialMs[btLatValidCount++] = btLatLastMs;
+                } else {
+                    btLatLastMs = -1;
+                }
+                btLatPhaseStart = now;
+                btLatPhase = BTLAT_GAP;
+                redrawMenu = true;
+            } else if (now - btLatPhaseStart > (unsigned long)BT_AUDIO_OFFSET_MAX_MS + 1000) {
+                btLatPhaseStart = now;
+                btLatPhase = BTLAT_GAP;
+            }
+            break;
+        }
+
+        case BTLAT_GAP:
+            if (now - btLatPhaseStart >= BT_LATENCY_TRIAL_GAP_MS) {
+                if (++btLatTrial >= BT_LATENCY_TRIALS) {
+                    finishBtLatencyCalibration();
+                } else {
+                    btLatPhase = BTLAT_SEND;
+                    redrawMenu = true;
+                }
+            }
+            break;
+
+        case BTLAT_DONE:
+            if (StickCP2.BtnA.wasClicked()) {
+                if (btLatResultMs >= 0) {
+                    currentBluetoothAudioOffsetMs = btLatResultMs;
+                    saveBtLatencyForDevice(currentBluetoothDeviceName, currentBluetoothAudioOffsetMs);
+                    playSuccessBeeps();
+                }
+                setState(SETTINGS_MENU_BLUETOOTH);
+                redrawMenu = true;
+                return;
+            }
+            break;
+    }
+
+    if (redrawMenu) {
+        int trialShown = (btLatTrial < 0) ? 0 : min(btLatTrial + 1, BT_LATENCY_TRIALS);
+        displayBtLatencyCalibrationScreen(trialShown, BT_LATENCY_TRIALS, btLatLastMs, btLatResultMs, btLatPhase == BTLAT_DONE);
+        redrawMenu = false;
+    }
+}
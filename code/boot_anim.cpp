@@ -0,0 +1,71 @@
+#include "boot_anim.h"
+#include "le_bytes.h"
+#include <string.h>
+
+bool bootAnimParseHeader(const uint8_t* data, size_t length, BootAnimHeader& header) {
+    if (length < BOOT_ANIM_HEADER_BYTES) return false;
+    header.magic = readU32(data);
+    header.width = readU16(data + 4);
+    header.height = readU16(data + 6);
+    header.scale = data[8];
+    header.reserved = data[9];
+    header.frameCount = readU16(data + 10);
+    header.frameDelayMs = readU16(data + 12);
+    header.reserved2 = readU16(data + 14);
+    header.maxFrameBytes = readU32(data + 16);
+    header.reserved3 = readU32(data + 20);
+    return header.magic == BOOT_ANIM_MAGIC && header.width > 0 && header.height > 0 &&
+           header.scale > 0 && header.frameCount > 0;
+}
+
+bool bootAnimDecodeFrame(const uint8_t* ops, size_t length, uint16_t* pixels, int width, int height,
+                         int& dirtyRowBegin, int& dirtyRowEnd) {
+    const size_t pixelCount = (size_t)width * height;
+    size_t pos = 0;
+    size_t pixel = 0;
+    size_t firstDirty = pixelCount;
+    size_t lastDirty = 0;
+
+    while (pos < length) {
+        uint8_t op = ops[pos++];
+        uint8_t kind = op >> 6;
+        size_t count = (op & 0x3F) + 1;
+        if ((op & 0x3F) == BOOT_ANIM_COUNT_EXTENDED) {
+            if (pos + 2 > length) return false;
+            count = readU16(ops + pos);
+            pos += 2;
+        }
+        if (count == 0 || pixel + count > pixelCount) return false;
+
+        if (kind == BOOT_ANIM_SKIP) {
+            pixel += count;
+            continue;
+        }
+        if (kind == BOOT_ANIM_RUN) {
+            if (pos + 2 > length) return false;
+            uint16_t color;
+            memcpy(&color, ops + pos, 2); // Already in panel byte order
+            pos += 2;
+            for (size_t i = 0; i < count; ++i) {
+                pixels[pixel + i] = color;
+            }
+        } else if (kind == BOOT_ANIM_LITERAL) {
+            if (pos + 2 * count > length) return false;
+            memcpy(pixels + pixel, ops + pos, 2 * count);
+            pos += 2 * count;
+        } else {
+            return false;
+        }
+        if (pixel < firstDirty) firstDirty = pixel;
+        lastDirty = pixel + count - 1;
+        pixel += count;
+    }
+
+    if (firstDirty == pixelCount) {
+        dirtyRowBegin = dirtyRowEnd = 0;
+    } else {
+        dirtyRowBegin = (int)(firstDirty / width);
+        dirtyRowEnd = (int)(lastDirty / width) + 1;
+    }
+    return true;
+}
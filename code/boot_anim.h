@@ -0,0 +1,58 @@
+#ifndef BOOT_ANIM_H
+#define BOOT_ANIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Packed boot animation (/boot.anim), written by host/pack_boot_anim.py.
+//
+// Layout (little-endian):
+//   header       BootAnimHeader (24 bytes)
+//   index        uint32_t offsets[frameCount + 1]; frame i is bytes [offsets[i], offsets[i+1])
+//   frames       one op stream per frame
+//
+// A frame is a delta against the one before it (the first against black), as
+// ops over the pixels in raster order. Each op starts with a byte: the top two
+// bits are the kind, the low six the pixel count minus one; 63 means the count
+// follows as a uint16_t instead.
+//   SKIP     pixels are unchanged
+//   RUN      one color follows, repeated
+//   LITERAL  'count' colors follow
+// Colors are RGB565 in panel byte order (big-endian), so frames can be sent
+// to the panel as they are. Each stored pixel covers scale x scale panel pixels.
+
+static const uint32_t BOOT_ANIM_MAGIC = 0x314E4142; // "BAN1"
+
+enum BootAnimOp : uint8_t {
+    BOOT_ANIM_SKIP = 0,
+    BOOT_ANIM_RUN = 1,
+    BOOT_ANIM_LITERAL = 2,
+};
+
+static const uint8_t BOOT_ANIM_COUNT_EXTENDED = 63;
+
+struct BootAnimHeader {
+    uint32_t magic;
+    uint16_t width;          // Stored frame size
+    uint16_t height;
+    uint8_t scale;
+    uint8_t reserved;
+    uint16_t frameCount;
+    uint16_t frameDelayMs;
+    uint16_t reserved2;
+    uint32_t maxFrameBytes;  // Largest op stream, for sizing the read buffer
+    uint32_t reserved3;
+};
+
+static const size_t BOOT_ANIM_HEADER_BYTES = 24;
+
+// Reads and checks the header at the start of the file.
+bool bootAnimParseHeader(const uint8_t* data, size_t length, BootAnimHeader& header);
+
+// Applies one frame's ops to 'pixels' (width * height, panel byte order),
+// which must hold the previous frame. Rows [dirtyRowBegin, dirtyRowEnd) are
+// the ones that changed (empty if none). Returns false on malformed data.
+bool bootAnimDecodeFrame(const uint8_t* ops, size_t length, uint16_t* pixels, int width, int height,
+                         int& dirtyRowBegin, int& dirtyRowEnd);
+
+#endif // BOOT_ANIM_H
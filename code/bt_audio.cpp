@@ -0,0 +1,100 @@
+#include "bt_audio.h"
+#include "config.h"
+#include "audio_utils.h"
+#include "tone_synth.h"
+#include <esp_timer.h>
+
+// **** Ensure this line is COMMENTED OUT for normal beep testing ****
+// #define DEBUG_A2DP_AUDIO_PATH 
+// *******************************************************************
+
+static ToneSynth btToneSynth;
+static_assert(sizeof(Frame) == 2 * sizeof(int16_t), "Frame must be interleaved int16 stereo");
+
+void bt_tone_synth_begin() {
+    btToneSynth.begin(A2DP_SAMPLE_RATE_HZ, BT_TONE_RAMP_MS);
+}
+
+// --- A2DP frame clock ---
+// Output frames are counted and mapped to esp_timer microseconds. The stack asks
+// for a buffer at or after the time its first frame is due, so the lowest
+// estimate of frame 0's time is kept, slewing slowly to follow clock drift.
+static uint64_t btFramesOut = 0;
+static int64_t btFrameZeroUs = 0;
+static bool btFrameClockAnchored = false;
+
+static int64_t btFrameToUs(uint64_t frame) {
+    return btFrameZeroUs + (int64_t)((frame * 1000000ULL) / A2DP_SAMPLE_RATE_HZ);
+}
+
+// Next command from the tone ring, held until its start frame comes up.
+static ToneCommand btNextTone;
+static bool btHasNextTone = false;
+static uint32_t btActiveGeneration = 0; // Generation of the sounding tone
+
+// Fetches the next tone that has not been cancelled. A command stamped with a
+// newer generation than 'generation' was pushed after it was read, so it is kept.
+static bool peekBtTone(uint32_t generation) {
+    if (btHasNextTone && (int32_t)(btNextTone.generation - generation) < 0) {
+        btHasNextTone = false;
+    }
+    while (!btHasNextTone && popBtToneCommand(btNextTone)) {
+        btHasNextTone = (int32_t)(btNextTone.generation - generation) >= 0;
+    }
+    return btHasNextTone;
+}
+
+int32_t get_data_frames(Frame *frames, int32_t frame_count) {
+    int16_t* out = (int16_t*)frames;
+    int64_t nowUs = esp_timer_get_time();
+    int64_t candidateZeroUs = nowUs - (int64_t)((btFramesOut * 1000000ULL) / A2DP_SAMPLE_RATE_HZ);
+    if (!btFrameClockAnchored || candidateZeroUs - btFrameZeroUs > A2DP_CLOCK_RESYNC_US) {
+        btFrameZeroUs = candidateZeroUs;
+        btFrameClockAnchored = true;
+    } else {
+        btFrameZeroUs = min(btFrameZeroUs + A2DP_CLOCK_SLEW_US_PER_CALLBACK, candidateZeroUs);
+    }
+
+#ifdef DEBUG_A2DP_AUDIO_PATH
+    if (!btToneSynth.isActive()) {
+        btToneSynth.start(440, 8000, UINT32_MAX);
+    }
+    btToneSynth.render(out, (size_t)frame_count);
+#else
+    // Tones cancelled from the main loop are released.
+    uint32_t generation = getBtToneGeneration();
+    if ((int32_t)(btActiveGeneration - generation) < 0) {
+        btToneSynth.stop();
+        btActiveGeneration = generation;
+    }
+
+    // Each queued tone starts on its exact frame, partway into this buffer if need be.
+    int32_t pos = 0;
+    while (pos < frame_count) {
+        int32_t startOffset = frame_count;
+        if (peekBtTone(generation)) {
+            int64_t leadUs = btNextTone.startUs - btFrameToUs(btFramesOut + (uint64_t)pos);
+            int64_t leadFrames = (leadUs <= 0) ? 0 : (leadUs * A2DP_SAMPLE_RATE_HZ) / 1000000;
+            if (leadFrames < frame_count - pos) {
+                startOffset = pos + (int32_t)leadFrames;
+            }
+        }
+
+        btToneSynth.render(out + 2 * pos, (size_t)(startOffset - pos));
+        pos = startOffset;
+        if (pos == frame_count) break;
+
+        int64_t startUs = btFrameToUs(btFramesOut + (uint64_t)pos);
+        uint32_t durationSamples = (uint32_t)((uint64_t)btNextTone.durationMs * A2DP_SAMPLE_RATE_HZ / 1000);
+        btToneSynth.start(btNextTone.frequency, BT_TONE_AMPLITUDE, durationSamples);
+        btActiveGeneration = btNextTone.generation;
+        if (btNextTone.reportStart) {
+            reportStartBeepEmitted(startUs, true);
+        }
+        btHasNextTone = false;
+    }
+#endif
+
+    btFramesOut += (uint64_t)frame_count;
+    return frame_count;
+}
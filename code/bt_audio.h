@@ -0,0 +1,17 @@
+#ifndef BT_AUDIO_H
+#define BT_AUDIO_H
+
+#include <Arduino.h>
+#include "BluetoothA2DPSource.h" // Frame
+
+// The A2DP data callback: BT tones from the tone ring (audio_utils.h) are
+// rendered starting on the frame they are due, on a frame clock that maps
+// output frames to esp_timer time.
+
+// Prepares the tone synth used by get_data_frames(). Call before starting A2DP.
+void bt_tone_synth_begin();
+
+// Runs in the Bluetooth stack's task: no allocation, no blocking.
+int32_t get_data_frames(Frame *frames, int32_t frame_count);
+
+#endif // BT_AUDIO_H
@@ -24,115 +24,42 @@
 #include "bluetooth_utils.h"
 #include "nvs_utils.h"
 #include "system_utils.h"
-
-
-// --- Global Variable Definitions ---
-TimerState currentState = BOOT_SCREEN;
-TimerState previousState = BOOT_SCREEN;
-TimerState stateBeforeEdit = SETTINGS_MENU_MAIN;
-TimerState stateBeforeScan = SETTINGS_MENU_BLUETOOTH;
-OperatingMode currentMode = MODE_LIVE_FIRE;
-unsigned long startTime = 0;
-unsigned long lastDisplayUpdateTime = 0;
-unsigned long lastActivityTime = 0;
-
-int currentMaxShots = 10;
-unsigned long currentBeepDuration = 150;
-int currentBeepToneHz = 2000;
-int shotThresholdRms = 15311;
-int dryFireParBeepCount = 3;
-float dryFireParTimesSec[MAX_PAR_BEEPS];
-float recoilThreshold = 1.5f;
-int screenRotationSetting = 3;
-bool playBootAnimation = true;
-bool enableAutoSleep = true;
-
-BluetoothA2DPSource a2dp_source;
-String currentBluetoothDeviceName = "LEXON MINO L";
-bool currentBluetoothAutoReconnect = false;
-int currentBluetoothVolume = 80;
-int currentBluetoothAudioOffsetMs = 0; 
-bool bluetoothJustConnected = false;
-bool bluetoothJustDisconnected = false;
-
-// Volatile variables for A2DP audio callback
-volatile int btBeepFrequency = 0;
-volatile unsigned long btBeepScheduledStartTime = 0;
-volatile unsigned int btBeepDurationVolatile = 0;
-volatile bool new_bt_beep_request = false;
-volatile bool current_bt_beep_is_active = false; 
-volatile unsigned long current_bt_beep_actual_end_time = 0;
-
-// --- Timer State Variables ---
-volatile bool is_listening_active = false;      // Definition
-volatile unsigned long beep_audio_end_time = 0; // Definition
-
-
-ESP32BluetoothScanner btScanner;
-std::vector<BTDevice> discoveredBtDevices;
-int scanMenuSelection = 0;
-int scanMenuScrollOffset = 0;
-bool scanInProgress = false;
-unsigned long scanStartTime = 0;
-
-int shotCount = 0;
-unsigned long shotTimestamps[MAX_SHOTS_LIMIT];
-float splitTimes[MAX_SHOTS_LIMIT];
-unsigned long lastShotTimestamp = 0;
-unsigned long lastDetectionTime = 0;
-
-int currentMenuSelection = 0;
-int menuScrollOffset = 0;
-int settingsMenuLevel = 0;
-unsigned long btnTopPressTime = 0;
-bool btnTopHeld = false;
-bool redrawMenu = true;
-
-EditableSetting settingBeingEdited = EDIT_NONE;
-int editingIntValue = 0;
-unsigned long editingULongValue = 0;
-float editingFloatValue = 0.0f;
-bool editingBoolValue = false;
-const char* editingSettingName = "";
-
-String fileListNames[MAX_FILES_LIST];
-size_t fileListSizes[MAX_FILES_LIST];
-int fileListCount = 0;
-int fileListScrollOffset = 0;
-
-float currentCyclePeakRMS = 0.0f;
-float peakRMSOverall = 0.0f;
-
-Preferences preferences;
-float peakBatteryVoltage = 4.2f;
-float currentBatteryVoltage = 0.0f;
-bool lowBatteryWarning = false;
-unsigned long lastBatteryCheckTime = 0;
-
-M5MicPeakRMS micPeakRMS;
-
-int currentJpgFrame = 1;
-bool filesystem_ok_for_boot = false;
-unsigned long lastFrameTime = 0;
-
-unsigned long randomDelayStartMs = 0;
-unsigned long parTimerStartTime = 0;
-unsigned long beepSequenceStartTime = 0;
-int beepsPlayed = 0;
-unsigned long nextBeepTime = 0;
-unsigned long lastBeepTime = 0;
-
-unsigned long lastSoundPeakTime = 0;
-bool checkingForRecoil = false;
-float peakRecoilValue = 0.0f;
-// AVRC metadata is defined in bluetooth_utils.cpp
-
-// --- FreeRTOS Handles ---
-QueueHandle_t buzzerQueue = NULL; 
-TaskHandle_t buzzerTaskHandle = NULL; 
-
-// Forward declaration for the task function (defined in audio_utils.cpp)
-void buzzerTask(void *pvParameters); 
+#include "shot_capture.h"
+#include "imu_pipeline.h"
+#include "ui_render.h"
+#include "loop_events.h"
+#include "loop_profiler.h"
+#include "detector_tuning.h"
+#include "session_journal.h"
+#include "state_dispatch.h"
+
+// Applies DETECTOR_TUNING_PATH (written by host/sweep_detector) once: the
+// values become the stored settings and the file is removed. Runs before the
+// mic capture task configures the detector.
+static void importDetectorTuning() {
+    if (!LittleFS.exists(DETECTOR_TUNING_PATH)) return;
+    File file = LittleFS.open(DETECTOR_TUNING_PATH, FILE_READ);
+    uint8_t data[DETECTOR_TUNING_BYTES + 1];
+    size_t length = file ? file.read(data, sizeof(data)) : 0;
+    file.close();
+    LittleFS.remove(DETECTOR_TUNING_PATH);
+
+    DetectorTuning tuning;
+    if (!detectorTuningDecode(data, length, tuning)) {
+        displayBootScreen("Tuning", "", "Invalid file");
+        delay(1500);
+        return;
+    }
+    shotThresholdRms = min(max((int)tuning.shotThresholdRms, 0), 32000);
+    shotMarginDb = min(max((int)tuning.shotMarginDb, SHOT_MARGIN_DB_MIN), SHOT_MARGIN_DB_MAX);
+    shotLockoutMs = min(max((unsigned long)tuning.shotLockoutMs, SHOT_LOCKOUT_MS_MIN), SHOT_LOCKOUT_MS_MAX);
+    if (tuning.recoilThreshold >= 0.5f && tuning.recoilThreshold <= 5.0f) {
+        recoilThreshold = tuning.recoilThreshold;
+    }
+    saveSettings();
+    displayBootScreen("Tuning", "", "Imported");
+    delay(1500);
+}
 
 // --- Setup ---
 void setup() {
@@ -160,7 +87,8 @@ void setup() {
     }
     micPeakRMS.resetPeak();
 
-    if (!StickCP2.Imu.begin()) {
+    bool imu_ok = StickCP2.Imu.begin() && imuPipelineBegin();
+    if (!imu_ok) {
         displayBootScreen("WARNING", "", "IMU Init Failed!");
         // playUnsuccessBeeps(); 
         delay(2000);
@@ -173,6 +101,7 @@ void setup() {
         filesystem_ok_for_boot = false;
     } else {
         filesystem_ok_for_boot = true;
+        importDetectorTuning();
     }
 
     // --- Create Buzzer Task and Queue ---
@@ -197,9 +126,74 @@ void setup() {
     }
     // --- End Buzzer Task Setup ---
 
+    // --- Create Mic Capture Task ---
+    // Owns the mic from here on: shots are detected and timestamped there, not in loop().
+    xTaskCreatePinnedToCore(
+        micCaptureTask,
+        "MicCaptureTask",
+        MIC_CAPTURE_TASK_STACK_SIZE,
+        NULL,
+        MIC_CAPTURE_TASK_PRIORITY,
+        &micCaptureTaskHandle,
+        MIC_CAPTURE_TASK_CORE);
+
+    if (micCaptureTaskHandle == NULL) {
+         displayBootScreen("ERROR", "", "Mic Task Fail!");
+         while(true);
+    }
+    // --- End Mic Capture Task Setup ---
+
+    // --- Create IMU Task ---
+    // Drains the accel FIFO into a timestamped history; Noisy Range looks recoil up there.
+    if (imu_ok) {
+        xTaskCreatePinnedToCore(
+            imuPipelineTask,
+            "ImuTask",
+            IMU_TASK_STACK_SIZE,
+            NULL,
+            IMU_TASK_PRIORITY,
+            &imuTaskHandle,
+            IMU_TASK_CORE);
+
+        if (imuTaskHandle == NULL) {
+             displayBootScreen("ERROR", "", "IMU Task Fail!");
+             while(true);
+        }
+    }
+    // --- End IMU Task Setup ---
+
+    // --- Create UI Render Task ---
+    // Draws every screen from snapshots published by loop().
+    if (!uiRenderBegin()) {
+        displayBootScreen("ERROR", "", "Queue Fail!");
+        while(true);
+    }
+    xTaskCreatePinnedToCore(
+        uiRenderTask,
+        "UiRenderTask",
+        UI_RENDER_TASK_STACK_SIZE,
+        NULL,
+        UI_RENDER_TASK_PRIORITY,
+        &uiRenderTaskHandle,
+        UI_RENDER_TASK_CORE);
+
+    if (uiRenderTaskHandle == NULL) {
+         displayBootScreen("ERROR", "", "UI Task Fail!");
+         while(true);
+    }
+    // --- End UI Render Task Setup ---
+
+    // --- Session Journal ---
+    // Finished strings are appended to LittleFS by their own task; without
+    // the filesystem they are just not kept.
+    if (filesystem_ok_for_boot) {
+        sessionJournalBegin();
+    }
+
 
     checkBattery(); 
 
+    bt_tone_synth_begin();
     a2dp_source.set_auto_reconnect(false); 
     a2dp_source.set_data_callback_in_frames(get_data_frames);
     a2dp_source.set_volume(currentBluetoothVolume);
@@ -217,203 +211,83 @@ void setup() {
     delay(500); 
 
     resetActivityTimer();
+    calibrateProfiler();
+    loopEventsBegin();
 
     if (filesystem_ok_for_boot && playBootAnimation) {
         setState(BOOT_JPG_SEQUENCE);
         currentJpgFrame = 1;
         lastFrameTime = 0;
         StickCP2.Lcd.fillScreen(BLACK);
+        openBootAnimation(); // Falls back to the JPG frames without a pack
     } else {
         delay(1000); 
         setState(MODE_SELECTION);
-        currentMenuSelection = (int)currentMode;
-        menuScrollOffset = 0;
         StickCP2.Lcd.fillScreen(BLACK);
     }
 }
 
 // --- Main Loop ---
+// See loopWaitMs() (system_utils) for how long each pass may block.
 void loop() {
-    StickCP2.update();
+    waitForLoopEvents(loopWaitMs()); // The handlers below still poll what they need
+    PROFILE_SCOPE(PROFILE_LOOP_PASS); // The rest of the pass
+    {
+        PROFILE_SCOPE(PROFILE_BUTTONS);
+        StickCP2.update();
+    }
     unsigned long currentTime = millis();
 
     if (bluetoothJustConnected) {
         playSuccessBeeps(); 
         bluetoothJustConnected = false;
-        if(currentState == SETTINGS_MENU_BLUETOOTH || currentState == BLUETOOTH_SCANNING || currentState == MODE_SELECTION) {
+        if (stateHasFlag(currentState, STATE_BLUETOOTH_REDRAW)) {
             redrawMenu = true;
         }
     }
     if (bluetoothJustDisconnected) {
         playUnsuccessBeeps(); 
         bluetoothJustDisconnected = false;
-        if(currentState == SETTINGS_MENU_BLUETOOTH || currentState == BLUETOOTH_SCANNING || currentState == MODE_SELECTION) {
+        if (stateHasFlag(currentState, STATE_BLUETOOTH_REDRAW)) {
             redrawMenu = true;
         }
     }
 
-    if (enableAutoSleep && 
-        currentState != BOOT_SCREEN && 
-        currentState != BOOT_JPG_SEQUENCE && 
-        currentState != BLUETOOTH_SCANNING && 
-        !a2dp_source.is_connected() ) { 
+    if (autoSleepArmed()) { 
         if (currentTime - lastActivityTime > AUTO_SLEEP_TIMEOUT_MS) {
-            StickCP2.Lcd.fillScreen(BLACK);
-            StickCP2.Lcd.setTextDatum(MC_DATUM);
-            StickCP2.Lcd.drawString("Sleeping...", StickCP2.Lcd.width()/2, StickCP2.Lcd.height()/2);
-            delay(SLEEP_MESSAGE_DELAY_MS);
-            StickCP2.Lcd.sleep();
-            StickCP2.Lcd.waitDisplay();
+            uiRenderSleepDisplay(); // Returns once the panel is asleep
+            flushSettings();
+            sessionJournalFlush();
 
             esp_sleep_enable_ext1_wakeup((1ULL << 37), ESP_EXT1_WAKEUP_ALL_LOW); 
             esp_light_sleep_start();
 
-            StickCP2.Lcd.wakeup();
             delay(200); 
             resetActivityTimer();
             redrawMenu = true; 
         }
     }
 
-    bool micUpdateNeeded = (currentState == LIVE_FIRE_TIMING ||
-                            currentState == NOISY_RANGE_TIMING ||
-                            currentState == CALIBRATE_THRESHOLD);
-    if (micUpdateNeeded && (is_listening_active || currentState == CALIBRATE_THRESHOLD)) {
-        micPeakRMS.update();
-    }
-
     if (currentTime - lastBatteryCheckTime > BATTERY_CHECK_INTERVAL_MS) {
         checkBattery();
-        if (currentState == DEVICE_STATUS || currentState == LIST_FILES || 
-            currentState == MODE_SELECTION || currentState == SETTINGS_MENU_BLUETOOTH || 
-            currentState == BLUETOOTH_SCANNING || lowBatteryWarning) { 
+        if (stateHasFlag(currentState, STATE_BATTERY_REDRAW) || lowBatteryWarning) { 
              redrawMenu = true;
         }
     }
 
-    if (StickCP2.BtnB.isPressed()) {
-        resetActivityTimer(); 
-        if (btnTopPressTime == 0) {
-            btnTopPressTime = currentTime;
-        } else if (!btnTopHeld && (currentTime - btnTopPressTime > LONG_PRESS_DURATION_MS)) {
-            btnTopHeld = true; 
-
-            bool exitToModeSelect = (currentState == LIVE_FIRE_READY || currentState == LIVE_FIRE_TIMING || currentState == LIVE_FIRE_STOPPED ||
-                                     currentState == DRY_FIRE_READY || currentState == DRY_FIRE_RUNNING ||
-                                     currentState == NOISY_RANGE_READY || currentState == NOISY_RANGE_TIMING || currentState == NOISY_RANGE_GET_READY);
-
-            if (exitToModeSelect) {
-                playUnsuccessBeeps();
-                setState(MODE_SELECTION);
-                currentMenuSelection = (int)currentMode; 
-                menuScrollOffset = 0;
-                StickCP2.Lcd.fillScreen(BLACK);
-            }
-            else if (currentState != SETTINGS_MENU_MAIN && currentState != SETTINGS_MENU_GENERAL &&
-                     currentState != SETTINGS_MENU_BEEP && currentState != SETTINGS_MENU_BLUETOOTH &&
-                     currentState != SETTINGS_MENU_DRYFIRE && currentState != SETTINGS_MENU_NOISY &&
-                     currentState != BLUETOOTH_SCANNING && 
-                     currentState != DEVICE_STATUS && currentState != LIST_FILES && 
-                     currentState != EDIT_SETTING && currentState != CALIBRATE_THRESHOLD && 
-                     currentState != CALIBRATE_RECOIL &&
-                     currentState != BOOT_JPG_SEQUENCE) 
-            {
-                setState(SETTINGS_MENU_MAIN);
-                StickCP2.Lcd.fillScreen(BLACK);
-                settingsMenuLevel = 0;
-                currentMenuSelection = 0;
-                menuScrollOffset = 0;
-            }
-        }
-    } else {
-        btnTopPressTime = 0; 
-        btnTopHeld = false;  
+    // Flash writes stall both cores' caches, so none while a string, a par
+    // run or a calibration is ticking; the save waits for the next screen.
+    if (!stateIsLive(currentState)) {
+        serviceSettingsSave();
     }
 
-    switch (currentState) {
-        case BOOT_SCREEN: break; 
-
-        case BOOT_JPG_SEQUENCE:
-            {
-                if (currentState != BOOT_JPG_SEQUENCE) break; 
-                if (StickCP2.BtnA.wasClicked()) {
-                    resetActivityTimer();
-                    setState(MODE_SELECTION);
-                    currentMenuSelection = (int)currentMode;
-                    menuScrollOffset = 0;
-                    StickCP2.Lcd.fillScreen(BLACK);
-                    break;
-                }
-                if (currentTime - lastFrameTime >= BOOT_JPG_FRAME_DELAY_MS) {
-                    resetActivityTimer();
-                    char jpgFilename[12];
-                    sprintf(jpgFilename, "/%d.jpg", currentJpgFrame);
-                    if (LittleFS.exists(jpgFilename) && currentJpgFrame <= MAX_BOOT_JPG_FRAMES) {
-                        File jpgFile = LittleFS.open(jpgFilename, FILE_READ);
-                        if (!jpgFile) {
-                            setState(MODE_SELECTION); break;
-                        }
-                        bool success = StickCP2.Lcd.drawJpg(&jpgFile, 0, 0, StickCP2.Lcd.width(), StickCP2.Lcd.height(), 0, 0, 0.0f, 0.0f, datum_t::middle_center);
-                        jpgFile.close();
-                        if (!success) {
-                            setState(MODE_SELECTION); break;
-                        }
-                        currentJpgFrame++;
-                        lastFrameTime = currentTime;
-                    } else { 
-                        setState(MODE_SELECTION);
-                    }
-                }
-                 if (currentState == MODE_SELECTION) { 
-                    currentMenuSelection = (int)currentMode;
-                    menuScrollOffset = 0;
-                    StickCP2.Lcd.fillScreen(BLACK); 
-                 }
-            }
-            break;
-
-        case MODE_SELECTION:          handleModeSelectionInput(); break;
-        case LIVE_FIRE_READY:         handleLiveFireReady(); break;
-        case LIVE_FIRE_GET_READY:     handleLiveFireGetReady(); break;
-        case LIVE_FIRE_TIMING:        handleLiveFireTiming(); break;
-        case LIVE_FIRE_STOPPED:
-            if (redrawMenu) {
-                displayStoppedScreen();
-                redrawMenu = false;
-            }
-            if (StickCP2.BtnA.wasClicked()) {
-                resetActivityTimer();
-                if (previousState == NOISY_RANGE_TIMING || previousState == NOISY_RANGE_GET_READY || currentMode == MODE_NOISY_RANGE) {
-                     setState(NOISY_RANGE_READY);
-                } else if (previousState == DRY_FIRE_RUNNING || currentMode == MODE_DRY_FIRE) { 
-                    setState(DRY_FIRE_READY); 
-                }
-                else { 
-                    setState(LIVE_FIRE_READY);
-                }
-                StickCP2.Lcd.fillScreen(BLACK);
-            }
-            break;
-        case DRY_FIRE_READY:          handleDryFireReadyInput(); break;
-        case DRY_FIRE_RUNNING:        handleDryFireRunning(); break;
-        case NOISY_RANGE_READY:       handleNoisyRangeReadyInput(); break;
-        case NOISY_RANGE_GET_READY:   handleNoisyRangeGetReady(); break;
-        case NOISY_RANGE_TIMING:      handleNoisyRangeTiming(); break;
-        case SETTINGS_MENU_MAIN:
-        case SETTINGS_MENU_GENERAL:
-        case SETTINGS_MENU_BEEP:
-        case SETTINGS_MENU_DRYFIRE:
-        case SETTINGS_MENU_NOISY:
-        case SETTINGS_MENU_BLUETOOTH: handleSettingsInput(); break;
-        case BLUETOOTH_SCANNING:      handleBluetoothScanning(); break;
-        case EDIT_SETTING:            handleEditSettingInput(); break;
-        case DEVICE_STATUS:           handleDeviceStatusInput(); break;
-        case LIST_FILES:              handleListFilesInput(); break;
-        case CALIBRATE_THRESHOLD:
-        case CALIBRATE_RECOIL:        handleCalibrationInput(currentState); break;
-        default: break; 
+    serviceTopButton();
+
+    // Handlers publish their screens; the UI render task draws them.
+    {
+        PROFILE_SCOPE(profileHandlerSection(currentState));
+        runStateHandler();
     }
-    vTaskDelay(pdMS_TO_TICKS(10)); 
 }
 
 // --- Buzzer Task Definition Removed ---
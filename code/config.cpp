@@ -1,11 +1,22 @@
 #include "config.h" // Include the header to ensure declarations match definitions
 
+const char* BOOT_ANIM_PATH = "/boot.anim";
+const char* DETECTOR_TUNING_PATH = "/detector.tuning";
+const char* SESSION_LOG_PATH = "/sessions.log";
+const char* SESSION_INDEX_PATH = "/sessions.idx";
+const char* SESSION_LOG_OLD_PATH = "/sessions.old.log";
+const char* SESSION_INDEX_OLD_PATH = "/sessions.old.idx";
+
 // --- NVS Keys (Definitions) ---
 const char* NVS_NAMESPACE = "ShotTimer";
+const char* KEY_SETTINGS = "settings";
 const char* KEY_MAX_SHOTS = "maxShots";
 const char* KEY_BEEP_DUR = "beepDur";
 const char* KEY_BEEP_HZ = "beepHz";
 const char* KEY_SHOT_THRESH = "shotThresh";
+const char* KEY_SHOT_MARGIN_DB = "shotMarginDb";
+const char* KEY_SHOT_LOCKOUT = "shotLockMs";
+const char* KEY_START_DELAY = "startDelayMs";
 const char* KEY_DF_BEEP_CNT = "dfBeepCnt";
 const char* KEY_NR_RECOIL = "nrRecoil";
 const char* KEY_PEAK_BATT = "peakBatt";
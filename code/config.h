@@ -2,10 +2,14 @@
 #define CONFIG_H
 
 #include <Arduino.h> // For String, PI etc.
+#include "state_machine.h" // TimerState and its per-state table
 
 // --- Configuration Constants (These are generally safe in headers as const) ---
 const unsigned long LONG_PRESS_DURATION_MS = 750;
-const unsigned long SHOT_REFRACTORY_MS = 150;
+const unsigned long SHOT_MIN_LOCKOUT_MS = 40;   // Default shortest possible split (shotLockoutMs); re-arm is envelope driven after this
+const float SHOT_REARM_FRACTION = 0.25f;        // Re-arm once the envelope RMS falls below this fraction of the shot peak
+const unsigned long SHOT_ECHO_WINDOW_MS = 85;   // Discrete echoes arrive 20-80 ms behind a shot; doubles of 0.1 s and up fall outside it...
+const float SHOT_ECHO_PEAK_RATIO = 0.75f;       // ...so onsets in this window need this fraction of its peak RMS
 const unsigned long TIMEOUT_DURATION_MS = 15000;
 const unsigned long BEEP_NOTE_DURATION_MS = 150;
 const unsigned long BEEP_NOTE_DELAY_MS = 50;
@@ -16,13 +20,20 @@ const int MENU_ITEM_HEIGHT_LANDSCAPE = 25;
 const int MENU_ITEM_HEIGHT_PORTRAIT = 18;
 const int MENU_ITEMS_PER_SCREEN_LANDSCAPE = 3;
 const int MENU_ITEMS_PER_SCREEN_PORTRAIT = 5;
-const unsigned long POST_BEEP_DELAY_MS = 750; // Increased further to 750ms
+const int UI_LIST_ROWS = MENU_ITEMS_PER_SCREEN_PORTRAIT + 2; // Most list rows any screen shows
+const int UI_PAGE_LINES = 10;                 // Most lines of a text page (Device Status)
+const int UI_TEXT_CHARS = 40;                 // Per line of a UI snapshot, with the terminator
+const unsigned long START_READY_HOLD_MS = 1000;          // "Ready..." before the start beep (or the random delay)
+const unsigned long START_RANDOM_DELAY_MAX_MS = 5000;    // Upper end of the startRandomDelayMs setting
+const unsigned long START_RANDOM_DELAY_STEP_MS = 500;
 const int MAX_FILES_LIST = 20;
 const unsigned long BOOT_JPG_FRAME_DELAY_MS = 100;
 const int MAX_BOOT_JPG_FRAMES = 150;
+const int BOOT_ANIM_BAND_ROWS = 8;            // Stored rows per DMA push of the packed boot animation
 const unsigned long MESSAGE_DISPLAY_MS = 2000;
 const unsigned long DRY_FIRE_RANDOM_DELAY_MIN_MS = 2000;
 const unsigned long DRY_FIRE_RANDOM_DELAY_MAX_MS = 5000;
+const unsigned long DRY_FIRE_DONE_HOLD_MS = 500;  // Running screen stays up this long after the last beep
 const int MAX_PAR_BEEPS = 10;
 const unsigned long RECOIL_DETECTION_WINDOW_MS = 100;
 const unsigned long MIN_FIRST_SHOT_TIME_MS = 100; // Min time after start for first shot
@@ -31,21 +42,126 @@ const unsigned long SLEEP_MESSAGE_DELAY_MS = 1500;
 // #define C3_FREQUENCY 130.81f // No longer used for keep-alive
 const unsigned long BT_SCAN_DURATION_S = 10;
 const int MAX_BT_DEVICES_DISPLAY = 20;
-const unsigned long DISPLAY_UPDATE_INTERVAL_MS = 100;
+const unsigned long DISPLAY_UPDATE_INTERVAL_MS = 33; // ~30 fps timing clock
+const unsigned long LOOP_TICK_MS = 10;          // loop() period while a screen is live or a button is down
+const unsigned long BUTTON_SETTLE_MS = 50;      // Keep ticking this long after a button edge (debounce, click)
+const uint32_t STATE_TRACE_SIZE = 32;           // State transitions kept for the Device Status dump (power of two)
 const int BT_AUDIO_OFFSET_STEP_MS = 50; 
 const int BUZZER_QUEUE_LENGTH = 10; 
 const int BUZZER_TASK_STACK_SIZE = 2048; 
 
+// --- Bluetooth Tone Synth ---
+const uint32_t A2DP_SAMPLE_RATE_HZ = 44100;
+const int16_t BT_TONE_AMPLITUDE = 10000;
+const float BT_TONE_RAMP_MS = 3.0f;          // Attack / release ramp
+const uint32_t BT_TONE_RING_SIZE = 32;       // Queued BT tone commands; must be a power of two
+const int MAX_SCHEDULED_TONES = 16;          // Tones per scheduleTones() call (par strings)
+const int BUZZER_LEDC_CHANNEL = 0;           // Same channel tone() uses
+const int64_t A2DP_CLOCK_SLEW_US_PER_CALLBACK = 1; // Lets the frame clock anchor follow drift
+const int64_t A2DP_CLOCK_RESYNC_US = 50000;        // Re-anchor after a stall (e.g. reconnect)
+const unsigned long BEEP_LISTEN_GUARD_MS = 150;    // Listening starts this long after the start beep ends
+
+// --- Bluetooth Latency Calibration ---
+// The BT audio offset is the speaker's output latency: time from an A2DP frame
+// leaving the stick to it being heard. It is measured by playing short bursts
+// and finding them on the mic with a matched filter.
+const int BT_AUDIO_OFFSET_MAX_MS = 600;
+const int BT_LATENCY_TRIALS = 7;             // Median of the valid trials is kept
+const int BT_LATENCY_MIN_VALID_TRIALS = 4;
+const int BT_LATENCY_BURST_HZ = 2500;
+const int BT_LATENCY_BURST_MS = 30;
+const unsigned long BT_LATENCY_TRIAL_GAP_MS = 300;  // Lets the room go quiet between bursts
+const unsigned long BT_LATENCY_EMIT_TIMEOUT_MS = 500;
+const float BT_LATENCY_MIN_PEAK_TO_MEAN = 12.0f; // Matched filter peak over its mean (noise alone gives ~5)
+
+// --- Mic Capture Task ---
+const uint32_t MIC_SAMPLE_RATE_HZ = 16000;
+const int MIC_CAPTURE_BLOCK_SAMPLES = 256;   // 16 ms per block at 16 kHz
+const int MIC_CAPTURE_BUFFER_COUNT = 3;      // Mic driver keeps 2 blocks in flight
+const int64_t MIC_CLOCK_SLEW_US_PER_BLOCK = 1; // Lets the sample clock anchor follow ~60 ppm of drift
+const int MIC_CAPTURE_TASK_STACK_SIZE = 4096;
+const int MIC_CAPTURE_TASK_PRIORITY = 5;     // Above the buzzer task and loop()
+const int MIC_CAPTURE_TASK_CORE = 0;
+const int SHOT_EVENT_RING_SIZE = 32;         // Must be a power of two
+const unsigned long FEATURE_HISTORY_MS = 2 * TIMEOUT_DURATION_MS; // Re-scorable history: string + timeout tail
+
+// --- UI Render Task ---
+const int UI_RENDER_TASK_STACK_SIZE = 4096;
+const int UI_RENDER_TASK_PRIORITY = 1;       // Same as loop(), below the capture tasks
+const int UI_RENDER_TASK_CORE = 1;
+
+// --- Session Journal ---
+const uint32_t SESSION_LOG_MAX_BYTES = 64 * 1024; // Then the log moves to the .old generation (~1500 strings each)
+const uint32_t SESSION_JOURNAL_BUFFER_BYTES = 256;   // One flash page of records before the writer writes them
+const int SESSION_JOURNAL_QUEUE_LENGTH = 4;
+const int SESSION_JOURNAL_TASK_STACK_SIZE = 4096;
+const int SESSION_JOURNAL_TASK_PRIORITY = 1;       // Flash writes wait behind everything timing related
+const int SESSION_JOURNAL_TASK_CORE = 1;
+const int SESSION_DUMP_COUNT = 20;                 // Sessions sent to Serial from Device Status
+
+// --- Onset Detector (adaptive noise floor) ---
+const float ONSET_ATTACK_MS = 0.5f;
+const float ONSET_RELEASE_MS = 10.0f;
+const float ONSET_HYSTERESIS_DB = 6.0f;
+const float ONSET_FLOOR_QUANTILE = 0.5f;          // Running median of the envelope
+const float ONSET_FLOOR_SLEW_DB_PER_SEC = 20.0f;
+const float ONSET_INITIAL_FLOOR_RMS = 100.0f;
+// `make sweep` / `make replay`: 16 dB finds the shots gusts of wind hide at
+// 20 dB (4 of 72 missed, not 12) for a few more onsets off ringing steel.
+const int SHOT_MARGIN_DB_DEFAULT = 16;
+const int SHOT_MARGIN_DB_MIN = 6;
+const int SHOT_MARGIN_DB_MAX = 40;
+const unsigned long SHOT_LOCKOUT_MS_MIN = 20;     // Range accepted for shotLockoutMs
+const unsigned long SHOT_LOCKOUT_MS_MAX = 200;
+
+// --- IMU Pipeline ---
+const uint8_t IMU_I2C_ADDR = 0x68;               // MPU6886 on the internal bus
+const uint32_t IMU_I2C_FREQ = 400000;
+const uint32_t IMU_SAMPLE_RATE_HZ = 1000;        // Highest FIFO rate with the accel DLPF on
+const int IMU_HISTORY_SIZE = 512;                // ~0.5 s of samples
+const int IMU_HISTORY_GUARD = 64;                // Slots the reader stays clear of
+const unsigned long IMU_DRAIN_INTERVAL_MS = 10;  // FIFO holds ~128 ms at 1 kHz
+const int64_t IMU_CLOCK_SLEW_US_PER_DRAIN = 1;
+const int IMU_TASK_STACK_SIZE = 3072;
+const int IMU_TASK_PRIORITY = 4;                 // Below the mic capture task
+const int IMU_TASK_CORE = 0;
+const unsigned long RECOIL_PRE_ONSET_MS = 20;    // Recoil search starts this long before the sound onset
+const unsigned long IMU_DRAIN_LATENCY_MS = 30;   // Give up waiting for samples after this
+
 // --- Buzzer Pins (External) ---
 #define BUZZER_PIN 25
 #define BUZZER_PIN_2 2
 
+// --- Button Pins (internal) ---
+#define BTN_A_PIN 37
+#define BTN_B_PIN 39
+#define BTN_PWR_PIN 35
+
+// --- LittleFS Files ---
+extern const char* BOOT_ANIM_PATH;           // Packed boot animation (see boot_anim.h)
+extern const char* DETECTOR_TUNING_PATH;     // Detector settings to import at boot (see detector_tuning.h)
+extern const char* SESSION_LOG_PATH;         // Session journal (see session_log.h) and its index
+extern const char* SESSION_INDEX_PATH;
+extern const char* SESSION_LOG_OLD_PATH;     // Previous generation
+extern const char* SESSION_INDEX_OLD_PATH;
+
+// --- Settings Store ---
+const uint16_t SETTINGS_VERSION = 1;                 // Of the KEY_SETTINGS blob; goes up with each field appended
+const unsigned long SETTINGS_SAVE_DELAY_MS = 2000;   // Changes within this of each other are one write
+const float PEAK_BATT_SAVE_STEP_V = 0.02f;           // Peak battery voltage is only stored once it rises by this
+const int SETTINGS_BT_NAME_BYTES = 64;
+
 // --- NVS Keys (Declarations) ---
 extern const char* NVS_NAMESPACE;
+extern const char* KEY_SETTINGS;             // All settings as one blob (see nvs_utils.cpp)
+// Settings were stored one per key before the blob; read once to migrate.
 extern const char* KEY_MAX_SHOTS;
 extern const char* KEY_BEEP_DUR;
 extern const char* KEY_BEEP_HZ;
 extern const char* KEY_SHOT_THRESH;
+extern const char* KEY_SHOT_MARGIN_DB;
+extern const char* KEY_SHOT_LOCKOUT;
+extern const char* KEY_START_DELAY;
 extern const char* KEY_DF_BEEP_CNT;
 extern const char* KEY_NR_RECOIL;
 extern const char* KEY_PEAK_BATT;
@@ -57,34 +173,6 @@ extern const char* KEY_BT_AUTO_RECONNECT;
 extern const char* KEY_BT_VOLUME;
 extern const char* KEY_BT_AUDIO_OFFSET; 
 
-// --- Timer States ---
-enum TimerState {
-    BOOT_SCREEN,
-    BOOT_JPG_SEQUENCE,
-    MODE_SELECTION,
-    LIVE_FIRE_READY,
-    LIVE_FIRE_GET_READY,
-    LIVE_FIRE_TIMING,
-    LIVE_FIRE_STOPPED,
-    DRY_FIRE_READY,
-    DRY_FIRE_RUNNING,
-    NOISY_RANGE_READY,
-    NOISY_RANGE_GET_READY,
-    NOISY_RANGE_TIMING,
-    SETTINGS_MENU_MAIN,
-    SETTINGS_MENU_GENERAL,
-    SETTINGS_MENU_BEEP,
-    SETTINGS_MENU_DRYFIRE,
-    SETTINGS_MENU_NOISY,
-    SETTINGS_MENU_BLUETOOTH,
-    BLUETOOTH_SCANNING,
-    DEVICE_STATUS,
-    LIST_FILES,
-    EDIT_SETTING,
-    CALIBRATE_THRESHOLD,
-    CALIBRATE_RECOIL
-};
-
 // --- Operating Modes ---
 enum OperatingMode {
     MODE_LIVE_FIRE,
@@ -98,7 +186,9 @@ enum EditableSetting {
     EDIT_MAX_SHOTS,
     EDIT_BEEP_DURATION,
     EDIT_BEEP_TONE,
+    EDIT_START_DELAY,
     EDIT_SHOT_THRESHOLD,
+    EDIT_SHOT_MARGIN,
     EDIT_PAR_BEEP_COUNT,
     EDIT_PAR_TIME_ARRAY,
     EDIT_RECOIL_THRESHOLD,
@@ -110,10 +200,24 @@ enum EditableSetting {
     EDIT_BT_AUDIO_OFFSET 
 };
 
+// --- Audio Cues ---
+// A cue is a short melody played in the background, by the buzzer task or by
+// the A2DP synth (whose attack / release ramp is the envelope).
+const int MAX_CUE_NOTES = 8;
+
+typedef struct {
+    uint16_t frequency; // 0 = rest
+    uint16_t duration;  // ms
+    uint16_t gap;       // Silence after the note, ms
+} CueNote;
+
 // --- Struct for Buzzer Task Queue ---
 typedef struct {
     int frequency;
     int duration;
+    bool reportStart; // Report the moment the tone starts (see takeStartBeepEmittedUs)
+    uint8_t noteCount; // > 0: play 'notes' instead of frequency / duration
+    CueNote notes[MAX_CUE_NOTES];
 } BuzzerRequest;
 
 
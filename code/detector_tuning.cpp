@@ -0,0 +1,32 @@
+#include "detector_tuning.h"
+#include "crc32.h"
+#include "le_bytes.h"
+#include <string.h>
+
+void detectorTuningEncode(const DetectorTuning& tuning, uint8_t* out) {
+    uint32_t recoilBits;
+    memcpy(&recoilBits, &tuning.recoilThreshold, 4);
+    writeU32(out, DETECTOR_TUNING_MAGIC);
+    writeU16(out + 4, DETECTOR_TUNING_VERSION);
+    writeU16(out + 6, 0);
+    writeU32(out + 8, (uint32_t)tuning.shotThresholdRms);
+    writeU32(out + 12, (uint32_t)tuning.shotMarginDb);
+    writeU32(out + 16, tuning.shotLockoutMs);
+    writeU32(out + 20, recoilBits);
+    writeU32(out + 24, crc32(out, 24));
+}
+
+bool detectorTuningDecode(const uint8_t* data, size_t length, DetectorTuning& tuning) {
+    if (length != DETECTOR_TUNING_BYTES ||
+        readU32(data) != DETECTOR_TUNING_MAGIC ||
+        readU16(data + 4) != DETECTOR_TUNING_VERSION ||
+        readU32(data + 24) != crc32(data, 24)) {
+        return false;
+    }
+    uint32_t recoilBits = readU32(data + 20);
+    tuning.shotThresholdRms = (int32_t)readU32(data + 8);
+    tuning.shotMarginDb = (int32_t)readU32(data + 12);
+    tuning.shotLockoutMs = readU32(data + 16);
+    memcpy(&tuning.recoilThreshold, &recoilBits, 4);
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef DETECTOR_TUNING_H
+#define DETECTOR_TUNING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Detector settings chosen with the host sweep (host/sweep_detector), imported
+// from DETECTOR_TUNING_PATH on LittleFS at boot and then deleted.
+//
+// Layout (little-endian, DETECTOR_TUNING_BYTES):
+//   uint32_t magic             DETECTOR_TUNING_MAGIC
+//   uint16_t version           DETECTOR_TUNING_VERSION
+//   uint16_t reserved
+//   int32_t  shotThresholdRms  Absolute minimum (0 = off)
+//   int32_t  shotMarginDb
+//   uint32_t shotLockoutMs
+//   float    recoilThreshold   G (IEEE 754 single)
+//   uint32_t crc32             CRC-32 of the bytes before it
+
+static const uint32_t DETECTOR_TUNING_MAGIC = 0x31545344; // "DST1"
+static const uint16_t DETECTOR_TUNING_VERSION = 1;
+static const size_t DETECTOR_TUNING_BYTES = 28;
+
+struct DetectorTuning {
+    int32_t shotThresholdRms;
+    int32_t shotMarginDb;
+    uint32_t shotLockoutMs;
+    float recoilThreshold;
+};
+
+void detectorTuningEncode(const DetectorTuning& tuning, uint8_t* out);
+
+// Checks magic, version and CRC. Values are returned as stored; the caller
+// clamps them to what it accepts.
+bool detectorTuningDecode(const uint8_t* data, size_t length, DetectorTuning& tuning);
+
+#endif // DETECTOR_TUNING_H
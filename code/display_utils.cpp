@@ -2,9 +2,22 @@
 #include "globals.h" // Access to global variables
 #include "config.h"  // Access to constants and enums
 #include <float.h>   // Added for FLT_MAX
+#include <stdarg.h>
 #include <LittleFS.h> // Added for LittleFS
+#include "imu_pipeline.h"
+#include "shot_capture.h"
+#include "audio_utils.h"
+#include "loop_events.h"
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include "boot_anim.h"
+#include "loop_profiler.h"
+#include "timer_modes.h"
+#include "session_journal.h"
+#include "system_utils.h"
 
 void displayBootScreen(const char* line1a, const char* line1b, const char* line2) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_BOOT);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(MC_DATUM);
     StickCP2.Lcd.setTextFont(0);
@@ -16,7 +29,7 @@ void displayBootScreen(const char* line1a, const char* line1b, const char* line2
 }
 
 String getUpButtonLabel() {
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     switch (rotation) {
         case 0: return "Right";
         case 1: return "Top";
@@ -27,7 +40,7 @@ String getUpButtonLabel() {
 }
 
 String getDownButtonLabel() {
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     switch (rotation) {
         case 0: return "Left";
         case 1: return "Bottom";
@@ -37,63 +50,67 @@ String getDownButtonLabel() {
     }
 }
 
-void displayMenu(const char* title, const char* items[], int count, int selection, int scrollOffset) {
-    StickCP2.Lcd.fillScreen(BLACK);
-    StickCP2.Lcd.setTextDatum(TC_DATUM);
-    StickCP2.Lcd.setTextFont(0);
-    StickCP2.Lcd.setTextSize(2);
-    StickCP2.Lcd.drawString(title, StickCP2.Lcd.width() / 2, 10);
+// --- Screens (loop side) ---
+// Everything a screen shows is looked up and formatted here, into the
+// snapshot; the render task only lays it out.
 
-    int y_pos = 45;
+static void copyText(char* dst, const char* src) {
+    snprintf(dst, UI_TEXT_CHARS, "%s", src);
+}
+
+void displayMessageScreen(const char* text, uint8_t textSize) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_MESSAGE;
+    copyText(snapshot.message.text, text);
+    snapshot.message.textSize = textSize;
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayMenu(const char* title, const char* items[], int count, int selection, int scrollOffset) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_MENU;
+    UiMenuScreen& menu = snapshot.menu;
+    copyText(menu.title, title);
+    menu.corner[0] = '\0';
+    menu.status[0] = '\0';
+    menu.statusColor = WHITE;
 
     if (strcmp(title, "Select Mode") == 0) {
-        StickCP2.Lcd.setTextDatum(TR_DATUM);
-        StickCP2.Lcd.setTextFont(0);
-        StickCP2.Lcd.setTextSize(1);
         int batt_pct = StickCP2.Power.getBatteryLevel();
         String statusText = String(batt_pct) + "%";
 
         if (a2dp_source.is_connected()){
             statusText = "[B] " + statusText;
         }
-        StickCP2.Lcd.setTextColor(WHITE, BLACK);
-        StickCP2.Lcd.drawString(statusText, StickCP2.Lcd.width() - 5, 5);
+        copyText(menu.corner, statusText.c_str());
     }
     else if (strcmp(title, "Bluetooth Settings") == 0) {
-        StickCP2.Lcd.setTextDatum(TC_DATUM);
-        StickCP2.Lcd.setTextFont(0);
-        StickCP2.Lcd.setTextSize(1);
         String btStatus = "Status: ";
         if (a2dp_source.is_connected()) {
             btStatus += "Connected";
-            StickCP2.Lcd.setTextColor(GREEN, BLACK);
+            menu.statusColor = GREEN;
         } else {
             btStatus += "Disconnected";
-            StickCP2.Lcd.setTextColor(YELLOW, BLACK);
+            menu.statusColor = YELLOW;
         }
-        StickCP2.Lcd.drawString(btStatus, StickCP2.Lcd.width() / 2, 30);
-        StickCP2.Lcd.setTextColor(WHITE, BLACK);
-        y_pos = 55;
+        copyText(menu.status, btStatus.c_str());
     }
 
-    StickCP2.Lcd.setTextDatum(TL_DATUM);
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
-    int itemHeight = (rotation % 2 == 0) ? MENU_ITEM_HEIGHT_PORTRAIT : MENU_ITEM_HEIGHT_LANDSCAPE;
-    int textSize = (rotation % 2 == 0) ? 1 : 2;
-
-    StickCP2.Lcd.setTextSize(textSize);
 
     int startIdx = scrollOffset;
     int endIdx = min(scrollOffset + itemsPerScreen, count);
+    menu.rowCount = 0;
+    menu.selectedRow = -1;
 
-    for (int i = startIdx; i < endIdx; ++i) {
-        int display_y = y_pos + (i - startIdx) * itemHeight;
+    for (int i = startIdx; i < endIdx && menu.rowCount < UI_LIST_ROWS; ++i) {
         String itemText = items[i];
 
         bool isNavOrAction = (strcmp(items[i], "Back") == 0 ||
                               strcmp(items[i], "Calibrate Thresh.") == 0 ||
                               strcmp(items[i], "Calibrate Recoil") == 0 ||
+                              strcmp(items[i], "Calibrate Latency") == 0 ||
                               strcmp(items[i], "Device Status") == 0 ||
                               strcmp(items[i], "List Files") == 0 ||
                               strcmp(items[i], "Power Off Now") == 0 ||
@@ -110,7 +127,9 @@ void displayMenu(const char* title, const char* items[], int count, int selectio
             if (strcmp(items[i], "Max Shots") == 0) itemText += currentMaxShots;
             else if (strcmp(items[i], "Beep Duration") == 0) itemText += currentBeepDuration;
             else if (strcmp(items[i], "Beep Tone") == 0) itemText += currentBeepToneHz;
-            else if (strcmp(items[i], "Shot Threshold") == 0) itemText += shotThresholdRms;
+            else if (strcmp(items[i], "Start Delay") == 0) itemText += (startRandomDelayMs > 0 ? String(startRandomDelayMs) + "ms" : String("Off"));
+            else if (strcmp(items[i], "Shot Threshold") == 0) itemText += (shotThresholdRms > 0 ? String(shotThresholdRms) : String("Off"));
+            else if (strcmp(items[i], "Shot Margin") == 0) { itemText += shotMarginDb; itemText += "dB"; }
             else if (strcmp(items[i], "Par Beep Count") == 0) itemText += dryFireParBeepCount;
             else if (strcmp(items[i], "Recoil Threshold") == 0) itemText += String(recoilThreshold, 1);
             else if (strcmp(items[i], "Screen Rotation") == 0) itemText += screenRotationSetting;
@@ -122,57 +141,364 @@ void displayMenu(const char* title, const char* items[], int count, int selectio
             else if (settingsMenuLevel == 5 && strcmp(items[i], "Volume") == 0) {
                 itemText += currentBluetoothVolume;
             }
-            else if (settingsMenuLevel == 5 && strcmp(items[i], "BT Audio Offset") == 0) { 
+            else if (settingsMenuLevel == 5 && strcmp(items[i], "BT Audio Offset") == 0) {
                 itemText += currentBluetoothAudioOffsetMs;
                 itemText += "ms";
             }
         }
 
         if (i == selection) {
+            menu.selectedRow = menu.rowCount;
+        }
+        copyText(menu.rows[menu.rowCount++], itemText.c_str());
+    }
+    menu.moreAbove = scrollOffset > 0;
+    menu.moreBelow = endIdx < count;
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayEditScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_EDIT;
+    UiEditScreen& edit = snapshot.edit;
+
+    if (settingBeingEdited == EDIT_PAR_TIME_ARRAY) {
+        String titleStr = "Par Time " + String(editingIntValue + 1);
+        copyText(edit.title, titleStr.c_str());
+    } else {
+        copyText(edit.title, editingSettingName);
+    }
+    if (settingBeingEdited == EDIT_BOOT_ANIM || settingBeingEdited == EDIT_AUTO_SLEEP || settingBeingEdited == EDIT_BT_AUTO_RECONNECT) {
+        copyText(edit.hint, (getUpButtonLabel() + " or " + getDownButtonLabel() + " = Toggle").c_str());
+    } else {
+        copyText(edit.hint, (getUpButtonLabel() + "=Up / " + getDownButtonLabel() + "=Down").c_str());
+    }
+
+    edit.valueFont = 7;
+    edit.msSuffix = false;
+    switch(settingBeingEdited) {
+        case EDIT_MAX_SHOTS:
+        case EDIT_BEEP_TONE:
+        case EDIT_SHOT_THRESHOLD:
+        case EDIT_SHOT_MARGIN:
+        case EDIT_PAR_BEEP_COUNT:
+        case EDIT_ROTATION:
+        case EDIT_BT_VOLUME:
+        case EDIT_BT_AUDIO_OFFSET:
+             copyText(edit.value, String(editingIntValue).c_str());
+             edit.msSuffix = (settingBeingEdited == EDIT_BT_AUDIO_OFFSET);
+             break;
+        case EDIT_BEEP_DURATION:
+        case EDIT_START_DELAY:
+             copyText(edit.value, String(editingULongValue).c_str());
+             break;
+        case EDIT_PAR_TIME_ARRAY:
+        case EDIT_RECOIL_THRESHOLD:
+             copyText(edit.value, String(editingFloatValue, 1).c_str());
+             break;
+        case EDIT_BOOT_ANIM:
+        case EDIT_AUTO_SLEEP:
+        case EDIT_BT_AUTO_RECONNECT:
+             copyText(edit.value, editingBoolValue ? "On" : "Off");
+             edit.valueFont = 4;
+             break;
+        default:
+             copyText(edit.value, "ERROR");
+             break;
+    }
+    publishUiSnapshot(snapshot, redrawMenu);
+}
+
+void displayCalibrationScreen(const char* title, float peakValue, const char* unit) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_CALIBRATION;
+    UiCalibrationScreen& calibration = snapshot.calibration;
+    calibration.recoil = (currentState == CALIBRATE_RECOIL);
+    copyText(calibration.title, title);
+    String peakStr = "PEAK: " + String(peakValue, (calibration.recoil ? 2 : 0));
+    copyText(calibration.peak, peakStr.c_str());
+    publishUiSnapshot(snapshot, redrawMenu);
+}
+
+void displayBtLatencyCalibrationScreen(int trial, int totalTrials, int lastLatencyMs, int resultMs, bool finished) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_BT_LATENCY;
+    snapshot.btLatency.trial = trial;
+    snapshot.btLatency.totalTrials = totalTrials;
+    snapshot.btLatency.lastLatencyMs = lastLatencyMs;
+    snapshot.btLatency.resultMs = resultMs;
+    snapshot.btLatency.finished = finished;
+    publishUiSnapshot(snapshot, true);
+}
+
+// printf() into the next line of a text page; lines past UI_PAGE_LINES are dropped.
+static void addPageLine(UiPageScreen& page, const char* format, ...) {
+    if (page.lineCount >= UI_PAGE_LINES) return;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(page.lines[page.lineCount++], UI_TEXT_CHARS, format, args);
+    va_end(args);
+}
+
+void displayDeviceStatusScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_PAGE;
+    UiPageScreen& page = snapshot.page;
+    copyText(page.title, "Device Status");
+    copyText(page.footer, "Front=Profile Hold=Return");
+    page.lineCount = 0;
+
+    float batt_v = StickCP2.Power.getBatteryVoltage() / 1000.0f;
+    int batt_pct = StickCP2.Power.getBatteryLevel();
+    bool charging = StickCP2.Power.isCharging();
+    addPageLine(page, "Batt: %.2fV (%d%%) %s Pk %.2fV", batt_v, batt_pct, charging ? "Chg" : "", peakBatteryVoltage);
+
+    float accX, accY, accZ;
+    imuLatestAccel(accX, accY, accZ);
+    addPageLine(page, "Acc G X:%.2f Y:%.2f Z:%.2f", accX, accY, accZ);
+
+    if (filesystem_ok_for_boot) {
+        size_t totalBytes = LittleFS.totalBytes();
+        size_t usedBytes = LittleFS.usedBytes();
+        addPageLine(page, "LittleFS: %u/%u B used", (unsigned)usedBytes, (unsigned)totalBytes);
+    } else {
+        addPageLine(page, "LittleFS: Not Mounted!");
+    }
+
+    DisplayFrameStats frame = getTimingFrameStats();
+    addPageLine(page, "Timing frame: %luus (max %lu)", (unsigned long)frame.avgUs, (unsigned long)frame.maxUs);
+
+    LoopEventStats loopStats = getLoopEventStats();
+    addPageLine(page, "Wake: %luus (max %lu) Busy %u%%", (unsigned long)loopStats.avgUs,
+                (unsigned long)loopStats.maxUs, (unsigned)loopStats.busyPercent);
+
+    StartSequenceStats startStats = getStartSequenceStats();
+    addPageLine(page, "Start: %lums Cancel %luus (max %lu)", (unsigned long)startStats.lastCycleMs,
+                (unsigned long)startStats.lastCancelUs, (unsigned long)startStats.maxCancelUs);
+
+    addPageLine(page, "Drops: Shot %lu BT %lu IMU %lu Log %lu", (unsigned long)getDroppedShotEventCount(),
+                (unsigned long)getBtToneOverflowCount(), (unsigned long)getImuFifoOverflowCount(),
+                (unsigned long)getDroppedSessionCount());
+
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayProfileScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_PAGE;
+    UiPageScreen& page = snapshot.page;
+    copyText(page.title, "Loop Profile");
+    copyText(page.footer, "Front=Status Hold=Return");
+    page.lineCount = 0;
+
+    if (!LOOP_PROFILER) {
+        addPageLine(page, "Compiled out (LOOP_PROFILER=0)");
+    } else {
+        // Busiest sections first, by total time.
+        int order[PROFILE_SECTION_COUNT];
+        uint64_t totals[PROFILE_SECTION_COUNT];
+        int used = 0;
+        for (int s = 0; s < PROFILE_SECTION_COUNT; ++s) {
+            ProfileHistogram h = getProfileHistogram((ProfileSection)s);
+            if (h.count == 0) continue;
+            int i = used++;
+            while (i > 0 && totals[i - 1] < h.totalCycles) {
+                order[i] = order[i - 1];
+                totals[i] = totals[i - 1];
+                i--;
+            }
+            order[i] = s;
+            totals[i] = h.totalCycles;
+        }
+
+        addPageLine(page, "Scopes %.2f%% of loop, %lu cyc", getProfileLoopOverheadPercent(),
+                    (unsigned long)getProfileScopeCycles());
+        addPageLine(page, "us          p50   p99   max");
+        for (int i = 0; i < used; ++i) {
+            ProfileHistogram h = getProfileHistogram((ProfileSection)order[i]);
+            addPageLine(page, "%-10.10s%6lu%6lu%6lu", profileSectionName((ProfileSection)order[i]),
+                        (unsigned long)profileCyclesToUs(h.quantileCycles(0.5f)),
+                        (unsigned long)profileCyclesToUs(h.quantileCycles(0.99f)),
+                        (unsigned long)profileCyclesToUs(h.maxCycles));
+        }
+    }
+
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayListFilesScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_FILES;
+    UiFilesScreen& files = snapshot.files;
+    int rotation = uiRotation();
+    int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT + 2 : MENU_ITEMS_PER_SCREEN_LANDSCAPE + 1;
+
+    int startIdx = fileListScrollOffset;
+    int endIdx = min(fileListScrollOffset + itemsPerScreen, fileListCount);
+    files.rowCount = 0;
+    for (int i = startIdx; i < endIdx && files.rowCount < UI_LIST_ROWS; ++i) {
+        String displayName = fileListNames[i];
+        if (displayName.length() > 20) {
+            displayName = displayName.substring(0, 17) + "...";
+        }
+        snprintf(files.rows[files.rowCount++], UI_TEXT_CHARS, "%-20s %6d B", displayName.c_str(), (int)fileListSizes[i]);
+    }
+    files.moreAbove = fileListScrollOffset > 0;
+    files.moreBelow = endIdx < fileListCount;
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayDryFireReadyScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_DRY_FIRE_READY;
+    publishUiSnapshot(snapshot, true);
+}
+
+void displayDryFireRunningScreen(bool waiting, int beepNum, int totalBeeps) {
+    if (!redrawMenu) return;
+
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_DRY_FIRE_RUNNING;
+    snapshot.dryFireRunning.waiting = waiting;
+    snapshot.dryFireRunning.beepNum = beepNum;
+    snapshot.dryFireRunning.totalBeeps = totalBeeps;
+    publishUiSnapshot(snapshot, true);
+    redrawMenu = false;
+}
+
+void displayBluetoothScanResults() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_BT_SCAN;
+    UiScanScreen& scan = snapshot.scan;
+    int itemsPerScreen = MENU_ITEMS_PER_SCREEN_PORTRAIT + 2;
+    int deviceCount = (int)discoveredBtDevices.size();
+
+    scan.scanning = scanInProgress;
+    scan.rowCount = 0;
+    scan.selectedRow = -1;
+    int startIdx = scanMenuScrollOffset;
+    int endIdx = min(scanMenuScrollOffset + itemsPerScreen, deviceCount);
+    for (int i = startIdx; i < endIdx && scan.rowCount < UI_LIST_ROWS; ++i) {
+        String deviceName = discoveredBtDevices[i].name;
+        if (deviceName.isEmpty()) {
+            deviceName = discoveredBtDevices[i].address; // Fallback to address
+        }
+        if (i == scanMenuSelection) {
+            scan.selectedRow = scan.rowCount;
+        }
+        copyText(scan.rows[scan.rowCount++], deviceName.c_str());
+    }
+    scan.moreAbove = scanMenuScrollOffset > 0;
+    scan.moreBelow = scanMenuScrollOffset + itemsPerScreen < deviceCount;
+    publishUiSnapshot(snapshot, true);
+}
+
+// --- Drawing (UI render task) ---
+
+static void drawLowBatteryIndicator(bool lowBattery) {
+    if (lowBattery) {
+        StickCP2.Lcd.setTextDatum(TR_DATUM);
+        StickCP2.Lcd.setTextFont(0);
+        StickCP2.Lcd.setTextSize(1);
+        StickCP2.Lcd.setTextColor(RED, BLACK);
+        StickCP2.Lcd.drawString("(Bat)", StickCP2.Lcd.width() - 5, 5);
+        StickCP2.Lcd.setTextColor(WHITE, BLACK);
+        StickCP2.Lcd.setTextDatum(TL_DATUM);
+    }
+}
+
+static void drawMessageScreen(const char* text, uint8_t textSize) {
+    StickCP2.Lcd.fillScreen(BLACK);
+    if (text[0] == '\0') return;
+    StickCP2.Lcd.setTextDatum(MC_DATUM);
+    StickCP2.Lcd.setTextFont(0);
+    StickCP2.Lcd.setTextSize(textSize);
+    StickCP2.Lcd.drawString(text, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
+}
+
+static void drawMenuScreen(const UiMenuScreen& menu, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_MENU);
+    StickCP2.Lcd.fillScreen(BLACK);
+    StickCP2.Lcd.setTextDatum(TC_DATUM);
+    StickCP2.Lcd.setTextFont(0);
+    StickCP2.Lcd.setTextSize(2);
+    StickCP2.Lcd.drawString(menu.title, StickCP2.Lcd.width() / 2, 10);
+
+    int y_pos = 45;
+    bool hasStatus = menu.status[0] != '\0';
+
+    if (menu.corner[0] != '\0') {
+        StickCP2.Lcd.setTextDatum(TR_DATUM);
+        StickCP2.Lcd.setTextFont(0);
+        StickCP2.Lcd.setTextSize(1);
+        StickCP2.Lcd.setTextColor(WHITE, BLACK);
+        StickCP2.Lcd.drawString(menu.corner, StickCP2.Lcd.width() - 5, 5);
+    }
+    if (hasStatus) {
+        StickCP2.Lcd.setTextDatum(TC_DATUM);
+        StickCP2.Lcd.setTextFont(0);
+        StickCP2.Lcd.setTextSize(1);
+        StickCP2.Lcd.setTextColor(menu.statusColor, BLACK);
+        StickCP2.Lcd.drawString(menu.status, StickCP2.Lcd.width() / 2, 30);
+        StickCP2.Lcd.setTextColor(WHITE, BLACK);
+        y_pos = 55;
+    }
+
+    StickCP2.Lcd.setTextDatum(TL_DATUM);
+    int rotation = StickCP2.Lcd.getRotation();
+    int itemHeight = (rotation % 2 == 0) ? MENU_ITEM_HEIGHT_PORTRAIT : MENU_ITEM_HEIGHT_LANDSCAPE;
+    int textSize = (rotation % 2 == 0) ? 1 : 2;
+
+    StickCP2.Lcd.setTextSize(textSize);
+
+    for (int row = 0; row < menu.rowCount; ++row) {
+        int display_y = y_pos + row * itemHeight;
+        if (row == menu.selectedRow) {
             StickCP2.Lcd.setTextColor(BLACK, WHITE);
             StickCP2.Lcd.fillRect(5, display_y - 2, StickCP2.Lcd.width() - 10, (textSize == 1 ? 14 : 20), WHITE);
-            StickCP2.Lcd.drawString(itemText, 15, display_y);
+            StickCP2.Lcd.drawString(menu.rows[row], 15, display_y);
             StickCP2.Lcd.setTextColor(WHITE, BLACK);
         } else {
-            StickCP2.Lcd.drawString(itemText, 15, display_y);
+            StickCP2.Lcd.drawString(menu.rows[row], 15, display_y);
         }
     }
 
-    if (scrollOffset > 0) {
-        StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, y_pos - itemHeight/2 - ( (strcmp(title, "Bluetooth Settings") == 0) ? 5 : 10 ), StickCP2.Lcd.width() / 2 - 5, y_pos - itemHeight/2 - ( (strcmp(title, "Bluetooth Settings") == 0) ? 0 : 5 ), StickCP2.Lcd.width() / 2 + 5, y_pos - itemHeight/2 - ( (strcmp(title, "Bluetooth Settings") == 0) ? 0 : 5 ), WHITE);
+    if (menu.moreAbove) {
+        StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, y_pos - itemHeight/2 - (hasStatus ? 5 : 10), StickCP2.Lcd.width() / 2 - 5, y_pos - itemHeight/2 - (hasStatus ? 0 : 5), StickCP2.Lcd.width() / 2 + 5, y_pos - itemHeight/2 - (hasStatus ? 0 : 5), WHITE);
     }
-    if (endIdx < count) {
+    if (menu.moreBelow) {
         StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 5, StickCP2.Lcd.width() / 2 - 5, StickCP2.Lcd.height() - 10, StickCP2.Lcd.width() / 2 + 5, StickCP2.Lcd.height() - 10, WHITE);
     }
 
-    drawLowBatteryIndicator();
+    drawLowBatteryIndicator(lowBattery);
     StickCP2.Lcd.setTextDatum(TL_DATUM);
 }
 
-void displayTimingScreen(float elapsedTime, int count, float lastSplit) {
+// Draws straight to the panel; used when there is no RAM for the sprites.
+static void drawTimingScreenDirect(float elapsedTime, int count, int maxShots, float lastSplit, bool lowBattery, bool redraw) {
     static float prevElapsedTime = -1.0f;
     static int prevCount = -1;
     static float prevLastSplit = -1.0f;
     static bool prevLowBattery = false;
     int rotation = StickCP2.Lcd.getRotation();
 
-    bool updateNeeded = redrawMenu ||
+    bool updateNeeded = redraw ||
                         abs(elapsedTime - prevElapsedTime) > 0.01f ||
                         count != prevCount ||
                         abs(lastSplit - prevLastSplit) > 0.01f ||
-                        lowBatteryWarning != prevLowBattery;
+                        lowBattery != prevLowBattery;
 
-    if (redrawMenu) {
+    if (redraw) {
         StickCP2.Lcd.fillScreen(BLACK);
     }
-    if (!updateNeeded && !redrawMenu) {
+    if (!updateNeeded && !redraw) {
         return;
     }
 
     StickCP2.Lcd.setTextColor(WHITE, BLACK);
     StickCP2.Lcd.setTextDatum(TL_DATUM);
 
-    if (redrawMenu || abs(elapsedTime - prevElapsedTime) > 0.01f) {
+    if (redraw || abs(elapsedTime - prevElapsedTime) > 0.01f) {
         StickCP2.Lcd.setTextFont(7);
         StickCP2.Lcd.setTextSize(1);
         int time_y = (rotation % 2 == 0) ? 20 : 15;
@@ -187,16 +513,16 @@ void displayTimingScreen(float elapsedTime, int count, float lastSplit) {
     int text_size = (rotation % 2 == 0) ? 1 : 2;
     int line_h = (text_size == 1) ? 14 : 20;
 
-    if (redrawMenu || count != prevCount) {
+    if (redraw || count != prevCount) {
         StickCP2.Lcd.setTextFont(0);
         StickCP2.Lcd.setTextSize(text_size);
         StickCP2.Lcd.fillRect(10, shots_y, StickCP2.Lcd.width() - 20, line_h, BLACK);
         StickCP2.Lcd.setCursor(10, shots_y);
-        StickCP2.Lcd.printf("Shots: %d/%d", count, currentMaxShots);
+        StickCP2.Lcd.printf("Shots: %d/%d", count, maxShots);
         prevCount = count;
     }
 
-    if (redrawMenu || abs(lastSplit - prevLastSplit) > 0.01f || count != prevCount) {
+    if (redraw || abs(lastSplit - prevLastSplit) > 0.01f || count != prevCount) {
         StickCP2.Lcd.setTextFont(0);
         StickCP2.Lcd.setTextSize(text_size);
         StickCP2.Lcd.fillRect(10, split_y, StickCP2.Lcd.width() - 20, line_h, BLACK);
@@ -209,15 +535,198 @@ void displayTimingScreen(float elapsedTime, int count, float lastSplit) {
          prevLastSplit = lastSplit;
     }
 
-    if (redrawMenu || lowBatteryWarning != prevLowBattery) {
+    if (redraw || lowBattery != prevLowBattery) {
         StickCP2.Lcd.fillRect(StickCP2.Lcd.width() - 40, 5, 35, 10, BLACK);
-        drawLowBatteryIndicator();
-        prevLowBattery = lowBatteryWarning;
+        drawLowBatteryIndicator(lowBattery);
+        prevLowBattery = lowBattery;
     }
-    redrawMenu = false;
 }
 
-void displayStoppedScreen() {
+// --- Timing Screen Sprites ---
+// The clock is drawn from a glyph atlas: '0'-'9' and '.' rendered once in
+// font 7, each in a fixed cell. Every tick only the cells whose character
+// changed are sent to the panel, by DMA straight from the atlas; the shot /
+// split lines are composed in a sprite and sent when they change. Both stay
+// in internal RAM (DMA cannot read PSRAM).
+static M5Canvas glyphAtlas(&StickCP2.Lcd);
+static M5Canvas lineSprite(&StickCP2.Lcd);
+static bool timingSpritesOk = false;
+static int glyphDigitW = 0;  // Cell width of every digit
+static int glyphDotW = 0;
+static int glyphH = 0;
+static DisplayFrameStats timingFrameStats = {0, 0, 0};
+
+static void renderGlyphAtlas() {
+    glyphAtlas.fillSprite(BLACK);
+    glyphAtlas.setTextColor(WHITE, BLACK);
+    glyphAtlas.setTextDatum(TL_DATUM);
+    glyphAtlas.setTextFont(7);
+    glyphAtlas.setTextSize(1);
+    char glyph[2] = {0, 0};
+    for (int d = 0; d < 10; ++d) {
+        glyph[0] = (char)('0' + d);
+        glyphAtlas.drawString(glyph, d * glyphDigitW, 0);
+    }
+    glyphAtlas.drawString(".", 10 * glyphDigitW, 0);
+}
+
+static bool ensureTimingSprites(int lineW, int lineH) {
+    if (timingSpritesOk && lineSprite.width() == lineW && lineSprite.height() == lineH) {
+        return true;
+    }
+    glyphAtlas.deleteSprite();
+    lineSprite.deleteSprite();
+    glyphAtlas.setColorDepth(16);
+    lineSprite.setColorDepth(16);
+
+    glyphAtlas.setTextFont(7);
+    glyphAtlas.setTextSize(1);
+    glyphDigitW = 0;
+    char glyph[2] = {0, 0};
+    for (int d = 0; d < 10; ++d) {
+        glyph[0] = (char)('0' + d);
+        glyphDigitW = max(glyphDigitW, (int)glyphAtlas.textWidth(glyph));
+    }
+    glyphDotW = glyphAtlas.textWidth(".");
+    glyphH = glyphAtlas.fontHeight(7);
+
+    timingSpritesOk = glyphAtlas.createSprite(10 * glyphDigitW + glyphDotW, glyphH) != nullptr &&
+                      lineSprite.createSprite(lineW, lineH) != nullptr;
+    if (!timingSpritesOk) {
+        glyphAtlas.deleteSprite();
+        lineSprite.deleteSprite();
+        return false;
+    }
+    renderGlyphAtlas();
+    return true;
+}
+
+static int glyphCellWidth(char c) {
+    return (c == '.') ? glyphDotW : glyphDigitW;
+}
+
+// Sends the atlas cell of 'c' to (dstX, dstY). The clip rect limits the DMA
+// transfer to the cell; rows are read with the atlas' stride.
+static void pushGlyph(char c, int dstX, int dstY) {
+    int cellX = (c == '.') ? 10 * glyphDigitW : (c - '0') * glyphDigitW;
+    StickCP2.Lcd.setClipRect(dstX, dstY, glyphCellWidth(c), glyphH);
+    StickCP2.Lcd.pushImageDMA(dstX - cellX, dstY, glyphAtlas.width(), glyphH, (const lgfx::swap565_t*)glyphAtlas.getBuffer());
+    StickCP2.Lcd.clearClipRect();
+}
+
+// Sends columns [x, x + w) of a sprite drawn at (dstX, dstY). The clip rect
+// limits the DMA transfer to those columns; rows are read with the sprite's stride.
+static void pushSpriteColumns(M5Canvas& sprite, int dstX, int dstY, int x, int w) {
+    if (w <= 0) return;
+    StickCP2.Lcd.setClipRect(dstX + x, dstY, w, sprite.height());
+    StickCP2.Lcd.pushImageDMA(dstX, dstY, sprite.width(), sprite.height(), (const lgfx::swap565_t*)sprite.getBuffer());
+    StickCP2.Lcd.clearClipRect();
+}
+
+static void recordTimingFrame(int64_t startUs) {
+    uint32_t us = (uint32_t)(esp_timer_get_time() - startUs);
+    timingFrameStats.lastUs = us;
+    timingFrameStats.avgUs = (timingFrameStats.avgUs == 0) ? us : (timingFrameStats.avgUs * 15 + us) / 16;
+    if (us > timingFrameStats.maxUs) timingFrameStats.maxUs = us;
+}
+
+DisplayFrameStats getTimingFrameStats() {
+    return timingFrameStats;
+}
+
+static void drawTimingScreen(float elapsedTime, int count, int maxShots, float lastSplit, bool lowBattery, bool redraw) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_TIMING);
+    static char prevTimeStr[12] = "";
+    static int prevCount = -1;
+    static float prevLastSplit = -1.0f;
+    static bool prevLowBattery = false;
+    int64_t frameStartUs = esp_timer_get_time();
+    int rotation = StickCP2.Lcd.getRotation();
+
+    int time_y = (rotation % 2 == 0) ? 20 : 15;
+    int shots_y = (rotation % 2 == 0) ? 80 : 75;
+    int split_y = shots_y + ((rotation % 2 == 0) ? 20 : 25);
+    int text_size = (rotation % 2 == 0) ? 1 : 2;
+    int line_h = (text_size == 1) ? 14 : 20;
+    int area_w = StickCP2.Lcd.width() - 20;
+
+    if (redraw) {
+        StickCP2.Lcd.waitDMA();
+        StickCP2.Lcd.fillScreen(BLACK);
+        ensureTimingSprites(area_w, line_h);
+    }
+    if (!timingSpritesOk) {
+        drawTimingScreenDirect(elapsedTime, count, maxShots, lastSplit, lowBattery, redraw);
+        recordTimingFrame(frameStartUs);
+        return;
+    }
+
+    char timeStr[12];
+    snprintf(timeStr, sizeof(timeStr), "%.2f", elapsedTime);
+    bool timeChanged = redraw || strcmp(timeStr, prevTimeStr) != 0;
+    bool countChanged = redraw || count != prevCount;
+    bool splitChanged = countChanged || abs(lastSplit - prevLastSplit) > 0.01f;
+    if (!timeChanged && !countChanged && !splitChanged && lowBattery == prevLowBattery) {
+        return;
+    }
+
+    // The previous frame's transfers must be done before lineSprite is reused.
+    StickCP2.Lcd.waitDMA();
+    StickCP2.Lcd.startWrite();
+
+    if (timeChanged) {
+        // The cells only line up with the last frame's while the length is the same.
+        bool allCells = redraw || strlen(timeStr) != strlen(prevTimeStr);
+        if (allCells) {
+            StickCP2.Lcd.fillRect(5, time_y, StickCP2.Lcd.width() - 10, glyphH + 4, BLACK);
+        }
+        int x = 10;
+        for (int i = 0; timeStr[i] != '\0'; ++i) {
+            if (allCells || timeStr[i] != prevTimeStr[i]) {
+                pushGlyph(timeStr[i], x, time_y);
+            }
+            x += glyphCellWidth(timeStr[i]);
+        }
+        strcpy(prevTimeStr, timeStr);
+    }
+
+    if (countChanged) {
+        lineSprite.fillSprite(BLACK);
+        lineSprite.setTextColor(WHITE, BLACK);
+        lineSprite.setTextFont(0);
+        lineSprite.setTextSize(text_size);
+        lineSprite.setCursor(0, 0);
+        lineSprite.printf("Shots: %d/%d", count, maxShots);
+        pushSpriteColumns(lineSprite, 10, shots_y, 0, lineSprite.width());
+        prevCount = count;
+    }
+
+    if (splitChanged) {
+        StickCP2.Lcd.waitDMA(); // lineSprite may still be going out
+        lineSprite.fillSprite(BLACK);
+        lineSprite.setCursor(0, 0);
+        if (count > 0) {
+            lineSprite.printf("Split: %.2fs", lastSplit);
+        } else {
+            lineSprite.print("Split: ---");
+        }
+        pushSpriteColumns(lineSprite, 10, split_y, 0, lineSprite.width());
+        prevLastSplit = lastSplit;
+    }
+
+    StickCP2.Lcd.endWrite();
+
+    if (redraw || lowBattery != prevLowBattery) {
+        StickCP2.Lcd.waitDMA();
+        StickCP2.Lcd.fillRect(StickCP2.Lcd.width() - 40, 5, 35, 10, BLACK);
+        drawLowBatteryIndicator(lowBattery);
+        prevLowBattery = lowBattery;
+    }
+    recordTimingFrame(frameStartUs);
+}
+
+static void drawStoppedScreen(int count, const float* splits, int marginDb, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_STOPPED);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextFont(0);
     StickCP2.Lcd.setTextColor(WHITE, BLACK);
@@ -230,26 +739,26 @@ void displayStoppedScreen() {
     StickCP2.Lcd.setTextSize(text_size);
 
     StickCP2.Lcd.setCursor(10, y_pos);
-    StickCP2.Lcd.printf("Total Shots: %d", shotCount);
+    StickCP2.Lcd.printf("Total Shots: %d", count);
     y_pos += line_h;
 
     StickCP2.Lcd.setCursor(10, y_pos);
-    if (shotCount > 0) { StickCP2.Lcd.printf("First: %.2fs", splitTimes[0]); }
+    if (count > 0) { StickCP2.Lcd.printf("First: %.2fs", splits[0]); }
     else { StickCP2.Lcd.print("First: ---s"); }
     y_pos += line_h;
 
     StickCP2.Lcd.setCursor(10, y_pos);
-     if (shotCount > 1) { StickCP2.Lcd.printf("Last Split: %.2fs", splitTimes[shotCount - 1]); }
-     else if (shotCount == 1) { StickCP2.Lcd.print("Last Split: N/A"); }
+     if (count > 1) { StickCP2.Lcd.printf("Last Split: %.2fs", splits[count - 1]); }
+     else if (count == 1) { StickCP2.Lcd.print("Last Split: N/A"); }
      else { StickCP2.Lcd.print("Last Split: ---s"); }
     y_pos += line_h;
 
-    if (shotCount > 1) {
+    if (count > 1) {
         float fastestSplit = FLT_MAX; 
         int fastestSplitIndex = -1;
-        for (int i = 1; i < shotCount; ++i) { 
-            if (splitTimes[i] < fastestSplit && splitTimes[i] > 0.0f) { 
-                fastestSplit = splitTimes[i];
+        for (int i = 1; i < count; ++i) { 
+            if (splits[i] < fastestSplit && splits[i] > 0.0f) { 
+                fastestSplit = splits[i];
                 fastestSplitIndex = i;
             }
         }
@@ -267,150 +776,120 @@ void displayStoppedScreen() {
     }
 
     StickCP2.Lcd.setTextSize(1);
+    if (marginDb > 0) {
+        StickCP2.Lcd.setCursor(30, StickCP2.Lcd.height() - 32);
+        StickCP2.Lcd.printf("Margin: %ddB (Up/Dn)", marginDb);
+    }
     StickCP2.Lcd.setCursor(30, StickCP2.Lcd.height() - 20);
     StickCP2.Lcd.print("Press Front to Reset");
-    drawLowBatteryIndicator();
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void displayEditScreen() {
-    if (!redrawMenu) {
+static void drawEditScreen(const UiEditScreen& edit, bool lowBattery, bool redraw) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_EDIT);
+    if (!redraw) {
          StickCP2.Lcd.fillRect(0, StickCP2.Lcd.height()/2 - 25, StickCP2.Lcd.width(), 50, BLACK);
     } else {
         StickCP2.Lcd.fillScreen(BLACK);
         StickCP2.Lcd.setTextDatum(TC_DATUM);
         StickCP2.Lcd.setTextFont(0);
         StickCP2.Lcd.setTextSize(2);
-        if (settingBeingEdited == EDIT_PAR_TIME_ARRAY) {
-             String titleStr = "Par Time " + String(editingIntValue + 1);
-             StickCP2.Lcd.drawString(titleStr, StickCP2.Lcd.width() / 2, 15);
-        } else {
-            StickCP2.Lcd.drawString(editingSettingName, StickCP2.Lcd.width() / 2, 15);
-        }
+        StickCP2.Lcd.drawString(edit.title, StickCP2.Lcd.width() / 2, 15);
         StickCP2.Lcd.setTextDatum(BC_DATUM);
         StickCP2.Lcd.setTextFont(0);
         StickCP2.Lcd.setTextSize(1);
-        if (settingBeingEdited == EDIT_BOOT_ANIM || settingBeingEdited == EDIT_AUTO_SLEEP || settingBeingEdited == EDIT_BT_AUTO_RECONNECT) {
-            StickCP2.Lcd.drawString(getUpButtonLabel() + " or " + getDownButtonLabel() + " = Toggle", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
-        } else {
-            StickCP2.Lcd.drawString(getUpButtonLabel() + "=Up / " + getDownButtonLabel() + "=Down", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
-        }
+        StickCP2.Lcd.drawString(edit.hint, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
         StickCP2.Lcd.drawString("Press=OK / Hold=Cancel", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
     }
 
     StickCP2.Lcd.setTextDatum(MC_DATUM);
-
-    switch(settingBeingEdited) {
-        case EDIT_MAX_SHOTS:
-        case EDIT_BEEP_TONE:
-        case EDIT_SHOT_THRESHOLD:
-        case EDIT_PAR_BEEP_COUNT:
-        case EDIT_ROTATION:
-        case EDIT_BT_VOLUME:
-        case EDIT_BT_AUDIO_OFFSET: 
-             StickCP2.Lcd.setTextFont(7); StickCP2.Lcd.setTextSize(1);
-             StickCP2.Lcd.drawNumber(editingIntValue, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
-             if (settingBeingEdited == EDIT_BT_AUDIO_OFFSET) { 
-                StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(1); 
-                StickCP2.Lcd.drawString("ms", StickCP2.Lcd.width() / 2 + StickCP2.Lcd.textWidth(String(editingIntValue))/2 + 15, StickCP2.Lcd.height() / 2);
-             }
-             break;
-        case EDIT_BEEP_DURATION:
-             StickCP2.Lcd.setTextFont(7); StickCP2.Lcd.setTextSize(1);
-             StickCP2.Lcd.drawNumber(editingULongValue, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
-             break;
-        case EDIT_PAR_TIME_ARRAY:
-        case EDIT_RECOIL_THRESHOLD:
-             StickCP2.Lcd.setTextFont(7); StickCP2.Lcd.setTextSize(1);
-             StickCP2.Lcd.drawFloat(editingFloatValue, 1, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
-             break;
-        case EDIT_BOOT_ANIM:
-        case EDIT_AUTO_SLEEP:
-        case EDIT_BT_AUTO_RECONNECT:
-             StickCP2.Lcd.setTextFont(4); StickCP2.Lcd.setTextSize(1);
-             StickCP2.Lcd.drawString(editingBoolValue ? "On" : "Off", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
-             break;
-        default:
-             StickCP2.Lcd.setTextFont(7); StickCP2.Lcd.setTextSize(1);
-             StickCP2.Lcd.drawString("ERROR", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
-             break;
+    StickCP2.Lcd.setTextFont(edit.valueFont); StickCP2.Lcd.setTextSize(1);
+    StickCP2.Lcd.drawString(edit.value, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
+    if (edit.msSuffix) {
+        StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(1);
+        StickCP2.Lcd.drawString("ms", StickCP2.Lcd.width() / 2 + StickCP2.Lcd.textWidth(edit.value)/2 + 15, StickCP2.Lcd.height() / 2);
     }
-    drawLowBatteryIndicator();
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void displayCalibrationScreen(const char* title, float peakValue, const char* unit) {
-    if (redrawMenu) { 
+static void drawCalibrationScreen(const UiCalibrationScreen& calibration, bool lowBattery, bool redraw) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_CALIBRATION);
+    if (redraw) {
         StickCP2.Lcd.fillScreen(BLACK);
         StickCP2.Lcd.setTextDatum(TC_DATUM); StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(2);
-        StickCP2.Lcd.drawString(title, StickCP2.Lcd.width() / 2, 10);
+        StickCP2.Lcd.drawString(calibration.title, StickCP2.Lcd.width() / 2, 10);
         StickCP2.Lcd.setTextDatum(BC_DATUM); StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(1);
         StickCP2.Lcd.drawString("Press Front=Save Peak", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
         StickCP2.Lcd.drawString("Hold Front=Cancel", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
-        if (currentState == CALIBRATE_RECOIL) {
+        if (calibration.recoil) {
              StickCP2.Lcd.drawString("Trigger Recoil", StickCP2.Lcd.width()/2, StickCP2.Lcd.height()-45);
         }
-    } else { 
+    } else {
         StickCP2.Lcd.fillRect(0, StickCP2.Lcd.height() / 2 - 25, StickCP2.Lcd.width(), 50, BLACK);
     }
 
     StickCP2.Lcd.setTextDatum(MC_DATUM);
     StickCP2.Lcd.setTextFont(1);
     StickCP2.Lcd.setTextSize(3);
-    String peakStr = "PEAK: " + String(peakValue, (currentState == CALIBRATE_RECOIL ? 2 : 0)); 
-    StickCP2.Lcd.drawString(peakStr, StickCP2.Lcd.width() / 2, (StickCP2.Lcd.height()/2));
-    drawLowBatteryIndicator(); 
+    StickCP2.Lcd.drawString(calibration.peak, StickCP2.Lcd.width() / 2, (StickCP2.Lcd.height()/2));
+    drawLowBatteryIndicator(lowBattery);
 }
 
+static void drawBtLatencyScreen(const UiBtLatencyScreen& latency, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_BT_LATENCY);
+    StickCP2.Lcd.fillScreen(BLACK);
+    StickCP2.Lcd.setTextDatum(TC_DATUM); StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(2);
+    StickCP2.Lcd.drawString("BT Latency", StickCP2.Lcd.width() / 2, 10);
 
-void displayDeviceStatusScreen() {
+    StickCP2.Lcd.setTextDatum(MC_DATUM);
+    if (latency.finished) {
+        StickCP2.Lcd.setTextFont(1); StickCP2.Lcd.setTextSize(3);
+        String resultStr = (latency.resultMs >= 0) ? String(latency.resultMs) + "ms" : String("FAILED");
+        StickCP2.Lcd.drawString(resultStr, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
+    } else {
+        StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(2);
+        StickCP2.Lcd.drawString("Trial " + String(latency.trial) + "/" + String(latency.totalTrials), StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 - 12);
+        String lastStr = (latency.lastLatencyMs >= 0) ? String(latency.lastLatencyMs) + "ms" : String("--");
+        StickCP2.Lcd.drawString(lastStr, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 + 12);
+    }
+
+    StickCP2.Lcd.setTextDatum(BC_DATUM); StickCP2.Lcd.setTextFont(0); StickCP2.Lcd.setTextSize(1);
+    if (latency.finished) {
+        StickCP2.Lcd.drawString(latency.resultMs >= 0 ? "Press Front=Save" : "Press Front=Exit", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
+    } else {
+        StickCP2.Lcd.drawString("Keep quiet, speaker near", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 25);
+    }
+    StickCP2.Lcd.drawString("Hold Front=Cancel", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
+    drawLowBatteryIndicator(lowBattery);
+}
+
+// Device Status and the Loop Profile: as many lines as fit above the footer.
+static void drawPageScreen(const UiPageScreen& page, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_DEVICE_STATUS);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(TC_DATUM);
     StickCP2.Lcd.setTextFont(0);
     StickCP2.Lcd.setTextSize(2);
-    StickCP2.Lcd.drawString("Device Status", StickCP2.Lcd.width() / 2, 10);
+    StickCP2.Lcd.drawString(page.title, StickCP2.Lcd.width() / 2, 10);
 
     StickCP2.Lcd.setTextDatum(TL_DATUM);
     StickCP2.Lcd.setTextSize(1);
     int y_pos = 35;
     int line_h = 12;
-
-    float batt_v = StickCP2.Power.getBatteryVoltage() / 1000.0f;
-    int batt_pct = StickCP2.Power.getBatteryLevel();
-    bool charging = StickCP2.Power.isCharging();
-
-    StickCP2.Lcd.setCursor(10, y_pos);
-    StickCP2.Lcd.printf("Batt: %.2fV (%d%%) %s", batt_v, batt_pct, charging ? "Chg" : "");
-    y_pos += line_h;
-    StickCP2.Lcd.setCursor(10, y_pos);
-    StickCP2.Lcd.printf("Peak V: %.2fV", peakBatteryVoltage);
-    y_pos += line_h + 5;
-
-    float accX, accY, accZ, gyroX, gyroY, gyroZ, temp;
-    StickCP2.Imu.getAccelData(&accX, &accY, &accZ);
-
-    StickCP2.Lcd.setCursor(10, y_pos);
-    StickCP2.Lcd.print("IMU Acc (G):");
-    y_pos += line_h;
-    StickCP2.Lcd.setCursor(15, y_pos);
-    StickCP2.Lcd.printf("X:%.2f, Y:%.2f, Z:%.2f", accX, accY, accZ);
-    y_pos += line_h + 5;
-
-    StickCP2.Lcd.setCursor(10, y_pos);
-    if (filesystem_ok_for_boot) { 
-        size_t totalBytes = LittleFS.totalBytes();
-        size_t usedBytes = LittleFS.usedBytes();
-        StickCP2.Lcd.printf("LittleFS: %u/%u B used", usedBytes, totalBytes);
-    } else {
-        StickCP2.Lcd.print("LittleFS: Not Mounted!");
+    for (int i = 0; i < page.lineCount && y_pos + line_h <= StickCP2.Lcd.height() - 16; ++i) {
+        StickCP2.Lcd.setCursor(10, y_pos);
+        StickCP2.Lcd.print(page.lines[i]);
+        y_pos += line_h;
     }
-    y_pos += line_h;
 
     StickCP2.Lcd.setTextDatum(BC_DATUM);
     StickCP2.Lcd.setTextSize(1);
-    StickCP2.Lcd.drawString("Hold Front to Return", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
-    drawLowBatteryIndicator();
+    StickCP2.Lcd.drawString(page.footer, StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void displayListFilesScreen() {
+static void drawListFilesScreen(const UiFilesScreen& files, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_LIST_FILES);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(TC_DATUM);
     StickCP2.Lcd.setTextFont(0);
@@ -421,33 +900,23 @@ void displayListFilesScreen() {
     StickCP2.Lcd.setTextSize(1);
     int y_pos = 35;
     int line_h = 12;
-    int rotation = StickCP2.Lcd.getRotation();
-    int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT + 2 : MENU_ITEMS_PER_SCREEN_LANDSCAPE + 1;
 
-    if (fileListCount == 0) {
+    if (files.rowCount == 0) {
         StickCP2.Lcd.setCursor(10, y_pos);
         StickCP2.Lcd.print("No files found or");
         y_pos += line_h;
         StickCP2.Lcd.setCursor(10, y_pos);
         StickCP2.Lcd.print("LittleFS error.");
     } else {
-        int startIdx = fileListScrollOffset;
-        int endIdx = min(fileListScrollOffset + itemsPerScreen, fileListCount);
-
-        for (int i = startIdx; i < endIdx; ++i) {
-            int display_y = y_pos + (i - startIdx) * line_h;
-            StickCP2.Lcd.setCursor(5, display_y);
-            String displayName = fileListNames[i];
-            if (displayName.length() > 20) {
-                displayName = displayName.substring(0, 17) + "...";
-            }
-            StickCP2.Lcd.printf("%-20s %6d B", displayName.c_str(), (int)fileListSizes[i]);
+        for (int row = 0; row < files.rowCount; ++row) {
+            StickCP2.Lcd.setCursor(5, y_pos + row * line_h);
+            StickCP2.Lcd.print(files.rows[row]);
         }
 
-        if (fileListScrollOffset > 0) {
+        if (files.moreAbove) {
              StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, 28, StickCP2.Lcd.width() / 2 - 4, 33, StickCP2.Lcd.width() / 2 + 4, 33, WHITE);
         }
-        if (endIdx < fileListCount) {
+        if (files.moreBelow) {
              StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 15, StickCP2.Lcd.width() / 2 - 4, StickCP2.Lcd.height() - 20, StickCP2.Lcd.width() / 2 + 4, StickCP2.Lcd.height() - 20, WHITE);
         }
     }
@@ -455,10 +924,11 @@ void displayListFilesScreen() {
     StickCP2.Lcd.setTextDatum(BC_DATUM);
     StickCP2.Lcd.setTextSize(1);
     StickCP2.Lcd.drawString("Hold Front to Return", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 5);
-    drawLowBatteryIndicator();
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void displayDryFireReadyScreen() {
+static void drawDryFireReadyScreen(bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_DRY_FIRE_READY);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(MC_DATUM);
     StickCP2.Lcd.setTextFont(0);
@@ -468,90 +938,67 @@ void displayDryFireReadyScreen() {
     StickCP2.Lcd.setTextSize(1);
     StickCP2.Lcd.drawString("Press Front to Start", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 + 10);
     StickCP2.Lcd.drawString("Hold Top/Front=Exit", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 20);
-    drawLowBatteryIndicator();
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void displayDryFireRunningScreen(bool waiting, int beepNum, int totalBeeps) {
-    if (!redrawMenu) return; 
-
+static void drawDryFireRunningScreen(const UiDryFireRunningScreen& running, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_DRY_FIRE_RUNNING);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(MC_DATUM);
     StickCP2.Lcd.setTextFont(0);
 
-    if (waiting) {
+    if (running.waiting) {
         StickCP2.Lcd.setTextSize(3);
         StickCP2.Lcd.drawString("Waiting...", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
     } else {
         StickCP2.Lcd.setTextSize(7);
-        StickCP2.Lcd.drawString(String(beepNum), StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 - 10);
+        StickCP2.Lcd.drawString(String(running.beepNum), StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 - 10);
         StickCP2.Lcd.setTextFont(0);
         StickCP2.Lcd.setTextSize(1);
-        StickCP2.Lcd.drawString("Beep / " + String(totalBeeps), StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 + 35);
+        StickCP2.Lcd.drawString("Beep / " + String(running.totalBeeps), StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 + 35);
     }
 
     StickCP2.Lcd.setTextDatum(BC_DATUM);
     StickCP2.Lcd.setTextSize(1);
     StickCP2.Lcd.drawString("Hold Top/Front=Cancel", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 10);
-    drawLowBatteryIndicator();
-    redrawMenu = false; 
+    drawLowBatteryIndicator(lowBattery);
 }
 
-void drawLowBatteryIndicator() {
-    if (lowBatteryWarning) {
-        StickCP2.Lcd.setTextDatum(TR_DATUM); 
-        StickCP2.Lcd.setTextFont(0);
-        StickCP2.Lcd.setTextSize(1);
-        StickCP2.Lcd.setTextColor(RED, BLACK);
-        StickCP2.Lcd.drawString("(Bat)", StickCP2.Lcd.width() - 5, 5); 
-        StickCP2.Lcd.setTextColor(WHITE, BLACK); 
-        StickCP2.Lcd.setTextDatum(TL_DATUM); 
-    }
-}
-
-void displayBluetoothScanResults() {
+static void drawBluetoothScanScreen(const UiScanScreen& scan, bool lowBattery) {
+    PROFILE_SCOPE(PROFILE_DISPLAY_BT_SCAN);
     StickCP2.Lcd.fillScreen(BLACK);
     StickCP2.Lcd.setTextDatum(TC_DATUM);
     StickCP2.Lcd.setTextFont(0);
     StickCP2.Lcd.setTextSize(2);
     // Dynamically change title based on scan state
-    if (scanInProgress) {
+    if (scan.scanning) {
         StickCP2.Lcd.drawString("Scanning...", StickCP2.Lcd.width() / 2, 10);
     } else {
         StickCP2.Lcd.drawString("Scan Results", StickCP2.Lcd.width() / 2, 10);
     }
-    
 
     StickCP2.Lcd.setTextDatum(TL_DATUM);
     int y_pos = 35;
-    int itemsPerScreen = MENU_ITEMS_PER_SCREEN_PORTRAIT + 2;
     int itemHeight = MENU_ITEM_HEIGHT_PORTRAIT - 3;
     int textSize = 1;
 
     StickCP2.Lcd.setTextSize(textSize);
 
-    if (discoveredBtDevices.empty() && !scanInProgress) { // Show "No devices" only if scan is finished
+    if (scan.rowCount == 0 && !scan.scanning) { // Show "No devices" only if scan is finished
         StickCP2.Lcd.setTextDatum(MC_DATUM);
         StickCP2.Lcd.drawString("No devices found.", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2);
         StickCP2.Lcd.drawString("Hold Front to go Back.", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() / 2 + 15);
-         StickCP2.Lcd.setTextDatum(TL_DATUM); 
+        StickCP2.Lcd.setTextDatum(TL_DATUM);
     } else {
-        int startIdx = scanMenuScrollOffset;
-        int endIdx = min((int)(scanMenuScrollOffset + itemsPerScreen), (int)discoveredBtDevices.size());
-
-        for (int i = startIdx; i < endIdx; ++i) {
-            if (i >= discoveredBtDevices.size()) break;
-
-            int display_y = y_pos + (i - startIdx) * itemHeight;
-            String deviceName = discoveredBtDevices[i].name;
-            if (deviceName.isEmpty()) {
-                deviceName = discoveredBtDevices[i].address; // Fallback to address
-            }
-            int maxDisplayChars = (StickCP2.Lcd.width() - 20) / 6; 
-            if (deviceName.length() > maxDisplayChars && maxDisplayChars > 3) { 
+        for (int row = 0; row < scan.rowCount; ++row) {
+            int display_y = y_pos + row * itemHeight;
+            String deviceName = scan.rows[row];
+            int maxDisplayChars = (StickCP2.Lcd.width() - 20) / 6;
+            if ((int)deviceName.length() > maxDisplayChars && maxDisplayChars > 3) {
                  deviceName = deviceName.substring(0, maxDisplayChars - 3) + "...";
             }
 
-            if (i == scanMenuSelection) {
+            if (row == scan.selectedRow) {
                 StickCP2.Lcd.setTextColor(BLACK, WHITE);
                 StickCP2.Lcd.fillRect(5, display_y - 2, StickCP2.Lcd.width() - 10, itemHeight + 1 , WHITE);
                 StickCP2.Lcd.drawString(deviceName, 10, display_y);
@@ -560,30 +1007,274 @@ void displayBluetoothScanResults() {
                 StickCP2.Lcd.drawString(deviceName, 10, display_y);
             }
         }
-        
-        // Show instructions only when scan is finished
-        if (!scanInProgress) {
-            StickCP2.Lcd.setTextDatum(BC_DATUM);
-            StickCP2.Lcd.setTextSize(1);
-            StickCP2.Lcd.drawString("Press=Connect / Hold=Back", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 5);
-            StickCP2.Lcd.setTextDatum(TL_DATUM); 
-        } else {
-             // Optionally show different text while scanning, e.g., "Scanning... Hold=Cancel"
-            StickCP2.Lcd.setTextDatum(BC_DATUM);
-            StickCP2.Lcd.setTextSize(1);
-            StickCP2.Lcd.drawString("Scanning... Hold=Cancel", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 5);
-            StickCP2.Lcd.setTextDatum(TL_DATUM); 
-        }
+
+        // Instructions follow the scan state
+        StickCP2.Lcd.setTextDatum(BC_DATUM);
+        StickCP2.Lcd.setTextSize(1);
+        StickCP2.Lcd.drawString(scan.scanning ? "Scanning... Hold=Cancel" : "Press=Connect / Hold=Back", StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 5);
+        StickCP2.Lcd.setTextDatum(TL_DATUM);
     }
 
     // Scroll indicators
-    if (scanMenuScrollOffset > 0) {
+    if (scan.moreAbove) {
         StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, 28, StickCP2.Lcd.width() / 2 - 4, 33, StickCP2.Lcd.width() / 2 + 4, 33, WHITE);
     }
-    if (scanMenuScrollOffset + itemsPerScreen < discoveredBtDevices.size() && !discoveredBtDevices.empty()) {
+    if (scan.moreBelow) {
         StickCP2.Lcd.fillTriangle(StickCP2.Lcd.width() / 2, StickCP2.Lcd.height() - 15, StickCP2.Lcd.width() / 2 - 4, StickCP2.Lcd.height() - 20, StickCP2.Lcd.width() / 2 + 4, StickCP2.Lcd.height() - 20, WHITE);
     }
 
-    drawLowBatteryIndicator();
-    StickCP2.Lcd.setTextDatum(TL_DATUM); 
+    drawLowBatteryIndicator(lowBattery);
+    StickCP2.Lcd.setTextDatum(TL_DATUM);
+}
+
+static void drawBootFrame(const UiBootFrameScreen& boot);
+
+void drawUiSnapshot(const UiSnapshot &snapshot, bool redraw) {
+    StickCP2.Lcd.setTextColor(WHITE, BLACK);
+    switch (snapshot.screen) {
+        case UI_SCREEN_MESSAGE:
+            drawMessageScreen(snapshot.message.text, snapshot.message.textSize);
+            break;
+        case UI_SCREEN_SLEEP:
+            drawMessageScreen("Sleeping...", 2);
+            break;
+        case UI_SCREEN_BOOT_FRAME:
+            drawBootFrame(snapshot.bootFrame); // Over the boot screen setup() cleared
+            break;
+        case UI_SCREEN_MENU:
+            drawMenuScreen(snapshot.menu, snapshot.lowBattery);
+            break;
+        case UI_SCREEN_TIMING:
+            drawTimingScreen(snapshot.timing.elapsedTime, snapshot.timing.shotCount, snapshot.timing.maxShots,
+                             snapshot.timing.lastSplit, snapshot.lowBattery, redraw);
+            break;
+        case UI_SCREEN_STOPPED:
+            drawStoppedScreen(snapshot.stopped.shotCount, snapshot.stopped.splits, snapshot.stopped.rescoreMarginDb,
+                              snapshot.lowBattery);
+            break;
+        case UI_SCREEN_EDIT:
+            drawEditScreen(snapshot.edit, snapshot.lowBattery, redraw);
+            break;
+        case UI_SCREEN_CALIBRATION:
+            drawCalibrationScreen(snapshot.calibration, snapshot.lowBattery, redraw);
+            break;
+        case UI_SCREEN_BT_LATENCY:
+            drawBtLatencyScreen(snapshot.btLatency, snapshot.lowBattery);
+            break;
+        case UI_SCREEN_PAGE:
+            drawPageScreen(snapshot.page, snapshot.lowBattery);
+            break;
+        case UI_SCREEN_FILES:
+            drawListFilesScreen(snapshot.files, snapshot.lowBattery);
+            break;
+        case UI_SCREEN_BT_SCAN:
+            drawBluetoothScanScreen(snapshot.scan, snapshot.lowBattery);
+            break;
+        case UI_SCREEN_DRY_FIRE_READY:
+            drawDryFireReadyScreen(snapshot.lowBattery);
+            break;
+        case UI_SCREEN_DRY_FIRE_RUNNING:
+            drawDryFireRunningScreen(snapshot.dryFireRunning, snapshot.lowBattery);
+            break;
+    }
+}
+
+// --- Packed Boot Animation ---
+// /boot.anim is read front to back through one file handle. Each frame's ops
+// update a copy of the stored frame; the rows that changed are pixel-doubled
+// into one of two internal-RAM bands and sent by DMA while the next band is
+// filled. setup() opens it and loop() publishes frame numbers; from then on
+// only the render task reads the file.
+static File bootAnimFile;
+static BootAnimHeader bootAnimHeader;
+static uint32_t* bootAnimIndex = NULL;  // frameCount + 1 offsets
+static uint8_t* bootAnimOps = NULL;
+static uint16_t* bootAnimPixels = NULL;
+static uint16_t* bootAnimBand[2] = {NULL, NULL};
+static int bootAnimFrame = 0;
+static int bootAnimScale = 1;           // Panel pixels per stored pixel
+static int bootAnimX = 0;
+static int bootAnimY = 0;
+static int bootAnimFrameCount = 0;     // For loop(): frames opened, 0 without the pack
+static int bootAnimFramesPublished = 0;
+
+bool openBootAnimation() {
+    closeBootAnimation();
+    bootAnimFile = LittleFS.open(BOOT_ANIM_PATH, FILE_READ);
+    if (!bootAnimFile) return false;
+
+    uint8_t headerBytes[BOOT_ANIM_HEADER_BYTES];
+    if (bootAnimFile.read(headerBytes, sizeof(headerBytes)) != sizeof(headerBytes) ||
+        !bootAnimParseHeader(headerBytes, sizeof(headerBytes), bootAnimHeader)) {
+        closeBootAnimation();
+        return false;
+    }
+
+    // Largest whole scale that fits; a last row cut in half is fine.
+    int panelW = StickCP2.Lcd.width();
+    int panelH = StickCP2.Lcd.height();
+    bootAnimScale = bootAnimHeader.scale;
+    while (bootAnimScale > 1 && (bootAnimHeader.width * bootAnimScale > panelW ||
+                                 bootAnimHeader.height * bootAnimScale > panelH + bootAnimScale - 1)) {
+        bootAnimScale--;
+    }
+    bootAnimX = max(0, (panelW - bootAnimHeader.width * bootAnimScale) / 2);
+    bootAnimY = max(0, (panelH - bootAnimHeader.height * bootAnimScale) / 2);
+
+    size_t indexBytes = 4 * ((size_t)bootAnimHeader.frameCount + 1);
+    size_t pixelBytes = 2 * (size_t)bootAnimHeader.width * bootAnimHeader.height;
+    size_t bandBytes = 2 * (size_t)bootAnimHeader.width * bootAnimScale * BOOT_ANIM_BAND_ROWS * bootAnimScale;
+    bootAnimIndex = (uint32_t*)malloc(indexBytes);
+    bootAnimOps = (uint8_t*)malloc(bootAnimHeader.maxFrameBytes);
+    bootAnimPixels = (uint16_t*)calloc(1, pixelBytes); // The first frame is a delta against black
+    bootAnimBand[0] = (uint16_t*)heap_caps_malloc(bandBytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    bootAnimBand[1] = (uint16_t*)heap_caps_malloc(bandBytes, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!bootAnimIndex || !bootAnimOps || !bootAnimPixels || !bootAnimBand[0] || !bootAnimBand[1] ||
+        bootAnimFile.read((uint8_t*)bootAnimIndex, indexBytes) != indexBytes) { // Little-endian, as stored
+        closeBootAnimation();
+        return false;
+    }
+    bootAnimFrame = 0;
+    bootAnimFrameCount = bootAnimHeader.frameCount;
+    bootAnimFramesPublished = 0;
+    return true;
+}
+
+bool isBootAnimationOpen() {
+    return bootAnimIndex != NULL;
+}
+
+static unsigned long getBootAnimationFrameDelayMs() {
+    return bootAnimHeader.frameDelayMs;
+}
+
+// Sends stored rows [rowBegin, rowEnd), each pixel as a scale x scale block.
+static void pushBootAnimationRows(int rowBegin, int rowEnd) {
+    const int width = bootAnimHeader.width;
+    const int scale = bootAnimScale;
+    const int bandWidth = width * scale;
+    int bandIndex = 0;
+
+    StickCP2.Lcd.startWrite();
+    for (int row = rowBegin; row < rowEnd; row += BOOT_ANIM_BAND_ROWS) {
+        int rows = min(BOOT_ANIM_BAND_ROWS, rowEnd - row);
+        int panelY = bootAnimY + row * scale;
+        int panelRows = min(rows * scale, StickCP2.Lcd.height() - panelY);
+        if (panelRows <= 0) break;
+
+        // The other band may still be going out; this one finished before it started.
+        uint16_t* band = bootAnimBand[bandIndex];
+        for (int r = 0; r < rows; ++r) {
+            const uint16_t* src = bootAnimPixels + (size_t)(row + r) * width;
+            uint16_t* dst = band + (size_t)r * scale * bandWidth;
+            for (int x = 0; x < width; ++x) {
+                for (int s = 0; s < scale; ++s) {
+                    dst[x * scale + s] = src[x];
+                }
+            }
+            for (int s = 1; s < scale; ++s) {
+                memcpy(dst + s * bandWidth, dst, 2 * bandWidth);
+            }
+        }
+        StickCP2.Lcd.pushImageDMA(bootAnimX, panelY, bandWidth, panelRows, (const lgfx::swap565_t*)band);
+        bandIndex ^= 1;
+    }
+    StickCP2.Lcd.endWrite();
+}
+
+static bool drawNextBootAnimationFrame() {
+    PROFILE_SCOPE(PROFILE_DISPLAY_BOOT_ANIM);
+    if (!isBootAnimationOpen() || bootAnimFrame >= bootAnimHeader.frameCount) return false;
+
+    uint32_t length = bootAnimIndex[bootAnimFrame + 1] - bootAnimIndex[bootAnimFrame];
+    if (length > bootAnimHeader.maxFrameBytes ||
+        bootAnimFile.read(bootAnimOps, length) != length) {
+        return false;
+    }
+    int dirtyBegin, dirtyEnd;
+    if (!bootAnimDecodeFrame(bootAnimOps, length, bootAnimPixels, bootAnimHeader.width, bootAnimHeader.height,
+                             dirtyBegin, dirtyEnd)) {
+        return false;
+    }
+    pushBootAnimationRows(dirtyBegin, dirtyEnd);
+    bootAnimFrame++;
+    return true;
+}
+
+void closeBootAnimation() {
+    StickCP2.Lcd.waitDMA(); // The bands may still be going out
+    if (bootAnimFile) bootAnimFile.close();
+    free(bootAnimIndex);
+    free(bootAnimOps);
+    free(bootAnimPixels);
+    heap_caps_free(bootAnimBand[0]);
+    heap_caps_free(bootAnimBand[1]);
+    bootAnimIndex = NULL;
+    bootAnimOps = NULL;
+    bootAnimPixels = NULL;
+    bootAnimBand[0] = bootAnimBand[1] = NULL;
+}
+
+// Catches up to 'boot.frame': frames are deltas, so any the render task fell
+// behind on are still decoded. A read error just ends the animation early;
+// loop() moves on once it has published every frame.
+static void drawBootFrame(const UiBootFrameScreen& boot) {
+    if (boot.jpg) {
+        char jpgFilename[12];
+        snprintf(jpgFilename, sizeof(jpgFilename), "/%d.jpg", boot.frame);
+        File jpgFile = LittleFS.open(jpgFilename, FILE_READ);
+        if (!jpgFile) return;
+        StickCP2.Lcd.drawJpg(&jpgFile, 0, 0, StickCP2.Lcd.width(), StickCP2.Lcd.height(), 0, 0, 0.0f, 0.0f, datum_t::middle_center);
+        jpgFile.close();
+        return;
+    }
+    while (isBootAnimationOpen() && bootAnimFrame <= boot.frame) {
+        if (!drawNextBootAnimationFrame()) {
+            closeBootAnimation();
+        }
+    }
+}
+
+static void publishBootFrame(int frame, bool jpg) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_BOOT_FRAME;
+    snapshot.bootFrame.frame = frame;
+    snapshot.bootFrame.jpg = jpg;
+    publishUiSnapshot(snapshot, false);
+}
+
+// BOOT_JPG_SEQUENCE: publishes the packed animation's frames, or the JPG
+// frames without one, until it ends or BtnA skips it. The next screen
+// published closes the animation.
+void handleBootSequence() {
+    unsigned long currentTime = millis();
+    if (StickCP2.BtnA.wasClicked()) {
+        resetActivityTimer();
+        setState(MODE_SELECTION);
+        return;
+    }
+    if (bootAnimFrameCount > 0) {
+        unsigned long frameDelay = getBootAnimationFrameDelayMs();
+        if (currentTime - lastFrameTime >= frameDelay) {
+            resetActivityTimer();
+            // Keep to the frame rate rather than adding the draw time to every frame.
+            lastFrameTime = (lastFrameTime != 0 && currentTime - lastFrameTime < 2 * frameDelay) ? lastFrameTime + frameDelay : currentTime;
+            if (bootAnimFramesPublished < bootAnimFrameCount) {
+                publishBootFrame(bootAnimFramesPublished++, false);
+            } else {
+                setState(MODE_SELECTION);
+            }
+        }
+    } else if (currentTime - lastFrameTime >= BOOT_JPG_FRAME_DELAY_MS) { // No pack: JPG frames
+        resetActivityTimer();
+        char jpgFilename[12];
+        sprintf(jpgFilename, "/%d.jpg", currentJpgFrame);
+        if (LittleFS.exists(jpgFilename) && currentJpgFrame <= MAX_BOOT_JPG_FRAMES) {
+            publishBootFrame(currentJpgFrame, true);
+            currentJpgFrame++;
+            lastFrameTime = currentTime;
+        } else {
+            setState(MODE_SELECTION);
+        }
+    }
 }
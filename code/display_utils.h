@@ -3,20 +3,53 @@
 
 #include <M5StickCPlus2.h>
 #include "config.h" // For enums if needed by display logic, and constants
+#include "ui_render.h"
 
+// Drawn straight to the panel; only for setup(), before the render task draws.
 void displayBootScreen(const char* line1a, const char* line1b, const char* line2);
+
+// --- Screens ---
+// Called from loop(): each copies what its screen shows into a UiSnapshot and
+// publishes it (ui_render.h); none of them touch the panel.
 void displayMenu(const char* title, const char* items[], int count, int selection, int scrollOffset);
-void displayTimingScreen(float elapsedTime, int count, float lastSplit);
-void displayStoppedScreen();
-void displayEditScreen();
-void displayCalibrationScreen(const char* title, float peakValue, const char* unit);
+void displayEditScreen();      // Clears the screen when redrawMenu is set, else only the value
+void displayCalibrationScreen(const char* title, float peakValue, const char* unit); // Same
+void displayBtLatencyCalibrationScreen(int trial, int totalTrials, int lastLatencyMs, int resultMs, bool finished);
 void displayDeviceStatusScreen();
+// Device Status second page: the loop profiler sections that took the most time.
+void displayProfileScreen();
 void displayListFilesScreen();
 void displayDryFireReadyScreen();
 void displayDryFireRunningScreen(bool waiting, int beepNum, int totalBeeps);
-void drawLowBatteryIndicator();
+void displayBluetoothScanResults(); // Moved here from bluetooth_utils for logical grouping
+// One centred line on a cleared screen ("Ready...", "Powering Off...").
+void displayMessageScreen(const char* text, uint8_t textSize);
 String getUpButtonLabel();
 String getDownButtonLabel();
-void displayBluetoothScanResults(); // Moved here from bluetooth_utils for logical grouping
+
+// Render task only: draws a published snapshot. 'redraw' clears the screen
+// first; otherwise the timing, edit and calibration screens only redraw
+// what changed.
+void drawUiSnapshot(const UiSnapshot &snapshot, bool redraw);
+
+// CPU time spent per timing screen update on the render task, in microseconds.
+typedef struct {
+    uint32_t lastUs;
+    uint32_t avgUs; // Running average over ~16 updates
+    uint32_t maxUs;
+} DisplayFrameStats;
+DisplayFrameStats getTimingFrameStats();
+
+// --- Packed Boot Animation ---
+// Plays BOOT_ANIM_PATH. openBootAnimation() (from setup()) returns false if
+// the file is missing or invalid, or there is not enough RAM; the JPG frames
+// are used then. The render task draws the frames and closes it once another
+// screen is published.
+bool openBootAnimation();
+bool isBootAnimationOpen();
+void closeBootAnimation();
+// BOOT_JPG_SEQUENCE handler: publishes the animation's frames, or the /N.jpg
+// frames without it, until it ends or BtnA skips it.
+void handleBootSequence();
 
 #endif // DISPLAY_UTILS_H
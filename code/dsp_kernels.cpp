@@ -0,0 +1,114 @@
+#include "dsp_kernels.h"
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline int32_t absSat16(int32_t s) {
+    int32_t a = (s < 0) ? -s : s;
+    return (a > 32767) ? 32767 : a;
+}
+
+BlockStats dspBlockStatsScalar(const int16_t* x, size_t n) {
+    BlockStats stats = {0, 0};
+    for (size_t i = 0; i < n; ++i) {
+        int32_t s = x[i];
+        stats.sumSq += (uint64_t)(s * s);
+        int32_t a = absSat16(s);
+        if (a > stats.peak) stats.peak = a;
+    }
+    return stats;
+}
+
+#if defined(__SSE2__)
+
+BlockStats dspBlockStats(const int16_t* x, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();  // 2 x uint64
+    __m128i peak = _mm_setzero_si128(); // 8 x int16
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(x + i));
+        // Pairwise x0*x0 + x1*x1 fits in 32 bits unsigned; widen before accumulating.
+        __m128i sq = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+        __m128i mag = _mm_max_epi16(v, _mm_subs_epi16(zero, v));
+        peak = _mm_max_epi16(peak, mag);
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    int16_t peaks[8];
+    _mm_storeu_si128((__m128i*)peaks, peak);
+
+    BlockStats stats = {lanes[0] + lanes[1], 0};
+    for (int k = 0; k < 8; ++k) {
+        if (peaks[k] > stats.peak) stats.peak = peaks[k];
+    }
+    BlockStats tail = dspBlockStatsScalar(x + i, n - i);
+    stats.sumSq += tail.sumSq;
+    if (tail.peak > stats.peak) stats.peak = tail.peak;
+    return stats;
+}
+
+#else
+
+// Four independent accumulators keep the multiply-accumulates free of
+// loop-carried dependencies.
+BlockStats dspBlockStats(const int16_t* x, size_t n) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int32_t p0 = 0, p1 = 0, p2 = 0, p3 = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        int32_t a = x[i], b = x[i + 1], c = x[i + 2], d = x[i + 3];
+        s0 += (uint32_t)(a * a);
+        s1 += (uint32_t)(b * b);
+        s2 += (uint32_t)(c * c);
+        s3 += (uint32_t)(d * d);
+        a = absSat16(a); b = absSat16(b); c = absSat16(c); d = absSat16(d);
+        p0 = (a > p0) ? a : p0;
+        p1 = (b > p1) ? b : p1;
+        p2 = (c > p2) ? c : p2;
+        p3 = (d > p3) ? d : p3;
+    }
+
+    BlockStats stats = {s0 + s1 + s2 + s3, p0};
+    if (p1 > stats.peak) stats.peak = p1;
+    if (p2 > stats.peak) stats.peak = p2;
+    if (p3 > stats.peak) stats.peak = p3;
+    BlockStats tail = dspBlockStatsScalar(x + i, n - i);
+    stats.sumSq += tail.sumSq;
+    if (tail.peak > stats.peak) stats.peak = tail.peak;
+    return stats;
+}
+
+#endif
+
+float dspStatsRms(const BlockStats& stats, size_t n) {
+    if (n == 0) return 0.0f;
+    return sqrtf((float)stats.sumSq / (float)n);
+}
+
+// The recursion is inherently serial, so this stays scalar; it is integer-only
+// with one 32x32->64 multiply per sample.
+void dspPowerEnvelope(const int16_t* x, size_t n, int32_t attackQ31, int32_t releaseQ31, uint32_t* state, uint32_t* env) {
+    int32_t power = (int32_t)*state;
+    for (size_t i = 0; i < n; ++i) {
+        int32_t s = x[i];
+        int32_t diff = s * s - power;
+        int32_t coef = (diff > 0) ? attackQ31 : releaseQ31;
+        power += (int32_t)(((int64_t)diff * coef + (1LL << 30)) >> 31);
+        env[i] = (uint32_t)power;
+    }
+    *state = (uint32_t)power;
+}
+
+int32_t dspTimeConstantToQ31(float ms, uint32_t sampleRateHz) {
+    if (ms <= 0.0f || sampleRateHz == 0) return INT32_MAX;
+    double coef = 1.0 - exp(-1000.0 / ((double)ms * (double)sampleRateHz));
+    return (int32_t)(coef * 2147483647.0);
+}
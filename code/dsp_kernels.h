@@ -0,0 +1,34 @@
+#ifndef DSP_KERNELS_H
+#define DSP_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-point block kernels for the mic path. Samples are Q15, squared
+// samples / envelope power are plain integer LSB^2 (<= 2^30), coefficients Q31.
+// The scalar loops are unrolled with independent accumulators so the ESP32's
+// compiler can keep its MAC pipeline busy; on x86 SSE2 versions are used.
+
+typedef struct {
+    uint64_t sumSq; // Sum of squared samples
+    int32_t peak;   // Largest |sample|, saturated to 32767
+} BlockStats;
+
+// Sum of squares and peak magnitude of one block.
+BlockStats dspBlockStats(const int16_t* x, size_t n);
+
+// Plain scalar reference (used by the host benchmark to compare against).
+BlockStats dspBlockStatsScalar(const int16_t* x, size_t n);
+
+// Windowed RMS from block statistics.
+float dspStatsRms(const BlockStats& stats, size_t n);
+
+// One-pole power envelope follower with separate attack / release.
+// 'state' carries the envelope between calls; env[i] receives the envelope
+// after sample i. Coefficients are Q31 (see dspTimeConstantToQ31).
+void dspPowerEnvelope(const int16_t* x, size_t n, int32_t attackQ31, int32_t releaseQ31, uint32_t* state, uint32_t* env);
+
+// 1 - exp(-1 / (ms * fs)) as a Q31 coefficient.
+int32_t dspTimeConstantToQ31(float ms, uint32_t sampleRateHz);
+
+#endif // DSP_KERNELS_H
@@ -0,0 +1,115 @@
+#include "feature_ring.h"
+#include <math.h>
+
+void FeatureRing::attach(FeatureFrame* storage, uint32_t capacity, uint32_t hopUs) {
+    frames_ = storage;
+    capacity_ = (storage != nullptr) ? capacity : 0;
+    hopUs_ = (hopUs > 0) ? hopUs : 1;
+    reset();
+}
+
+void FeatureRing::reset() {
+    count_.store(0, std::memory_order_release);
+}
+
+void FeatureRing::push(const FeatureFrame& frame, int64_t frameTimeUs) {
+    if (!isAttached()) return;
+    uint32_t count = count_.load(std::memory_order_relaxed);
+    if (count == 0) firstFrameUs_ = frameTimeUs;
+    frames_[count % capacity_] = frame;
+    count_.store(count + 1, std::memory_order_release);
+}
+
+uint32_t FeatureRing::size() const {
+    uint32_t count = count_.load(std::memory_order_acquire);
+    return (count < capacity_) ? count : capacity_;
+}
+
+int64_t FeatureRing::oldestTimeUs() const {
+    uint32_t count = count_.load(std::memory_order_acquire);
+    uint32_t skipped = (count > capacity_) ? count - capacity_ : 0;
+    return firstFrameUs_ + (int64_t)skipped * hopUs_;
+}
+
+uint16_t FeatureRing::powerToDbQ8(uint32_t power) {
+    return (uint16_t)(10.0f * log10f((float)power + 1.0f) * 256.0f);
+}
+
+uint8_t FeatureRing::amplitudeToHalfDb(float amplitude) {
+    float halfDb = 40.0f * log10f(amplitude + 1.0f);
+    return (uint8_t)((halfDb > 255.0f) ? 255.0f : halfDb);
+}
+
+// Same rules as OnsetDetector::process, evaluated once per frame in the dB
+// domain with integer Q8 arithmetic. The frame's envelope maximum stands for
+// the samples that can cross the onset level, its minimum for the ones that
+// can re-arm the trigger or set the valley under it.
+size_t FeatureRing::rescore(const OnsetDetectorConfig& config, int64_t fromUs, int64_t* onsetUs, size_t maxOnsets) const {
+    uint32_t count = count_.load(std::memory_order_acquire);
+    if (!isAttached() || count == 0) return 0;
+    uint32_t first = (count > capacity_) ? count - capacity_ : 0;
+
+    const int32_t marginQ8 = (int32_t)(config.thresholdDb * 256.0f);
+    const int32_t hysteresisQ8 = (int32_t)(config.hysteresisDb * 256.0f);
+    const int32_t minQ8 = (config.minRms > 0.0f) ? (int32_t)(20.0f * log10f(config.minRms) * 256.0f) : 0;
+    float fraction = (config.rearmFraction > 0.0f && config.rearmFraction < 1.0f) ? config.rearmFraction : 0.0f;
+    const int32_t rearmDropQ8 = (fraction > 0.0f) ? (int32_t)(-20.0f * log10f(fraction) * 256.0f) : INT32_MAX;
+    const uint32_t lockoutFrames = (uint32_t)((uint64_t)config.lockoutMs * 1000 / hopUs_);
+    float echoRatio = (config.echoPeakRatio > 0.0f && config.echoPeakRatio < 1.0f) ? config.echoPeakRatio : 0.0f;
+    const int32_t echoDropQ8 = (echoRatio > 0.0f) ? (int32_t)(-20.0f * log10f(echoRatio) * 256.0f) : INT32_MAX;
+    const uint32_t echoFrames = (uint32_t)((uint64_t)config.echoWindowMs * 1000 / hopUs_);
+
+    bool active = false;
+    bool pending = false; // Onset in the echo window, not yet at the shot level
+    int32_t shotPeak = 0;
+    int32_t valley = 0;
+    uint32_t lockout = 0;
+    uint32_t echo = 0;
+    size_t found = 0;
+
+    for (uint32_t n = first; n < count && found < maxOnsets; ++n) {
+        const FeatureFrame& f = frames_[n % capacity_];
+        int32_t envMax = f.envMaxDbQ8;
+        int32_t envMin = f.envMinDbQ8;
+        int32_t onQ8 = (int32_t)f.floorDbQ8 + marginQ8;
+        if (lockout > 0) --lockout;
+        if (echo > 0) --echo;
+
+        if (!active) {
+            if (envMin < valley) valley = envMin;
+            bool crossed = envMax > onQ8 && envMax >= minQ8 && envMax > valley + hysteresisQ8;
+            if (pending || crossed) {
+                bool gated = echo > 0 || pending;
+                if (!gated || envMax >= shotPeak - echoDropQ8) {
+                    active = true;
+                    pending = false;
+                    lockout = lockoutFrames;
+                    echo = echoFrames;
+                    shotPeak = envMax;
+                    int64_t timeUs = firstFrameUs_ + (int64_t)n * hopUs_;
+                    if (timeUs >= fromUs) onsetUs[found++] = timeUs;
+                } else if (!pending) {
+                    // The detector's confirm time is one hop: the next frame
+                    // decides.
+                    pending = true;
+                } else {
+                    // Never got as loud as a shot: an echo, ridden out like
+                    // the tail.
+                    pending = false;
+                    active = true;
+                }
+            }
+        } else {
+            // The minimum is checked against the peak before this frame: it
+            // may come before the frame's maximum, the start of the next shot.
+            bool decayed = envMin < shotPeak - rearmDropQ8;
+            if (lockout == 0 && (envMin < onQ8 - hysteresisQ8 || decayed)) {
+                active = false;
+                valley = envMin;
+            } else if (envMax > shotPeak) {
+                shotPeak = envMax;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,58 @@
+#ifndef FEATURE_RING_H
+#define FEATURE_RING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "onset_detector.h"
+
+// Decimated detection features for one string, so it can be re-scored with a
+// different threshold after it has ended. One frame per hop (2 ms at 16 kHz)
+// holds the envelope maximum and minimum, the noise floor and the sample peak,
+// all in dB, in 8 bytes: a 30 s string is 120 KB and a full re-score is a
+// single linear pass over it.
+// Single writer (capture task) / single reader (main loop, after the string
+// has stopped).
+
+typedef struct {
+    uint16_t envMaxDbQ8; // Envelope maximum over the hop, dB re 1 LSB^2 power, Q8
+    uint16_t envMinDbQ8; // Envelope minimum over the hop, same scale
+    uint16_t floorDbQ8;  // Noise floor at the end of the hop, same scale
+    uint8_t peakHalfDb;  // Largest |sample| over the hop, 0.5 dB steps
+} FeatureFrame;
+
+class FeatureRing {
+public:
+    // Storage is owned by the caller; 'capacity' frames of 'hopUs' each.
+    void attach(FeatureFrame* storage, uint32_t capacity, uint32_t hopUs);
+    bool isAttached() const { return frames_ != nullptr && capacity_ > 0; }
+
+    // Writer side.
+    void reset();
+    void push(const FeatureFrame& frame, int64_t frameTimeUs);
+
+    // Reader side. Frames older than 'capacity' are overwritten; the covered
+    // range starts at oldestTimeUs().
+    uint32_t size() const;
+    int64_t oldestTimeUs() const;
+
+    // Replays the stored frames through the onset rules of 'config' (dB
+    // threshold, hysteresis, minimum RMS, lockout, re-arm fraction, echo gate)
+    // and writes the onset times at or after 'fromUs', each within one hop of
+    // where the live detector put it at the margin the string was shot with.
+    // Returns the number of onsets written.
+    size_t rescore(const OnsetDetectorConfig& config, int64_t fromUs, int64_t* onsetUs, size_t maxOnsets) const;
+
+    // Helpers shared with the writer.
+    static uint16_t powerToDbQ8(uint32_t power);
+    static uint8_t amplitudeToHalfDb(float amplitude);
+
+private:
+    FeatureFrame* frames_ = nullptr;
+    uint32_t capacity_ = 0;
+    uint32_t hopUs_ = 2000;
+    int64_t firstFrameUs_ = 0;
+    std::atomic<uint32_t> count_{0};
+};
+
+#endif // FEATURE_RING_H
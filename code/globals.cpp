@@ -0,0 +1,105 @@
+#include "globals.h"
+#include "config.h"
+
+// --- Global Variable Definitions ---
+// Kept out of code.ino so the host simulation (host/sim) links the same ones.
+TimerState currentState = BOOT_SCREEN;
+TimerState previousState = BOOT_SCREEN;
+TimerState stateBeforeEdit = SETTINGS_MENU_MAIN;
+TimerState stateBeforeScan = SETTINGS_MENU_BLUETOOTH;
+OperatingMode currentMode = MODE_LIVE_FIRE;
+unsigned long startTime = 0;
+unsigned long lastDisplayUpdateTime = 0;
+unsigned long lastActivityTime = 0;
+
+int currentMaxShots = 10;
+unsigned long currentBeepDuration = 150;
+int currentBeepToneHz = 2000;
+unsigned long startRandomDelayMs = 0;
+int shotThresholdRms = 0;
+int shotMarginDb = SHOT_MARGIN_DB_DEFAULT;
+unsigned long shotLockoutMs = SHOT_MIN_LOCKOUT_MS;
+int rescoreMarginDb = 0;
+int dryFireParBeepCount = 3;
+float dryFireParTimesSec[MAX_PAR_BEEPS];
+float recoilThreshold = 1.5f;
+int screenRotationSetting = 3;
+bool playBootAnimation = true;
+bool enableAutoSleep = true;
+
+BluetoothA2DPSource a2dp_source;
+String currentBluetoothDeviceName = "LEXON MINO L";
+bool currentBluetoothAutoReconnect = false;
+int currentBluetoothVolume = 80;
+int currentBluetoothAudioOffsetMs = 0; 
+bool bluetoothJustConnected = false;
+bool bluetoothJustDisconnected = false;
+
+// --- Timer State Variables ---
+volatile bool is_listening_active = false;      // Definition
+volatile unsigned long beep_audio_end_time = 0; // Definition
+
+
+ESP32BluetoothScanner btScanner;
+std::vector<BTDevice> discoveredBtDevices;
+int scanMenuSelection = 0;
+int scanMenuScrollOffset = 0;
+bool scanInProgress = false;
+unsigned long scanStartTime = 0;
+
+int shotCount = 0;
+unsigned long shotTimestamps[MAX_SHOTS_LIMIT];
+float splitTimes[MAX_SHOTS_LIMIT];
+unsigned long lastShotTimestamp = 0;
+unsigned long lastDetectionTime = 0;
+
+int currentMenuSelection = 0;
+int menuScrollOffset = 0;
+int settingsMenuLevel = 0;
+unsigned long btnTopPressTime = 0;
+bool btnTopHeld = false;
+bool redrawMenu = true;
+
+EditableSetting settingBeingEdited = EDIT_NONE;
+int editingIntValue = 0;
+unsigned long editingULongValue = 0;
+float editingFloatValue = 0.0f;
+bool editingBoolValue = false;
+const char* editingSettingName = "";
+
+String fileListNames[MAX_FILES_LIST];
+size_t fileListSizes[MAX_FILES_LIST];
+int fileListCount = 0;
+int fileListScrollOffset = 0;
+
+float currentCyclePeakRMS = 0.0f;
+float peakRMSOverall = 0.0f;
+
+Preferences preferences;
+float peakBatteryVoltage = 4.2f;
+float currentBatteryVoltage = 0.0f;
+bool lowBatteryWarning = false;
+unsigned long lastBatteryCheckTime = 0;
+
+M5MicPeakRMS micPeakRMS;
+
+int currentJpgFrame = 1;
+bool filesystem_ok_for_boot = false;
+unsigned long lastFrameTime = 0;
+
+unsigned long beepSequenceStartTime = 0;
+int beepsPlayed = 0;
+unsigned long lastBeepTime = 0;
+
+unsigned long lastSoundPeakTime = 0;
+bool checkingForRecoil = false;
+int64_t recoilOnsetUs = 0;
+float peakRecoilValue = 0.0f;
+// AVRC metadata is defined in bluetooth_utils.cpp
+
+// --- FreeRTOS Handles ---
+QueueHandle_t buzzerQueue = NULL; 
+TaskHandle_t buzzerTaskHandle = NULL; 
+TaskHandle_t micCaptureTaskHandle = NULL;
+TaskHandle_t imuTaskHandle = NULL;
+TaskHandle_t uiRenderTaskHandle = NULL;
@@ -26,7 +26,11 @@ extern unsigned long lastActivityTime;
 extern int currentMaxShots;
 extern unsigned long currentBeepDuration;
 extern int currentBeepToneHz;
-extern int shotThresholdRms;
+extern unsigned long startRandomDelayMs; // Live Fire / Noisy Range: random wait before the beep, up to this (0 = off)
+extern int shotThresholdRms;   // Optional absolute minimum (0 = off)
+extern int shotMarginDb;       // Onset level above the adaptive noise floor
+extern unsigned long shotLockoutMs; // Shortest split the detector accepts; set by tuning import only
+extern int rescoreMarginDb;    // Margin the stopped string was last scored with (0 = re-scoring unavailable)
 extern int dryFireParBeepCount;
 extern float dryFireParTimesSec[MAX_PAR_BEEPS];
 extern float recoilThreshold;
@@ -43,14 +47,6 @@ extern int currentBluetoothAudioOffsetMs;
 extern bool bluetoothJustConnected;
 extern bool bluetoothJustDisconnected;
 
-// Volatile variables for A2DP audio callback, managed by audio_utils and bluetooth_utils
-extern volatile int btBeepFrequency;
-extern volatile unsigned long btBeepScheduledStartTime; 
-extern volatile unsigned int btBeepDurationVolatile;   
-extern volatile bool new_bt_beep_request;              
-extern volatile bool current_bt_beep_is_active;        
-extern volatile unsigned long current_bt_beep_actual_end_time; 
-
 // --- Timer State Variables ---
 extern volatile bool is_listening_active;      // Flag to enable/disable mic reading after start beep
 extern volatile unsigned long beep_audio_end_time; // Calculated time when start beep audio should be finished
@@ -113,16 +109,14 @@ extern bool filesystem_ok_for_boot;
 extern unsigned long lastFrameTime;
 
 // Dry Fire Par Variables
-extern unsigned long randomDelayStartMs;
-extern unsigned long parTimerStartTime;
 extern unsigned long beepSequenceStartTime;
 extern int beepsPlayed;
-extern unsigned long nextBeepTime;
 extern unsigned long lastBeepTime;
 
 // Noisy Range Variables
 extern unsigned long lastSoundPeakTime;
 extern bool checkingForRecoil;
+extern int64_t recoilOnsetUs; // Sound onset being checked for recoil (esp_timer us)
 extern float peakRecoilValue;
 
 // AVRC Metadata
@@ -131,6 +125,9 @@ extern const char *avrc_metadata[];
 // --- FreeRTOS Handles ---
 extern QueueHandle_t buzzerQueue; 
 extern TaskHandle_t buzzerTaskHandle; 
+extern TaskHandle_t micCaptureTaskHandle;
+extern TaskHandle_t imuTaskHandle;
+extern TaskHandle_t uiRenderTaskHandle;
 
 
 #endif // GLOBALS_H
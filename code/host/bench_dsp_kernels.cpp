@@ -0,0 +1,102 @@
+// Host micro-benchmark for the mic DSP kernels.
+// Build and run with `make bench`; reports ns/sample per block size and the
+// time to re-score a full feature history.
+
+#include "../dsp_kernels.h"
+#include "../shot_config.h"
+#include "../shot_detector.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static volatile uint64_t sink;
+static const size_t MAX_RESCORED_SHOTS = 20;
+
+template <typename Fn>
+static double nsPerSample(size_t blockSamples, size_t totalSamples, Fn fn) {
+    // Warm up once, then time enough blocks for a stable figure.
+    fn();
+    size_t blocks = totalSamples / blockSamples;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < blocks; ++b) {
+        fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / (double)(blocks * blockSamples);
+}
+
+int main() {
+    const size_t kTotalSamples = 16 * 1000 * 1000;
+    const size_t kBlockSizes[] = {64, 128, 256, 512, 1024};
+
+    std::vector<int16_t> pcm(1024);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    for (auto& s : pcm) s = (int16_t)dist(rng);
+
+    // Sanity check: SIMD / unrolled path must match the reference exactly.
+    for (size_t n : kBlockSizes) {
+        for (size_t tail = 0; tail < 8; ++tail) {
+            BlockStats a = dspBlockStats(pcm.data(), n - tail);
+            BlockStats b = dspBlockStatsScalar(pcm.data(), n - tail);
+            if (a.sumSq != b.sumSq || a.peak != b.peak) {
+                printf("MISMATCH at n=%zu\n", n - tail);
+                return 1;
+            }
+        }
+    }
+
+    OnsetDetectorConfig config = shotOnsetConfig(SHOT_MARGIN_DB_DEFAULT, 0, SHOT_MIN_LOCKOUT_MS);
+    int32_t attackQ31 = dspTimeConstantToQ31(config.attackMs, config.sampleRateHz);
+    int32_t releaseQ31 = dspTimeConstantToQ31(config.releaseMs, config.sampleRateHz);
+    std::vector<uint32_t> env(1024);
+
+    printf("%-6s %12s %12s %12s %12s\n", "block", "stats", "scalar", "envelope", "detector");
+    for (size_t n : kBlockSizes) {
+        double stats = nsPerSample(n, kTotalSamples, [&] {
+            sink += dspBlockStats(pcm.data(), n).sumSq;
+        });
+        double scalar = nsPerSample(n, kTotalSamples, [&] {
+            sink += dspBlockStatsScalar(pcm.data(), n).sumSq;
+        });
+        uint32_t state = 0;
+        double envelope = nsPerSample(n, kTotalSamples, [&] {
+            dspPowerEnvelope(pcm.data(), n, attackQ31, releaseQ31, &state, env.data());
+            sink += env[n - 1];
+        });
+        ShotDetector detector;
+        detector.configure(config);
+        ShotEvent events[4];
+        double full = nsPerSample(n, kTotalSamples, [&] {
+            sink += detector.process(pcm.data(), n, events, 4);
+        });
+        printf("%-6zu %9.3f ns %9.3f ns %9.3f ns %9.3f ns\n", n, stats, scalar, envelope, full);
+    }
+
+    // Re-scoring cost over a full 30 s history (worst case on the stopped screen).
+    const uint32_t kHistoryFrames = 15000;
+    std::vector<FeatureFrame> storage(kHistoryFrames);
+    FeatureRing ring;
+    ring.attach(storage.data(), kHistoryFrames, 2000);
+    ShotDetector recorder;
+    recorder.configure(config);
+    recorder.setFeatureRing(&ring);
+    ShotEvent events[4];
+    for (uint32_t f = 0; f < kHistoryFrames * ShotDetector::kFeatureHopSamples / pcm.size(); ++f) {
+        recorder.process(pcm.data(), pcm.size(), events, 4);
+    }
+    int64_t onsets[MAX_RESCORED_SHOTS];
+    const int kRescoreRuns = 200;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRescoreRuns; ++r) {
+        config.thresholdDb = 10.0f + (float)(r % 30);
+        sink += ring.rescore(config, 0, onsets, MAX_RESCORED_SHOTS);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / kRescoreRuns;
+    printf("rescore %u frames: %.1f us\n", (unsigned)ring.size(), us);
+    return 0;
+}
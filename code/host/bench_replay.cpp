@@ -0,0 +1,213 @@
+// Replay benchmark for detection accuracy and latency.
+// Plays labelled recordings (host/shot_corpus.h) into the host simulation,
+// so shots go through the capture task's processMicBlock() and are counted by
+// handleLiveFireTiming() (or handleNoisyRangeTiming() with the recoil check,
+// for recordings with an accelerometer trace), with the recording's start
+// beep lined up with the simulated one. Reports, per recording and overall,
+// misses, false positives, the shot time error distribution (the firmware
+// stamps shots in whole ms) and the detector's CPU time per second of audio.
+//   bench_replay generate <dir> [per-kind]   Writes the synthetic corpus
+//   bench_replay <dir or .wav>...            Replays recordings
+// `make replay` (in code/) does both with the synthetic corpus.
+
+#include "shot_corpus.h"
+#include "sim_hal.h"
+#include "globals.h"
+#include "config.h"
+#include "system_utils.h"
+#include "nvs_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const int64_t kMatchWindowUs = 20000; // A detection this close to a true shot is a hit
+static const int64_t kSettleUs = 300000;
+
+struct ReplayScore : ShotMatch {
+    double audioSec = 0.0;
+    int64_t detectorNs = 0;
+
+    void add(const ReplayScore& other) {
+        shots += other.shots;
+        misses += other.misses;
+        falsePositives += other.falsePositives;
+        errorsUs.insert(errorsUs.end(), other.errorsUs.begin(), other.errorsUs.end());
+        audioSec += other.audioSec;
+        detectorNs += other.detectorNs;
+    }
+};
+
+static void runFor(int64_t us) {
+    int64_t endUs = simNowUs() + us;
+    while (simNowUs() < endUs) {
+        simLoopPass(endUs);
+    }
+}
+
+// Nearest-rank quantile of |error|, in ms.
+static double absErrorQuantileMs(std::vector<int64_t> errorsUs, double fraction) {
+    if (errorsUs.empty()) return 0.0;
+    for (int64_t& e : errorsUs) e = std::abs(e);
+    std::sort(errorsUs.begin(), errorsUs.end());
+    size_t rank = (size_t)ceil(fraction * errorsUs.size());
+    return errorsUs[std::min(errorsUs.size() - 1, rank > 0 ? rank - 1 : 0)] / 1000.0;
+}
+
+static ReplayScore replay(const ShotRecording& rec) {
+    const bool noisy = rec.accelRateHz > 0;
+    const TimerState readyState = noisy ? NOISY_RANGE_READY : LIVE_FIRE_READY;
+    const TimerState timingState = noisy ? NOISY_RANGE_TIMING : LIVE_FIRE_TIMING;
+    const int64_t beepSample = (int64_t)(rec.beepSec * rec.sampleRateHz);
+
+    // Until the simulated start beep goes out, the pre-roll loops; from then
+    // on the recording plays with its beep on the simulated one.
+    size_t beepsBefore = simBeeps().size();
+    bool aligned = false;
+    int64_t beepUs = 0;
+    auto findBeep = [&]() {
+        if (aligned) return true;
+        const std::vector<SimBeep>& beeps = simBeeps();
+        for (size_t i = beepsBefore; i < beeps.size(); ++i) {
+            if (beeps[i].frequencyHz == currentBeepToneHz) {
+                beepUs = beeps[i].startUs;
+                aligned = true;
+                break;
+            }
+        }
+        return aligned;
+    };
+    simSetMicSource([&](uint64_t firstSample, int16_t* out, size_t count) {
+        findBeep();
+        int64_t offset = aligned ? beepSample - (int64_t)((uint64_t)beepUs * MIC_SAMPLE_RATE_HZ / 1000000) : 0;
+        for (size_t i = 0; i < count; ++i) {
+            int64_t n = (int64_t)(firstSample + i) + offset;
+            if (!aligned || n < 0 || n >= (int64_t)rec.pcm.size()) {
+                n = (int64_t)(firstSample + i) % std::max(beepSample, (int64_t)1);
+            }
+            out[i] = rec.pcm[n];
+        }
+    });
+    simSetImuSource([&](int64_t timeUs) {
+        if (!noisy || !findBeep()) return 1.0f;
+        double recSec = rec.beepSec + (timeUs - beepUs) / 1e6;
+        int64_t i = (int64_t)lround(recSec * rec.accelRateHz);
+        return (i >= 0 && i < (int64_t)rec.accelZ.size()) ? rec.accelZ[i] : 1.0f;
+    });
+
+    ReplayScore score;
+    setState(readyState);
+    redrawMenu = true;
+    runFor(kSettleUs);
+
+    int64_t detectorNsBefore = simMicProcessNs();
+    int64_t clickUs = simNowUs();
+    simClick(SIM_BTN_A);
+    bool started = simRunUntil(timingState, 5000000);
+    int64_t beepWaitEndUs = simNowUs() + 1000000;
+    while (started && !findBeep() && simNowUs() < beepWaitEndUs) {
+        simLoopPass(beepWaitEndUs); // The buzzer task plays it once loop() waits
+    }
+    if (!started || !findBeep()) {
+        printf("%s: the string never started (state %s, beep %d)\n", rec.name.c_str(), stateName(currentState), (int)aligned);
+        score.misses = score.shots = (int)rec.shotSec.size();
+        return score;
+    }
+    int64_t endUs = beepUs + (int64_t)((rec.durationSec() - rec.beepSec) * 1e6);
+    while (currentState == timingState && simNowUs() < endUs) {
+        simLoopPass(endUs);
+    }
+    if (currentState == timingState) {
+        simClick(SIM_BTN_A); // Manual stop at the end of the recording
+        simRunUntil(LIVE_FIRE_STOPPED, 1000000);
+    }
+    score.detectorNs = simMicProcessNs() - detectorNsBefore;
+    score.audioSec = (simNowUs() - clickUs) / 1e6;
+
+    std::vector<int64_t> truthUs, detectedUs;
+    for (double t : rec.shotSec) {
+        truthUs.push_back(beepUs + (int64_t)llround((t - rec.beepSec) * 1e6));
+    }
+    for (int i = 0; i < shotCount; ++i) {
+        detectedUs.push_back((int64_t)shotTimestamps[i] * 1000);
+    }
+    matchShots(truthUs, detectedUs, kMatchWindowUs, score);
+    runFor(kSettleUs); // Cue
+    simSetMicSource(nullptr);
+    simSetImuSource(nullptr);
+    return score;
+}
+
+static void printScore(const char* name, const char* mode, const ReplayScore& s) {
+    printf("%-14s %-6s %5d %6d %5d %8.2f %8.2f %10.1f\n", name, mode, s.shots, s.misses, s.falsePositives,
+           absErrorQuantileMs(s.errorsUs, 0.5), absErrorQuantileMs(s.errorsUs, 0.99),
+           s.audioSec > 0 ? s.detectorNs / 1000.0 / s.audioSec : 0.0);
+}
+
+static int generate(const std::string& dir, int perKind) {
+    std::filesystem::create_directories(dir);
+    std::vector<ShotRecording> corpus = generateSyntheticCorpus(perKind, 1);
+    for (const ShotRecording& rec : corpus) {
+        if (!saveRecording(dir + "/" + rec.name + ".wav", rec)) {
+            printf("could not write %s/%s\n", dir.c_str(), rec.name.c_str());
+            return 1;
+        }
+    }
+    printf("wrote %d recordings to %s\n", (int)corpus.size(), dir.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::string(argv[1]) == "generate") {
+        return generate(argv[2], argc >= 4 ? atoi(argv[3]) : 3);
+    }
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i) {
+        if (std::filesystem::is_directory(argv[i])) {
+            std::vector<std::string> found = listRecordings(argv[i]);
+            paths.insert(paths.end(), found.begin(), found.end());
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        printf("usage: %s generate <dir> [per-kind] | %s <dir or .wav>...\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    // The settings setup() loads on a fresh device (the simulated NVS is
+    // empty), so the replay scores the shipped defaults; only the shot limit
+    // is raised to cover every string.
+    loadSettings();
+    currentMaxShots = MAX_SHOTS_LIMIT;
+
+    printf("%-14s %-6s %5s %6s %5s %8s %8s %10s\n", "recording", "mode", "shots", "misses", "false",
+           "p50 ms", "p99 ms", "cpu us/s");
+    ReplayScore total;
+    auto wallStart = std::chrono::steady_clock::now();
+    for (const std::string& path : paths) {
+        ShotRecording rec;
+        std::string error;
+        if (!loadRecording(path, rec, error)) {
+            printf("%s: %s\n", path.c_str(), error.c_str());
+            return 1;
+        }
+        if (rec.sampleRateHz != MIC_SAMPLE_RATE_HZ) {
+            printf("%s: recorded at %u Hz, the mic runs at %u Hz\n", path.c_str(), rec.sampleRateHz, MIC_SAMPLE_RATE_HZ);
+            return 1;
+        }
+        ReplayScore score = replay(rec);
+        printScore(rec.name.c_str(), rec.accelRateHz ? "noisy" : "live", score);
+        total.add(score);
+    }
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printScore("total", "", total);
+    printf("%.1f s of audio replayed in %.2f s wall; the detector used %.3f%% of one host core\n",
+           total.audioSec, wallSec, total.audioSec > 0 ? total.detectorNs / 1e7 / total.audioSec : 0.0);
+    return 0;
+}
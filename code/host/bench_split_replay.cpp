@@ -0,0 +1,204 @@
+// Replay benchmark for fast doubles.
+// Synthesizes gunshot trains at decreasing split times, runs them through the
+// shot detector and reports the smallest split that is still detected reliably
+// (every shot found within the timing tolerance and no extra detections) for
+// the old fixed refractory window, the envelope re-arm alone and the re-arm
+// with the echo gate, all built by shotOnsetConfig() from config.h. The
+// "echo" scenarios add discrete wall / berm echoes 20-80 ms behind every shot,
+// which the re-arm alone counts as shots; a second table counts the missed
+// and extra detections at a comfortable split.
+// Build and run with `make bench`.
+
+#include "../shot_config.h"
+#include "../shot_detector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const uint32_t kSampleRate = 16000;
+static const int kShotsPerTrain = 6;
+static const int kTrialsPerSplit = 20;
+static const double kToleranceMs = 2.0;
+static const double kErrorSplitMs = 250.0;
+static const int kErrorTrains = 100;
+
+struct Scenario {
+    const char* name;
+    float noiseRms;     // Background noise
+    float blastTauMs;   // Decay of the muzzle blast
+    float reverbTauMs;  // Decay of the range / room tail
+    float reverbLevel;  // Tail amplitude relative to the blast
+    int echoes;         // Discrete echoes 20-80 ms behind each shot, at 0.2-0.45 of it
+};
+
+static const Scenario kScenarios[] = {
+    {"outdoor",       150.0f,  6.0f,  25.0f, 0.05f, 0},
+    {"covered",       400.0f,  8.0f,  60.0f, 0.15f, 0},
+    {"indoor",        800.0f, 10.0f, 120.0f, 0.25f, 0},
+    {"berm echo",     150.0f,  6.0f,  25.0f, 0.05f, 2},
+    {"indoor echo",   800.0f, 10.0f, 120.0f, 0.25f, 3},
+};
+
+// Adds one blast (or echo of one) with the scenario's tail at sample 'onset'.
+static void addBlast(const Scenario& sc, std::vector<float>& mix, uint64_t onset, float amp, std::mt19937& rng) {
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    float blastTau = sc.blastTauMs * kSampleRate / 1000.0f;
+    float reverbTau = sc.reverbTauMs * kSampleRate / 1000.0f;
+    for (size_t n = 0; onset + n < mix.size(); ++n) {
+        float env = expf(-(float)n / blastTau) + sc.reverbLevel * expf(-(float)n / reverbTau);
+        if (env < 1e-4f) break;
+        mix[onset + n] += amp * env * gauss(rng);
+    }
+}
+
+// Builds one train; shot onset sample indices are returned in 'truth'.
+static std::vector<int16_t> makeTrain(const Scenario& sc, double splitMs, std::mt19937& rng, std::vector<uint64_t>& truth) {
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::uniform_real_distribution<float> level(0.5f, 1.0f);
+    std::uniform_real_distribution<double> jitter(-0.1, 0.1);
+    std::uniform_real_distribution<float> echoDelayMs(20.0f, 80.0f);
+    std::uniform_real_distribution<float> echoGain(0.2f, 0.45f);
+
+    // 3 s of background first: the floor starts at ONSET_INITIAL_FLOOR_RMS and
+    // needs that long to climb to the indoor noise, as it has on the device by
+    // the time the start beep sounds.
+    uint64_t first = 3 * kSampleRate;
+    size_t total = (size_t)(first + (kShotsPerTrain * splitMs / 1000.0 + 1.0) * kSampleRate);
+    std::vector<float> mix(total);
+    for (auto& s : mix) s = gauss(rng) * sc.noiseRms;
+
+    truth.clear();
+    double t = (double)first;
+    for (int k = 0; k < kShotsPerTrain; ++k) {
+        uint64_t onset = (uint64_t)t;
+        truth.push_back(onset);
+        float amp = 30000.0f * level(rng);
+        addBlast(sc, mix, onset, amp, rng);
+        for (int e = 0; e < sc.echoes; ++e) {
+            addBlast(sc, mix, onset + (uint64_t)(echoDelayMs(rng) * kSampleRate / 1000.0f), amp * echoGain(rng), rng);
+        }
+        t += splitMs * (1.0 + jitter(rng)) * kSampleRate / 1000.0;
+    }
+
+    std::vector<int16_t> pcm(total);
+    for (size_t n = 0; n < total; ++n) {
+        pcm[n] = (int16_t)std::max(-32768.0f, std::min(32767.0f, mix[n]));
+    }
+    return pcm;
+}
+
+// Onsets the detector finds in 'pcm', from the first shot on.
+static std::vector<uint64_t> detect(const OnsetDetectorConfig& config, const std::vector<int16_t>& pcm, const std::vector<uint64_t>& truth) {
+    ShotDetector detector;
+    detector.configure(config);
+    ShotEvent events[4];
+    std::vector<uint64_t> found;
+    const size_t block = 256;
+    for (size_t o = 0; o + block <= pcm.size(); o += block) {
+        size_t n = detector.process(&pcm[o], block, events, 4);
+        for (size_t i = 0; i < n; ++i) found.push_back(events[i].sampleIndex);
+    }
+    // Ignore anything before the first shot (floor settling).
+    found.erase(std::remove_if(found.begin(), found.end(), [&](uint64_t s) {
+        return s + kSampleRate / 100 < truth.front();
+    }), found.end());
+    return found;
+}
+
+static bool withinTolerance(uint64_t found, uint64_t truth) {
+    return std::fabs(((double)found - (double)truth) * 1000.0 / kSampleRate) <= kToleranceMs;
+}
+
+static bool trainDetected(const OnsetDetectorConfig& config, const std::vector<int16_t>& pcm, const std::vector<uint64_t>& truth) {
+    std::vector<uint64_t> found = detect(config, pcm, truth);
+    if (found.size() != truth.size()) return false;
+    for (size_t i = 0; i < truth.size(); ++i) {
+        if (!withinTolerance(found[i], truth[i])) return false;
+    }
+    return true;
+}
+
+struct TrainErrors {
+    int shots = 0;
+    int misses = 0;
+    int extras = 0; // Detections that match no shot: echoes, tails
+};
+
+static TrainErrors countErrors(const OnsetDetectorConfig& config, const Scenario& sc, double splitMs, int trains) {
+    TrainErrors errors;
+    std::mt19937 rng((uint32_t)(splitMs * 100));
+    std::vector<uint64_t> truth;
+    for (int trial = 0; trial < trains; ++trial) {
+        std::vector<int16_t> pcm = makeTrain(sc, splitMs, rng, truth);
+        std::vector<uint64_t> found = detect(config, pcm, truth);
+        int hits = 0;
+        for (uint64_t t : truth) {
+            if (std::any_of(found.begin(), found.end(), [&](uint64_t f) { return withinTolerance(f, t); })) ++hits;
+        }
+        errors.shots += (int)truth.size();
+        errors.misses += (int)truth.size() - hits;
+        errors.extras += (int)found.size() - hits;
+    }
+    return errors;
+}
+
+// Smallest split (ms) at or above which every trial down to it was detected;
+// -1 if even the longest split tested is missed.
+static double minReliableSplit(const OnsetDetectorConfig& config, const Scenario& sc) {
+    double reliable = -1.0;
+    for (double splitMs = 250.0; splitMs >= 40.0; splitMs -= 5.0) {
+        std::mt19937 rng((uint32_t)(splitMs * 100));
+        std::vector<uint64_t> truth;
+        int ok = 0;
+        for (int trial = 0; trial < kTrialsPerSplit; ++trial) {
+            std::vector<int16_t> pcm = makeTrain(sc, splitMs, rng, truth);
+            if (trainDetected(config, pcm, truth)) ++ok;
+        }
+        if (ok < kTrialsPerSplit) break;
+        reliable = splitMs;
+    }
+    return reliable;
+}
+
+int main() {
+    OnsetDetectorConfig echoGate = shotOnsetConfig(SHOT_MARGIN_DB_DEFAULT, 0, SHOT_MIN_LOCKOUT_MS);
+    OnsetDetectorConfig rearm = echoGate;
+    rearm.echoWindowMs = 0;
+    // Before the re-arm: a slower release and a fixed 150 ms refractory window.
+    OnsetDetectorConfig fixed = rearm;
+    fixed.releaseMs = 30.0f;
+    fixed.lockoutMs = 150;
+    fixed.rearmFraction = 0.0f;
+    const OnsetDetectorConfig* configs[] = {&fixed, &rearm, &echoGate};
+
+    printf("Minimum reliably detected split (%d trains x %d shots, +/-%.0f ms)\n",
+           kTrialsPerSplit, kShotsPerTrain, kToleranceMs);
+    printf("%-12s %16s %16s %16s\n", "scenario", "fixed 150 ms", "envelope re-arm", "+ echo gate");
+    for (const Scenario& sc : kScenarios) {
+        printf("%-12s", sc.name);
+        for (const OnsetDetectorConfig* config : configs) {
+            char cell[16];
+            double split = minReliableSplit(*config, sc);
+            if (split < 0) snprintf(cell, sizeof(cell), "> 250"); else snprintf(cell, sizeof(cell), "%.0f", split);
+            printf(" %13s ms", cell);
+        }
+        printf("\n");
+    }
+
+    printf("\nMissed / extra detections per 100 shots at %.0f ms splits (%d trains)\n", kErrorSplitMs, kErrorTrains);
+    printf("%-12s %16s %16s %16s\n", "scenario", "fixed 150 ms", "envelope re-arm", "+ echo gate");
+    for (const Scenario& sc : kScenarios) {
+        printf("%-12s", sc.name);
+        for (const OnsetDetectorConfig* config : configs) {
+            TrainErrors e = countErrors(*config, sc, kErrorSplitMs, kErrorTrains);
+            char cell[24];
+            snprintf(cell, sizeof(cell), "%.1f / %.1f", 100.0 * e.misses / e.shots, 100.0 * e.extras / e.shots);
+            printf(" %16s", cell);
+        }
+        printf("\n");
+    }
+    return 0;
+}
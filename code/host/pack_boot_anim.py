@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Packs the boot animation JPGs (1.jpg, 2.jpg, ...) into one /boot.anim file.
+
+Frames are stored at 1/scale resolution as RGB565 deltas against the frame
+before, with run-length coding (format in boot_anim.h). A pixel is left
+alone, or joins a run, while it is within --tolerance (per 8-bit channel) of
+what the panel already shows / of the run's color; that keeps JPEG noise from
+turning every frame into literals.
+
+Usage: pack_boot_anim.py FRAME_DIR OUTPUT [--scale 2] [--tolerance 8]
+                         [--delay-ms 100] [--dump-frames FILE]
+
+--dump-frames writes every decoded frame (width * height RGB565 pixels, panel
+byte order, back to back), for host/test_boot_anim.cpp to check the firmware
+decoder against. Needs Pillow.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from PIL import Image
+
+MAGIC = 0x314E4142  # "BAN1"
+OP_SKIP, OP_RUN, OP_LITERAL = 0, 1, 2
+COUNT_EXTENDED = 63
+MAX_COUNT = 0xFFFF
+
+
+def find_frames(frame_dir):
+    """1.jpg, 2.jpg, ... up to the first gap, as the firmware plays them."""
+    frames = []
+    n = 1
+    while os.path.exists(os.path.join(frame_dir, "%d.jpg" % n)):
+        frames.append(os.path.join(frame_dir, "%d.jpg" % n))
+        n += 1
+    return frames
+
+
+def to_rgb565(rgb):
+    r, g, b = rgb
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def expand565(c):
+    r, g, b = (c >> 11) & 0x1F, (c >> 5) & 0x3F, c & 0x1F
+    return ((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2))
+
+
+def close(a, b, tolerance):
+    return (abs(a[0] - b[0]) <= tolerance and abs(a[1] - b[1]) <= tolerance
+            and abs(a[2] - b[2]) <= tolerance)
+
+
+def emit_op(out, kind, count):
+    """Op byte for 1..MAX_COUNT pixels."""
+    if count <= COUNT_EXTENDED:
+        out.append((kind << 6) | (count - 1))
+    else:
+        out.append((kind << 6) | COUNT_EXTENDED)
+        out += struct.pack("<H", count)
+
+
+def emit_color(out, c):
+    out += struct.pack(">H", c)  # Panel byte order
+
+
+def encode_frame(source, shown, tolerance):
+    """Returns the op stream turning 'shown' into 'source' (within tolerance); updates 'shown'."""
+    out = bytearray()
+    shown_rgb = [expand565(c) for c in shown]
+    n = len(source)
+    i = 0
+    while i < n:
+        if close(source[i], shown_rgb[i], tolerance):
+            j = i
+            while j < n and j - i < MAX_COUNT and close(source[j], shown_rgb[j], tolerance):
+                j += 1
+            emit_op(out, OP_SKIP, j - i)
+            i = j
+            continue
+
+        color = to_rgb565(source[i])
+        color_rgb = expand565(color)
+        j = i + 1
+        while (j < n and j - i < MAX_COUNT and close(source[j], color_rgb, tolerance)
+               and not close(source[j], shown_rgb[j], tolerance)):
+            j += 1
+        if j - i >= 2:
+            emit_op(out, OP_RUN, j - i)
+            emit_color(out, color)
+            for k in range(i, j):
+                shown[k] = color
+            i = j
+            continue
+
+        j = i
+        literal = []
+        while (j < n and len(literal) < MAX_COUNT
+               and not close(source[j], shown_rgb[j], tolerance)):
+            if literal and j + 1 < n and close(source[j + 1], source[j], tolerance):
+                break  # Leave it to start a run
+            literal.append(to_rgb565(source[j]))
+            j += 1
+        emit_op(out, OP_LITERAL, len(literal))
+        for k, c in enumerate(literal):
+            emit_color(out, c)
+            shown[i + k] = c
+        i = j
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack boot animation JPGs into boot.anim")
+    parser.add_argument("frame_dir")
+    parser.add_argument("output")
+    parser.add_argument("--scale", type=int, default=2)
+    parser.add_argument("--tolerance", type=int, default=8)
+    parser.add_argument("--delay-ms", type=int, default=100)
+    parser.add_argument("--dump-frames")
+    args = parser.parse_args()
+
+    paths = find_frames(args.frame_dir)
+    if not paths:
+        sys.exit("no frames (1.jpg, 2.jpg, ...) in %s" % args.frame_dir)
+
+    first = Image.open(paths[0])
+    width = (first.width + args.scale - 1) // args.scale
+    height = (first.height + args.scale - 1) // args.scale
+
+    shown = [0] * (width * height)
+    frames = []
+    dump = open(args.dump_frames, "wb") if args.dump_frames else None
+    for path in paths:
+        image = Image.open(path).convert("RGB").resize((width, height), Image.Resampling.BOX)
+        source = [image.getpixel((x, y)) for y in range(height) for x in range(width)]
+        frames.append(encode_frame(source, shown, args.tolerance))
+        if dump:
+            dump.write(struct.pack(">%dH" % len(shown), *shown))
+    if dump:
+        dump.close()
+
+    index_bytes = 4 * (len(frames) + 1)
+    offsets = [24 + index_bytes]
+    for frame in frames:
+        offsets.append(offsets[-1] + len(frame))
+
+    with open(args.output, "wb") as f:
+        f.write(struct.pack("<IHHBBHHHII", MAGIC, width, height, args.scale, 0, len(frames),
+                            args.delay_ms, 0, max(len(fr) for fr in frames), 0))
+        f.write(struct.pack("<%dI" % len(offsets), *offsets))
+        for frame in frames:
+            f.write(frame)
+
+    print("%s: %d frames, %dx%d (x%d), %d bytes" % (args.output, len(frames), width, height,
+                                                   args.scale, offsets[-1]))
+
+
+if __name__ == "__main__":
+    main()
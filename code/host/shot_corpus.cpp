@@ -0,0 +1,375 @@
+#include "shot_corpus.h"
+#include "le_bytes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// --- Files ---
+
+static std::string stemOf(const std::string& wavPath) {
+    return wavPath.substr(0, wavPath.size() - 4); // Without ".wav"
+}
+
+static bool loadWav(const std::string& path, ShotRecording& recording, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || memcmp(&bytes[0], "RIFF", 4) != 0 || memcmp(&bytes[8], "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+    bool haveFormat = false;
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        uint32_t chunkSize = readU32(&bytes[pos + 4]);
+        const uint8_t* body = &bytes[pos + 8];
+        size_t available = std::min((size_t)chunkSize, bytes.size() - pos - 8);
+        if (memcmp(&bytes[pos], "fmt ", 4) == 0 && available >= 16) {
+            if (readU16(body) != 1 || readU16(body + 2) != 1 || readU16(body + 14) != 16) {
+                error = "WAV must be 16-bit mono PCM";
+                return false;
+            }
+            recording.sampleRateHz = readU32(body + 4);
+            haveFormat = true;
+        } else if (memcmp(&bytes[pos], "data", 4) == 0 && haveFormat) {
+            recording.pcm.resize(available / 2);
+            for (size_t i = 0; i < recording.pcm.size(); ++i) {
+                recording.pcm[i] = (int16_t)readU16(body + 2 * i);
+            }
+            return true;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+    error = "WAV has no fmt / data chunk";
+    return false;
+}
+
+static bool loadLabels(const std::string& path, ShotRecording& recording, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "no labels file";
+        return false;
+    }
+    int beeps = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        double start, end;
+        std::string label;
+        if (!(fields >> start >> end >> label)) continue;
+        if (label == "beep") {
+            recording.beepSec = start;
+            beeps++;
+        } else if (label == "shot") {
+            recording.shotSec.push_back(start);
+        } else {
+            recording.notes.push_back({start, label});
+        }
+    }
+    std::sort(recording.shotSec.begin(), recording.shotSec.end());
+    if (beeps != 1) {
+        error = "labels need exactly one beep";
+        return false;
+    }
+    return true;
+}
+
+// Missing file: no trace. The rate comes from the first two rows.
+static bool loadAccel(const std::string& path, ShotRecording& recording, std::string& error) {
+    std::ifstream in(path);
+    if (!in) return true;
+    std::string line;
+    std::getline(in, line); // Header
+    std::vector<double> times;
+    while (std::getline(in, line)) {
+        double t;
+        float g;
+        if (sscanf(line.c_str(), "%lf,%f", &t, &g) == 2) {
+            times.push_back(t);
+            recording.accelZ.push_back(g);
+        }
+    }
+    if (times.size() < 2 || times[1] <= times[0]) {
+        error = "accel trace needs at least two evenly spaced rows";
+        return false;
+    }
+    recording.accelRateHz = (uint32_t)lround(1.0 / (times[1] - times[0]));
+    return true;
+}
+
+bool loadRecording(const std::string& wavPath, ShotRecording& recording, std::string& error) {
+    recording = ShotRecording();
+    std::string stem = stemOf(wavPath);
+    recording.name = std::filesystem::path(stem).filename().string();
+    return loadWav(wavPath, recording, error) &&
+           loadLabels(stem + ".labels.txt", recording, error) &&
+           loadAccel(stem + ".accel.csv", recording, error);
+}
+
+static void writeLe32(std::ofstream& out, uint32_t v) {
+    uint8_t b[4];
+    writeU32(b, v);
+    out.write((const char*)b, 4);
+}
+
+static void writeLe16(std::ofstream& out, uint16_t v) {
+    uint8_t b[2];
+    writeU16(b, v);
+    out.write((const char*)b, 2);
+}
+
+bool saveRecording(const std::string& wavPath, const ShotRecording& recording) {
+    std::string stem = stemOf(wavPath);
+    std::ofstream wav(wavPath, std::ios::binary);
+    uint32_t dataBytes = (uint32_t)(recording.pcm.size() * 2);
+    wav.write("RIFF", 4);
+    writeLe32(wav, 36 + dataBytes);
+    wav.write("WAVEfmt ", 8);
+    writeLe32(wav, 16);
+    writeLe16(wav, 1); // PCM
+    writeLe16(wav, 1); // Mono
+    writeLe32(wav, recording.sampleRateHz);
+    writeLe32(wav, recording.sampleRateHz * 2);
+    writeLe16(wav, 2);
+    writeLe16(wav, 16);
+    wav.write("data", 4);
+    writeLe32(wav, dataBytes);
+    for (int16_t s : recording.pcm) writeLe16(wav, (uint16_t)s);
+
+    std::ofstream labels(stem + ".labels.txt");
+    char line[96];
+    snprintf(line, sizeof(line), "%.6f\t%.6f\tbeep\n", recording.beepSec, recording.beepSec);
+    labels << line;
+    for (double t : recording.shotSec) {
+        snprintf(line, sizeof(line), "%.6f\t%.6f\tshot\n", t, t);
+        labels << line;
+    }
+    for (const auto& note : recording.notes) {
+        snprintf(line, sizeof(line), "%.6f\t%.6f\t%s\n", note.first, note.first, note.second.c_str());
+        labels << line;
+    }
+
+    if (!recording.accelZ.empty()) {
+        std::ofstream accel(stem + ".accel.csv");
+        accel << "time_s,accel_z_g\n";
+        for (size_t i = 0; i < recording.accelZ.size(); ++i) {
+            snprintf(line, sizeof(line), "%.6f,%.4f\n", (double)i / recording.accelRateHz, recording.accelZ[i]);
+            accel << line;
+        }
+    }
+    return (bool)wav && (bool)labels;
+}
+
+std::vector<std::string> listRecordings(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string path = entry.path().string();
+        if (entry.path().extension() == ".wav" && std::filesystem::exists(stemOf(path) + ".labels.txt")) {
+            paths.push_back(path);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// --- Scoring ---
+
+void matchShots(const std::vector<int64_t>& truthUs, const std::vector<int64_t>& detectedUs, int64_t windowUs,
+                ShotMatch& match) {
+    std::vector<bool> used(detectedUs.size(), false);
+    match.shots += (int)truthUs.size();
+    for (int64_t t : truthUs) {
+        int best = -1;
+        for (size_t d = 0; d < detectedUs.size(); ++d) {
+            if (used[d] || std::llabs(detectedUs[d] - t) > windowUs) continue;
+            if (best < 0 || std::llabs(detectedUs[d] - t) < std::llabs(detectedUs[best] - t)) best = (int)d;
+        }
+        if (best < 0) {
+            match.misses++;
+        } else {
+            used[best] = true;
+            match.errorsUs.push_back(detectedUs[best] - t);
+        }
+    }
+    match.falsePositives += (int)std::count(used.begin(), used.end(), false);
+}
+
+// --- Synthetic Corpus ---
+
+static const uint32_t kSynthRateHz = 16000;
+static const uint32_t kSynthAccelRateHz = 1000;
+static const double kPreRollSec = 1.5;
+static const int kShotsPerString = 6;
+
+// Float mix of one recording before it is quantized.
+struct SynthString {
+    std::vector<float> mix;
+    ShotRecording recording;
+    std::mt19937 rng;
+
+    SynthString(const char* kind, int index, uint32_t seed, double durationSec)
+        : mix((size_t)(durationSec * kSynthRateHz)), rng(seed * 7919u + (uint32_t)index * 104729u + (uint32_t)kind[0]) {
+        char name[32];
+        snprintf(name, sizeof(name), "%s_%02d", kind, index);
+        recording.name = name;
+        recording.sampleRateHz = kSynthRateHz;
+    }
+
+    float gauss() { return std::normal_distribution<float>(0.0f, 1.0f)(rng); }
+    double uniform(double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); }
+
+    void addNoise(float rms) {
+        for (float& s : mix) s += rms * gauss();
+    }
+
+    void addBeep(double atSec) {
+        recording.beepSec = atSec;
+        size_t first = (size_t)(atSec * kSynthRateHz);
+        for (size_t n = 0; n < (size_t)(0.15 * kSynthRateHz) && first + n < mix.size(); ++n) {
+            mix[first + n] += 6000.0f * sinf(2.0f * (float)M_PI * 2000.0f * n / kSynthRateHz);
+        }
+    }
+
+    // Muzzle blast: decaying noise burst with a short room tail.
+    void addBlast(double atSec, float amplitude, float gain = 1.0f) {
+        size_t first = (size_t)(atSec * kSynthRateHz);
+        const float blastTau = 0.006f * kSynthRateHz;
+        const float tailTau = 0.04f * kSynthRateHz;
+        for (size_t n = 0; first + n < mix.size(); ++n) {
+            float env = expf(-(float)n / blastTau) + 0.08f * expf(-(float)n / tailTau);
+            if (env < 1e-4f) break;
+            mix[first + n] += gain * amplitude * env * gauss();
+        }
+    }
+
+    // Shot times of a string starting 1.2-2 s after the beep, splits 0.15-0.6 s.
+    std::vector<double> stringTimes() {
+        std::vector<double> times;
+        double t = recording.beepSec + uniform(1.2, 2.0);
+        for (int k = 0; k < kShotsPerString; ++k) {
+            times.push_back(t);
+            t += uniform(0.15, 0.6);
+        }
+        return times;
+    }
+
+    void addShot(double atSec, float amplitude) {
+        addBlast(atSec, amplitude);
+        recording.shotSec.push_back(atSec);
+    }
+
+    ShotRecording finish() {
+        recording.pcm.resize(mix.size());
+        for (size_t n = 0; n < mix.size(); ++n) {
+            recording.pcm[n] = (int16_t)std::max(-32768.0f, std::min(32767.0f, mix[n]));
+        }
+        std::sort(recording.notes.begin(), recording.notes.end());
+        return recording;
+    }
+};
+
+static ShotRecording synthImpulse(int index, uint32_t seed) {
+    SynthString s("impulse", index, seed, 8.0);
+    s.addNoise(150.0f);
+    s.addBeep(kPreRollSec);
+    for (double t : s.stringTimes()) {
+        float amplitude = (float)s.uniform(12000.0, 30000.0);
+        s.addShot(t, amplitude);
+        for (int e = 0; e < 3; ++e) {
+            s.addBlast(t + s.uniform(0.02, 0.08), amplitude, (float)s.uniform(0.2, 0.45));
+        }
+    }
+    return s.finish();
+}
+
+static ShotRecording synthSteel(int index, uint32_t seed) {
+    SynthString s("steel", index, seed, 8.0);
+    s.addNoise(150.0f);
+    s.addBeep(kPreRollSec);
+    const float modesHz[] = {1130.0f, 2710.0f, 4420.0f};
+    for (double t : s.stringTimes()) {
+        float amplitude = (float)s.uniform(12000.0, 30000.0);
+        s.addShot(t, amplitude);
+        double hitSec = t + s.uniform(0.12, 0.25);
+        s.recording.notes.push_back({hitSec, "steel"});
+        // Sharp strike, then the plate rings down over a few hundred ms.
+        float ring = amplitude * (float)s.uniform(0.3, 0.6);
+        size_t first = (size_t)(hitSec * kSynthRateHz);
+        for (size_t n = 0; first + n < s.mix.size() && n < (size_t)(0.8 * kSynthRateHz); ++n) {
+            float tSec = (float)n / kSynthRateHz;
+            float v = 0.0f;
+            for (int m = 0; m < 3; ++m) {
+                v += expf(-tSec / (0.25f / (m + 1))) * sinf(2.0f * (float)M_PI * modesHz[m] * tSec) / (m + 1);
+            }
+            s.mix[first + n] += ring * v;
+        }
+    }
+    return s.finish();
+}
+
+static ShotRecording synthNeighbor(int index, uint32_t seed) {
+    SynthString s("neighbor", index, seed, 8.0);
+    s.addNoise(200.0f);
+    s.addBeep(kPreRollSec);
+    s.recording.accelRateHz = kSynthAccelRateHz;
+    s.recording.accelZ.assign(s.mix.size() * kSynthAccelRateHz / kSynthRateHz, 1.0f);
+    for (float& g : s.recording.accelZ) g += 0.02f * s.gauss();
+
+    std::vector<double> own = s.stringTimes();
+    for (double t : own) {
+        s.addShot(t, (float)s.uniform(15000.0, 30000.0));
+        float recoil = (float)s.uniform(2.5, 4.0);
+        size_t first = (size_t)((t + 0.002) * kSynthAccelRateHz);
+        for (size_t n = 0; n < 20 && first + n < s.recording.accelZ.size(); ++n) {
+            s.recording.accelZ[first + n] += (recoil - 1.0f) * sinf((float)M_PI * (n + 0.5f) / 20.0f);
+        }
+    }
+    // Neighbouring bays: just as loud at times, never closer than 150 ms to an own shot.
+    int placed = 0;
+    for (int attempt = 0; attempt < 200 && placed < 5; ++attempt) {
+        double t = s.recording.beepSec + s.uniform(0.8, 5.5);
+        bool clear = true;
+        for (double o : own) clear = clear && fabs(t - o) >= 0.15;
+        if (!clear) continue;
+        s.addBlast(t, (float)s.uniform(8000.0, 25000.0));
+        s.recording.notes.push_back({t, "neighbor"});
+        placed++;
+    }
+    return s.finish();
+}
+
+static ShotRecording synthWind(int index, uint32_t seed) {
+    SynthString s("wind", index, seed, 8.0);
+    // Low-passed noise (~150 Hz) under a slow gust envelope.
+    const float alpha = 1.0f - expf(-2.0f * (float)M_PI * 150.0f / kSynthRateHz);
+    const double gustHz = s.uniform(0.2, 0.5);
+    const double phase = s.uniform(0.0, 2.0 * M_PI);
+    float lp = 0.0f;
+    for (size_t n = 0; n < s.mix.size(); ++n) {
+        lp += alpha * (s.gauss() - lp);
+        double gust = 0.5 + 0.5 * sin(2.0 * M_PI * gustHz * n / kSynthRateHz + phase);
+        s.mix[n] += 2500.0f * 4.0f * (float)(0.3 + gust) * lp; // ~4x makes up the low-pass loss
+    }
+    s.addNoise(100.0f);
+    s.addBeep(kPreRollSec);
+    for (double t : s.stringTimes()) {
+        s.addShot(t, (float)s.uniform(15000.0, 30000.0));
+    }
+    return s.finish();
+}
+
+std::vector<ShotRecording> generateSyntheticCorpus(int perKind, uint32_t seed) {
+    std::vector<ShotRecording> corpus;
+    for (int i = 0; i < perKind; ++i) corpus.push_back(synthImpulse(i, seed));
+    for (int i = 0; i < perKind; ++i) corpus.push_back(synthSteel(i, seed));
+    for (int i = 0; i < perKind; ++i) corpus.push_back(synthNeighbor(i, seed));
+    for (int i = 0; i < perKind; ++i) corpus.push_back(synthWind(i, seed));
+    return corpus;
+}
@@ -0,0 +1,67 @@
+#ifndef SHOT_CORPUS_H
+#define SHOT_CORPUS_H
+
+// Ground-truth shot recordings for the replay benchmark (bench_replay) and
+// the settings sweep. A recording is three files side by side:
+//   <name>.wav         Mic PCM: 16-bit mono at MIC_SAMPLE_RATE_HZ.
+//   <name>.labels.txt  Audacity label track ("start<TAB>end<TAB>label", seconds
+//                      from the start of the WAV). "beep" marks the start beep
+//                      (exactly one), "shot" each true shot by the shooter
+//                      wearing the timer; other labels ("neighbor", "steel",
+//                      ...) are notes and are not scored.
+//   <name>.accel.csv   Optional accelerometer Z trace ("time_s,accel_z_g" with
+//                      a header line, evenly spaced). Recordings with one are
+//                      replayed in Noisy Range, the others in Live Fire.
+// The recording should start at least a second before the beep so the noise
+// floor has settled by then, as on the device.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct ShotRecording {
+    std::string name;
+    uint32_t sampleRateHz = 0;
+    std::vector<int16_t> pcm;
+    double beepSec = 0.0;         // Start beep onset
+    std::vector<double> shotSec;  // True shots, in time order
+    std::vector<std::pair<double, std::string>> notes; // Unscored labels
+    uint32_t accelRateHz = 0;     // 0: no accelerometer trace
+    std::vector<float> accelZ;    // G, sample i at i / accelRateHz
+
+    double durationSec() const { return sampleRateHz ? (double)pcm.size() / sampleRateHz : 0.0; }
+};
+
+// Loads the recording whose WAV is 'wavPath', with the files next to it.
+// 'error' says what is wrong if it returns false.
+bool loadRecording(const std::string& wavPath, ShotRecording& recording, std::string& error);
+
+// Writes the WAV, labels and (if there is a trace) accel files next to each other.
+bool saveRecording(const std::string& wavPath, const ShotRecording& recording);
+
+// The .wav files in 'dir' that have a labels file, sorted by name.
+std::vector<std::string> listRecordings(const std::string& dir);
+
+// --- Scoring ---
+// Detections matched to true shots, greedily in time order: each true shot
+// takes the closest unused detection within 'windowUs'.
+struct ShotMatch {
+    int shots = 0;
+    int misses = 0;
+    int falsePositives = 0;
+    std::vector<int64_t> errorsUs; // Detected - true, per hit
+};
+void matchShots(const std::vector<int64_t>& truthUs, const std::vector<int64_t>& detectedUs, int64_t windowUs,
+                ShotMatch& match);
+
+// --- Synthetic Corpus ---
+// Strings at 16 kHz with a start beep and 6 labelled shots, in four kinds:
+//   impulse   Shots with discrete wall echoes 20-80 ms behind them.
+//   steel     Each shot followed by a ringing steel target 120-250 ms later.
+//   neighbor  Shots from neighbouring bays between the shooter's own; with an
+//             accelerometer trace showing recoil on the own shots only.
+//   wind      Low-frequency gusting noise under the shots.
+// 'perKind' recordings of each, deterministic for a given seed.
+std::vector<ShotRecording> generateSyntheticCorpus(int perKind, uint32_t seed);
+
+#endif // SHOT_CORPUS_H
@@ -0,0 +1,71 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Host simulation stand-in for the Arduino core: just what the simulated
+// firmware files use, on the virtual clock (sim_hal.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+using std::max;
+using std::min;
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+#define IRAM_ATTR
+#define CHANGE 0x03
+#define HIGH 1
+#define LOW 0
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+
+// Buzzer output; recorded by the simulation.
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+double ledcWriteTone(uint8_t channel, double frequency);
+
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    const char* c_str() const { return s_.c_str(); }
+    unsigned int length() const { return (unsigned int)s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    bool operator==(const String& other) const { return s_ == other.s_; }
+    bool operator!=(const String& other) const { return s_ != other.s_; }
+    String& operator+=(const String& other) { s_ += other.s_; return *this; }
+
+private:
+    std::string s_;
+};
+
+// Serial output goes to stdout.
+class SimSerial {
+public:
+    void begin(unsigned long) {}
+    int printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    void print(const char* s) { fputs(s, stdout); }
+    void println(const char* s = "") { puts(s); }
+};
+extern SimSerial Serial;
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,28 @@
+#ifndef SIM_BLUETOOTH_A2DP_SOURCE_H
+#define SIM_BLUETOOTH_A2DP_SOURCE_H
+
+#include <stdint.h>
+
+// Host simulation: the link is up or down as the scenario says
+// (simSetBluetoothConnected()); while it is up the sim calls the firmware's
+// get_data_frames() like a sink and records the tones it hears.
+struct Frame {
+    int16_t channel1;
+    int16_t channel2;
+};
+
+typedef uint8_t esp_bd_addr_t[6];
+
+enum esp_a2d_connection_state_t {
+    ESP_A2D_CONNECTION_STATE_DISCONNECTED,
+    ESP_A2D_CONNECTION_STATE_CONNECTING,
+    ESP_A2D_CONNECTION_STATE_CONNECTED,
+    ESP_A2D_CONNECTION_STATE_DISCONNECTING
+};
+
+class BluetoothA2DPSource {
+public:
+    bool is_connected();
+};
+
+#endif // SIM_BLUETOOTH_A2DP_SOURCE_H
@@ -0,0 +1,14 @@
+#ifndef SIM_ESP32_BLUETOOTH_SCANNER_H
+#define SIM_ESP32_BLUETOOTH_SCANNER_H
+
+#include <Arduino.h>
+
+struct BTDevice {
+    String name;
+    String address;
+    int rssi = 0;
+};
+
+class ESP32BluetoothScanner {};
+
+#endif // SIM_ESP32_BLUETOOTH_SCANNER_H
@@ -0,0 +1,11 @@
+#ifndef SIM_M5_MIC_PEAK_RMS_H
+#define SIM_M5_MIC_PEAK_RMS_H
+
+// Host simulation: the mic is fed through processMicBlock() instead.
+class M5MicPeakRMS {
+public:
+    template <typename T> bool begin(T&) { return true; }
+    void resetPeak() {}
+};
+
+#endif // SIM_M5_MIC_PEAK_RMS_H
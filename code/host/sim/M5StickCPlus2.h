@@ -0,0 +1,103 @@
+#ifndef SIM_M5_STICKC_PLUS2_H
+#define SIM_M5_STICKC_PLUS2_H
+
+// Host simulation stand-in for M5StickCPlus2 / M5Unified: scripted buttons
+// (simClick(), simSetPressed()), a null display, a fixed battery and no
+// mic / I2C (the simulation feeds the capture and IMU code itself).
+
+#include <Arduino.h>
+
+#define BLACK 0x0000
+#define WHITE 0xFFFF
+#define RED 0xF800
+#define GREEN 0x07E0
+#define BLUE 0x001F
+#define YELLOW 0xFFE0
+#define ORANGE 0xFD20
+#define CYAN 0x07FF
+#define DARKGREY 0x7BEF
+
+enum textdatum_t {
+    TL_DATUM, TC_DATUM, TR_DATUM, ML_DATUM, MC_DATUM, MR_DATUM, BL_DATUM, BC_DATUM, BR_DATUM
+};
+
+class Button_Class {
+public:
+    bool isPressed() const { return pressed_; }
+    bool wasClicked() const { return clicked_; }
+    bool wasPressed() const { return clicked_; }
+    bool wasReleased() const { return clicked_; }
+    bool pressedFor(uint32_t ms) const;
+
+    // Simulation side.
+    void simClick() { pendingClick_ = true; }
+    void simSetPressed(bool pressed);
+    void simUpdate() { clicked_ = pendingClick_; pendingClick_ = false; }
+
+private:
+    bool pressed_ = false;
+    bool clicked_ = false;
+    bool pendingClick_ = false;
+    unsigned long pressedSinceMs_ = 0;
+};
+
+class SimLcd {
+public:
+    int width() const { return 240; }
+    int height() const { return 135; }
+    int getRotation() const { return 3; }
+    void setRotation(int) {}
+    void fillScreen(uint16_t) {}
+    void fillRect(int, int, int, int, uint16_t) {}
+    void drawRect(int, int, int, int, uint16_t) {}
+    void setTextDatum(int) {}
+    void setTextFont(int) {}
+    void setTextSize(float) {}
+    void setTextColor(uint16_t, uint16_t = 0) {}
+    void setCursor(int, int) {}
+    void drawString(const char*, int, int) {}
+    void drawString(const String&, int, int) {}
+    void print(const char*) {}
+    int printf(const char*, ...) { return 0; }
+    void sleep() {}
+    void wakeup() {}
+    void waitDisplay() {}
+};
+
+class SimPower {
+public:
+    int32_t getBatteryVoltage() { return 4000; } // mV
+    int32_t getBatteryLevel() { return 80; }
+    bool isCharging() { return false; }
+};
+
+class SimMic {
+public:
+    bool begin() { return true; }
+    bool record(int16_t*, size_t, uint32_t) { return false; }
+};
+
+class SimI2C {
+public:
+    bool writeRegister8(uint8_t, uint8_t, uint8_t, uint32_t) { return false; }
+    bool readRegister(uint8_t, uint8_t, uint8_t*, size_t, uint32_t) { return false; }
+};
+
+class SimM5 {
+public:
+    void begin() {}
+    void update(); // Latches scripted clicks for this pass
+
+    Button_Class BtnA;
+    Button_Class BtnB;
+    Button_Class BtnPWR;
+    SimLcd Lcd;
+    SimPower Power;
+    SimMic Mic;
+    SimI2C In_I2C;
+};
+
+extern SimM5 M5;
+extern SimM5& StickCP2;
+
+#endif // SIM_M5_STICKC_PLUS2_H
@@ -0,0 +1,58 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Host simulation: NVS in memory, empty at start.
+class Preferences {
+public:
+    bool begin(const char*, bool = false) { return true; }
+    void end() {}
+    bool isKey(const char* key) { return values_.count(key) != 0 || blobs_.count(key) != 0; }
+    bool remove(const char* key) {
+        return values_.erase(key) + strings_.erase(key) + blobs_.erase(key) != 0;
+    }
+
+    int32_t getInt(const char* key, int32_t def = 0) { return (int32_t)get(key, def); }
+    uint32_t getULong(const char* key, uint32_t def = 0) { return (uint32_t)get(key, def); }
+    float getFloat(const char* key, float def = 0.0f) { return (float)get(key, def); }
+    bool getBool(const char* key, bool def = false) { return get(key, def) != 0.0; }
+    String getString(const char* key, const String& def = String()) {
+        return strings_.count(key) ? String(strings_[key]) : def;
+    }
+
+    size_t putInt(const char* key, int32_t value) { values_[key] = value; return 4; }
+    size_t putULong(const char* key, uint32_t value) { values_[key] = value; return 4; }
+    size_t putFloat(const char* key, float value) { values_[key] = value; return 4; }
+    size_t putBool(const char* key, bool value) { values_[key] = value; return 1; }
+    size_t putString(const char* key, const String& value) {
+        strings_[key] = value.c_str();
+        values_[key] = 0;
+        return value.length();
+    }
+
+    size_t getBytesLength(const char* key) { return blobs_.count(key) ? blobs_[key].size() : 0; }
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        if (!blobs_.count(key) || blobs_[key].size() > maxLen) return 0;
+        memcpy(buf, blobs_[key].data(), blobs_[key].size());
+        return blobs_[key].size();
+    }
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        const uint8_t* bytes = (const uint8_t*)value;
+        blobs_[key].assign(bytes, bytes + len);
+        return len;
+    }
+
+private:
+    double get(const char* key, double def) { return values_.count(key) ? values_[key] : def; }
+
+    std::map<std::string, double> values_;
+    std::map<std::string, std::string> strings_;
+    std::map<std::string, std::vector<uint8_t>> blobs_;
+};
+
+#endif // SIM_PREFERENCES_H
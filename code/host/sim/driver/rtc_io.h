@@ -0,0 +1,6 @@
+#ifndef SIM_DRIVER_RTC_IO_H
+#define SIM_DRIVER_RTC_IO_H
+
+// Host simulation: no RTC GPIO.
+
+#endif // SIM_DRIVER_RTC_IO_H
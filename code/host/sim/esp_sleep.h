@@ -0,0 +1,6 @@
+#ifndef SIM_ESP_SLEEP_H
+#define SIM_ESP_SLEEP_H
+
+// Host simulation: nothing sleeps.
+
+#endif // SIM_ESP_SLEEP_H
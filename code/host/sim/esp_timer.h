@@ -0,0 +1,28 @@
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+// Host simulation: esp_timer on the virtual clock. One-shot timers fire from
+// simAdvanceUs() when their deadline passes.
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef struct SimEspTimer* esp_timer_handle_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    int dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+int64_t esp_timer_get_time();
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+#endif // SIM_ESP_TIMER_H
@@ -0,0 +1,64 @@
+// Host simulation: the display_utils.h / ui_render.h API with nothing behind
+// it. The timer modes publish through these; the simulation only keeps the last
+// snapshot for scenarios to look at.
+
+#include "sim_hal.h"
+#include "display_utils.h"
+#include "ui_render.h"
+#include "globals.h"
+
+static UiSnapshot lastSnapshot = {};
+static uint32_t screenSeq = 0;
+
+const UiSnapshot& simLastUiSnapshot() {
+    return lastSnapshot;
+}
+
+// --- ui_render.h ---
+
+bool uiRenderBegin() { return true; }
+void uiRenderTask(void*) {}
+
+int uiRotation() {
+    if (currentState == EDIT_SETTING && settingBeingEdited == EDIT_ROTATION) {
+        return editingIntValue;
+    }
+    return screenRotationSetting;
+}
+
+void publishUiSnapshot(UiSnapshot &snapshot, bool redraw) {
+    if (redraw) screenSeq++;
+    snapshot.screenSeq = screenSeq;
+    snapshot.rotation = (uint8_t)uiRotation();
+    snapshot.lowBattery = lowBatteryWarning;
+    lastSnapshot = snapshot;
+}
+
+void uiRenderSleepDisplay() {
+    UiSnapshot snapshot = {};
+    snapshot.screen = UI_SCREEN_SLEEP;
+    publishUiSnapshot(snapshot, true);
+}
+
+// --- display_utils.h ---
+
+void displayBootScreen(const char*, const char*, const char*) {}
+void drawUiSnapshot(const UiSnapshot&, bool) {}
+void displayMenu(const char*, const char*[], int, int, int) {}
+DisplayFrameStats getTimingFrameStats() { return DisplayFrameStats{0, 0, 0}; }
+void displayEditScreen() {}
+void displayCalibrationScreen(const char*, float, const char*) {}
+void displayBtLatencyCalibrationScreen(int, int, int, int, bool) {}
+void displayDeviceStatusScreen() {}
+void displayProfileScreen() {}
+void displayListFilesScreen() {}
+void displayDryFireReadyScreen() {}
+void displayDryFireRunningScreen(bool, int, int) {}
+void displayMessageScreen(const char*, uint8_t) {}
+String getUpButtonLabel() { return String(); }
+String getDownButtonLabel() { return String(); }
+void displayBluetoothScanResults() {}
+
+bool openBootAnimation() { return false; }
+bool isBootAnimationOpen() { return false; }
+void closeBootAnimation() {}
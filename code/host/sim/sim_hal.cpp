@@ -0,0 +1,663 @@
+#include "sim_hal.h"
+#include <Arduino.h>
+#include <M5StickCPlus2.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdarg>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "globals.h"
+#include "config.h"
+#include "audio_utils.h"
+#include "bt_audio.h"
+#include "shot_capture.h"
+#include "imu_pipeline.h"
+#include "timer_modes.h"
+#include "loop_events.h"
+#include "session_journal.h"
+#include "state_dispatch.h"
+#include "system_utils.h"
+
+SimSerial Serial;
+SimM5 M5;
+SimM5& StickCP2 = M5;
+
+static int64_t nowUs = 0;
+static bool started = false;
+
+static SimJitter jitter = {200, 1000, 2000, 100};
+static uint32_t jitterState = 0x2545F491u; // Own generator, so firmware random() is unaffected
+
+static SimMicSource micSource;
+static SimImuSource imuSource;
+static uint64_t nextMicBlock = 0;
+static int64_t nextMicDueUs = -1; // Delivery time of nextMicBlock, jitter included; -1 until drawn
+static int64_t micProcessNs = 0;
+static int64_t nextImuDrainUs = 0;
+static uint64_t nextImuSample = 0;
+
+static bool bluetoothConnected = false;
+static std::vector<SimBeep> beeps;
+static int ledcBeepIndex = -1; // Beep the LEDC channel is sounding, if any
+static std::vector<std::pair<int64_t, SimButton>> scheduledClicks; // simClickAt(), by time
+static void (*pinIsrs[64])() = {}; // attachInterrupt() handlers by GPIO
+
+struct SimEspTimer {
+    esp_timer_cb_t callback;
+    void* arg;
+    int64_t fireUs; // Deadline plus dispatch jitter; INT64_MAX when not armed
+};
+static std::vector<std::unique_ptr<SimEspTimer>> espTimers;
+
+// A2DP sink: asks for kA2dpCallbackFrames at a time, each request a little
+// after its first frame is due; frame n is heard at a2dpStartUs + n / rate
+// plus the speaker latency.
+static const int32_t kA2dpCallbackFrames = 256;
+static const uint64_t kA2dpSilenceFrames = A2DP_SAMPLE_RATE_HZ / 1000; // 1 ms of silence ends a beep
+static int64_t a2dpStartUs = 0;
+static uint64_t a2dpBuffers = 0;
+static int64_t nextA2dpCallUs = INT64_MAX;
+
+// A beep being heard in the A2DP output.
+struct A2dpBeepTracker {
+    bool sounding;
+    uint64_t startFrame;
+    uint64_t lastSoundFrame;
+    int16_t previous;
+    int crossings;        // Rising zero crossings
+    double firstCrossing; // Frame positions, interpolated
+    double lastCrossing;
+};
+static A2dpBeepTracker a2dpBeep = {};
+
+// Firmware tasks run on their own threads, one at a time: the clock only
+// moves while every task is blocked, so a task sees the time it woke at.
+struct SimTask {
+    TaskFunction_t function;
+    void* arg;
+    int64_t wakeUs;          // Runnable once the clock gets here...
+    QueueHandle_t waitQueue; // ...or, if set, once this queue has an item
+    bool running;
+    uint32_t notifyBits;
+    bool notified;
+};
+static std::vector<SimTask*> tasks;
+static thread_local SimTask* currentTask = nullptr;
+// loop()'s task: the process's main thread, never in 'tasks'.
+static SimTask mainTask = {nullptr, nullptr, INT64_MAX, NULL, true, 0, false};
+static uint32_t loopPasses = 0;
+static int64_t loopBusyNs = 0;
+
+// Never destroyed: blocked task threads still wait on them at exit.
+static std::mutex& taskMutex() {
+    static std::mutex* mutex = new std::mutex;
+    return *mutex;
+}
+
+static std::condition_variable& taskSwitch() {
+    static std::condition_variable* cv = new std::condition_variable;
+    return *cv;
+}
+
+struct SimQueue {
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+// The firmware's setup() work the simulated parts depend on. Deferred to the
+// first call so scenarios can change settings before the detector is configured.
+static void simStart() {
+    if (started) return;
+    started = true;
+    buzzerQueue = xQueueCreate(BUZZER_QUEUE_LENGTH, sizeof(BuzzerRequest));
+    xTaskCreatePinnedToCore(buzzerTask, "BuzzerTask", BUZZER_TASK_STACK_SIZE, NULL, 1, &buzzerTaskHandle, 0);
+    bt_tone_synth_begin();
+    shotCaptureBegin();
+    loopEventsBegin();
+}
+
+// Delay for the next asynchronous event, uniform in [0, maxUs].
+static int64_t jitterUs(int64_t maxUs) {
+    if (maxUs <= 0) return 0;
+    jitterState = jitterState * 1664525u + 1013904223u;
+    return (int64_t)((jitterState >> 8) % (uint32_t)(maxUs + 1));
+}
+
+// --- Tasks ---
+
+static bool taskReady(const SimTask* task) {
+    return task->wakeUs <= nowUs || (task->waitQueue != NULL && !task->waitQueue->items.empty());
+}
+
+// Main thread: lets 'task' run until it blocks again.
+static void runTask(SimTask* task) {
+    std::unique_lock<std::mutex> lock(taskMutex());
+    task->running = true;
+    taskSwitch().notify_all();
+    taskSwitch().wait(lock, [task] { return !task->running; });
+}
+
+static void runReadyTasks() {
+    bool ran = true;
+    while (ran) {
+        ran = false;
+        for (SimTask* task : tasks) {
+            if (taskReady(task)) {
+                runTask(task);
+                ran = true;
+            }
+        }
+    }
+}
+
+// Task thread: hands control back to the main thread until 'wakeUs', or
+// until 'queue' has an item.
+static void taskBlock(int64_t wakeUs, QueueHandle_t queue) {
+    SimTask* task = currentTask;
+    std::unique_lock<std::mutex> lock(taskMutex());
+    task->wakeUs = wakeUs;
+    task->waitQueue = queue;
+    task->running = false;
+    taskSwitch().notify_all();
+    taskSwitch().wait(lock, [task] { return task->running; });
+}
+
+static void taskThread(SimTask* task) {
+    {
+        std::unique_lock<std::mutex> lock(taskMutex());
+        taskSwitch().wait(lock, [task] { return task->running; });
+    }
+    currentTask = task;
+    task->function(task->arg); // Tasks never return
+}
+
+// --- Virtual Clock ---
+
+int64_t simNowUs() {
+    return nowUs;
+}
+
+static int64_t micBlockEndUs(uint64_t block) {
+    return (int64_t)((block + 1) * MIC_CAPTURE_BLOCK_SAMPLES * 1000000ULL / MIC_SAMPLE_RATE_HZ);
+}
+
+static void runMicBlock() {
+    int16_t samples[MIC_CAPTURE_BLOCK_SAMPLES];
+    uint64_t first = nextMicBlock * MIC_CAPTURE_BLOCK_SAMPLES;
+    if (micSource) {
+        micSource(first, samples, MIC_CAPTURE_BLOCK_SAMPLES);
+    } else {
+        memset(samples, 0, sizeof(samples));
+    }
+    auto processStart = std::chrono::steady_clock::now();
+    processMicBlock(samples, nowUs);
+    micProcessNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - processStart).count();
+    nextMicBlock++;
+    nextMicDueUs = micBlockEndUs(nextMicBlock) + jitterUs(jitter.micBlockUs);
+}
+
+static void drainImu() {
+    const int64_t periodUs = 1000000 / IMU_SAMPLE_RATE_HZ;
+    const float lsbPerG = 4096.0f; // The pipeline's default (+-8 G)
+    while ((int64_t)nextImuSample * periodUs <= nowUs) {
+        ImuSample sample;
+        sample.timeUs = (int64_t)nextImuSample * periodUs;
+        float g = imuSource ? imuSource(sample.timeUs) : 1.0f;
+        float raw = std::max(-32768.0f, std::min(32767.0f, roundf(g * lsbPerG)));
+        sample.ax = 0;
+        sample.ay = 0;
+        sample.az = (int16_t)raw;
+        imuAppendSample(sample);
+        nextImuSample++;
+    }
+    nextImuDrainUs += (int64_t)IMU_DRAIN_INTERVAL_MS * 1000;
+}
+
+static void recordBeep(int64_t startUs, int frequencyHz, int durationMs, bool bluetooth) {
+    beeps.push_back({startUs, frequencyHz, durationMs, bluetooth});
+}
+
+static int64_t a2dpFrameHeardUs(double frame) {
+    return a2dpStartUs + (int64_t)(frame * 1000000.0 / A2DP_SAMPLE_RATE_HZ) + (int64_t)currentBluetoothAudioOffsetMs * 1000;
+}
+
+// Follows the left channel: a beep starts on its first non-zero sample and
+// is recorded once kA2dpSilenceFrames of silence end it, with its frequency
+// from the spacing of its rising zero crossings.
+static void trackA2dpSample(uint64_t frame, int16_t sample) {
+    A2dpBeepTracker& beep = a2dpBeep;
+    if (sample != 0) {
+        if (!beep.sounding) {
+            beep = A2dpBeepTracker();
+            beep.sounding = true;
+            beep.startFrame = frame;
+        }
+        beep.lastSoundFrame = frame;
+    }
+    if (beep.sounding) {
+        if (beep.previous < 0 && sample >= 0) {
+            double at = (double)(frame - 1) + (double)-beep.previous / (double)(sample - beep.previous);
+            if (beep.crossings == 0) beep.firstCrossing = at;
+            beep.lastCrossing = at;
+            beep.crossings++;
+        }
+        if (frame - beep.lastSoundFrame >= kA2dpSilenceFrames) {
+            int frequencyHz = (beep.crossings >= 2)
+                ? (int)lround((beep.crossings - 1) * (double)A2DP_SAMPLE_RATE_HZ / (beep.lastCrossing - beep.firstCrossing))
+                : 0;
+            int durationMs = (int)((beep.lastSoundFrame + 1 - beep.startFrame) * 1000 / A2DP_SAMPLE_RATE_HZ);
+            recordBeep(a2dpFrameHeardUs((double)beep.startFrame), frequencyHz, durationMs, true);
+            beep.sounding = false;
+        }
+    }
+    beep.previous = sample;
+}
+
+static int64_t a2dpBufferDueUs(uint64_t buffer) {
+    return a2dpStartUs + (int64_t)(buffer * kA2dpCallbackFrames * 1000000ULL / A2DP_SAMPLE_RATE_HZ);
+}
+
+// The sink asking for the next buffer: the firmware's data callback fills it
+// and whatever tones it holds are recorded as heard.
+static void runA2dpCallback() {
+    Frame frames[kA2dpCallbackFrames];
+    memset(frames, 0, sizeof(frames));
+    int32_t filled = get_data_frames(frames, kA2dpCallbackFrames);
+    uint64_t first = a2dpBuffers * kA2dpCallbackFrames;
+    for (int32_t i = 0; i < filled; ++i) {
+        trackA2dpSample(first + (uint64_t)i, frames[i].channel1);
+    }
+    a2dpBuffers++;
+    nextA2dpCallUs = a2dpBufferDueUs(a2dpBuffers) + jitterUs(jitter.a2dpUs);
+}
+
+// Runs everything due up to 'targetUs', or (with 'untilNotified') only until
+// something notifies loop()'s task.
+static void advanceTo(int64_t targetUs, bool untilNotified) {
+    if (nextMicDueUs < 0) nextMicDueUs = micBlockEndUs(nextMicBlock) + jitterUs(jitter.micBlockUs);
+    runReadyTasks();
+    for (;;) {
+        if (untilNotified && mainTask.notified) break;
+        int64_t nextUs = std::min(targetUs, std::min(nextMicDueUs, std::min(nextImuDrainUs, nextA2dpCallUs)));
+        for (const auto& timer : espTimers) {
+            nextUs = std::min(nextUs, timer->fireUs);
+        }
+        for (const SimTask* task : tasks) {
+            nextUs = std::min(nextUs, task->wakeUs);
+        }
+        if (!scheduledClicks.empty()) nextUs = std::min(nextUs, scheduledClicks.front().first);
+        nowUs = std::max(nowUs, nextUs);
+
+        while (!scheduledClicks.empty() && scheduledClicks.front().first <= nowUs) {
+            SimButton button = scheduledClicks.front().second;
+            scheduledClicks.erase(scheduledClicks.begin());
+            simClick(button);
+        }
+        if (nextMicDueUs <= nowUs) runMicBlock();
+        if (nextImuDrainUs <= nowUs) drainImu();
+        for (size_t i = 0; i < espTimers.size(); ++i) {
+            SimEspTimer& timer = *espTimers[i];
+            if (timer.fireUs <= nowUs) {
+                timer.fireUs = INT64_MAX;
+                timer.callback(timer.arg);
+            }
+        }
+        runReadyTasks();
+        if (nextA2dpCallUs <= nowUs) runA2dpCallback();
+        if (nowUs >= targetUs || (untilNotified && mainTask.notified)) break;
+    }
+}
+
+void simAdvanceUs(int64_t us) {
+    simStart();
+    if (currentTask) {
+        taskBlock(nowUs + std::max(us, (int64_t)0), NULL); // A task sleeping
+        return;
+    }
+    advanceTo(nowUs + std::max(us, (int64_t)0), false);
+}
+
+void simSetJitter(const SimJitter& newJitter) {
+    jitter = newJitter;
+}
+
+// --- Scripted Sources ---
+
+void simSetMicSource(SimMicSource source) {
+    micSource = source;
+}
+
+int64_t simMicProcessNs() {
+    return micProcessNs;
+}
+
+void simSetImuSource(SimImuSource source) {
+    imuSource = source;
+}
+
+// --- Buttons ---
+
+static Button_Class& simButton(SimButton button) {
+    switch (button) {
+        case SIM_BTN_B: return M5.BtnB;
+        case SIM_BTN_PWR: return M5.BtnPWR;
+        default: return M5.BtnA;
+    }
+}
+
+// The button's GPIO interrupt, as its edge would fire it.
+static void buttonEdge(SimButton button) {
+    uint8_t pin = (button == SIM_BTN_B) ? BTN_B_PIN : (button == SIM_BTN_PWR) ? BTN_PWR_PIN : BTN_A_PIN;
+    if (pinIsrs[pin]) pinIsrs[pin]();
+}
+
+void simClick(SimButton button) {
+    buttonEdge(button);
+    simButton(button).simClick();
+}
+
+void simClickAt(SimButton button, int64_t atUs) {
+    auto later = std::upper_bound(scheduledClicks.begin(), scheduledClicks.end(), atUs,
+                                  [](int64_t t, const std::pair<int64_t, SimButton>& click) { return t < click.first; });
+    scheduledClicks.insert(later, std::make_pair(atUs, button));
+}
+
+void simSetPressed(SimButton button, bool pressed) {
+    if (pressed != simButton(button).isPressed()) buttonEdge(button);
+    simButton(button).simSetPressed(pressed);
+}
+
+bool Button_Class::pressedFor(uint32_t ms) const {
+    return pressed_ && millis() - pressedSinceMs_ >= ms;
+}
+
+void Button_Class::simSetPressed(bool pressed) {
+    if (pressed && !pressed_) pressedSinceMs_ = millis();
+    pressed_ = pressed;
+}
+
+void SimM5::update() {
+    BtnA.simUpdate();
+    BtnB.simUpdate();
+    BtnPWR.simUpdate();
+}
+
+// --- Bluetooth / Beeps ---
+
+void simSetBluetoothConnected(bool connected) {
+    if (connected && !bluetoothConnected) {
+        a2dpStartUs = nowUs;
+        a2dpBuffers = 0;
+        nextA2dpCallUs = nowUs + jitterUs(jitter.a2dpUs);
+        a2dpBeep = A2dpBeepTracker();
+    } else if (!connected) {
+        nextA2dpCallUs = INT64_MAX;
+    }
+    bluetoothConnected = connected;
+}
+
+bool BluetoothA2DPSource::is_connected() {
+    return bluetoothConnected;
+}
+
+const std::vector<SimBeep>& simBeeps() {
+    return beeps;
+}
+
+void simClearBeeps() {
+    beeps.clear();
+    ledcBeepIndex = -1;
+}
+
+// --- Session Journal ---
+
+static std::vector<SessionRecord> sessions;
+
+void sessionJournalAppend(SessionRecord& record) {
+    record.seq = (uint32_t)sessions.size() + 1;
+    record.bootId = 0;
+    uint8_t buffer[SESSION_RECORD_MAX_BYTES];
+    size_t length = sessionRecordEncode(record, buffer);
+    SessionRecord decoded;
+    size_t recordBytes;
+    if (!sessionRecordDecode(buffer, length, decoded, recordBytes) || recordBytes != length) {
+        fprintf(stderr, "sim: session record %lu does not decode\n", (unsigned long)record.seq);
+        return;
+    }
+    sessions.push_back(decoded);
+}
+
+void sessionJournalFlush() {}
+
+uint32_t getDroppedSessionCount() {
+    return 0;
+}
+
+const std::vector<SessionRecord>& simSessions() {
+    return sessions;
+}
+
+// --- Loop ---
+
+void simLoopPass(int64_t untilUs) {
+    simStart();
+    uint32_t waitMs = loopWaitMs();
+    if (untilUs != INT64_MAX) {
+        int64_t leftMs = (std::max(untilUs - nowUs, (int64_t)0) + 999) / 1000;
+        waitMs = (uint32_t)std::min((int64_t)waitMs, leftMs);
+    }
+    waitForLoopEvents(waitMs);
+
+    auto passStart = std::chrono::steady_clock::now();
+    M5.update();
+    if (millis() - lastBatteryCheckTime > BATTERY_CHECK_INTERVAL_MS) {
+        checkBattery(); // Its deadline is one of loopWaitMs()'s
+    }
+    serviceTopButton();
+    runStateHandler();
+    loopBusyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - passStart).count();
+    loopPasses++;
+}
+
+bool simRunUntil(TimerState state, int64_t timeoutUs) {
+    int64_t endUs = nowUs + timeoutUs;
+    while (currentState != state) {
+        if (nowUs >= endUs) return false;
+        simLoopPass(endUs);
+    }
+    return true;
+}
+
+uint32_t simLoopPasses() {
+    return loopPasses;
+}
+
+int64_t simLoopBusyNs() {
+    return loopBusyNs;
+}
+
+// --- Arduino ---
+
+unsigned long millis() {
+    return (unsigned long)(nowUs / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)nowUs;
+}
+
+void delay(unsigned long ms) {
+    simAdvanceUs((int64_t)ms * 1000);
+}
+
+static uint32_t randomState = 1;
+
+void randomSeed(unsigned long seed) {
+    randomState = (uint32_t)seed | 1;
+}
+
+long random(long howbig) {
+    if (howbig <= 0) return 0;
+    randomState = randomState * 1664525u + 1013904223u;
+    return (long)((randomState >> 8) % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig) {
+    return (howsmall >= howbig) ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+int digitalRead(uint8_t) {
+    return HIGH; // Buttons are read through Button_Class
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+    if (pin < 64) pinIsrs[pin] = isr;
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+    if (pin == BUZZER_PIN) recordBeep(nowUs, (int)frequency, (int)duration, false);
+}
+
+void noTone(uint8_t) {}
+
+void ledcAttachPin(uint8_t, uint8_t) {}
+
+void ledcDetachPin(uint8_t) {}
+
+double ledcWriteTone(uint8_t, double frequency) {
+    if (ledcBeepIndex >= 0) {
+        beeps[ledcBeepIndex].durationMs = (int)((nowUs - beeps[ledcBeepIndex].startUs) / 1000);
+        ledcBeepIndex = -1;
+    }
+    if (frequency > 0) {
+        recordBeep(nowUs, (int)frequency, 0, false);
+        ledcBeepIndex = (int)beeps.size() - 1;
+    }
+    return frequency;
+}
+
+int SimSerial::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+// --- esp_timer ---
+
+int64_t esp_timer_get_time() {
+    return nowUs;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    espTimers.emplace_back(new SimEspTimer{args->callback, args->arg, INT64_MAX});
+    *handle = espTimers.back().get();
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs) {
+    timer->fireUs = nowUs + (int64_t)timeoutUs + jitterUs(jitter.espTimerUs);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->fireUs = INT64_MAX;
+    return ESP_OK;
+}
+
+// --- FreeRTOS ---
+
+void vTaskDelay(TickType_t ticks) {
+    simAdvanceUs((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char*, uint32_t, void* arg, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    SimTask* task = new SimTask{function, arg, 0, NULL, false, 0, false};
+    tasks.push_back(task);
+    std::thread(taskThread, task).detach();
+    if (handle) *handle = task;
+    return pdPASS;
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(nowUs / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return currentTask ? currentTask : &mainTask;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction) {
+    if (task == NULL) return pdFAIL;
+    task->notifyBits |= value;
+    task->notified = true;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xTaskNotify(task, value, action);
+}
+
+// Only loop()'s task waits: the clock runs until a notification or the
+// timeout, and a notified loop() wakes loopWakeUs of jitter later.
+BaseType_t xTaskNotifyWait(uint32_t clearOnEntry, uint32_t clearOnExit, uint32_t* value, TickType_t ticks) {
+    SimTask* task = &mainTask;
+    if (!task->notified) {
+        task->notifyBits &= ~clearOnEntry;
+        if (!currentTask && ticks > 0) {
+            advanceTo((ticks == portMAX_DELAY) ? INT64_MAX : nowUs + (int64_t)ticks * portTICK_PERIOD_MS * 1000, true);
+        }
+    }
+    bool notified = task->notified;
+    if (notified && !currentTask) advanceTo(nowUs + jitterUs(jitter.loopWakeUs), false);
+    if (value) *value = task->notifyBits;
+    if (notified) {
+        task->notifyBits &= ~clearOnExit;
+        task->notified = false;
+    }
+    return notified ? pdTRUE : pdFALSE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    return new SimQueue{length, itemSize, {}};
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t) {
+    if (queue == NULL || queue->items.size() >= queue->length) return pdFAIL;
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    return pdPASS;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+    if (queue == NULL) return pdFAIL;
+    queue->items.clear();
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    if (queue == NULL) return pdFAIL;
+    if (queue->items.empty() && currentTask && ticks > 0) {
+        taskBlock((ticks == portMAX_DELAY) ? INT64_MAX : nowUs + (int64_t)ticks * portTICK_PERIOD_MS * 1000, queue);
+    }
+    if (queue->items.empty()) return pdFAIL;
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdPASS;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    if (queue != NULL) queue->items.clear();
+    return pdPASS;
+}
@@ -0,0 +1,108 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+// Host simulation of the timer engine.
+// The firmware's timer modes, state machine, audio scheduling, shot capture
+// and IMU history are compiled unchanged against the stand-in headers in this
+// directory (Arduino.h, M5StickCPlus2.h, esp_timer.h, freertos/...), which run
+// on a virtual clock instead of hardware:
+//   - millis() / micros() / esp_timer_get_time() read the virtual clock, and
+//     delay() / vTaskDelay() advance it.
+//   - As time passes, completed mic blocks from the scripted mic source go
+//     through processMicBlock() (the capture task's code), IMU samples from
+//     the scripted IMU source are appended every IMU_DRAIN_INTERVAL_MS, and
+//     esp_timer deadlines fire, each a little late (SimJitter).
+//   - The real buzzerTask() runs as a task: it blocks on buzzerQueue and in
+//     vTaskDelay() and only runs while the main loop waits.
+//   - While Bluetooth is up the real A2DP callback, get_data_frames(), is
+//     asked for buffers as a sink would, and the tones in its output are found
+//     from the samples. Buzzer tones are recorded as tone() / the LEDC
+//     schedule play them.
+//   - The display does nothing; the last UI snapshot is kept.
+// Time only moves forward: a process is one continuous power-on, like the
+// device, so the sample clock anchoring holds across sessions.
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "state_machine.h"
+#include "ui_render.h"
+#include "session_log.h"
+
+// --- Virtual Clock ---
+int64_t simNowUs();
+void simAdvanceUs(int64_t us);
+
+// --- Timing Jitter ---
+// How late each asynchronous event may run after it is due; each gets its own
+// delay, uniform in [0, max], from a fixed-seed generator so runs repeat.
+// Without it every timestamp lands exactly on its deadline.
+struct SimJitter {
+    int64_t espTimerUs; // esp_timer callback dispatch (default 200)
+    int64_t micBlockUs; // I2S block handed to the capture task (default 1000)
+    int64_t a2dpUs;     // A2DP sink asking for a buffer (default 2000)
+    int64_t loopWakeUs; // loop() running after a notification (default 100)
+};
+void simSetJitter(const SimJitter& jitter);
+
+// --- Scripted Sources ---
+// Fills 'count' mic samples starting at sample 'firstSample' (sample n is
+// taken at n / MIC_SAMPLE_RATE_HZ seconds). Without a source the mic is silent.
+typedef std::function<void(uint64_t firstSample, int16_t* out, size_t count)> SimMicSource;
+void simSetMicSource(SimMicSource source);
+
+// Wall time spent in processMicBlock() so far, in ns: the detector's CPU cost.
+int64_t simMicProcessNs();
+
+// Accelerometer Z (G) at 'timeUs'. Without a source the stick lies still at 1 G.
+typedef std::function<float(int64_t timeUs)> SimImuSource;
+void simSetImuSource(SimImuSource source);
+
+// --- Buttons ---
+enum SimButton { SIM_BTN_A, SIM_BTN_B, SIM_BTN_PWR };
+// Both fire the button's GPIO interrupt (loop_events) at the current time.
+void simClick(SimButton button);                   // wasClicked() on the next pass
+void simSetPressed(SimButton button, bool pressed); // Held: pressedFor() counts from now
+void simClickAt(SimButton button, int64_t atUs);    // simClick() once the clock gets to 'atUs'
+
+// --- Bluetooth ---
+// While connected, tones go to the A2DP path and are heard after
+// currentBluetoothAudioOffsetMs, as on a real speaker. A BT beep is recorded
+// once it has ended, so some time after it was heard.
+void simSetBluetoothConnected(bool connected);
+
+// --- Beep Recorder ---
+struct SimBeep {
+    int64_t startUs;    // When it was heard
+    int frequencyHz;
+    int durationMs;
+    bool bluetooth;
+};
+const std::vector<SimBeep>& simBeeps();
+void simClearBeeps();
+
+// --- Session Journal ---
+// Finished strings, as the journal would read them back: each record goes
+// through sessionRecordEncode() / sessionRecordDecode() on the way in.
+const std::vector<SessionRecord>& simSessions();
+
+// --- Null Display ---
+const UiSnapshot& simLastUiSnapshot();
+
+// --- Loop ---
+// One pass of loop(): it blocks in waitForLoopEvents() for loopWaitMs(), as
+// the firmware does, but not past 'untilUs'; then buttons are latched, the
+// battery is checked when due, a BtnB long press is acted on and the current
+// state's handler runs from the firmware's table. Menu handlers are stubbed (sim_menus.cpp), so those
+// states just let the time pass.
+void simLoopPass(int64_t untilUs = INT64_MAX);
+
+// Passes run so far, and the wall time they took outside the wait, in ns.
+uint32_t simLoopPasses();
+int64_t simLoopBusyNs();
+
+// Runs passes until currentState is 'state' or 'timeoutUs' of virtual time
+// has passed. Returns true if the state was reached.
+bool simRunUntil(TimerState state, int64_t timeoutUs);
+
+#endif // SIM_HAL_H
@@ -0,0 +1,25 @@
+// Host simulation: the menu, Bluetooth and calibration screens' handlers with
+// nothing behind them. The simulation covers the drill screens; scenarios put
+// the machine on the screen they start from.
+
+#include "input_handler.h"
+#include "bluetooth_utils.h"
+#include "display_utils.h"
+
+// --- input_handler.h ---
+
+void handleModeSelectionInput() {}
+void handleSettingsInput() {}
+void handleEditSettingInput() {}
+void handleDeviceStatusInput() {}
+void handleListFilesInput() {}
+void handleCalibrationInput(TimerState) {}
+
+// --- bluetooth_utils.h ---
+
+void handleBluetoothScanning() {}
+void handleBtLatencyCalibration() {}
+
+// --- display_utils.h ---
+
+void handleBootSequence() {}
@@ -0,0 +1,405 @@
+// Whole timer sessions on the host simulation (host/sim): the firmware's timer
+// modes, audio scheduling and shot capture run unchanged on a virtual clock,
+// with scripted shots on the mic and recoil on the IMU.
+//   - Live Fire, on the buzzer and over Bluetooth: every shot is stamped within
+//     kToleranceUs of when it was fired and the splits follow from the start
+//     beep as it was heard.
+//   - Noisy Range: only shots with recoil count, neighbouring bays' do not.
+//   - Each finished string is journalled with its shots once the stopped
+//     screen is left, read back from the encoded record.
+//   - Dry Fire: the par beeps go out at the par times.
+//   - Start sequence: press to listening takes the ready hold plus the beep
+//     (and random delay, when set), and a second press cancels the start
+//     during the hold or the delay without a beep going out.
+//   - A BtnB long press during the hold or the delay, in Live Fire and Noisy
+//     Range alike, goes back to mode selection and drops the start.
+//   - loop() sleeps between events: how often it wakes on the mode menu and
+//     on a running string, and how soon a button edge wakes it.
+// Prints virtual vs wall time. Build and run with `make host`.
+
+#include "sim_hal.h"
+#include "globals.h"
+#include "config.h"
+#include "system_utils.h"
+#include "timer_modes.h"
+#include "state_dispatch.h"
+#include "loop_events.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const int64_t kToleranceUs = 2000;
+static const float kNoiseRms = 150.0f;
+static const float kBlastTauMs = 6.0f;
+static const float kReverbTauMs = 40.0f;
+static const float kReverbLevel = 0.1f;
+static const int64_t kShotSoundUs = 300000; // Tail length synthesized per shot
+static const float kRecoilG = 3.5f;
+
+struct RangeShot {
+    int64_t timeUs;  // Onset
+    float amplitude;
+    bool recoil;     // Fired by the shooter wearing the timer
+};
+
+// Every shot fired so far on the virtual range.
+static std::vector<RangeShot> rangeShots;
+static int failures = 0;
+
+static void expect(bool ok, const char* session, const char* what) {
+    if (!ok) {
+        printf("FAIL %s: %s\n", session, what);
+        failures++;
+    }
+}
+
+// Deterministic white noise in [-1, 1), a function of the sample index only,
+// so blocks can be generated in any order.
+static float noiseAt(uint64_t n, uint64_t salt) {
+    uint64_t z = n * 0x9E3779B97F4A7C15ULL + salt;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (float)(z >> 40) / (float)(1ULL << 23) - 1.0f;
+}
+
+static void rangeMic(uint64_t firstSample, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t n = firstSample + i;
+        int64_t tUs = (int64_t)(n * 1000000ULL / MIC_SAMPLE_RATE_HZ);
+        float v = kNoiseRms * 1.73f * noiseAt(n, 1); // Uniform noise of RMS kNoiseRms
+        for (const RangeShot& shot : rangeShots) {
+            if (tUs < shot.timeUs || tUs >= shot.timeUs + kShotSoundUs) continue;
+            float ms = (float)(tUs - shot.timeUs) / 1000.0f;
+            float env = expf(-ms / kBlastTauMs) + kReverbLevel * expf(-ms / kReverbTauMs);
+            v += shot.amplitude * env * noiseAt(n, 2);
+        }
+        out[i] = (int16_t)std::max(-32768.0f, std::min(32767.0f, v));
+    }
+}
+
+static float rangeImu(int64_t timeUs) {
+    for (const RangeShot& shot : rangeShots) {
+        if (shot.recoil && timeUs >= shot.timeUs + 2000 && timeUs < shot.timeUs + 20000) {
+            return kRecoilG;
+        }
+    }
+    return 1.0f;
+}
+
+static void fire(int64_t timeUs, bool recoil) {
+    rangeShots.push_back({timeUs, 20000.0f, recoil});
+}
+
+static void runFor(int64_t us) {
+    int64_t endUs = simNowUs() + us;
+    while (simNowUs() < endUs) {
+        simLoopPass(endUs);
+    }
+}
+
+// Start time of the first beep at the start tone since beep 'from'. A BT
+// beep is only recorded once it has played out, so passes run until it is
+// (at most 'waitUs').
+static bool findStartBeep(size_t from, bool bluetooth, int64_t& startUs, int64_t waitUs = 0) {
+    int64_t endUs = simNowUs() + waitUs;
+    for (;;) {
+        const std::vector<SimBeep>& beeps = simBeeps();
+        for (size_t i = from; i < beeps.size(); ++i) {
+            if (beeps[i].frequencyHz == currentBeepToneHz && beeps[i].bluetooth == bluetooth) {
+                startUs = beeps[i].startUs;
+                return true;
+            }
+        }
+        if (simNowUs() >= endUs) return false;
+        simLoopPass(endUs);
+    }
+}
+
+// Checks the recorded string against the shots that should have counted.
+static void checkString(const char* session, int64_t beepUs, const std::vector<int64_t>& truthUs) {
+    expect(shotCount == (int)truthUs.size(), session, "shot count");
+    int64_t worstUs = 0;
+    for (int i = 0; i < shotCount && i < (int)truthUs.size(); ++i) {
+        int64_t errorUs = (int64_t)shotTimestamps[i] * 1000 - truthUs[i];
+        worstUs = std::max(worstUs, std::abs(errorUs));
+        int64_t previousUs = (i == 0) ? beepUs : truthUs[i - 1];
+        float expectedSplit = (float)(truthUs[i] - previousUs) / 1e6f;
+        expect(fabsf(splitTimes[i] - expectedSplit) * 1e6f <= 2 * kToleranceUs, session, "split");
+    }
+    expect(worstUs <= kToleranceUs, session, "shot time");
+
+    printf("%-22s %d/%d shots, worst time error %.2f ms\n", session, shotCount, (int)truthUs.size(), worstUs / 1000.0);
+}
+
+// Leaves the stopped screen with BtnA and checks the string was journalled
+// on the way out, with the shots as they stood.
+static void leaveStopped(const char* session, TimerState ready) {
+    size_t sessionsBefore = simSessions().size();
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(ready, 1000000), session, "never left the stopped screen");
+
+    const std::vector<SessionRecord>& sessions = simSessions();
+    expect(sessions.size() == sessionsBefore + 1, session, "not journalled on leaving");
+    if (!sessions.empty()) {
+        const SessionRecord& record = sessions.back();
+        bool same = record.shotCount == shotCount && record.startMs == (uint32_t)startTime;
+        for (int i = 0; same && i < shotCount; ++i) {
+            same = record.shotMs[i] == (uint32_t)(shotTimestamps[i] - startTime);
+        }
+        expect(same, session, "journalled shots");
+    }
+}
+
+static void liveFireSession(const char* session, bool bluetooth) {
+    simSetBluetoothConnected(bluetooth);
+    currentMaxShots = 5;
+    setState(LIVE_FIRE_READY);
+    redrawMenu = true;
+    runFor(500000);
+
+    size_t beepsBefore = simBeeps().size();
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(LIVE_FIRE_TIMING, 5000000), session, "never started timing");
+    int64_t beepUs = 0;
+    expect(findStartBeep(beepsBefore, bluetooth, beepUs, 1000000), session, "no start beep");
+
+    const float splitsSec[] = {1.45f, 0.31f, 0.22f, 0.48f, 0.19f};
+    std::vector<int64_t> truthUs;
+    int64_t shotUs = beepUs;
+    for (float split : splitsSec) {
+        shotUs += (int64_t)(split * 1e6f) + 137; // Off the millisecond grid
+        fire(shotUs, true);
+        truthUs.push_back(shotUs);
+    }
+    expect(simRunUntil(LIVE_FIRE_STOPPED, 10000000), session, "never stopped");
+    checkString(session, beepUs, truthUs);
+    runFor(1000000); // Success cue
+    leaveStopped(session, LIVE_FIRE_READY);
+
+    // Press to listening: the hold, then the beep as heard plus the guard.
+    int64_t expectedMs = (int64_t)START_READY_HOLD_MS + currentBeepDuration + BEEP_LISTEN_GUARD_MS +
+                         (bluetooth ? currentBluetoothAudioOffsetMs : 0);
+    int64_t cycleMs = getStartSequenceStats().lastCycleMs;
+    expect(cycleMs >= expectedMs && cycleMs <= expectedMs + 3 * (int64_t)LOOP_TICK_MS, session, "start cycle time");
+}
+
+static void noisyRangeSession() {
+    const char* session = "noisy range";
+    simSetBluetoothConnected(false);
+    currentMaxShots = 3;
+    setState(NOISY_RANGE_READY);
+    redrawMenu = true;
+    runFor(500000);
+
+    size_t beepsBefore = simBeeps().size();
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(NOISY_RANGE_TIMING, 5000000), session, "never started timing");
+    int64_t beepUs = 0;
+    expect(findStartBeep(beepsBefore, false, beepUs, 1000000), session, "no start beep");
+
+    // Neighbouring bays fire around the shooter's own string.
+    std::vector<int64_t> truthUs;
+    const float ownSec[] = {1.6f, 2.2f, 2.75f};
+    const float neighbourSec[] = {1.25f, 1.9f, 2.5f};
+    for (int i = 0; i < 3; ++i) {
+        int64_t ownUs = beepUs + (int64_t)(ownSec[i] * 1e6f) + 389; // Off the millisecond grid
+        fire(beepUs + (int64_t)(neighbourSec[i] * 1e6f), false);
+        fire(ownUs, true);
+        truthUs.push_back(ownUs);
+    }
+    expect(simRunUntil(LIVE_FIRE_STOPPED, 10000000), session, "never stopped");
+    checkString(session, beepUs, truthUs);
+    runFor(1000000);
+    leaveStopped(session, NOISY_RANGE_READY);
+}
+
+// Presses again during the ready hold, then during the random delay: each
+// time the start is dropped straight away and no start beep goes out.
+static void startCancelSession() {
+    const char* session = "start cancel";
+    simSetBluetoothConnected(false);
+    const unsigned long cancelAfterMs[] = {400, START_READY_HOLD_MS + 700};
+    startRandomDelayMs = 2000; // At least 1 s of random delay
+    uint32_t worstUs = 0;
+    for (unsigned long afterMs : cancelAfterMs) {
+        setState(LIVE_FIRE_READY);
+        redrawMenu = true;
+        runFor(500000);
+
+        size_t beepsBefore = simBeeps().size();
+        simClick(SIM_BTN_A);
+        expect(simRunUntil(LIVE_FIRE_GET_READY, 100000), session, "never started");
+        runFor((int64_t)afterMs * 1000);
+        expect(currentState == LIVE_FIRE_GET_READY, session, "beep before the cancel");
+        uint32_t cancelsBefore = getStartSequenceStats().cancels;
+        simClickAt(SIM_BTN_A, simNowUs() + 3700); // Between two passes
+        simLoopPass();
+        simLoopPass();
+        expect(currentState == LIVE_FIRE_READY, session, "not cancelled on the next pass");
+        expect(getStartSequenceStats().cancels == cancelsBefore + 1, session, "cancel not counted");
+        worstUs = std::max(worstUs, getStartSequenceStats().lastCancelUs);
+
+        runFor(4000000);
+        int64_t beepUs = 0;
+        expect(!findStartBeep(beepsBefore, false, beepUs), session, "start beep after the cancel");
+        expect(currentState == LIVE_FIRE_READY, session, "left the ready screen");
+    }
+    expect(worstUs <= LOOP_TICK_MS * 1000, session, "cancel latency");
+    startRandomDelayMs = 0;
+    printf("%-22s 2/2 cancelled, worst latency %.2f ms\n", session, worstUs / 1000.0);
+}
+
+// Holds BtnB during the ready hold (Live Fire) and the random delay (Noisy
+// Range): both leave for mode selection, and the start beep never goes out.
+static void getReadyLongPressSession() {
+    const char* session = "get ready long press";
+    simSetBluetoothConnected(false);
+    startRandomDelayMs = 4000; // At least 2 s of random delay
+    const TimerState readyStates[] = {LIVE_FIRE_READY, NOISY_RANGE_READY};
+    const TimerState getReadyStates[] = {LIVE_FIRE_GET_READY, NOISY_RANGE_GET_READY};
+    const unsigned long pressAfterMs[] = {100, START_READY_HOLD_MS + 200};
+    int abandoned = 0;
+    for (int i = 0; i < 2; ++i) {
+        setState(readyStates[i]);
+        redrawMenu = true;
+        runFor(500000);
+
+        size_t beepsBefore = simBeeps().size();
+        simClick(SIM_BTN_A);
+        expect(simRunUntil(getReadyStates[i], 100000), session, "never started");
+        runFor((int64_t)pressAfterMs[i] * 1000);
+        simSetPressed(SIM_BTN_B, true);
+        bool left = simRunUntil(MODE_SELECTION, (int64_t)(LONG_PRESS_DURATION_MS + 3 * LOOP_TICK_MS) * 1000);
+        simSetPressed(SIM_BTN_B, false);
+        expect(left, session, stateName(getReadyStates[i]));
+
+        runFor(6000000);
+        int64_t beepUs = 0;
+        expect(!findStartBeep(beepsBefore, false, beepUs), session, "start beep after leaving");
+        expect(currentState == MODE_SELECTION, session, "left mode selection");
+        if (left && currentState == MODE_SELECTION) abandoned++;
+    }
+    startRandomDelayMs = 0;
+    printf("%-22s %d/2 back to mode selection\n", session, abandoned);
+}
+
+static void dryFireSession() {
+    const char* session = "dry fire";
+    simSetBluetoothConnected(false);
+    dryFireParBeepCount = 3;
+    dryFireParTimesSec[0] = 1.5f;
+    dryFireParTimesSec[1] = 0.85f;
+    setState(DRY_FIRE_READY);
+    redrawMenu = true;
+    runFor(500000);
+
+    size_t beepsBefore = simBeeps().size();
+    int64_t clickUs = simNowUs();
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(DRY_FIRE_RUNNING, 1000000), session, "never started");
+    expect(simRunUntil(DRY_FIRE_READY, 15000000), session, "never finished");
+
+    std::vector<SimBeep> parBeeps;
+    for (size_t i = beepsBefore; i < simBeeps().size(); ++i) {
+        if (simBeeps()[i].frequencyHz == currentBeepToneHz) parBeeps.push_back(simBeeps()[i]);
+    }
+    expect(parBeeps.size() == 3, session, "beep count");
+    int64_t worstUs = 0;
+    if (parBeeps.size() == 3) {
+        int64_t delayUs = parBeeps[0].startUs - clickUs;
+        expect(delayUs >= (int64_t)DRY_FIRE_RANDOM_DELAY_MIN_MS * 1000 - (int64_t)LOOP_TICK_MS * 1000 &&
+               delayUs <= (int64_t)DRY_FIRE_RANDOM_DELAY_MAX_MS * 1000 + (int64_t)LOOP_TICK_MS * 1000,
+               session, "random delay");
+        for (int i = 1; i < 3; ++i) {
+            int64_t parUs = (int64_t)(dryFireParTimesSec[i - 1] * 1e6f + 0.5f);
+            worstUs = std::max(worstUs, std::abs(parBeeps[i].startUs - parBeeps[i - 1].startUs - parUs));
+        }
+        for (const SimBeep& beep : parBeeps) {
+            expect(beep.durationMs == (int)currentBeepDuration, session, "beep length");
+        }
+    }
+    expect(worstUs <= kToleranceUs, session, "par time");
+    printf("%-22s %d/3 beeps, worst par error %.2f ms\n", session, (int)parBeeps.size(), worstUs / 1000.0);
+}
+
+// How often loop() wakes with nothing to do, on the mode menu and on a
+// string before the first shot, and how long a button edge takes to wake it
+// (the loop's own event latency stats).
+static void loopWakeSession() {
+    const char* session = "loop wakeups";
+    simSetBluetoothConnected(false);
+    setState(MODE_SELECTION);
+    resetActivityTimer();
+    runFor(200000);
+
+    // Clicks a second apart, each at a different point between two wakes.
+    for (int i = 0; i < 5; ++i) {
+        simClickAt(SIM_BTN_A, simNowUs() + 1000000 + i * 1733);
+        runFor(1100000);
+    }
+    LoopEventStats events = getLoopEventStats();
+
+    uint32_t passesBefore = simLoopPasses();
+    int64_t busyNsBefore = simLoopBusyNs();
+    int64_t fromUs = simNowUs();
+    runFor(20000000);
+    double idleSec = (simNowUs() - fromUs) / 1e6;
+    double idleWakes = (simLoopPasses() - passesBefore) / idleSec;
+    double idleBusyNs = (simLoopBusyNs() - busyNsBefore) / idleSec;
+
+    // A string waiting for its first shot: listening, the clock running.
+    currentMaxShots = 5;
+    setState(LIVE_FIRE_READY);
+    redrawMenu = true;
+    runFor(500000);
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(LIVE_FIRE_TIMING, 5000000), session, "never started timing");
+    runFor(1000000);
+    passesBefore = simLoopPasses();
+    fromUs = simNowUs();
+    runFor(10000000);
+    double timingWakes = (simLoopPasses() - passesBefore) / ((simNowUs() - fromUs) / 1e6);
+    expect(currentState == LIVE_FIRE_TIMING && is_listening_active, session, "not listening");
+    simClick(SIM_BTN_A);
+    expect(simRunUntil(LIVE_FIRE_STOPPED, 1000000), session, "never stopped");
+    runFor(1000000);
+
+    expect(events.maxUs <= 1000, session, "button to wake");
+    expect(idleWakes <= 1.0, session, "idle wakeups");
+    expect(timingWakes <= 1000.0 / DISPLAY_UPDATE_INTERVAL_MS + 1.0, session, "timing wakeups");
+    printf("%-22s %.2f/s idle (%.0f ns/s of host CPU), %.1f/s timing, button to wake max %.2f ms\n",
+           session, idleWakes, idleBusyNs, timingWakes, events.maxUs / 1000.0);
+}
+
+int main() {
+    // What setup() would have loaded from NVS.
+    shotThresholdRms = 1500;
+    shotMarginDb = 20;
+    recoilThreshold = 1.5f;
+    currentBluetoothAudioOffsetMs = 180;
+
+    simSetMicSource(rangeMic);
+    simSetImuSource(rangeImu);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    runFor(1000000); // Let the noise floor settle
+    liveFireSession("live fire (buzzer)", false);
+    liveFireSession("live fire (bluetooth)", true);
+    noisyRangeSession();
+    startCancelSession();
+    getReadyLongPressSession();
+    dryFireSession();
+    loopWakeSession();
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double virtualSec = simNowUs() / 1e6;
+
+    printf("%.1f s virtual in %.3f s wall (%.0fx real time)\n", virtualSec, wallSec, virtualSec / std::max(wallSec, 1e-6));
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,361 @@
+// Parameter sweep for the shot detector settings.
+// Runs the detection pipeline (ShotDetector, configured by shotOnsetConfig()
+// as in shotCaptureBegin() and re-armed when listening starts after the start
+// beep, and for recordings with an accelerometer trace the Noisy Range recoil
+// check, both by the rules in shot_config.h)
+// over a labelled corpus (host/shot_corpus.h) for every combination of
+// shotThresholdRms, shotMarginDb, shotLockoutMs and recoilThreshold on the
+// grid below. Each (recording x detector settings) tile runs on a
+// work-stealing thread pool across all cores; the recoil thresholds are
+// scored within the tile, as they only decide which onsets count. Prints the
+// Pareto front of miss rate against false-positive rate (false detections per
+// true shot) and can write one point as a settings file the device imports
+// at boot (detector_tuning.h).
+//   sweep_detector [--synthetic <per-kind>] [--threads <n>] [--pick <row>]
+//                  [--out <file>] [<dir or .wav>...]
+// Without --pick the point with the lowest miss + false-positive rate is
+// exported. `make sweep` (in code/) runs it on the synthetic corpus.
+
+#include "shot_corpus.h"
+#include "../config.h"
+#include "../detector_tuning.h"
+#include "../shot_config.h"
+#include "../shot_detector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const int kThresholdsRms[] = {0, 500, 1000, 1500, 2000, 3000, 4000, 6000};
+static const int kMarginsDb[] = {8, 12, 16, 20, 24, 28, 32};
+static const unsigned long kLockoutsMs[] = {20, 40, 60, 80, 120};
+static const float kRecoilsG[] = {1.2f, 1.5f, 2.0f, 2.5f, 3.0f};
+
+static const int kThresholdCount = sizeof(kThresholdsRms) / sizeof(kThresholdsRms[0]);
+static const int kMarginCount = sizeof(kMarginsDb) / sizeof(kMarginsDb[0]);
+static const int kLockoutCount = sizeof(kLockoutsMs) / sizeof(kLockoutsMs[0]);
+static const int kRecoilCount = sizeof(kRecoilsG) / sizeof(kRecoilsG[0]);
+static const int kDetectorSets = kThresholdCount * kMarginCount * kLockoutCount;
+
+static const int64_t kMatchWindowUs = 20000;
+static const unsigned long kBeepDurationMs = 150; // Default currentBeepDuration
+
+// --- Work-Stealing Pool ---
+// Each worker owns a deque of task indices, seeded with a contiguous slice; it
+// takes from the back of its own and, once that is empty, steals from the
+// front of the others'. Tiles vary a lot in cost (recording length, how many
+// onsets a low threshold lets through), so fixed slices would leave cores
+// idle at the end.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned threads) : threads_(std::max(threads, 1u)) {}
+
+    // Runs task(i) for every i in [0, count); returns once all are done.
+    void run(size_t count, const std::function<void(size_t)>& task) {
+        std::vector<Worker> workers(threads_);
+        for (size_t i = 0; i < count; ++i) {
+            workers[i * threads_ / count].tasks.push_back(i);
+        }
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < threads_; ++w) {
+            threads.emplace_back([&, w]() {
+                size_t index;
+                while (takeOwn(workers[w], index) || steal(workers, w, index)) {
+                    task(index);
+                }
+            });
+        }
+        for (std::thread& t : threads) t.join();
+    }
+
+    unsigned threads() const { return threads_; }
+    uint64_t steals() const { return steals_.load(); }
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    static bool takeOwn(Worker& worker, size_t& index) {
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.tasks.empty()) return false;
+        index = worker.tasks.back();
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    // No task is ever added once run() has started, so finding every other
+    // deque empty means this worker is done.
+    bool steal(std::vector<Worker>& workers, unsigned self, size_t& index) {
+        for (unsigned k = 1; k < threads_; ++k) {
+            Worker& victim = workers[(self + k) % threads_];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                index = victim.tasks.front();
+                victim.tasks.pop_front();
+                steals_++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    unsigned threads_;
+    std::atomic<uint64_t> steals_{0};
+};
+
+// --- Detection ---
+
+struct DetectorSet {
+    int thresholdRms;
+    int marginDb;
+    unsigned long lockoutMs;
+};
+
+static DetectorSet detectorSet(int index) {
+    DetectorSet set;
+    set.lockoutMs = kLockoutsMs[index % kLockoutCount];
+    index /= kLockoutCount;
+    set.marginDb = kMarginsDb[index % kMarginCount];
+    set.thresholdRms = kThresholdsRms[index / kMarginCount];
+    return set;
+}
+
+// Counts and errors of one tile for every recoil threshold.
+struct TileScore {
+    int shots;
+    int misses;
+    int falsePositives;
+    int64_t sumAbsErrorUs;
+    int64_t maxAbsErrorUs;
+};
+
+static float peakAbsAccelZ(const ShotRecording& rec, double fromSec, double toSec) {
+    int64_t first = std::max((int64_t)0, (int64_t)ceil(fromSec * rec.accelRateHz));
+    int64_t last = std::min((int64_t)rec.accelZ.size() - 1, (int64_t)floor(toSec * rec.accelRateHz));
+    float peak = 0.0f;
+    for (int64_t i = first; i <= last; ++i) {
+        peak = std::max(peak, fabsf(rec.accelZ[i]));
+    }
+    return peak;
+}
+
+static void runTile(const ShotRecording& rec, const DetectorSet& set, TileScore* scores) {
+    OnsetDetectorConfig config = shotOnsetConfig(set.marginDb, set.thresholdRms, set.lockoutMs);
+    ShotDetector detector;
+    detector.configure(config);
+
+    // Listening starts once the start beep has ended, plus the guard. As in
+    // processMicBlock(), the arm request re-arms the detector on the first
+    // block handed over after that, keeping the noise floor.
+    const double listenSec = rec.beepSec + listenDelayMs(kBeepDurationMs) / 1000.0;
+    const size_t listenSample = (size_t)(listenSec * rec.sampleRateHz);
+    bool armed = false;
+    std::vector<int64_t> onsetsUs;
+    ShotEvent events[4];
+    for (size_t o = 0; o + MIC_CAPTURE_BLOCK_SAMPLES <= rec.pcm.size(); o += MIC_CAPTURE_BLOCK_SAMPLES) {
+        if (!armed && o + MIC_CAPTURE_BLOCK_SAMPLES > listenSample) {
+            detector.setThresholds((float)set.marginDb, ONSET_HYSTERESIS_DB, (float)set.thresholdRms);
+            armed = true;
+        }
+        size_t n = detector.process(&rec.pcm[o], MIC_CAPTURE_BLOCK_SAMPLES, events, 4);
+        for (size_t i = 0; i < n; ++i) {
+            if (events[i].timeUs >= (int64_t)(listenSec * 1e6)) onsetsUs.push_back(events[i].timeUs);
+        }
+    }
+
+    std::vector<int64_t> truthUs;
+    for (double t : rec.shotSec) truthUs.push_back((int64_t)llround(t * 1e6));
+
+    for (int r = 0; r < kRecoilCount; ++r) {
+        std::vector<int64_t> countedUs;
+        for (int64_t t : onsetsUs) {
+            if (rec.accelRateHz == 0 ||
+                recoilConfirmsShot(peakAbsAccelZ(rec, recoilWindowStartUs(t) / 1e6, recoilWindowEndUs(t) / 1e6), kRecoilsG[r])) {
+                countedUs.push_back(t);
+            }
+        }
+        ShotMatch match;
+        matchShots(truthUs, countedUs, kMatchWindowUs, match);
+        TileScore& score = scores[r];
+        score = TileScore{match.shots, match.misses, match.falsePositives, 0, 0};
+        for (int64_t e : match.errorsUs) {
+            score.sumAbsErrorUs += std::llabs(e);
+            score.maxAbsErrorUs = std::max(score.maxAbsErrorUs, (int64_t)std::llabs(e));
+        }
+    }
+}
+
+// --- Results ---
+
+struct SweepPoint {
+    DetectorSet set;
+    float recoilG;
+    TileScore total;
+
+    double missRate() const { return total.shots ? (double)total.misses / total.shots : 0.0; }
+    double falsePositiveRate() const { return total.shots ? (double)total.falsePositives / total.shots : 0.0; }
+    double meanErrorMs() const {
+        int hits = total.shots - total.misses;
+        return hits ? total.sumAbsErrorUs / 1000.0 / hits : 0.0;
+    }
+};
+
+static void printPoint(const char* label, const SweepPoint& p) {
+    printf("%-8s %6d %6d %7lu %6.1f %7.1f%% %7.1f%% %8.2f %8.2f\n", label, p.set.thresholdRms, p.set.marginDb,
+           p.set.lockoutMs, p.recoilG, 100.0 * p.missRate(), 100.0 * p.falsePositiveRate(), p.meanErrorMs(),
+           p.total.maxAbsErrorUs / 1000.0);
+}
+
+// Lowest miss rate first; a point stays only if it has fewer false positives
+// than every point before it.
+static std::vector<SweepPoint> paretoFront(std::vector<SweepPoint> points) {
+    std::sort(points.begin(), points.end(), [](const SweepPoint& a, const SweepPoint& b) {
+        if (a.total.misses != b.total.misses) return a.total.misses < b.total.misses;
+        if (a.total.falsePositives != b.total.falsePositives) return a.total.falsePositives < b.total.falsePositives;
+        return a.total.sumAbsErrorUs < b.total.sumAbsErrorUs;
+    });
+    std::vector<SweepPoint> front;
+    for (const SweepPoint& p : points) {
+        if (front.empty() || p.total.falsePositives < front.back().total.falsePositives) {
+            front.push_back(p);
+        }
+    }
+    return front;
+}
+
+static bool writeTuning(const std::string& path, const SweepPoint& p) {
+    DetectorTuning tuning;
+    tuning.shotThresholdRms = p.set.thresholdRms;
+    tuning.shotMarginDb = p.set.marginDb;
+    tuning.shotLockoutMs = (uint32_t)p.set.lockoutMs;
+    tuning.recoilThreshold = p.recoilG;
+    uint8_t blob[DETECTOR_TUNING_BYTES];
+    detectorTuningEncode(tuning, blob);
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)blob, sizeof(blob));
+    return (bool)out;
+}
+
+int main(int argc, char** argv) {
+    std::vector<ShotRecording> corpus;
+    unsigned threads = std::thread::hardware_concurrency();
+    int pick = -1;
+    std::string outPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--synthetic" && i + 1 < argc) {
+            std::vector<ShotRecording> synthetic = generateSyntheticCorpus(atoi(argv[++i]), 1);
+            corpus.insert(corpus.end(), synthetic.begin(), synthetic.end());
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = (unsigned)atoi(argv[++i]);
+        } else if (arg == "--pick" && i + 1 < argc) {
+            pick = atoi(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            std::vector<std::string> paths;
+            if (std::filesystem::is_directory(arg)) {
+                paths = listRecordings(arg);
+            } else {
+                paths.push_back(arg);
+            }
+            for (const std::string& path : paths) {
+                ShotRecording rec;
+                std::string error;
+                if (!loadRecording(path, rec, error)) {
+                    printf("%s: %s\n", path.c_str(), error.c_str());
+                    return 1;
+                }
+                if (rec.sampleRateHz != MIC_SAMPLE_RATE_HZ) {
+                    printf("%s: recorded at %u Hz, the mic runs at %u Hz\n", path.c_str(), rec.sampleRateHz, MIC_SAMPLE_RATE_HZ);
+                    return 1;
+                }
+                corpus.push_back(rec);
+            }
+        }
+    }
+    if (corpus.empty()) {
+        printf("usage: %s [--synthetic <per-kind>] [--threads <n>] [--pick <row>] [--out <file>] [<dir or .wav>...]\n", argv[0]);
+        return 1;
+    }
+
+    // Tile t is recording t % corpus.size() with detector set t / corpus.size().
+    const size_t tileCount = corpus.size() * kDetectorSets;
+    std::vector<TileScore> tileScores(tileCount * kRecoilCount);
+    WorkStealingPool pool(threads);
+    auto wallStart = std::chrono::steady_clock::now();
+    pool.run(tileCount, [&](size_t tile) {
+        runTile(corpus[tile % corpus.size()], detectorSet((int)(tile / corpus.size())), &tileScores[tile * kRecoilCount]);
+    });
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    double audioSec = 0.0;
+    for (const ShotRecording& rec : corpus) audioSec += rec.durationSec();
+    printf("%d recordings (%.0f s of audio) x %d settings = %zu tiles on %u threads in %.2f s (%llu steals, %.0f audio-s/s)\n",
+           (int)corpus.size(), audioSec, kDetectorSets * kRecoilCount, tileCount, pool.threads(), wallSec,
+           (unsigned long long)pool.steals(), audioSec * kDetectorSets / std::max(wallSec, 1e-6));
+
+    std::vector<SweepPoint> points;
+    for (int d = 0; d < kDetectorSets; ++d) {
+        for (int r = 0; r < kRecoilCount; ++r) {
+            SweepPoint p = {detectorSet(d), kRecoilsG[r], {0, 0, 0, 0, 0}};
+            for (size_t rec = 0; rec < corpus.size(); ++rec) {
+                const TileScore& s = tileScores[(d * corpus.size() + rec) * kRecoilCount + r];
+                p.total.shots += s.shots;
+                p.total.misses += s.misses;
+                p.total.falsePositives += s.falsePositives;
+                p.total.sumAbsErrorUs += s.sumAbsErrorUs;
+                p.total.maxAbsErrorUs = std::max(p.total.maxAbsErrorUs, s.maxAbsErrorUs);
+            }
+            points.push_back(p);
+        }
+    }
+    std::vector<SweepPoint> front = paretoFront(points);
+
+    printf("%-8s %6s %6s %7s %6s %8s %8s %8s %8s\n", "", "thrRms", "margin", "lockout", "recoil", "miss", "false+",
+           "mean ms", "max ms");
+    for (const SweepPoint& p : points) {
+        if (p.set.thresholdRms == 0 && p.set.marginDb == SHOT_MARGIN_DB_DEFAULT && p.set.lockoutMs == SHOT_MIN_LOCKOUT_MS && p.recoilG == 1.5f) {
+            printPoint("default", p);
+        }
+    }
+    int best = 0;
+    for (size_t i = 0; i < front.size(); ++i) {
+        char label[24];
+        snprintf(label, sizeof(label), "%zu", i);
+        printPoint(label, front[i]);
+        if (front[i].missRate() + front[i].falsePositiveRate() < front[best].missRate() + front[best].falsePositiveRate()) {
+            best = (int)i;
+        }
+    }
+
+    int chosen = (pick >= 0) ? pick : best;
+    if (chosen >= (int)front.size()) {
+        printf("--pick %d: the front has %d rows\n", pick, (int)front.size());
+        return 1;
+    }
+    printf("chosen: row %d\n", chosen);
+    if (!outPath.empty()) {
+        if (!writeTuning(outPath, front[chosen])) {
+            printf("could not write %s\n", outPath.c_str());
+            return 1;
+        }
+        printf("wrote %s: `make flash-tuning` adds it to the device's LittleFS; it is imported at the next boot\n",
+               outPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Host round-trip test for the packed boot animation.
+// Decodes every frame of a boot.anim with the firmware decoder and compares
+// it with the frames the packer intended (its --dump-frames output), and
+// checks the reported dirty rows cover every change.
+// Build and run with `make test-boot-anim`.
+
+#include "../boot_anim.h"
+#include "../le_bytes.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? (size_t)size : 0);
+    bool ok = fread(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s boot.anim frames.rgb565\n", argv[0]);
+        return 2;
+    }
+    std::vector<uint8_t> pack, expected;
+    if (!readFile(argv[1], pack) || !readFile(argv[2], expected)) {
+        fprintf(stderr, "cannot read input files\n");
+        return 2;
+    }
+
+    BootAnimHeader header;
+    if (!bootAnimParseHeader(pack.data(), pack.size(), header)) {
+        fprintf(stderr, "FAIL: bad header\n");
+        return 1;
+    }
+    const size_t pixelCount = (size_t)header.width * header.height;
+    const size_t indexEnd = BOOT_ANIM_HEADER_BYTES + 4 * ((size_t)header.frameCount + 1);
+    if (indexEnd > pack.size() || expected.size() != pixelCount * 2 * header.frameCount) {
+        fprintf(stderr, "FAIL: pack / reference sizes do not match the header\n");
+        return 1;
+    }
+
+    std::vector<uint16_t> frame(pixelCount, 0), previous(pixelCount, 0);
+    size_t totalOps = 0;
+    for (int i = 0; i < header.frameCount; ++i) {
+        uint32_t begin = readU32(&pack[BOOT_ANIM_HEADER_BYTES + 4 * i]);
+        uint32_t end = readU32(&pack[BOOT_ANIM_HEADER_BYTES + 4 * (i + 1)]);
+        if (begin < indexEnd || end < begin || end > pack.size() || end - begin > header.maxFrameBytes) {
+            fprintf(stderr, "FAIL: frame %d index entry out of range\n", i + 1);
+            return 1;
+        }
+        int dirtyBegin, dirtyEnd;
+        if (!bootAnimDecodeFrame(&pack[begin], end - begin, frame.data(), header.width, header.height,
+                                 dirtyBegin, dirtyEnd)) {
+            fprintf(stderr, "FAIL: frame %d does not decode\n", i + 1);
+            return 1;
+        }
+        if (memcmp(frame.data(), &expected[pixelCount * 2 * i], pixelCount * 2) != 0) {
+            fprintf(stderr, "FAIL: frame %d differs from the packer's\n", i + 1);
+            return 1;
+        }
+        for (size_t p = 0; p < pixelCount; ++p) {
+            int row = (int)(p / header.width);
+            if (frame[p] != previous[p] && (row < dirtyBegin || row >= dirtyEnd)) {
+                fprintf(stderr, "FAIL: frame %d changed row %d outside its dirty rows\n", i + 1, row);
+                return 1;
+            }
+        }
+        previous = frame;
+        totalOps += end - begin;
+    }
+
+    printf("boot.anim: %d frames %dx%d x%d round-trip OK (%zu bytes of ops, %.1f%% of raw RGB565)\n",
+           header.frameCount, header.width, header.height, header.scale, totalOps,
+           100.0 * totalOps / (pixelCount * 2.0 * header.frameCount));
+    return 0;
+}
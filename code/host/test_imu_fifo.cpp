@@ -0,0 +1,119 @@
+// Host test for the IMU FIFO parser (imu_fifo.h).
+// Feeds a byte stream laid out like the MPU6886 FIFO (accel + TEMP_OUT per
+// packet) through drains of varying size, in the drain task's burst chunks,
+// and checks every sample decodes to its own axes with a timestamp one
+// period after the last; then checks that an overflow asks for a reset and
+// the clock is anchored again afterwards.
+// Build and run with `make test-imu-fifo`.
+
+#include "../imu_fifo.h"
+
+#include <cstdio>
+#include <vector>
+
+static const uint32_t kRateHz = 1000;
+static const int64_t kPeriodUs = 1000;
+static const int kBurstPackets = 16;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Sample n: distinct axes and a temperature reading that must be skipped.
+static int16_t axisValue(uint32_t n, int axis) {
+    return (int16_t)(n * 3 + axis * 1000 - 20000);
+}
+
+static void appendPacket(std::vector<uint8_t>& fifo, uint32_t n) {
+    for (int axis = 0; axis < 3; ++axis) {
+        uint16_t v = (uint16_t)axisValue(n, axis);
+        fifo.push_back((uint8_t)(v >> 8));
+        fifo.push_back((uint8_t)v);
+    }
+    fifo.push_back(0x7F); // TEMP_OUT_H
+    fifo.push_back(0xA5); // TEMP_OUT_L
+}
+
+// Reads 'packets' whole packets from the front of 'fifo' the way the drain
+// task does, in bursts of at most kBurstPackets.
+static void drain(ImuFifoReader& reader, std::vector<uint8_t>& fifo, int packets, std::vector<ImuSample>& out) {
+    size_t pos = 0;
+    ImuSample samples[kBurstPackets];
+    while (packets > 0) {
+        int chunk = packets < kBurstPackets ? packets : kBurstPackets;
+        reader.decode(fifo.data() + pos, chunk, samples);
+        out.insert(out.end(), samples, samples + chunk);
+        pos += (size_t)chunk * IMU_FIFO_PACKET_BYTES;
+        packets -= chunk;
+    }
+    fifo.erase(fifo.begin(), fifo.begin() + pos);
+}
+
+static void testStream() {
+    ImuFifoReader reader(kRateHz, 1);
+    std::vector<uint8_t> fifo;
+    std::vector<ImuSample> samples;
+    uint32_t written = 0;
+    int64_t nowUs = 5000000;
+
+    // Drains of 0 to 40 packets, with a part-written packet left over now and then.
+    for (int round = 0; round < 60; ++round) {
+        int newPackets = (round * 7) % 41;
+        for (int i = 0; i < newPackets; ++i) appendPacket(fifo, written++);
+        nowUs += newPackets * kPeriodUs;
+        size_t partial = (round % 3 == 0) ? 3 : 0;
+        int packets = reader.beginDrain(0, (int)(fifo.size() + partial), nowUs);
+        expect(packets == (int)(fifo.size() / IMU_FIFO_PACKET_BYTES), "whole packets only");
+        drain(reader, fifo, packets, samples);
+    }
+
+    expect(samples.size() == written, "sample count");
+    bool axesOk = true;
+    bool periodOk = true;
+    for (size_t n = 0; n < samples.size(); ++n) {
+        axesOk = axesOk && samples[n].ax == axisValue((uint32_t)n, 0) &&
+                 samples[n].ay == axisValue((uint32_t)n, 1) && samples[n].az == axisValue((uint32_t)n, 2);
+        if (n > 0) periodOk = periodOk && samples[n].timeUs - samples[n - 1].timeUs >= kPeriodUs;
+    }
+    expect(axesOk, "axes decode in packet order, TEMP_OUT skipped");
+    expect(periodOk, "timestamps one period apart (or slewed later)");
+    expect(!samples.empty() && samples.back().timeUs <= nowUs, "newest sample not after the drain");
+}
+
+static void testOverflow() {
+    ImuFifoReader reader(kRateHz, 1);
+    std::vector<uint8_t> fifo;
+    std::vector<ImuSample> samples;
+    for (uint32_t n = 0; n < 10; ++n) appendPacket(fifo, n);
+    drain(reader, fifo, reader.beginDrain(0, (int)fifo.size(), 1000000), samples);
+    int64_t lastBefore = samples.back().timeUs;
+
+    expect(reader.beginDrain(IMU_INT_STATUS_FIFO_OFLOW, 64, 1100000) == -1, "overflow flag asks for a reset");
+    expect(reader.beginDrain(0, IMU_FIFO_SIZE_BYTES, 1100000) == -1, "full FIFO asks for a reset");
+
+    // After the reset the clock is anchored on the new samples, not carried
+    // over the gap.
+    fifo.clear();
+    for (uint32_t n = 0; n < 4; ++n) appendPacket(fifo, n);
+    int packets = reader.beginDrain(0, (int)fifo.size(), 2000000);
+    expect(packets == 4, "packets after the reset");
+    drain(reader, fifo, packets, samples);
+    expect(samples.back().timeUs == 2000000, "newest sample anchored at the drain after a reset");
+    expect(samples[samples.size() - 4].timeUs > lastBefore + 500000, "gap kept across the reset");
+}
+
+int main() {
+    testStream();
+    testOverflow();
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("imu fifo: %d-byte packets OK, overflow OK\n", IMU_FIFO_PACKET_BYTES);
+    return 0;
+}
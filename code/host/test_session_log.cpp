@@ -0,0 +1,118 @@
+// Host test for the session journal record format (session_log.h).
+// Round-trips records through the encoder and decoder, including the varint
+// boundaries, and checks that a torn or corrupted record is rejected instead
+// of being read back as a different string.
+// Build and run with `make test-session-log`.
+
+#include "../session_log.h"
+
+#include <cstdio>
+#include <cstring>
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+static SessionRecord makeRecord(int shots) {
+    SessionRecord record;
+    memset(&record, 0, sizeof(record));
+    record.seq = 4097;
+    record.startMs = 0xDEADBEEF;
+    record.settingsHash = 0x12345678;
+    record.bootId = 513;
+    record.mode = 2;
+    record.shotCount = (uint8_t)shots;
+    uint32_t shotMs = 0;
+    for (int i = 0; i < shots; ++i) {
+        shotMs += 150 + 97 * i;
+        record.shotMs[i] = shotMs;
+    }
+    return record;
+}
+
+static bool sameRecord(const SessionRecord& a, const SessionRecord& b) {
+    if (a.seq != b.seq || a.startMs != b.startMs || a.settingsHash != b.settingsHash ||
+        a.bootId != b.bootId || a.mode != b.mode || a.shotCount != b.shotCount) {
+        return false;
+    }
+    for (int i = 0; i < a.shotCount; ++i) {
+        if (a.shotMs[i] != b.shotMs[i]) return false;
+    }
+    return true;
+}
+
+static void testRoundTrip() {
+    uint8_t buffer[SESSION_RECORD_MAX_BYTES];
+    for (int shots = 0; shots <= SESSION_RECORD_MAX_SHOTS; ++shots) {
+        SessionRecord record = makeRecord(shots);
+        size_t length = sessionRecordEncode(record, buffer);
+        SessionRecord decoded;
+        size_t recordBytes = 0;
+        expect(sessionRecordDecode(buffer, length, decoded, recordBytes), "decode");
+        expect(recordBytes == length, "record length");
+        expect(sameRecord(record, decoded), "round trip");
+    }
+
+    // Splits on each side of the 1- to 5-byte varint boundaries.
+    const uint32_t splits[] = {0, 127, 128, 16383, 16384, 2097151, 2097152, 268435455, 268435456, 0xFFFFFFFF};
+    SessionRecord record = makeRecord(0);
+    uint32_t shotMs = 0;
+    for (uint32_t split : splits) {
+        shotMs += split;
+        record.shotMs[record.shotCount++] = shotMs;
+    }
+    size_t length = sessionRecordEncode(record, buffer);
+    expect(length == SESSION_RECORD_HEADER_BYTES + 1 + 1 + 2 + 2 + 3 + 3 + 4 + 4 + 5 + 5, "varint lengths");
+    SessionRecord decoded;
+    size_t recordBytes = 0;
+    expect(sessionRecordDecode(buffer, length, decoded, recordBytes) && sameRecord(record, decoded),
+           "varint boundaries");
+}
+
+static void testRejected() {
+    uint8_t buffer[SESSION_RECORD_MAX_BYTES + 16];
+    SessionRecord record = makeRecord(8);
+    size_t length = sessionRecordEncode(record, buffer);
+    SessionRecord decoded;
+    size_t recordBytes = 0;
+
+    // Cut short anywhere: a record torn by a reset mid-write.
+    for (size_t cut = 0; cut < length; ++cut) {
+        expect(!sessionRecordDecode(buffer, cut, decoded, recordBytes), "torn record accepted");
+    }
+
+    // Any flipped bit, in the header or the payload.
+    for (size_t i = 0; i < length; ++i) {
+        buffer[i] ^= 0x10;
+        expect(!sessionRecordDecode(buffer, length, decoded, recordBytes), "corrupted record accepted");
+        buffer[i] ^= 0x10;
+    }
+
+    // Trailing bytes (the next record) are left alone.
+    memset(buffer + length, 0xA5, 16);
+    expect(sessionRecordDecode(buffer, length + 16, decoded, recordBytes) && recordBytes == length,
+           "record followed by more data");
+
+    // Index entries.
+    uint8_t entry[SESSION_INDEX_ENTRY_BYTES];
+    uint32_t seq = 0, offset = 0;
+    sessionIndexEncode(0xCAFEF00D, 65535, entry);
+    sessionIndexDecode(entry, seq, offset);
+    expect(seq == 0xCAFEF00D && offset == 65535, "index entry");
+}
+
+int main() {
+    testRoundTrip();
+    testRejected();
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("session log: records OK\n");
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Host harness for the capture task's shot timestamps (shot_capture.cpp).
+// Feeds synthetic PCM - noise with shots at known, off-grid times - through
+// processMicBlock() block by block, the way micCaptureTask() hands over each
+// completed DMA buffer, and checks every ShotEvent is stamped within
+// kMaxErrorUs of the true onset on the esp_timer clock while:
+//   - blocks are handed over up to kJitterUs after they complete,
+//   - now and then a block is held up kStallUs (a display redraw or flash
+//     write) and the ones behind it arrive back to back,
+//   - the mic's sample clock runs kDriftPpm fast against esp_timer.
+// Build and run with `make test-shot-timestamps`.
+
+#include <Arduino.h>
+#include "globals.h"
+#include "config.h"
+#include "shot_capture.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const int64_t kMaxErrorUs = 1000;
+static const int64_t kJitterUs = 3000;
+static const int64_t kStallUs = 40000;
+static const int kStallEveryBlocks = 97;
+static const double kDriftPpm = 50.0;
+static const double kRunSec = 120.0;
+static const float kNoiseRms = 150.0f;
+static const float kShotAmplitude = 20000.0f;
+static const float kShotTauMs = 6.0f;
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Deterministic white noise in [-1, 1) from the sample index.
+static float noiseAt(uint64_t n, uint64_t salt) {
+    uint64_t z = n * 0x9E3779B97F4A7C15ULL + salt;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (float)(z >> 40) / (float)(1ULL << 23) - 1.0f;
+}
+
+static uint32_t lcgState = 12345;
+
+static uint32_t nextRandom(uint32_t range) {
+    lcgState = lcgState * 1664525u + 1013904223u;
+    return (lcgState >> 8) % range;
+}
+
+// esp_timer time sample 'n' is taken at: the mic clock runs kDriftPpm fast
+// and sample 0 is taken at 'zeroUs'.
+static double sampleTimeUs(double n, int64_t zeroUs) {
+    return (double)zeroUs + n * 1e6 / (MIC_SAMPLE_RATE_HZ * (1.0 + kDriftPpm * 1e-6));
+}
+
+int main() {
+    shotThresholdRms = 1500;
+    shotMarginDb = 20;
+    shotCaptureBegin();
+
+    const int64_t zeroUs = 2500000; // Capture starts a while after boot
+    const uint64_t totalSamples = (uint64_t)(kRunSec * MIC_SAMPLE_RATE_HZ);
+    const uint64_t settleSamples = MIC_SAMPLE_RATE_HZ; // Noise floor settles, then capture is armed
+
+    // Shots 250-800 ms apart, off the sample grid, from 1.5 s on.
+    std::vector<double> shotSample;
+    for (double n = 1.5 * MIC_SAMPLE_RATE_HZ; n < totalSamples - MIC_SAMPLE_RATE_HZ;) {
+        shotSample.push_back(n + nextRandom(1000) / 1000.0);
+        n += (250 + nextRandom(550)) * MIC_SAMPLE_RATE_HZ / 1000.0;
+    }
+
+    std::vector<ShotEvent> events;
+    bool armed = false;
+    size_t nextShot = 0;
+    int64_t stallUntilUs = 0;
+    int16_t block[MIC_CAPTURE_BLOCK_SAMPLES];
+    for (uint64_t first = 0; first + MIC_CAPTURE_BLOCK_SAMPLES <= totalSamples; first += MIC_CAPTURE_BLOCK_SAMPLES) {
+        while (nextShot < shotSample.size() && shotSample[nextShot] + kShotTauMs * 20 * MIC_SAMPLE_RATE_HZ / 1000 < first) {
+            nextShot++;
+        }
+        for (int i = 0; i < MIC_CAPTURE_BLOCK_SAMPLES; ++i) {
+            uint64_t n = first + i;
+            float v = kNoiseRms * 1.73f * noiseAt(n, 1);
+            for (size_t s = nextShot; s < shotSample.size() && shotSample[s] <= (double)n; ++s) {
+                float ms = (float)(((double)n - shotSample[s]) * 1000.0 / MIC_SAMPLE_RATE_HZ);
+                v += kShotAmplitude * expf(-ms / kShotTauMs) * noiseAt(n, 2);
+            }
+            block[i] = (int16_t)std::max(-32768.0f, std::min(32767.0f, v));
+        }
+
+        // Handed over when the last sample is in, plus scheduling jitter; a
+        // stalled block holds up the ones behind it.
+        int64_t completeUs = (int64_t)sampleTimeUs((double)(first + MIC_CAPTURE_BLOCK_SAMPLES), zeroUs);
+        int64_t deliveredUs = completeUs + nextRandom((uint32_t)kJitterUs + 1);
+        uint64_t blockNumber = first / MIC_CAPTURE_BLOCK_SAMPLES;
+        if (blockNumber % kStallEveryBlocks == kStallEveryBlocks - 1) {
+            stallUntilUs = completeUs + kStallUs;
+        }
+        deliveredUs = std::max(deliveredUs, stallUntilUs);
+
+        processMicBlock(block, deliveredUs);
+        if (!armed && first + MIC_CAPTURE_BLOCK_SAMPLES >= settleSamples) {
+            armShotCapture(); // Stamped at esp_timer 0 on the host, so nothing is discarded
+            armed = true;
+        }
+        ShotEvent event;
+        while (popShotEvent(event)) {
+            events.push_back(event);
+        }
+    }
+
+    // Shots fired before capture was armed are not looked for.
+    std::vector<double> truthUs;
+    for (double n : shotSample) {
+        if (n >= (double)settleSamples) truthUs.push_back(sampleTimeUs(n, zeroUs));
+    }
+
+    expect(events.size() == truthUs.size(), "one event per shot");
+    int64_t worstUs = 0;
+    double sumUs = 0.0;
+    for (size_t i = 0; i < events.size() && i < truthUs.size(); ++i) {
+        int64_t errorUs = events[i].timeUs - (int64_t)llround(truthUs[i]);
+        worstUs = std::max(worstUs, std::abs(errorUs));
+        sumUs += std::abs(errorUs);
+    }
+    expect(worstUs < kMaxErrorUs, "timestamp error under 1 ms");
+
+    if (failures) {
+        printf("%d check(s) failed (%zu events for %zu shots, worst error %lld us)\n",
+               failures, events.size(), truthUs.size(), (long long)worstUs);
+        return 1;
+    }
+    printf("shot timestamps: %zu shots, worst error %lld us, mean %.0f us "
+           "(0-%lld us jitter, %lld ms stalls, %.0f ppm drift)\n",
+           events.size(), (long long)worstUs, sumUs / std::max(events.size(), (size_t)1),
+           (long long)kJitterUs, (long long)(kStallUs / 1000), kDriftPpm);
+    return 0;
+}
@@ -0,0 +1,261 @@
+// Host test for the state machine (state_machine.h).
+// Checks the state table's flags against the comparison chains loop() used
+// before the table, so moving a state between groups is a deliberate change;
+// walks the drills through the transition table event by event and checks
+// which entry and exit actions run, in what order and with what arguments;
+// and checks the trace ring's ordering and wrap-around.
+// Build and run with `make test-state-machine`.
+
+#include "../state_machine.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+
+static int failures = 0;
+
+static void expect(bool ok, const char* what, TimerState state) {
+    if (!ok) {
+        printf("FAIL %s: %s\n", stateName(state), what);
+        failures++;
+    }
+}
+
+// --- The chains loop() used before the table ---
+
+static bool legacyNeedsTicks(TimerState s) {
+    return s == BOOT_JPG_SEQUENCE || s == LIVE_FIRE_GET_READY || s == LIVE_FIRE_TIMING ||
+           s == DRY_FIRE_RUNNING || s == NOISY_RANGE_GET_READY || s == NOISY_RANGE_TIMING ||
+           s == BLUETOOTH_SCANNING || s == CALIBRATE_THRESHOLD || s == CALIBRATE_RECOIL ||
+           s == CALIBRATE_BT_LATENCY;
+}
+
+static bool legacyKeepsAwake(TimerState s) {
+    return s == SETTINGS_MENU_MAIN || s == SETTINGS_MENU_GENERAL || s == SETTINGS_MENU_BEEP ||
+           s == SETTINGS_MENU_DRYFIRE || s == SETTINGS_MENU_NOISY || s == SETTINGS_MENU_BLUETOOTH ||
+           s == EDIT_SETTING || s == DEVICE_STATUS || s == LIST_FILES ||
+           s == DRY_FIRE_READY || s == NOISY_RANGE_READY || legacyNeedsTicks(s);
+}
+
+// The timing screens left the ticking group for STATE_TIMED_WAKE; both are live.
+static bool timedWake(TimerState s) {
+    return s == LIVE_FIRE_TIMING || s == NOISY_RANGE_TIMING;
+}
+
+static bool legacyBatteryRedraw(TimerState s) {
+    return s == DEVICE_STATUS || s == LIST_FILES || s == MODE_SELECTION ||
+           s == SETTINGS_MENU_BLUETOOTH || s == BLUETOOTH_SCANNING;
+}
+
+static bool legacyBluetoothRedraw(TimerState s) {
+    return s == SETTINGS_MENU_BLUETOOTH || s == BLUETOOTH_SCANNING || s == MODE_SELECTION;
+}
+
+static void testTable() {
+    for (int i = 0; i < TIMER_STATE_COUNT; ++i) {
+        TimerState s = (TimerState)i;
+        const StateInfo& info = stateInfo(s);
+        expect(info.state == s, "row out of order", s);
+        expect(info.name != nullptr && info.name[0] != '\0', "no name", s);
+        for (int j = 0; j < i; ++j) {
+            expect(strcmp(info.name, STATE_TABLE[j].name) != 0, "duplicate name", s);
+        }
+
+        expect(stateHasFlag(s, STATE_NEEDS_TICKS) == (legacyNeedsTicks(s) && !timedWake(s)), "STATE_NEEDS_TICKS", s);
+        expect(stateHasFlag(s, STATE_TIMED_WAKE) == timedWake(s), "STATE_TIMED_WAKE", s);
+        expect(stateIsLive(s) == legacyNeedsTicks(s), "stateIsLive", s);
+        expect(stateHasFlag(s, STATE_KEEPS_AWAKE) == legacyKeepsAwake(s), "STATE_KEEPS_AWAKE", s);
+        expect(stateHasFlag(s, STATE_BATTERY_REDRAW) == legacyBatteryRedraw(s), "STATE_BATTERY_REDRAW", s);
+        expect(stateHasFlag(s, STATE_BLUETOOTH_REDRAW) == legacyBluetoothRedraw(s), "STATE_BLUETOOTH_REDRAW", s);
+    }
+    expect(strcmp(stateName(TIMER_STATE_COUNT), "?") == 0, "out-of-range name", TIMER_STATE_COUNT);
+}
+
+// --- Transitions ---
+
+// Where a BtnB long press leaves each state for; TIMER_STATE_COUNT where it is
+// ignored (menus handle their own buttons, calibrations are not interruptible).
+static TimerState expectedTopLongPress(TimerState s) {
+    switch (s) {
+        case BOOT_SCREEN:
+        case MODE_SELECTION:
+            return SETTINGS_MENU_MAIN;
+        case LIVE_FIRE_READY:
+        case LIVE_FIRE_GET_READY:
+        case LIVE_FIRE_TIMING:
+        case LIVE_FIRE_STOPPED:
+        case DRY_FIRE_READY:
+        case DRY_FIRE_RUNNING:
+        case NOISY_RANGE_READY:
+        case NOISY_RANGE_GET_READY:
+        case NOISY_RANGE_TIMING:
+            return MODE_SELECTION;
+        default:
+            return TIMER_STATE_COUNT;
+    }
+}
+
+static void testTransitionTable() {
+    for (size_t i = 0; i < sizeof(TRANSITION_TABLE) / sizeof(TRANSITION_TABLE[0]); ++i) {
+        const StateTransitionRule& rule = TRANSITION_TABLE[i];
+        expect(rule.from != rule.to, "rule that does not change state", rule.from);
+        expect(rule.event < STATE_EVENT_COUNT && rule.to < TIMER_STATE_COUNT, "rule out of range", rule.from);
+        for (size_t j = 0; j < i; ++j) {
+            expect(TRANSITION_TABLE[j].from != rule.from || TRANSITION_TABLE[j].event != rule.event,
+                   "two rules for the same event", rule.from);
+        }
+    }
+    for (int i = 0; i < TIMER_STATE_COUNT; ++i) {
+        TimerState s = (TimerState)i;
+        expect(nextState(s, EVENT_TOP_LONG_PRESS) == expectedTopLongPress(s), "BtnB long press", s);
+        // The compiled lookup says what the rule list says, for every event.
+        for (int e = 0; e < STATE_EVENT_COUNT; ++e) {
+            TimerState ruled = TIMER_STATE_COUNT;
+            for (const StateTransitionRule& rule : TRANSITION_TABLE) {
+                if (rule.from == s && rule.event == e) ruled = rule.to;
+            }
+            expect(nextState(s, (StateEvent)e) == ruled, "lookup differs from TRANSITION_TABLE", s);
+        }
+    }
+}
+
+// A machine like the firmware's setState() / dispatchStateEvent(), with
+// actions that log what they were called with.
+static TimerState machineState = BOOT_SCREEN;
+static char actionLog[512];
+
+static void logAction(const char* what, TimerState from, TimerState to) {
+    size_t used = strlen(actionLog);
+    snprintf(actionLog + used, sizeof(actionLog) - used, "%s%s(%s>%s)", used ? " " : "", what, stateName(from), stateName(to));
+}
+
+static void exitGetReady(TimerState from, TimerState to)   { logAction("exitGetReady", from, to); }
+static void exitTiming(TimerState from, TimerState to)     { logAction("exitTiming", from, to); }
+static void exitParRun(TimerState from, TimerState to)     { logAction("exitParRun", from, to); }
+static void enterModeSelect(TimerState from, TimerState to) {
+    // Entry actions run once the state has changed.
+    logAction(machineState == to ? "enterModeSelect" : "enterModeSelect-early", from, to);
+}
+
+static StateHooks TEST_HOOKS[TIMER_STATE_COUNT];
+
+static void setupHooks() {
+    for (int i = 0; i < TIMER_STATE_COUNT; ++i) {
+        TEST_HOOKS[i] = {(TimerState)i, nullptr, nullptr};
+    }
+    TEST_HOOKS[MODE_SELECTION].onEnter = enterModeSelect;
+    TEST_HOOKS[LIVE_FIRE_GET_READY].onExit = exitGetReady;
+    TEST_HOOKS[NOISY_RANGE_GET_READY].onExit = exitGetReady;
+    TEST_HOOKS[LIVE_FIRE_TIMING].onExit = exitTiming;
+    TEST_HOOKS[NOISY_RANGE_TIMING].onExit = exitTiming;
+    TEST_HOOKS[DRY_FIRE_RUNNING].onExit = exitParRun;
+}
+
+static void setMachineState(TimerState to) {
+    runTransition(TEST_HOOKS, machineState, to, [&]() { machineState = to; });
+}
+
+static bool dispatch(StateEvent event) {
+    TimerState to = nextState(machineState, event);
+    if (to == TIMER_STATE_COUNT) return false;
+    setMachineState(to);
+    return true;
+}
+
+// Puts the machine in 'from' (without actions), sends the events in turn and
+// checks the state it ends in and the actions that ran on the way.
+static void expectRun(TimerState from, std::initializer_list<StateEvent> events, TimerState to, const char* actions) {
+    machineState = from;
+    actionLog[0] = '\0';
+    for (StateEvent event : events) dispatch(event);
+    if (machineState != to || strcmp(actionLog, actions) != 0) {
+        printf("FAIL from %s: ended in %s with actions \"%s\", expected %s with \"%s\"\n",
+               stateName(from), stateName(machineState), actionLog, stateName(to), actions);
+        failures++;
+    }
+}
+
+static void testTransitions() {
+    setupHooks();
+
+    // Live Fire: start, beep, string over. Going on to TIMING is still an
+    // exit from GET_READY; the action is told where to.
+    expectRun(LIVE_FIRE_READY, {EVENT_START, EVENT_BEEP, EVENT_STRING_DONE}, LIVE_FIRE_STOPPED,
+              "exitGetReady(LIVE_FIRE_GET_READY>LIVE_FIRE_TIMING) exitTiming(LIVE_FIRE_TIMING>LIVE_FIRE_STOPPED)");
+    expectRun(LIVE_FIRE_READY, {EVENT_START, EVENT_CANCEL}, LIVE_FIRE_READY,
+              "exitGetReady(LIVE_FIRE_GET_READY>LIVE_FIRE_READY)");
+    // Abandoned during "Ready..." / the delay: both GET_READY states leave for
+    // mode selection, and the exit action drops the start.
+    expectRun(LIVE_FIRE_GET_READY, {EVENT_TOP_LONG_PRESS}, MODE_SELECTION,
+              "exitGetReady(LIVE_FIRE_GET_READY>MODE_SELECTION) enterModeSelect(LIVE_FIRE_GET_READY>MODE_SELECTION)");
+    expectRun(LIVE_FIRE_TIMING, {EVENT_TOP_LONG_PRESS}, MODE_SELECTION,
+              "exitTiming(LIVE_FIRE_TIMING>MODE_SELECTION) enterModeSelect(LIVE_FIRE_TIMING>MODE_SELECTION)");
+    expectRun(LIVE_FIRE_STOPPED, {EVENT_TOP_LONG_PRESS}, MODE_SELECTION,
+              "enterModeSelect(LIVE_FIRE_STOPPED>MODE_SELECTION)");
+
+    // Noisy Range strings end on the Live Fire stopped screen.
+    expectRun(NOISY_RANGE_READY, {EVENT_START, EVENT_BEEP, EVENT_STRING_DONE}, LIVE_FIRE_STOPPED,
+              "exitGetReady(NOISY_RANGE_GET_READY>NOISY_RANGE_TIMING) exitTiming(NOISY_RANGE_TIMING>LIVE_FIRE_STOPPED)");
+    expectRun(NOISY_RANGE_GET_READY, {EVENT_TOP_LONG_PRESS}, MODE_SELECTION,
+              "exitGetReady(NOISY_RANGE_GET_READY>MODE_SELECTION) enterModeSelect(NOISY_RANGE_GET_READY>MODE_SELECTION)");
+    expectRun(NOISY_RANGE_READY, {EVENT_SIDE_LONG_PRESS}, MODE_SELECTION,
+              "enterModeSelect(NOISY_RANGE_READY>MODE_SELECTION)");
+
+    // Dry Fire: the par run ends, is stopped or is abandoned.
+    expectRun(DRY_FIRE_READY, {EVENT_START, EVENT_STRING_DONE}, DRY_FIRE_READY,
+              "exitParRun(DRY_FIRE_RUNNING>DRY_FIRE_READY)");
+    expectRun(DRY_FIRE_RUNNING, {EVENT_SIDE_LONG_PRESS}, DRY_FIRE_READY,
+              "exitParRun(DRY_FIRE_RUNNING>DRY_FIRE_READY)");
+    expectRun(DRY_FIRE_RUNNING, {EVENT_TOP_LONG_PRESS}, MODE_SELECTION,
+              "exitParRun(DRY_FIRE_RUNNING>MODE_SELECTION) enterModeSelect(DRY_FIRE_RUNNING>MODE_SELECTION)");
+
+    // Events a state has no rule for change nothing and run nothing.
+    expectRun(LIVE_FIRE_READY, {EVENT_BEEP, EVENT_CANCEL, EVENT_STRING_DONE, EVENT_SIDE_LONG_PRESS}, LIVE_FIRE_READY, "");
+    expectRun(LIVE_FIRE_TIMING, {EVENT_START, EVENT_BEEP, EVENT_CANCEL}, LIVE_FIRE_TIMING, "");
+    expectRun(SETTINGS_MENU_MAIN, {EVENT_TOP_LONG_PRESS, EVENT_START}, SETTINGS_MENU_MAIN, "");
+    expectRun(CALIBRATE_THRESHOLD, {EVENT_TOP_LONG_PRESS}, CALIBRATE_THRESHOLD, "");
+
+    // Setting the state it is already in is not a transition.
+    machineState = LIVE_FIRE_TIMING;
+    actionLog[0] = '\0';
+    setMachineState(LIVE_FIRE_TIMING);
+    expect(actionLog[0] == '\0', "actions run without a change of state", LIVE_FIRE_TIMING);
+}
+
+static void testTrace() {
+    StateTrace<8> trace;
+    expect(trace.size() == 0 && trace.total() == 0, "trace starts empty", BOOT_SCREEN);
+
+    trace.record(BOOT_SCREEN, MODE_SELECTION, 100);
+    trace.record(MODE_SELECTION, LIVE_FIRE_READY, 200);
+    expect(trace.size() == 2, "trace size before wrapping", BOOT_SCREEN);
+    expect(trace.at(0).atUs == 100 && trace.at(0).from == BOOT_SCREEN && trace.at(0).to == MODE_SELECTION,
+           "oldest entry first", BOOT_SCREEN);
+    expect(trace.at(1).atUs == 200 && trace.at(1).to == LIVE_FIRE_READY, "latest entry last", BOOT_SCREEN);
+
+    // 21 transitions into an 8-slot ring keeps the last 8, oldest first.
+    StateTrace<8> wrapped;
+    for (int i = 0; i < 21; ++i) {
+        wrapped.record((TimerState)(i % TIMER_STATE_COUNT), (TimerState)((i + 1) % TIMER_STATE_COUNT), 1000 + i);
+    }
+    expect(wrapped.size() == 8 && wrapped.total() == 21, "trace size after wrapping", BOOT_SCREEN);
+    for (uint32_t i = 0; i < wrapped.size(); ++i) {
+        int n = 13 + (int)i;
+        expect(wrapped.at(i).atUs == 1000 + n && wrapped.at(i).from == n % TIMER_STATE_COUNT,
+               "wrapped entry order", (TimerState)(n % TIMER_STATE_COUNT));
+    }
+}
+
+int main() {
+    testTable();
+    testTransitionTable();
+    testTransitions();
+    testTrace();
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("state table: %d states OK, %d transitions OK, trace OK\n", (int)TIMER_STATE_COUNT,
+           (int)(sizeof(TRANSITION_TABLE) / sizeof(TRANSITION_TABLE[0])));
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef IMU_FIFO_H
+#define IMU_FIFO_H
+
+#include <stdint.h>
+
+// Parsing of the MPU6886 FIFO for the IMU drain task: how many packets a
+// drain may read, the timestamps they get and how their bytes decode.
+// With only ACCEL_FIFO_EN set the chip still writes TEMP_OUT after the accel
+// axes (MPU6886 datasheet, FIFO_EN register), so a packet is
+//   ACCEL_XOUT_H/L  ACCEL_YOUT_H/L  ACCEL_ZOUT_H/L  TEMP_OUT_H/L
+// all big-endian. Packets are only ever read whole, so a drain never leaves
+// the FIFO part way through one.
+
+typedef struct {
+    int64_t timeUs; // esp_timer time the sample was taken
+    int16_t ax, ay, az;
+} ImuSample;
+
+static const int IMU_FIFO_PACKET_BYTES = 8;
+static const int IMU_FIFO_SIZE_BYTES = 1024;
+static const uint8_t IMU_INT_STATUS_FIFO_OFLOW = 0x10;
+
+class ImuFifoReader {
+public:
+    ImuFifoReader(uint32_t sampleRateHz, int64_t slewUsPerDrain)
+        : periodUs_(1000000 / (int64_t)sampleRateHz), slewUsPerDrain_(slewUsPerDrain) {}
+
+    // Starts a drain from INT_STATUS and FIFO_COUNT, read at 'nowUs'. Returns
+    // the packets to read, or -1 if the FIFO overflowed: it has stopped
+    // accepting samples, so the sample clock has a gap and the caller resets
+    // the FIFO; the clock is anchored again on the next drain.
+    int beginDrain(uint8_t status, int fifoBytes, int64_t nowUs) {
+        if ((status & IMU_INT_STATUS_FIFO_OFLOW) || fifoBytes > IMU_FIFO_SIZE_BYTES - IMU_FIFO_PACKET_BYTES) {
+            anchored_ = false;
+            return -1;
+        }
+        int packets = fifoBytes / IMU_FIFO_PACKET_BYTES;
+        if (packets == 0) return 0;
+
+        // Same anchoring as the mic: the newest packet was taken at or before
+        // nowUs; keep the lowest estimate and let it slew slowly to follow
+        // clock drift.
+        int64_t candidateZeroUs = nowUs - (int64_t)(samplesRead_ + packets - 1) * periodUs_;
+        if (!anchored_) {
+            sampleZeroUs_ = candidateZeroUs;
+            anchored_ = true;
+        } else if (sampleZeroUs_ + slewUsPerDrain_ < candidateZeroUs) {
+            sampleZeroUs_ += slewUsPerDrain_;
+        } else {
+            sampleZeroUs_ = candidateZeroUs;
+        }
+        return packets;
+    }
+
+    // Decodes 'count' packets read from FIFO_R_W, oldest first.
+    void decode(const uint8_t* data, int count, ImuSample* out) {
+        for (int i = 0; i < count; ++i) {
+            const uint8_t* p = data + i * IMU_FIFO_PACKET_BYTES;
+            out[i].timeUs = sampleZeroUs_ + (int64_t)samplesRead_ * periodUs_;
+            out[i].ax = (int16_t)((p[0] << 8) | p[1]);
+            out[i].ay = (int16_t)((p[2] << 8) | p[3]);
+            out[i].az = (int16_t)((p[4] << 8) | p[5]);
+            ++samplesRead_;
+        }
+    }
+
+private:
+    int64_t periodUs_;
+    int64_t slewUsPerDrain_;
+    int64_t sampleZeroUs_ = 0;
+    uint64_t samplesRead_ = 0;
+    bool anchored_ = false;
+};
+
+#endif // IMU_FIFO_H
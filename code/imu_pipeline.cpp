@@ -0,0 +1,151 @@
+#include "imu_pipeline.h"
+#include "globals.h"
+#include "config.h"
+#include "imu_fifo.h"
+#include <esp_timer.h>
+#include <atomic>
+
+// --- MPU6886 registers ---
+static const uint8_t REG_SMPLRT_DIV = 0x19;
+static const uint8_t REG_CONFIG = 0x1A;
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_ACCEL_CONFIG2 = 0x1D;
+static const uint8_t REG_FIFO_EN = 0x23;
+static const uint8_t REG_INT_STATUS = 0x3A;     // Overflow bit: IMU_INT_STATUS_FIFO_OFLOW
+static const uint8_t REG_USER_CTRL = 0x6A;
+static const uint8_t REG_FIFO_COUNTH = 0x72;
+static const uint8_t REG_FIFO_R_W = 0x74;
+
+static const uint8_t FIFO_EN_ACCEL = 0x08;
+static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+static const uint8_t USER_CTRL_FIFO_RST = 0x04;
+static const uint8_t CONFIG_FIFO_MODE_STOP = 0x40; // Stop writing when full, keeps packets aligned
+static const uint8_t CONFIG_DLPF_1KHZ = 0x01;
+
+static const int IMU_FIFO_READ_PACKETS = 16;      // Packets per I2C burst (see imu_fifo.h for the layout)
+
+static ImuSample imuHistory[IMU_HISTORY_SIZE];
+static std::atomic<uint32_t> imuHead{0};          // Total samples written; slot = head % size
+static std::atomic<float> imuPeakAbsZ{0.0f};
+static std::atomic<uint32_t> imuFifoOverflows{0};
+static float imuLsbPerG = 4096.0f;
+
+static bool imuWrite(uint8_t reg, uint8_t value) {
+    return StickCP2.In_I2C.writeRegister8(IMU_I2C_ADDR, reg, value, IMU_I2C_FREQ);
+}
+
+static bool imuRead(uint8_t reg, uint8_t* buf, size_t len) {
+    return StickCP2.In_I2C.readRegister(IMU_I2C_ADDR, reg, buf, len, IMU_I2C_FREQ);
+}
+
+static void imuResetFifo() {
+    imuWrite(REG_USER_CTRL, USER_CTRL_FIFO_RST);
+    imuWrite(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+bool imuPipelineBegin() {
+    // Keep the full-scale range M5Unified chose so StickCP2.Imu readings and ours agree.
+    uint8_t accelConfig = 0;
+    if (!imuRead(REG_ACCEL_CONFIG, &accelConfig, 1)) return false;
+    imuLsbPerG = (float)(16384 >> ((accelConfig >> 3) & 0x03));
+
+    // 1 kHz internal rate with the 218 Hz accel DLPF, no divider.
+    bool ok = imuWrite(REG_FIFO_EN, 0x00);
+    ok = ok && imuWrite(REG_SMPLRT_DIV, (uint8_t)(1000 / IMU_SAMPLE_RATE_HZ - 1));
+    ok = ok && imuWrite(REG_CONFIG, CONFIG_FIFO_MODE_STOP | CONFIG_DLPF_1KHZ);
+    ok = ok && imuWrite(REG_ACCEL_CONFIG2, 0x00);
+    ok = ok && imuWrite(REG_FIFO_EN, FIFO_EN_ACCEL);
+    if (ok) imuResetFifo();
+    return ok;
+}
+
+void imuAppendSample(const ImuSample& sample) {
+    uint32_t head = imuHead.load(std::memory_order_relaxed);
+    imuHistory[head % IMU_HISTORY_SIZE] = sample;
+    imuHead.store(head + 1, std::memory_order_release);
+
+    float absZ = fabsf(sample.az / imuLsbPerG);
+    float stored = imuPeakAbsZ.load(std::memory_order_relaxed);
+    while (absZ > stored && !imuPeakAbsZ.compare_exchange_weak(stored, absZ)) {
+    }
+}
+
+// --- IMU Drain Task (Runs on Core 0) ---
+void imuPipelineTask(void *) {
+    ImuFifoReader reader(IMU_SAMPLE_RATE_HZ, IMU_CLOCK_SLEW_US_PER_DRAIN);
+    uint8_t buf[IMU_FIFO_READ_PACKETS * IMU_FIFO_PACKET_BYTES];
+    ImuSample samples[IMU_FIFO_READ_PACKETS];
+
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(IMU_DRAIN_INTERVAL_MS));
+
+        uint8_t status = 0;
+        uint8_t countBytes[2];
+        if (!imuRead(REG_INT_STATUS, &status, 1) || !imuRead(REG_FIFO_COUNTH, countBytes, 2)) {
+            continue;
+        }
+        int fifoBytes = ((countBytes[0] & 0x1F) << 8) | countBytes[1];
+        int packets = reader.beginDrain(status, fifoBytes, esp_timer_get_time());
+        if (packets < 0) {
+            imuResetFifo();
+            imuFifoOverflows.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        while (packets > 0) {
+            int chunk = min(packets, IMU_FIFO_READ_PACKETS);
+            if (!imuRead(REG_FIFO_R_W, buf, chunk * IMU_FIFO_PACKET_BYTES)) break;
+            reader.decode(buf, chunk, samples);
+            for (int i = 0; i < chunk; ++i) {
+                imuAppendSample(samples[i]);
+            }
+            packets -= chunk;
+        }
+    }
+}
+
+
+// --- History Queries (Called from Core 1) ---
+// Only the newest IMU_HISTORY_SIZE - IMU_HISTORY_GUARD samples are read, so the
+// task cannot overwrite a slot while it is being looked at.
+
+float imuPeakAbsAccelZ(int64_t fromUs, int64_t toUs) {
+    uint32_t head = imuHead.load(std::memory_order_acquire);
+    uint32_t available = min(head, (uint32_t)(IMU_HISTORY_SIZE - IMU_HISTORY_GUARD));
+    int16_t peak = 0;
+    for (uint32_t n = 1; n <= available; ++n) {
+        const ImuSample& s = imuHistory[(head - n) % IMU_HISTORY_SIZE];
+        if (s.timeUs < fromUs) break;
+        if (s.timeUs > toUs) continue;
+        int16_t absZ = (s.az == INT16_MIN) ? INT16_MAX : (int16_t)abs(s.az);
+        if (absZ > peak) peak = absZ;
+    }
+    return peak / imuLsbPerG;
+}
+
+bool imuHistoryCovers(int64_t timeUs) {
+    uint32_t head = imuHead.load(std::memory_order_acquire);
+    if (head == 0) return false;
+    return imuHistory[(head - 1) % IMU_HISTORY_SIZE].timeUs >= timeUs;
+}
+
+bool imuLatestAccel(float &ax, float &ay, float &az) {
+    uint32_t head = imuHead.load(std::memory_order_acquire);
+    if (head == 0) {
+        ax = ay = az = 0.0f;
+        return false;
+    }
+    const ImuSample& s = imuHistory[(head - 1) % IMU_HISTORY_SIZE];
+    ax = s.ax / imuLsbPerG;
+    ay = s.ay / imuLsbPerG;
+    az = s.az / imuLsbPerG;
+    return true;
+}
+
+float takeImuPeakAbsAccelZ() {
+    return imuPeakAbsZ.exchange(0.0f);
+}
+
+uint32_t getImuFifoOverflowCount() {
+    return imuFifoOverflows.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,39 @@
+#ifndef IMU_PIPELINE_H
+#define IMU_PIPELINE_H
+
+#include <Arduino.h>
+#include "imu_fifo.h"
+
+// High-rate accelerometer pipeline. The MPU6886 streams accel samples into its
+// hardware FIFO at IMU_SAMPLE_RATE_HZ; a background task drains the FIFO and
+// appends timestamped samples to a history ring, so recoil can be looked up
+// around a sound onset after the fact instead of polled in loop().
+// Once started, the task is the only user of the IMU; read accel values through
+// the functions below rather than StickCP2.Imu.
+
+// Configures the IMU FIFO. Call after StickCP2.Imu.begin(); returns false if the IMU does not respond.
+bool imuPipelineBegin();
+
+// IMU drain task (Core 0).
+void imuPipelineTask(void *pvParameters);
+
+// Adds a sample to the history. Called by the drain task, and by the host
+// simulation (host/sim) in its place.
+void imuAppendSample(const ImuSample& sample);
+
+// Highest |accZ| (G) among samples taken in [fromUs, toUs]. Returns 0 if none.
+float imuPeakAbsAccelZ(int64_t fromUs, int64_t toUs);
+
+// True once samples up to 'timeUs' have been drained into the history.
+bool imuHistoryCovers(int64_t timeUs);
+
+// Most recent sample in G. Returns false if no sample has arrived yet.
+bool imuLatestAccel(float &ax, float &ay, float &az);
+
+// Highest |accZ| (G) seen since the previous call (used by calibration).
+float takeImuPeakAbsAccelZ();
+
+// Times the hardware FIFO overflowed and had to be reset.
+uint32_t getImuFifoOverflowCount();
+
+#endif // IMU_PIPELINE_H
@@ -6,13 +6,17 @@
 #include "system_utils.h"
 #include "audio_utils.h"     // For reset_bt_beep_state
 #include "bluetooth_utils.h" 
+#include "shot_capture.h"
+#include "imu_pipeline.h"
+#include "loop_profiler.h"
+#include "session_journal.h"
 #include <LittleFS.h>
 
 
 void handleModeSelectionInput() {
     const char* modeItems[] = {"Live Fire", "Dry Fire Par", "Noisy Range"};
     int modeCount = sizeof(modeItems) / sizeof(modeItems[0]);
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
 
     if (currentMenuSelection < menuScrollOffset) {
@@ -46,7 +50,6 @@ void handleModeSelectionInput() {
             case MODE_DRY_FIRE:    setState(DRY_FIRE_READY); break;
             case MODE_NOISY_RANGE: setState(NOISY_RANGE_READY); break;
         }
-        StickCP2.Lcd.fillScreen(BLACK);
         menuScrollOffset = 0;
     }
 }
@@ -56,19 +59,19 @@ void handleSettingsInput() {
     const char* title = "Settings";
     const char** items = nullptr;
     int itemCount = 0;
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
 
     static const char* mainItems[] = {"General", "Bluetooth", "Dry Fire", "Noisy Range", "Device Status", "List Files", "Power Off Now", "Save & Exit"};
-    static const char* generalItems[] = {"Max Shots", "Beep Settings", "Shot Threshold", "Screen Rotation", "Boot Animation", "Auto Sleep", "Calibrate Thresh.", "Back"};
-    static const char* beepItems[] = {"Beep Duration", "Beep Tone", "Back"};
+    static const char* generalItems[] = {"Max Shots", "Beep Settings", "Shot Margin", "Shot Threshold", "Screen Rotation", "Boot Animation", "Auto Sleep", "Calibrate Thresh.", "Back"};
+    static const char* beepItems[] = {"Beep Duration", "Beep Tone", "Start Delay", "Back"};
     static const char* noisyItems[] = {"Recoil Threshold", "Calibrate Recoil", "Back"};
 
     const int maxDryFireItems = 1 + MAX_PAR_BEEPS + 1;
     static const char* dryFireItemsBuffer[maxDryFireItems];
     static String dryFireItemStrings[MAX_PAR_BEEPS];
 
-    static const char* bluetoothItems[7]; 
+    static const char* bluetoothItems[8]; 
 
 
     switch (settingsMenuLevel) {
@@ -109,9 +112,10 @@ void handleSettingsInput() {
             bluetoothItems[1] = "Disconnect";
             bluetoothItems[2] = "Volume"; 
             bluetoothItems[3] = "BT Audio Offset"; 
-            bluetoothItems[4] = "Auto Reconnect"; 
-            bluetoothItems[5] = "Scan for Devices"; 
-            bluetoothItems[6] = "Back";
+            bluetoothItems[4] = "Calibrate Latency";
+            bluetoothItems[5] = "Auto Reconnect"; 
+            bluetoothItems[6] = "Scan for Devices"; 
+            bluetoothItems[7] = "Back";
             items = bluetoothItems; 
             itemCount = sizeof(bluetoothItems) / sizeof(bluetoothItems[0]); 
             break;
@@ -144,8 +148,7 @@ void handleSettingsInput() {
 
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
          if (settingsMenuLevel == 0) {
-             setState(MODE_SELECTION); currentMenuSelection = (int)currentMode; menuScrollOffset = 0;
-             StickCP2.Lcd.fillScreen(BLACK);
+             setState(MODE_SELECTION);
          } else if (settingsMenuLevel == 1 || settingsMenuLevel == 2 || settingsMenuLevel == 3 || settingsMenuLevel == 5) {
              int oldMenuLevel = settingsMenuLevel;
              settingsMenuLevel = 0;
@@ -168,22 +171,21 @@ void handleSettingsInput() {
             else if (strcmp(items[currentMenuSelection], "Dry Fire") == 0) settingsMenuLevel = 2;
             else if (strcmp(items[currentMenuSelection], "Noisy Range") == 0) settingsMenuLevel = 3;
             else if (strcmp(items[currentMenuSelection], "Device Status") == 0) {
-                setState(DEVICE_STATUS); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                setState(DEVICE_STATUS); needsActionRedraw = false;
             }
             else if (strcmp(items[currentMenuSelection], "List Files") == 0) {
-                setState(LIST_FILES); fileListScrollOffset = 0; needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                setState(LIST_FILES); fileListScrollOffset = 0; needsActionRedraw = false;
             }
             else if (strcmp(items[currentMenuSelection], "Power Off Now") == 0) {
-                StickCP2.Lcd.fillScreen(BLACK);
-                StickCP2.Lcd.setTextDatum(MC_DATUM);
-                StickCP2.Lcd.drawString("Powering Off...", StickCP2.Lcd.width()/2, StickCP2.Lcd.height()/2);
+                displayMessageScreen("Powering Off...", 2);
                 delay(1500);
+                flushSettings();
+                sessionJournalFlush();
                 StickCP2.Power.powerOff();
             }
             else if (strcmp(items[currentMenuSelection], "Save & Exit") == 0) {
                 saveSettings(); playSuccessBeeps(); setState(MODE_SELECTION);
                 currentMenuSelection = (int)currentMode; menuScrollOffset = 0; needsActionRedraw = false;
-                StickCP2.Lcd.fillScreen(BLACK);
             }
             currentMenuSelection = 0; menuScrollOffset = 0;
         }
@@ -191,19 +193,21 @@ void handleSettingsInput() {
             editingSettingName = items[currentMenuSelection];
             stateBeforeEdit = SETTINGS_MENU_GENERAL;
             if (strcmp(editingSettingName, "Max Shots") == 0) {
-                settingBeingEdited = EDIT_MAX_SHOTS; editingIntValue = currentMaxShots; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_MAX_SHOTS; editingIntValue = currentMaxShots; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Beep Settings") == 0) {
                 settingsMenuLevel = 4; currentMenuSelection = 0; menuScrollOffset = 0; 
+            } else if (strcmp(editingSettingName, "Shot Margin") == 0) {
+                settingBeingEdited = EDIT_SHOT_MARGIN; editingIntValue = shotMarginDb; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Shot Threshold") == 0) {
-                settingBeingEdited = EDIT_SHOT_THRESHOLD; editingIntValue = shotThresholdRms; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_SHOT_THRESHOLD; editingIntValue = shotThresholdRms; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Screen Rotation") == 0) {
-                settingBeingEdited = EDIT_ROTATION; editingIntValue = screenRotationSetting; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_ROTATION; editingIntValue = screenRotationSetting; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Boot Animation") == 0) {
-                settingBeingEdited = EDIT_BOOT_ANIM; editingBoolValue = playBootAnimation; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_BOOT_ANIM; editingBoolValue = playBootAnimation; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Auto Sleep") == 0) {
-                settingBeingEdited = EDIT_AUTO_SLEEP; editingBoolValue = enableAutoSleep; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_AUTO_SLEEP; editingBoolValue = enableAutoSleep; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Calibrate Thresh.") == 0) {
-                setState(CALIBRATE_THRESHOLD); peakRMSOverall = 0; micPeakRMS.resetPeak(); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                setState(CALIBRATE_THRESHOLD); peakRMSOverall = 0; takeCapturePeakRms(); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Back") == 0) {
                 settingsMenuLevel = 0; currentMenuSelection = 0; menuScrollOffset = 0; 
             }
@@ -212,7 +216,7 @@ void handleSettingsInput() {
             stateBeforeEdit = SETTINGS_MENU_DRYFIRE;
             if (strcmp(items[currentMenuSelection], "Par Beep Count") == 0) {
                 editingSettingName = items[currentMenuSelection];
-                settingBeingEdited = EDIT_PAR_BEEP_COUNT; editingIntValue = dryFireParBeepCount; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_PAR_BEEP_COUNT; editingIntValue = dryFireParBeepCount; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strncmp(items[currentMenuSelection], "Par Time", 8) == 0) {
                 int parTimeIndex = currentMenuSelection - 1; 
                 if (parTimeIndex >= 0 && parTimeIndex < dryFireParBeepCount) {
@@ -226,7 +230,6 @@ void handleSettingsInput() {
                     editingFloatValue = dryFireParTimesSec[parTimeIndex];
                     setState(EDIT_SETTING);
                     needsActionRedraw = false;
-                    StickCP2.Lcd.fillScreen(BLACK);
                 }
             } else if (strcmp(items[currentMenuSelection], "Back") == 0) {
                 settingsMenuLevel = 0; currentMenuSelection = 2; menuScrollOffset = 0; 
@@ -236,9 +239,9 @@ void handleSettingsInput() {
             editingSettingName = items[currentMenuSelection];
             stateBeforeEdit = SETTINGS_MENU_NOISY;
             if (strcmp(editingSettingName, "Recoil Threshold") == 0) {
-                settingBeingEdited = EDIT_RECOIL_THRESHOLD; editingFloatValue = recoilThreshold; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_RECOIL_THRESHOLD; editingFloatValue = recoilThreshold; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Calibrate Recoil") == 0) {
-                setState(CALIBRATE_RECOIL); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK); peakRecoilValue = 0;
+                setState(CALIBRATE_RECOIL); needsActionRedraw = false; peakRecoilValue = 0; takeImuPeakAbsAccelZ();
             } else if (strcmp(editingSettingName, "Back") == 0) {
                 settingsMenuLevel = 0; currentMenuSelection = 3; menuScrollOffset = 0; 
             }
@@ -247,9 +250,11 @@ void handleSettingsInput() {
             editingSettingName = items[currentMenuSelection];
             stateBeforeEdit = SETTINGS_MENU_BEEP;
              if (strcmp(editingSettingName, "Beep Duration") == 0) {
-                settingBeingEdited = EDIT_BEEP_DURATION; editingULongValue = currentBeepDuration; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_BEEP_DURATION; editingULongValue = currentBeepDuration; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Beep Tone") == 0) {
-                settingBeingEdited = EDIT_BEEP_TONE; editingIntValue = currentBeepToneHz; setState(EDIT_SETTING); needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                settingBeingEdited = EDIT_BEEP_TONE; editingIntValue = currentBeepToneHz; setState(EDIT_SETTING); needsActionRedraw = false;
+            } else if (strcmp(editingSettingName, "Start Delay") == 0) {
+                settingBeingEdited = EDIT_START_DELAY; editingULongValue = startRandomDelayMs; setState(EDIT_SETTING); needsActionRedraw = false;
             } else if (strcmp(editingSettingName, "Back") == 0) {
                 settingsMenuLevel = 1; currentMenuSelection = 1; 
                 menuScrollOffset = 0;
@@ -288,17 +293,25 @@ void handleSettingsInput() {
                 settingBeingEdited = EDIT_BT_VOLUME;
                 editingIntValue = currentBluetoothVolume;
                 setState(EDIT_SETTING);
-                needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                needsActionRedraw = false;
             } else if (strcmp(items[currentMenuSelection], "BT Audio Offset") == 0) { 
                 settingBeingEdited = EDIT_BT_AUDIO_OFFSET;
                 editingIntValue = currentBluetoothAudioOffsetMs;
                 setState(EDIT_SETTING);
-                needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                needsActionRedraw = false;
+            } else if (strcmp(items[currentMenuSelection], "Calibrate Latency") == 0) {
+                if (a2dp_source.is_connected()) {
+                    startBtLatencyCalibration();
+                    needsActionRedraw = false;
+                } else {
+                    playUnsuccessBeeps();
+                    needsActionRedraw = true;
+                }
             } else if (strcmp(items[currentMenuSelection], "Auto Reconnect") == 0) {
                 settingBeingEdited = EDIT_BT_AUTO_RECONNECT;
                 editingBoolValue = currentBluetoothAutoReconnect;
                 setState(EDIT_SETTING);
-                needsActionRedraw = false; StickCP2.Lcd.fillScreen(BLACK);
+                needsActionRedraw = false;
             } else if (strcmp(items[currentMenuSelection], "Scan for Devices") == 0) {
                 // --- Setup for A2DP Discovery Scan ---
                 if (a2dp_source.is_connected()){
@@ -327,7 +340,6 @@ void handleSettingsInput() {
                 a2dp_source.start(); // Start A2DP in discovery mode 
                 
                 needsActionRedraw = false; 
-                StickCP2.Lcd.fillScreen(BLACK); 
                 // --- End Scan Setup ---
             }
             else if (strcmp(items[currentMenuSelection], "Back") == 0) {
@@ -341,7 +353,7 @@ void handleSettingsInput() {
 void handleEditSettingInput() {
     resetActivityTimer();
     bool valueChanged = false;
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     bool upPressed = (rotation == 3) ? M5.BtnPWR.wasClicked() : StickCP2.BtnB.wasClicked();
     bool downPressed = (rotation == 3) ? StickCP2.BtnB.wasClicked() : M5.BtnPWR.wasClicked();
 
@@ -353,7 +365,12 @@ void handleEditSettingInput() {
             case EDIT_MAX_SHOTS: editingIntValue = min(max(editingIntValue + increment, 1), MAX_SHOTS_LIMIT); break;
             case EDIT_BEEP_DURATION: editingULongValue = min(max(editingULongValue + (unsigned long)(increment * 50), 50UL), 2000UL); break;
             case EDIT_BEEP_TONE: editingIntValue = min(max(editingIntValue + (increment * 100), 500), 8000); break;
-            case EDIT_SHOT_THRESHOLD: editingIntValue = min(max(editingIntValue + (increment * 500), 100), 32000); break;
+            case EDIT_START_DELAY:
+                if (increment > 0) editingULongValue = min(editingULongValue + START_RANDOM_DELAY_STEP_MS, START_RANDOM_DELAY_MAX_MS);
+                else editingULongValue = (editingULongValue > START_RANDOM_DELAY_STEP_MS) ? editingULongValue - START_RANDOM_DELAY_STEP_MS : 0;
+                break;
+            case EDIT_SHOT_THRESHOLD: editingIntValue = min(max(editingIntValue + (increment * 500), 0), 32000); break;
+            case EDIT_SHOT_MARGIN: editingIntValue = min(max(editingIntValue + increment, SHOT_MARGIN_DB_MIN), SHOT_MARGIN_DB_MAX); break;
             case EDIT_PAR_BEEP_COUNT: editingIntValue = min(max(editingIntValue + increment, 1), MAX_PAR_BEEPS); break;
             case EDIT_PAR_TIME_ARRAY: editingFloatValue = min(max(editingFloatValue + (increment * 0.1f), 0.1f), 10.0f); break;
             case EDIT_RECOIL_THRESHOLD: editingFloatValue = min(max(editingFloatValue + (increment * 0.1f), 0.5f), 5.0f); break;
@@ -365,7 +382,7 @@ void handleEditSettingInput() {
                 editingIntValue = min(max(editingIntValue + (increment * 5), 0), 127);
                 break;
             case EDIT_BT_AUDIO_OFFSET: 
-                editingIntValue = min(max(editingIntValue + (increment * BT_AUDIO_OFFSET_STEP_MS), -1000), 500); 
+                editingIntValue = min(max(editingIntValue + (increment * BT_AUDIO_OFFSET_STEP_MS), 0), BT_AUDIO_OFFSET_MAX_MS); 
                 if (a2dp_source.is_connected()) { 
                     playSyncCalibrationTone(currentBeepToneHz, BEEP_NOTE_DURATION_MS, editingIntValue);
                 } else {
@@ -375,8 +392,7 @@ void handleEditSettingInput() {
             default: valueChanged = false; break;
         }
         if (settingBeingEdited == EDIT_ROTATION) {
-            StickCP2.Lcd.setRotation(editingIntValue);
-            redrawMenu = true;
+            redrawMenu = true; // Laid out again for the rotation being tried (uiRotation())
         }
         if (valueChanged && 
             settingBeingEdited != EDIT_BOOT_ANIM && 
@@ -388,11 +404,7 @@ void handleEditSettingInput() {
     }
 
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
-        if (settingBeingEdited == EDIT_ROTATION) {
-             StickCP2.Lcd.setRotation(screenRotationSetting); 
-        }
         setState(stateBeforeEdit);
-        StickCP2.Lcd.fillScreen(BLACK);
         settingBeingEdited = EDIT_NONE;
         playUnsuccessBeeps();
         return;
@@ -403,7 +415,9 @@ void handleEditSettingInput() {
             case EDIT_MAX_SHOTS: currentMaxShots = editingIntValue; break;
             case EDIT_BEEP_DURATION: currentBeepDuration = editingULongValue; break;
             case EDIT_BEEP_TONE: currentBeepToneHz = editingIntValue; break;
+            case EDIT_START_DELAY: startRandomDelayMs = editingULongValue; break;
             case EDIT_SHOT_THRESHOLD: shotThresholdRms = editingIntValue; break;
+            case EDIT_SHOT_MARGIN: shotMarginDb = editingIntValue; break;
             case EDIT_PAR_BEEP_COUNT: dryFireParBeepCount = editingIntValue; break;
             case EDIT_PAR_TIME_ARRAY:
                 if (editingIntValue >= 0 && editingIntValue < MAX_PAR_BEEPS) { 
@@ -423,11 +437,11 @@ void handleEditSettingInput() {
                 break;
             case EDIT_BT_AUDIO_OFFSET: 
                 currentBluetoothAudioOffsetMs = editingIntValue;
+                saveBtLatencyForDevice(currentBluetoothDeviceName, currentBluetoothAudioOffsetMs);
                 break;
             default: break;
         }
         setState(stateBeforeEdit);
-        StickCP2.Lcd.fillScreen(BLACK);
         settingBeingEdited = EDIT_NONE;
         playSuccessBeeps();
         return;
@@ -440,24 +454,37 @@ void handleEditSettingInput() {
 }
 
 void handleDeviceStatusInput() {
+    static bool showProfile = false;
     resetActivityTimer();
     if (redrawMenu) {
-        displayDeviceStatusScreen();
+        if (showProfile) {
+            displayProfileScreen();
+        } else {
+            displayDeviceStatusScreen();
+        }
         redrawMenu = false;
     }
+    if (StickCP2.BtnA.wasClicked()) {
+        // Flip pages, and send the trace and profile to Serial for bug reports.
+        showProfile = !showProfile;
+        redrawMenu = true;
+        dumpStateTrace();
+        dumpProfileCsv();
+        dumpSessionJournal();
+    }
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
+        showProfile = false;
         setState(SETTINGS_MENU_MAIN);
         currentMenuSelection = 4; 
-        int rotation = StickCP2.Lcd.getRotation();
+        int rotation = uiRotation();
         int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
         menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
-        StickCP2.Lcd.fillScreen(BLACK);
     }
 }
 
 void handleListFilesInput() {
     resetActivityTimer();
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT + 2 : MENU_ITEMS_PER_SCREEN_LANDSCAPE + 1;
 
     if (redrawMenu) {
@@ -502,34 +529,30 @@ void handleListFilesInput() {
          setState(SETTINGS_MENU_MAIN);
          currentMenuSelection = 5; 
          menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
-         StickCP2.Lcd.fillScreen(BLACK);
      }
 }
 
 void handleCalibrationInput(TimerState calibrationType) {
     resetActivityTimer();
     float currentValue = 0.0f;
-    float accX, accY, accZ;
     const char* title = "Calibrating...";
     const char* unit = "";
     bool valueChanged = false;
-    int rotation = StickCP2.Lcd.getRotation();
+    int rotation = uiRotation();
     int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
 
     if (calibrationType == CALIBRATE_THRESHOLD) {
         title = "Calibrate Threshold";
         unit = "RMS";
-        currentValue = micPeakRMS.getPeakRMS();
+        currentValue = takeCapturePeakRms();
         if (currentValue > peakRMSOverall) {
             peakRMSOverall = currentValue;
             valueChanged = true;
         }
-        micPeakRMS.resetPeak();
     } else if (calibrationType == CALIBRATE_RECOIL) {
         title = "Calibrate Recoil";
         unit = "G";
-        StickCP2.Imu.getAccelData(&accX, &accY, &accZ);
-        currentValue = abs(accZ);
+        currentValue = takeImuPeakAbsAccelZ();
         if (currentValue > peakRecoilValue) {
             peakRecoilValue = currentValue;
             valueChanged = true;
@@ -537,34 +560,22 @@ void handleCalibrationInput(TimerState calibrationType) {
     }
 
     if (redrawMenu || valueChanged) {
-        if (!redrawMenu && valueChanged) {
-             StickCP2.Lcd.fillRect(0, StickCP2.Lcd.height() / 2 - 25, StickCP2.Lcd.width(), 50, BLACK);
-        } else {
-            StickCP2.Lcd.fillScreen(BLACK);
-            displayCalibrationScreen(title, (calibrationType == CALIBRATE_RECOIL ? peakRecoilValue : peakRMSOverall), unit);
-        }
-        StickCP2.Lcd.setTextDatum(MC_DATUM);
-        StickCP2.Lcd.setTextFont(1);
-        StickCP2.Lcd.setTextSize(3);
-        String peakStr = "PEAK: " + String((calibrationType == CALIBRATE_RECOIL ? peakRecoilValue : peakRMSOverall), (calibrationType == CALIBRATE_RECOIL ? 2 : 0));
-        StickCP2.Lcd.drawString(peakStr, StickCP2.Lcd.width() / 2, (StickCP2.Lcd.height()/2));
-        drawLowBatteryIndicator(); 
+        displayCalibrationScreen(title, (calibrationType == CALIBRATE_RECOIL ? peakRecoilValue : peakRMSOverall), unit);
         redrawMenu = false;
     }
 
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
         stateBeforeEdit = (calibrationType == CALIBRATE_THRESHOLD) ? SETTINGS_MENU_GENERAL : SETTINGS_MENU_NOISY;
         setState(stateBeforeEdit);
-        currentMenuSelection = (calibrationType == CALIBRATE_THRESHOLD) ? 6 : 1; 
+        currentMenuSelection = (calibrationType == CALIBRATE_THRESHOLD) ? 7 : 1; 
         menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
-        StickCP2.Lcd.fillScreen(BLACK);
         playUnsuccessBeeps();
     } else if (StickCP2.BtnA.wasClicked()) {
         if (calibrationType == CALIBRATE_THRESHOLD) {
             shotThresholdRms = (int)peakRMSOverall;
             stateBeforeEdit = SETTINGS_MENU_GENERAL;
             setState(stateBeforeEdit);
-            currentMenuSelection = 6;
+            currentMenuSelection = 7;
             menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
         } else if (calibrationType == CALIBRATE_RECOIL) {
             recoilThreshold = peakRecoilValue;
@@ -573,7 +584,6 @@ void handleCalibrationInput(TimerState calibrationType) {
             currentMenuSelection = 1;
             menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
         }
-        StickCP2.Lcd.fillScreen(BLACK);
         playSuccessBeeps();
     }
 }
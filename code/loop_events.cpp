@@ -0,0 +1,78 @@
+#include "loop_events.h"
+#include "config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include <atomic>
+
+static TaskHandle_t loopTaskHandle = NULL;
+// When the oldest event not yet seen by loop() was posted (low 32 bits of
+// esp_timer, never 0); 0 if none.
+static std::atomic<uint32_t> pendingSinceUs{0};
+// When a button last changed (low 32 bits of esp_timer).
+static std::atomic<uint32_t> buttonEdgeUs{0};
+static LoopEventStats loopEventStats = {0, 0, 0, 0};
+static int64_t busyWindowStartUs = 0;
+static int64_t busyWindowAwakeUs = 0;
+static int64_t awakeSinceUs = 0;
+
+static void IRAM_ATTR markPending() {
+    uint32_t nowUs = (uint32_t)esp_timer_get_time() | 1;
+    uint32_t expected = 0;
+    pendingSinceUs.compare_exchange_strong(expected, nowUs);
+}
+
+static void IRAM_ATTR buttonEdgeIsr() {
+    buttonEdgeUs.store((uint32_t)esp_timer_get_time());
+    markPending();
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(loopTaskHandle, LOOP_EVENT_BUTTON, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void loopEventsBegin() {
+    loopTaskHandle = xTaskGetCurrentTaskHandle();
+    awakeSinceUs = busyWindowStartUs = esp_timer_get_time();
+    // M5Unified still reads and debounces the buttons; the edges only wake loop().
+    attachInterrupt(BTN_A_PIN, buttonEdgeIsr, CHANGE);
+    attachInterrupt(BTN_B_PIN, buttonEdgeIsr, CHANGE);
+    attachInterrupt(BTN_PWR_PIN, buttonEdgeIsr, CHANGE);
+}
+
+void postLoopEvent(uint32_t events) {
+    if (loopTaskHandle == NULL) return;
+    markPending();
+    xTaskNotify(loopTaskHandle, events, eSetBits);
+}
+
+uint32_t waitForLoopEvents(uint32_t timeoutMs) {
+    int64_t sleepStartUs = esp_timer_get_time();
+    busyWindowAwakeUs += sleepStartUs - awakeSinceUs;
+
+    uint32_t events = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &events, pdMS_TO_TICKS(timeoutMs));
+
+    int64_t nowUs = esp_timer_get_time();
+    awakeSinceUs = nowUs;
+    uint32_t postedUs = pendingSinceUs.exchange(0);
+    if (events != 0 && postedUs != 0) {
+        uint32_t us = ((uint32_t)nowUs | 1) - postedUs; // Stamped the same way, so never negative
+        loopEventStats.lastUs = us;
+        loopEventStats.avgUs = (loopEventStats.avgUs == 0) ? us : (loopEventStats.avgUs * 15 + us) / 16;
+        if (us > loopEventStats.maxUs) loopEventStats.maxUs = us;
+    }
+    if (nowUs - busyWindowStartUs >= 1000000) {
+        loopEventStats.busyPercent = (uint8_t)min((int64_t)100, busyWindowAwakeUs * 100 / (nowUs - busyWindowStartUs));
+        busyWindowStartUs = nowUs;
+        busyWindowAwakeUs = 0;
+    }
+    return events;
+}
+
+uint32_t lastButtonEdgeUs() {
+    return buttonEdgeUs.load();
+}
+
+LoopEventStats getLoopEventStats() {
+    return loopEventStats;
+}
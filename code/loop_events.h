@@ -0,0 +1,39 @@
+#ifndef LOOP_EVENTS_H
+#define LOOP_EVENTS_H
+
+#include <Arduino.h>
+
+// --- Main Loop Events ---
+// loop() blocks in waitForLoopEvents() until something posts an event or its
+// next deadline passes, instead of running every 10 ms. Button edges come
+// from GPIO interrupts; tasks and callbacks post the rest.
+enum LoopEvent : uint32_t {
+    LOOP_EVENT_BUTTON    = 1u << 0,
+    LOOP_EVENT_SHOT      = 1u << 1,
+    LOOP_EVENT_BLUETOOTH = 1u << 2,
+    LOOP_EVENT_START_BEEP = 1u << 3, // The start beep went out (buzzer task / A2DP callback)
+};
+
+// Call from setup() (the loop task): attaches the button interrupts.
+void loopEventsBegin();
+
+// Wakes loop(). Safe from any task or callback.
+void postLoopEvent(uint32_t events);
+
+// Blocks for up to 'timeoutMs'. Returns the events posted (0 on timeout).
+uint32_t waitForLoopEvents(uint32_t timeoutMs);
+
+// esp_timer time (low 32 bits) of the last button edge, for measuring how
+// long a press takes to act: (uint32_t)esp_timer_get_time() - lastButtonEdgeUs().
+uint32_t lastButtonEdgeUs();
+
+// Post-to-loop latency of events, and how much of the time loop() is awake.
+typedef struct {
+    uint32_t lastUs;
+    uint32_t avgUs;       // Running average over ~16 events
+    uint32_t maxUs;
+    uint8_t busyPercent;  // Over the last second
+} LoopEventStats;
+LoopEventStats getLoopEventStats();
+
+#endif // LOOP_EVENTS_H
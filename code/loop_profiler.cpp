@@ -0,0 +1,100 @@
+#include "loop_profiler.h"
+#include <Arduino.h>
+#include "esp_cpu.h"
+
+static ProfileHistogram profileHistograms[PROFILE_SECTION_COUNT];
+static uint32_t profileScopeCycles = 0;
+
+static const char* const DISPLAY_SECTION_NAMES[] = {
+    "dispBoot", "dispBootAnim", "dispMenu", "dispTiming", "dispStopped", "dispEdit",
+    "dispCalib", "dispBtLat", "dispStatus", "dispFiles", "dispDfReady", "dispDfRun", "dispBtScan",
+};
+static_assert(sizeof(DISPLAY_SECTION_NAMES) / sizeof(DISPLAY_SECTION_NAMES[0]) == PROFILE_SECTION_COUNT - PROFILE_DISPLAY_BOOT,
+              "One name per display section");
+
+const char* profileSectionName(ProfileSection section) {
+    if (section == PROFILE_BUTTONS) return "buttons";
+    if (section == PROFILE_MIC_BLOCK) return "micBlock";
+    if (section == PROFILE_LOOP_PASS) return "loopPass";
+    if (section == PROFILE_SCOPE_COST) return "scopeCost";
+    if (section < PROFILE_DISPLAY_BOOT) return stateName((TimerState)(section - PROFILE_HANDLER_FIRST));
+    if (section < PROFILE_SECTION_COUNT) return DISPLAY_SECTION_NAMES[section - PROFILE_DISPLAY_BOOT];
+    return "?";
+}
+
+// Never inlined, so calibrateProfiler() times the calls the other files make.
+__attribute__((noinline)) uint32_t profileCycles() {
+    return esp_cpu_get_ccount();
+}
+
+__attribute__((noinline)) void profileRecord(ProfileSection section, uint32_t cycles) {
+    if (section < PROFILE_SECTION_COUNT) {
+        profileHistograms[section].add(cycles);
+    }
+}
+
+ProfileHistogram getProfileHistogram(ProfileSection section) {
+    return profileHistograms[(section < PROFILE_SECTION_COUNT) ? section : PROFILE_BUTTONS];
+}
+
+void resetProfile() {
+    memset(profileHistograms, 0, sizeof(profileHistograms));
+}
+
+void calibrateProfiler() {
+#if LOOP_PROFILER
+    const int kScopes = 32;
+    uint32_t best = UINT32_MAX;
+    for (int round = 0; round < 8; ++round) { // The quietest round: no interrupt in it
+        uint32_t start = profileCycles();
+        for (int i = 0; i < kScopes; ++i) {
+            PROFILE_SCOPE(PROFILE_SCOPE_COST);
+        }
+        best = min(best, (profileCycles() - start) / kScopes);
+    }
+    profileScopeCycles = best;
+#endif
+}
+
+uint32_t getProfileScopeCycles() {
+    return profileScopeCycles;
+}
+
+float getProfileLoopOverheadPercent() {
+    const ProfileHistogram& pass = profileHistograms[PROFILE_LOOP_PASS];
+    if (pass.totalCycles == 0) return 0.0f;
+    uint64_t scopes = (uint64_t)pass.count + profileHistograms[PROFILE_BUTTONS].count;
+    for (int s = PROFILE_HANDLER_FIRST; s < PROFILE_DISPLAY_BOOT; ++s) {
+        scopes += profileHistograms[s].count;
+    }
+    return 100.0f * (float)(scopes * profileScopeCycles) / (float)pass.totalCycles;
+}
+
+uint32_t profileCyclesToUs(uint32_t cycles) {
+    return cycles / getCpuFrequencyMhz();
+}
+
+void dumpProfileCsv() {
+    Serial.printf("# loop profile: %s, %lu MHz, bucket b = [2^b, 2^(b+1)) cycles\n",
+                  LOOP_PROFILER ? "on" : "compiled out", (unsigned long)getCpuFrequencyMhz());
+    Serial.printf("# empty scope %lu cycles, loop() scopes %.2f%% of loop time\n",
+                  (unsigned long)profileScopeCycles, getProfileLoopOverheadPercent());
+    Serial.print("section,count,mean_us,p50_us,p99_us,max_us");
+    for (int b = 0; b < PROFILE_BUCKET_COUNT; ++b) {
+        Serial.printf(",b%d", b);
+    }
+    Serial.println();
+    for (int s = 0; s < PROFILE_SECTION_COUNT; ++s) {
+        ProfileHistogram h = getProfileHistogram((ProfileSection)s);
+        if (h.count == 0) continue;
+        Serial.printf("%s,%lu,%lu,%lu,%lu,%lu", profileSectionName((ProfileSection)s), (unsigned long)h.count,
+                      (unsigned long)profileCyclesToUs((uint32_t)(h.totalCycles / h.count)),
+                      (unsigned long)profileCyclesToUs(h.quantileCycles(0.5f)),
+                      (unsigned long)profileCyclesToUs(h.quantileCycles(0.99f)),
+                      (unsigned long)profileCyclesToUs(h.maxCycles));
+        for (int b = 0; b < PROFILE_BUCKET_COUNT; ++b) {
+            Serial.printf(",%lu", (unsigned long)h.buckets[b]);
+        }
+        Serial.println();
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "state_machine.h" // TIMER_STATE_COUNT, one handler section per state
+
+// --- Loop Profiler ---
+// Per-section latency histograms in CPU cycles, with log2 buckets: a
+// PROFILE_SCOPE costs two cycle-counter reads and a few increments, so it
+// can stay in release builds. Build with -DLOOP_PROFILER=0 to compile every
+// scope out. Sections nest. The screens are drawn on the UI render task, so
+// a handler's time only includes publishing its screen. Each section is only
+// recorded by one task; readers take unlocked copies, which can be off by a
+// sample. setup() times empty scopes (PROFILE_SCOPE_COST) so the profile
+// page can show what the scopes cost as a share of loop time.
+
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 1
+#endif
+
+enum ProfileSection : uint8_t {
+    PROFILE_BUTTONS,        // StickCP2.update() in loop()
+    PROFILE_MIC_BLOCK,      // One mic block through the shot detector (capture task, Core 0)
+    PROFILE_LOOP_PASS,      // One loop() pass after its wait, every other loop() section included
+    PROFILE_SCOPE_COST,     // An empty PROFILE_SCOPE, timed by calibrateProfiler()
+    PROFILE_HANDLER_FIRST,  // + TimerState: that state's handler in loop()
+    PROFILE_DISPLAY_BOOT = PROFILE_HANDLER_FIRST + TIMER_STATE_COUNT, // setup()
+    PROFILE_DISPLAY_BOOT_ANIM, // This and the rest: UI render task
+    PROFILE_DISPLAY_MENU,
+    PROFILE_DISPLAY_TIMING,
+    PROFILE_DISPLAY_STOPPED,
+    PROFILE_DISPLAY_EDIT,
+    PROFILE_DISPLAY_CALIBRATION,
+    PROFILE_DISPLAY_BT_LATENCY,
+    PROFILE_DISPLAY_DEVICE_STATUS,
+    PROFILE_DISPLAY_LIST_FILES,
+    PROFILE_DISPLAY_DRY_FIRE_READY,
+    PROFILE_DISPLAY_DRY_FIRE_RUNNING,
+    PROFILE_DISPLAY_BT_SCAN,
+    PROFILE_SECTION_COUNT
+};
+
+inline ProfileSection profileHandlerSection(TimerState state) {
+    return (ProfileSection)(PROFILE_HANDLER_FIRST + state);
+}
+
+// Bucket b holds durations of [2^b, 2^(b+1)) cycles (bucket 0 also holds 0).
+static const int PROFILE_BUCKET_COUNT = 32;
+
+struct ProfileHistogram {
+    uint32_t buckets[PROFILE_BUCKET_COUNT];
+    uint32_t count;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+
+    void add(uint32_t cycles) {
+        buckets[bucketOf(cycles)]++;
+        count++;
+        totalCycles += cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+    }
+
+    // Upper edge of the bucket holding the 'fraction' quantile (0 if empty).
+    uint32_t quantileCycles(float fraction) const {
+        if (count == 0) return 0;
+        uint32_t rank = (uint32_t)(fraction * (float)(count - 1)) + 1;
+        uint32_t seen = 0;
+        for (int b = 0; b < PROFILE_BUCKET_COUNT; ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return (b == PROFILE_BUCKET_COUNT - 1) ? maxCycles : ((2u << b) - 1);
+            }
+        }
+        return maxCycles;
+    }
+
+    static int bucketOf(uint32_t cycles) {
+        return cycles ? 31 - __builtin_clz(cycles) : 0;
+    }
+};
+
+// Short name for the screen and the CSV.
+const char* profileSectionName(ProfileSection section);
+
+// Cycle counter of the calling core.
+uint32_t profileCycles();
+
+// Adds one duration to a section.
+void profileRecord(ProfileSection section, uint32_t cycles);
+
+// Copy of one section's histogram.
+ProfileHistogram getProfileHistogram(ProfileSection section);
+
+// Clears every histogram.
+void resetProfile();
+
+// Call from setup(): times empty PROFILE_SCOPEs, calls and recording
+// included, for getProfileScopeCycles().
+void calibrateProfiler();
+uint32_t getProfileScopeCycles(); // 0 before calibrateProfiler()
+
+// Cycles the loop() task's scopes cost, as a percentage of the cycles its
+// passes took (0 until a pass has been recorded).
+float getProfileLoopOverheadPercent();
+
+// Prints every section with samples to Serial as CSV: name, count, mean,
+// p50, p99, max (us) and then the bucket counts.
+void dumpProfileCsv();
+
+uint32_t profileCyclesToUs(uint32_t cycles);
+
+#if LOOP_PROFILER
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSection section) : section_(section), start_(profileCycles()) {}
+    ~ProfileScope() { profileRecord(section_, profileCycles() - start_); }
+
+private:
+    ProfileSection section_;
+    uint32_t start_;
+};
+#define PROFILE_SCOPE(section) ProfileScope profileScope(section)
+#else
+#define PROFILE_SCOPE(section) do {} while (0)
+#endif
+
+#endif // LOOP_PROFILER_H
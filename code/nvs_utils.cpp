@@ -1,69 +1,310 @@
 #include "nvs_utils.h"
 #include "globals.h" // Access to global variables and preferences object
 #include "config.h"  // Access to NVS_NAMESPACE and KEY_ constants
+#include "crc32.h"
 
-void loadSettings() {
-    preferences.begin(NVS_NAMESPACE, false); // Open NVS
+// NVS keys are limited to 15 characters, so per-speaker keys use a hash of the name.
+static void btLatencyKey(const String& deviceName, char* key) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (const char* c = deviceName.c_str(); *c != '\0'; ++c) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    sprintf(key, "btLat%08lx", (unsigned long)hash);
+}
+
+static int clampBtAudioOffset(int offsetMs) {
+    if (offsetMs < 0) return 0;
+    if (offsetMs > BT_AUDIO_OFFSET_MAX_MS) return BT_AUDIO_OFFSET_MAX_MS;
+    return offsetMs;
+}
+
+// All settings live in one NVS blob (KEY_SETTINGS): a boot is one read, and a
+// save is one write that NVS commits atomically, so a reset mid-save leaves
+// the old settings or the new ones, never a mix. Fields are only ever
+// appended: a blob written by an older version is read up to its own size,
+// the newer fields keep their defaults, and SETTINGS_VERSION goes up with
+// each field added. Every field is 4 bytes (or a multiple), so the struct
+// has no padding and two copies can be compared with memcmp.
+struct StoredSettings {
+    uint16_t version;
+    uint16_t bytes;     // sizeof(StoredSettings) when written
+    uint32_t crc;       // CRC-32 of the bytes after this header, up to 'bytes'
+    int32_t maxShots;
+    uint32_t beepDurationMs;
+    int32_t beepToneHz;
+    uint32_t startRandomDelayMs;
+    int32_t shotThresholdRms;
+    int32_t shotMarginDb;
+    uint32_t shotLockoutMs;
+    int32_t dryFireParBeepCount;
+    float dryFireParTimesSec[MAX_PAR_BEEPS];
+    float recoilThreshold;
+    int32_t screenRotation;
+    uint8_t playBootAnimation;
+    uint8_t enableAutoSleep;
+    uint8_t btAutoReconnect;
+    uint8_t reserved;
+    int32_t btVolume;
+    int32_t btAudioOffsetMs;
+    float peakBatteryVoltage;
+    char btDeviceName[SETTINGS_BT_NAME_BYTES];
+};
+
+static_assert(sizeof(StoredSettings) == 168, "StoredSettings must not have padding");
+
+static const size_t SETTINGS_HEADER_BYTES = 8;
+static const size_t SETTINGS_BLOB_MAX_BYTES = 512; // A newer version's blob still loads after a downgrade
+
+static StoredSettings stored;          // As NVS holds it (the defaults if it holds nothing)
+static StoredSettings pending;         // Waiting out SETTINGS_SAVE_DELAY_MS
+static bool savePending = false;
+static unsigned long saveDueMs = 0;
+
+static uint32_t settingsCrc(const uint8_t* blob, size_t bytes) {
+    return crc32(blob + SETTINGS_HEADER_BYTES, bytes - SETTINGS_HEADER_BYTES);
+}
+
+static void defaultSettings(StoredSettings& s) {
+    memset(&s, 0, sizeof(s));
+    s.maxShots = 10;
+    s.beepDurationMs = 150;
+    s.beepToneHz = 2000;
+    s.startRandomDelayMs = 0;
+    s.shotThresholdRms = 0;
+    s.shotMarginDb = SHOT_MARGIN_DB_DEFAULT;
+    s.shotLockoutMs = SHOT_MIN_LOCKOUT_MS;
+    s.dryFireParBeepCount = 3;
+    for (int i = 0; i < MAX_PAR_BEEPS; ++i) s.dryFireParTimesSec[i] = 1.0f;
+    s.recoilThreshold = 1.5f;
+    s.screenRotation = 3;
+    s.playBootAnimation = true;
+    s.enableAutoSleep = true;
+    s.btAutoReconnect = false;
+    s.btVolume = 80;
+    s.btAudioOffsetMs = 0;
+    s.peakBatteryVoltage = 4.2f;
+    strncpy(s.btDeviceName, "LEXON MINO L", sizeof(s.btDeviceName) - 1);
+}
+
+// False if there is no blob or it fails the CRC; 's' then holds the defaults.
+static bool readSettingsBlob(StoredSettings& s) {
+    defaultSettings(s);
+    size_t length = preferences.getBytesLength(KEY_SETTINGS);
+    if (length < SETTINGS_HEADER_BYTES || length > SETTINGS_BLOB_MAX_BYTES) return false;
+    static uint8_t blob[SETTINGS_BLOB_MAX_BYTES];
+    if (preferences.getBytes(KEY_SETTINGS, blob, length) != length) return false;
+
+    StoredSettings header;
+    memcpy(&header, blob, SETTINGS_HEADER_BYTES);
+    if (header.version == 0 || header.bytes != length || header.crc != settingsCrc(blob, length)) {
+        return false;
+    }
+    memcpy(&s, blob, min(length, sizeof(s)));
+    return true;
+}
+
+// The keys settings were stored under before the blob.
+static bool forEachLegacyKey(bool (*action)(const char* key)) {
+    const char* keys[] = {
+        KEY_MAX_SHOTS, KEY_BEEP_DUR, KEY_BEEP_HZ, KEY_START_DELAY, KEY_SHOT_THRESH, KEY_SHOT_MARGIN_DB,
+        KEY_SHOT_LOCKOUT, KEY_DF_BEEP_CNT, KEY_NR_RECOIL, KEY_ROTATION, KEY_BOOT_ANIM, KEY_AUTO_SLEEP,
+        KEY_BT_DEVICE_NAME, KEY_BT_AUTO_RECONNECT, KEY_BT_VOLUME, KEY_BT_AUDIO_OFFSET, KEY_PEAK_BATT,
+    };
+    bool any = false;
+    for (const char* key : keys) any |= action(key);
+    for (int i = 0; i < MAX_PAR_BEEPS; ++i) {
+        char key[12];
+        sprintf(key, "dfParT_%d", i);
+        any |= action(key);
+    }
+    return any;
+}
+
+static bool legacyKeyExists(const char* key) { return preferences.isKey(key); }
+static bool removeLegacyKey(const char* key) { return preferences.remove(key); }
+
+// Reads the one-key-per-setting layout, over the defaults already in 's'.
+static void readLegacySettings(StoredSettings& s) {
+    s.maxShots = preferences.getInt(KEY_MAX_SHOTS, s.maxShots);
+    s.beepDurationMs = preferences.getULong(KEY_BEEP_DUR, s.beepDurationMs);
+    s.beepToneHz = preferences.getInt(KEY_BEEP_HZ, s.beepToneHz);
+    s.startRandomDelayMs = preferences.getULong(KEY_START_DELAY, s.startRandomDelayMs);
+    s.shotThresholdRms = preferences.getInt(KEY_SHOT_THRESH, s.shotThresholdRms);
+    s.shotMarginDb = preferences.getInt(KEY_SHOT_MARGIN_DB, s.shotMarginDb);
+    s.shotLockoutMs = preferences.getULong(KEY_SHOT_LOCKOUT, s.shotLockoutMs);
+    s.dryFireParBeepCount = preferences.getInt(KEY_DF_BEEP_CNT, s.dryFireParBeepCount);
+    for (int i = 0; i < MAX_PAR_BEEPS; ++i) {
+        char key[12];
+        sprintf(key, "dfParT_%d", i);
+        s.dryFireParTimesSec[i] = preferences.getFloat(key, s.dryFireParTimesSec[i]);
+    }
+    s.recoilThreshold = preferences.getFloat(KEY_NR_RECOIL, s.recoilThreshold);
+    s.screenRotation = preferences.getInt(KEY_ROTATION, s.screenRotation);
+    s.playBootAnimation = preferences.getBool(KEY_BOOT_ANIM, s.playBootAnimation);
+    s.enableAutoSleep = preferences.getBool(KEY_AUTO_SLEEP, s.enableAutoSleep);
+    String deviceName = preferences.getString(KEY_BT_DEVICE_NAME, s.btDeviceName);
+    strncpy(s.btDeviceName, deviceName.c_str(), sizeof(s.btDeviceName) - 1);
+    s.btAutoReconnect = preferences.getBool(KEY_BT_AUTO_RECONNECT, s.btAutoReconnect);
+    s.btVolume = preferences.getInt(KEY_BT_VOLUME, s.btVolume);
+    s.btAudioOffsetMs = preferences.getInt(KEY_BT_AUDIO_OFFSET, s.btAudioOffsetMs);
+    s.peakBatteryVoltage = preferences.getFloat(KEY_PEAK_BATT, s.peakBatteryVoltage);
+}
 
-    currentMaxShots = preferences.getInt(KEY_MAX_SHOTS, 10);
+static void applySettings(const StoredSettings& s) {
+    currentMaxShots = s.maxShots;
     if (currentMaxShots > MAX_SHOTS_LIMIT) currentMaxShots = MAX_SHOTS_LIMIT;
     else if (currentMaxShots <= 0) currentMaxShots = 1;
 
-    currentBeepDuration = preferences.getULong(KEY_BEEP_DUR, 150);
-    currentBeepToneHz = preferences.getInt(KEY_BEEP_HZ, 2000);
-    shotThresholdRms = preferences.getInt(KEY_SHOT_THRESH, 15311);
-    dryFireParBeepCount = preferences.getInt(KEY_DF_BEEP_CNT, 3);
+    currentBeepDuration = s.beepDurationMs;
+    currentBeepToneHz = s.beepToneHz;
+    startRandomDelayMs = s.startRandomDelayMs;
+    if (startRandomDelayMs > START_RANDOM_DELAY_MAX_MS) startRandomDelayMs = 0;
+    shotThresholdRms = s.shotThresholdRms;
+    shotMarginDb = s.shotMarginDb;
+    if (shotMarginDb < SHOT_MARGIN_DB_MIN || shotMarginDb > SHOT_MARGIN_DB_MAX) shotMarginDb = SHOT_MARGIN_DB_DEFAULT;
+    shotLockoutMs = s.shotLockoutMs;
+    if (shotLockoutMs < SHOT_LOCKOUT_MS_MIN || shotLockoutMs > SHOT_LOCKOUT_MS_MAX) shotLockoutMs = SHOT_MIN_LOCKOUT_MS;
+    dryFireParBeepCount = s.dryFireParBeepCount;
     if (dryFireParBeepCount < 1) dryFireParBeepCount = 1;
     if (dryFireParBeepCount > MAX_PAR_BEEPS) dryFireParBeepCount = MAX_PAR_BEEPS;
-
     for (int i = 0; i < MAX_PAR_BEEPS; ++i) {
-        char key[12];
-        sprintf(key, "dfParT_%d", i);
-        dryFireParTimesSec[i] = preferences.getFloat(key, 1.0f);
+        dryFireParTimesSec[i] = s.dryFireParTimesSec[i];
     }
 
-    recoilThreshold = preferences.getFloat(KEY_NR_RECOIL, 1.5f);
-    screenRotationSetting = preferences.getInt(KEY_ROTATION, 3);
+    recoilThreshold = s.recoilThreshold;
+    screenRotationSetting = s.screenRotation;
     if (screenRotationSetting < 0 || screenRotationSetting > 3) screenRotationSetting = 3;
-    playBootAnimation = preferences.getBool(KEY_BOOT_ANIM, true);
-    enableAutoSleep = preferences.getBool(KEY_AUTO_SLEEP, true);
+    playBootAnimation = s.playBootAnimation;
+    enableAutoSleep = s.enableAutoSleep;
+
+    char deviceName[SETTINGS_BT_NAME_BYTES];
+    memcpy(deviceName, s.btDeviceName, sizeof(deviceName));
+    deviceName[sizeof(deviceName) - 1] = '\0';
+    currentBluetoothDeviceName = deviceName;
+    currentBluetoothAutoReconnect = s.btAutoReconnect;
+    currentBluetoothVolume = s.btVolume;
+    // The last offset in use, unless the selected speaker has its own.
+    currentBluetoothAudioOffsetMs = clampBtAudioOffset(s.btAudioOffsetMs);
+    loadBtLatencyForDevice(currentBluetoothDeviceName, currentBluetoothAudioOffsetMs);
+
+    peakBatteryVoltage = s.peakBatteryVoltage;
+}
+
+// The settings in use, as they would be stored. The peak battery voltage is
+// left at the stored value, which only savePeakVoltage() moves.
+static void captureSettings(StoredSettings& s) {
+    defaultSettings(s);
+    s.maxShots = currentMaxShots;
+    s.beepDurationMs = currentBeepDuration;
+    s.beepToneHz = currentBeepToneHz;
+    s.startRandomDelayMs = startRandomDelayMs;
+    s.shotThresholdRms = shotThresholdRms;
+    s.shotMarginDb = shotMarginDb;
+    s.shotLockoutMs = shotLockoutMs;
+    s.dryFireParBeepCount = dryFireParBeepCount;
+    for (int i = 0; i < MAX_PAR_BEEPS; ++i) {
+        s.dryFireParTimesSec[i] = dryFireParTimesSec[i];
+    }
+    s.recoilThreshold = recoilThreshold;
+    s.screenRotation = screenRotationSetting;
+    s.playBootAnimation = playBootAnimation;
+    s.enableAutoSleep = enableAutoSleep;
+    memset(s.btDeviceName, 0, sizeof(s.btDeviceName));
+    strncpy(s.btDeviceName, currentBluetoothDeviceName.c_str(), sizeof(s.btDeviceName) - 1);
+    s.btAutoReconnect = currentBluetoothAutoReconnect;
+    s.btVolume = currentBluetoothVolume;
+    s.btAudioOffsetMs = currentBluetoothAudioOffsetMs;
+    s.peakBatteryVoltage = (savePending ? pending : stored).peakBatteryVoltage;
+}
+
+static bool sameSettings(const StoredSettings& a, const StoredSettings& b) {
+    return memcmp((const uint8_t*)&a + SETTINGS_HEADER_BYTES, (const uint8_t*)&b + SETTINGS_HEADER_BYTES,
+                  sizeof(StoredSettings) - SETTINGS_HEADER_BYTES) == 0;
+}
+
+// Schedules 'next' to be written once SETTINGS_SAVE_DELAY_MS passes without
+// another change; a change that puts back what NVS holds cancels the write.
+static void queueSave(const StoredSettings& next) {
+    if (sameSettings(next, stored)) {
+        savePending = false;
+        return;
+    }
+    pending = next;
+    savePending = true;
+    saveDueMs = millis() + SETTINGS_SAVE_DELAY_MS;
+}
 
-    currentBluetoothDeviceName = preferences.getString(KEY_BT_DEVICE_NAME, "LEXON MINO L");
-    currentBluetoothAutoReconnect = preferences.getBool(KEY_BT_AUTO_RECONNECT, false);
-    currentBluetoothVolume = preferences.getInt(KEY_BT_VOLUME, 80);
+void loadSettings() {
+    preferences.begin(NVS_NAMESPACE, false); // Open NVS
 
-    peakBatteryVoltage = preferences.getFloat(KEY_PEAK_BATT, 4.2f); // Also load peak battery here
+    StoredSettings loaded;
+    if (!readSettingsBlob(loaded) && forEachLegacyKey(legacyKeyExists)) {
+        // First boot with the blob: carry the old keys over, then drop them
+        // once the blob is safely written.
+        readLegacySettings(loaded);
+        defaultSettings(stored);
+        pending = loaded;
+        savePending = true;
+        flushSettings();
+        if (!savePending) forEachLegacyKey(removeLegacyKey);
+    } else {
+        stored = loaded;
+    }
+    applySettings(loaded);
 
     // preferences.end(); // Keep NVS open if frequently accessed, or close if done for now
 }
 
 void saveSettings() {
-    // preferences.begin(NVS_NAMESPACE, false); // Ensure NVS is open if not already
+    StoredSettings next;
+    captureSettings(next);
+    queueSave(next);
+}
 
-    preferences.putInt(KEY_MAX_SHOTS, currentMaxShots);
-    preferences.putULong(KEY_BEEP_DUR, currentBeepDuration);
-    preferences.putInt(KEY_BEEP_HZ, currentBeepToneHz);
-    preferences.putInt(KEY_SHOT_THRESH, shotThresholdRms);
-    preferences.putInt(KEY_DF_BEEP_CNT, dryFireParBeepCount);
-    for (int i = 0; i < MAX_PAR_BEEPS; ++i) {
-         char key[12];
-         sprintf(key, "dfParT_%d", i);
-         preferences.putFloat(key, dryFireParTimesSec[i]);
+void savePeakVoltage(float voltage) {
+    if (fabsf(voltage - stored.peakBatteryVoltage) < PEAK_BATT_SAVE_STEP_V) return;
+    StoredSettings next = savePending ? pending : stored; // Not any edits the menu hasn't saved
+    next.peakBatteryVoltage = voltage;
+    queueSave(next);
+}
+
+void flushSettings() {
+    if (!savePending) return;
+    pending.version = SETTINGS_VERSION;
+    pending.bytes = sizeof(StoredSettings);
+    pending.crc = settingsCrc((const uint8_t*)&pending, sizeof(StoredSettings));
+    if (preferences.putBytes(KEY_SETTINGS, &pending, sizeof(StoredSettings)) == sizeof(StoredSettings)) {
+        stored = pending;
+        savePending = false;
+    } else {
+        saveDueMs = millis() + SETTINGS_SAVE_DELAY_MS; // Try again later
     }
-    preferences.putFloat(KEY_NR_RECOIL, recoilThreshold);
-    preferences.putInt(KEY_ROTATION, screenRotationSetting);
-    preferences.putBool(KEY_BOOT_ANIM, playBootAnimation);
-    preferences.putBool(KEY_AUTO_SLEEP, enableAutoSleep);
+}
 
-    preferences.putString(KEY_BT_DEVICE_NAME, currentBluetoothDeviceName);
-    preferences.putBool(KEY_BT_AUTO_RECONNECT, currentBluetoothAutoReconnect);
-    preferences.putInt(KEY_BT_VOLUME, currentBluetoothVolume);
+void serviceSettingsSave() {
+    if (savePending && (long)(millis() - saveDueMs) >= 0) {
+        flushSettings();
+    }
+}
 
-    // preferences.end(); // Close NVS if done with batch of writes
+uint32_t settingsSaveWaitMs() {
+    if (!savePending) return UINT32_MAX;
+    long remainingMs = (long)(saveDueMs - millis());
+    return (remainingMs > 0) ? (uint32_t)remainingMs : 0;
 }
 
-void savePeakVoltage(float voltage) {
-    // preferences.begin(NVS_NAMESPACE, false); // Ensure NVS is open
-    preferences.putFloat(KEY_PEAK_BATT, voltage);
-    // preferences.end();
+bool loadBtLatencyForDevice(const String& deviceName, int& latencyMs) {
+    if (deviceName.isEmpty()) return false;
+    char key[16];
+    btLatencyKey(deviceName, key);
+    if (!preferences.isKey(key)) return false;
+    latencyMs = clampBtAudioOffset(preferences.getInt(key, latencyMs));
+    return true;
+}
+
+void saveBtLatencyForDevice(const String& deviceName, int latencyMs) {
+    if (deviceName.isEmpty()) return;
+    char key[16];
+    btLatencyKey(deviceName, key);
+    preferences.putInt(key, clampBtAudioOffset(latencyMs));
 }
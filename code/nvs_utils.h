@@ -4,8 +4,27 @@
 #include <Preferences.h> // Already in globals.h but good for clarity
 #include <Arduino.h>     // For String
 
+// Reads the settings blob, or on the first boot with it, the settings from
+// the old one-key-per-setting layout, which it then replaces.
 void loadSettings();
+
+// Settings are written only when they differ from what NVS holds, and only
+// once SETTINGS_SAVE_DELAY_MS passes without another change, so a run of
+// changes is one flash write. serviceSettingsSave() does the write.
 void saveSettings();
-void savePeakVoltage(float voltage);
+void savePeakVoltage(float voltage); // Only a rise of PEAK_BATT_SAVE_STEP_V or more is stored
+
+// Call from loop() while nothing is being timed: writes a save that is due.
+void serviceSettingsSave();
+// Milliseconds until a queued save is due (UINT32_MAX if none).
+uint32_t settingsSaveWaitMs();
+// Writes a queued save now, before power off or sleep.
+void flushSettings();
+
+// Bluetooth audio offset (speaker latency) measured for one speaker, keyed by
+// its name. Returns false (leaving 'latencyMs' alone) if that speaker has no
+// stored value. Written only when the offset is set for that speaker.
+bool loadBtLatencyForDevice(const String& deviceName, int& latencyMs);
+void saveBtLatencyForDevice(const String& deviceName, int latencyMs);
 
 #endif // NVS_UTILS_H
@@ -0,0 +1,159 @@
+#include "onset_detector.h"
+#include "dsp_kernels.h"
+#include <math.h>
+
+// Amplitude fraction to a power ratio in Q16, clamped to [0, 1].
+static uint32_t fractionToPowerQ16(float fraction) {
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    return (uint32_t)(fraction * fraction * 65536.0f);
+}
+
+// dB (re 1 LSB^2) to an integer power level, saturating instead of wrapping.
+static uint32_t dbToPower(float db) {
+    float power = powf(10.0f, db / 10.0f);
+    if (power >= 4294967040.0f) return UINT32_MAX;
+    if (power <= 0.0f) return 0;
+    return (uint32_t)power;
+}
+
+void OnsetDetector::configure(const OnsetDetectorConfig& config) {
+    config_ = config;
+    if (config_.sampleRateHz == 0) config_.sampleRateHz = 16000;
+    if (config_.floorQuantile <= 0.0f || config_.floorQuantile >= 1.0f) config_.floorQuantile = 0.5f;
+
+    attackQ31_ = dspTimeConstantToQ31(config_.attackMs, config_.sampleRateHz);
+    releaseQ31_ = dspTimeConstantToQ31(config_.releaseMs, config_.sampleRateHz);
+
+    // Floor is updated once per millisecond. Stepping up by q and down by (1 - q)
+    // settles where a fraction (1 - q) of the envelope lies above the floor.
+    frameSamples_ = config_.sampleRateHz / 1000;
+    if (frameSamples_ == 0) frameSamples_ = 1;
+    float stepDb = config_.floorSlewDbPerSec / 1000.0f;
+    floorStepUpDb_ = stepDb * config_.floorQuantile;
+    floorStepDownDb_ = stepDb * (1.0f - config_.floorQuantile);
+    lockoutSamples_ = (uint32_t)((uint64_t)config_.lockoutMs * config_.sampleRateHz / 1000);
+    rearmQ16_ = fractionToPowerQ16(config_.rearmFraction);
+    echoSamples_ = (uint32_t)((uint64_t)config_.echoWindowMs * config_.sampleRateHz / 1000);
+    echoQ16_ = fractionToPowerQ16(config_.echoPeakRatio);
+    confirmSamples_ = (uint32_t)(kEchoConfirmAttacks * config_.attackMs * config_.sampleRateHz / 1000.0f);
+    if (confirmSamples_ == 0) confirmSamples_ = 1;
+
+    float initialRms = (config_.initialFloorRms > 1.0f) ? config_.initialFloorRms : 1.0f;
+    floorDb_ = 20.0f * log10f(initialRms);
+    power_ = (uint32_t)(initialRms * initialRms);
+    frameFill_ = 0;
+    rearm();
+    updateLevels();
+}
+
+void OnsetDetector::setThresholds(float thresholdDb, float hysteresisDb, float minRms) {
+    config_.thresholdDb = thresholdDb;
+    config_.hysteresisDb = hysteresisDb;
+    config_.minRms = minRms;
+    updateLevels();
+}
+
+void OnsetDetector::rearm() {
+    active_ = false;
+    lockoutRemaining_ = 0;
+    echoRemaining_ = 0;
+    pendingRemaining_ = 0;
+    shotPeak_ = 0;
+    valley_ = 0;
+}
+
+size_t OnsetDetector::process(const int16_t* samples, size_t count, OnsetHit* hits, size_t maxHits, uint32_t* envelopeOut) {
+    uint32_t chunkEnv[kChunkSamples];
+    size_t hitCount = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        // Chunks never cross a floor-update frame boundary.
+        size_t chunk = frameSamples_ - frameFill_;
+        if (chunk > count - i) chunk = count - i;
+        if (chunk > kChunkSamples) chunk = kChunkSamples;
+
+        uint32_t* env = (envelopeOut != nullptr) ? envelopeOut + i : chunkEnv;
+        dspPowerEnvelope(samples + i, chunk, attackQ31_, releaseQ31_, &power_, env);
+
+        for (size_t j = 0; j < chunk; ++j) {
+            if (lockoutRemaining_ > 0) --lockoutRemaining_;
+            if (echoRemaining_ > 0) --echoRemaining_;
+            uint32_t p = env[j];
+            if (!active_) {
+                if (p < valley_) valley_ = p;
+                bool rose = (uint64_t)p * 256 > (uint64_t)valley_ * riseQ8_;
+                if (pendingRemaining_ > 0 || (p > onPower_ && p >= minPower_ && rose)) {
+                    bool gated = echoRemaining_ > 0 || pendingRemaining_ > 0;
+                    bool shotLevel = !gated || (uint64_t)p * 65536 >= (uint64_t)shotPeak_ * echoQ16_;
+                    if (shotLevel) {
+                        active_ = true;
+                        pendingRemaining_ = 0;
+                        lockoutRemaining_ = lockoutSamples_;
+                        echoRemaining_ = echoSamples_;
+                        shotPeak_ = p;
+                        if (hitCount < maxHits) {
+                            hits[hitCount].offset = (uint32_t)(i + j);
+                            hits[hitCount].power = p;
+                            ++hitCount;
+                        }
+                    } else if (pendingRemaining_ == 0) {
+                        pendingRemaining_ = confirmSamples_;
+                    } else if (--pendingRemaining_ == 0) {
+                        // Never got as loud as a shot: an echo of the last one,
+                        // ridden out like its tail.
+                        active_ = true;
+                    }
+                }
+            } else {
+                if (p > shotPeak_) shotPeak_ = p;
+                bool decayed = (uint64_t)p * 65536 < (uint64_t)shotPeak_ * rearmQ16_;
+                if (lockoutRemaining_ == 0 && (p < offPower_ || decayed)) {
+                    active_ = false;
+                    valley_ = p;
+                }
+            }
+        }
+
+        i += chunk;
+        frameFill_ += (uint32_t)chunk;
+        if (frameFill_ >= frameSamples_) {
+            frameFill_ = 0;
+            updateFloor();
+        }
+    }
+    return hitCount;
+}
+
+float OnsetDetector::envelopeRms() const {
+    return sqrtf((float)power_);
+}
+
+float OnsetDetector::noiseFloorRms() const {
+    return powf(10.0f, floorDb_ / 20.0f);
+}
+
+// Called once per frame. The floor is frozen during the lockout and the echo
+// window after an onset so the shot, its echoes and the start of its tail do
+// not drag it upwards; a sustained loud noise still raises it afterwards and
+// eventually releases the trigger.
+void OnsetDetector::updateFloor() {
+    if (lockoutRemaining_ > 0 || echoRemaining_ > 0) return;
+    float envDb = 10.0f * log10f((float)power_ + 1.0f);
+    if (envDb > floorDb_) {
+        floorDb_ += floorStepUpDb_;
+    } else {
+        floorDb_ -= floorStepDownDb_;
+        if (floorDb_ < 0.0f) floorDb_ = 0.0f;
+    }
+    updateLevels();
+}
+
+void OnsetDetector::updateLevels() {
+    onPower_ = dbToPower(floorDb_ + config_.thresholdDb);
+    offPower_ = dbToPower(floorDb_ + config_.thresholdDb - config_.hysteresisDb);
+    minPower_ = (uint32_t)(config_.minRms * config_.minRms);
+    float hysteresis = (config_.hysteresisDb > 0.0f) ? config_.hysteresisDb : 0.0f;
+    riseQ8_ = (uint32_t)(256.0f * powf(10.0f, hysteresis / 10.0f));
+}
@@ -0,0 +1,101 @@
+#ifndef ONSET_DETECTOR_H
+#define ONSET_DETECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming onset detector: power envelope follower + adaptive noise floor.
+// The floor is a running quantile of the envelope (in dB) tracked with a
+// fixed-step stochastic estimator, so memory and per-sample cost are constant.
+// An onset fires when the envelope rises 'thresholdDb' above the floor (and
+// above the optional absolute minimum). After a short minimum lockout it
+// re-arms as soon as the envelope decays below 'rearmFraction' of the peak of
+// the current shot (or back under the hysteresis level). Once re-armed, the next
+// onset needs the envelope to climb 'hysteresisDb' above its lowest point since
+// re-arming, so a fast follow-up shot is caught while the tail of the first is
+// still ringing. For 'echoWindowMs' after an onset the envelope must also
+// reach 'echoPeakRatio' of the previous shot's peak RMS within a few attack
+// time constants of crossing the onset level; the quieter discrete echoes off
+// walls and berms that follow a shot never do, and are ridden out like its
+// tail instead of counting as shots of their own. The floor is held for that
+// window too, so a reverberant room does not lift it between shots.
+// The per-sample work is the fixed-point envelope kernel from dsp_kernels plus
+// integer compares; floating point is only used once per floor update.
+
+typedef struct {
+    uint32_t sampleRateHz;
+    float attackMs;          // Envelope rise time constant
+    float releaseMs;         // Envelope decay time constant
+    float thresholdDb;       // Onset level above the noise floor
+    float hysteresisDb;      // Re-arm level below the onset level
+    float minRms;            // Absolute minimum envelope RMS (0 = off)
+    float floorQuantile;     // 0.5 = running median of the envelope
+    float floorSlewDbPerSec; // Adaptation speed of the noise floor
+    float initialFloorRms;
+    unsigned long lockoutMs; // Minimum time between onsets
+    float rearmFraction;     // Re-arm once the envelope RMS drops below this fraction of the shot peak
+    unsigned long echoWindowMs; // Echo gate after an onset (0 = off)
+    float echoPeakRatio;     // Inside it, onsets need this fraction of the previous shot's peak RMS
+} OnsetDetectorConfig;
+
+typedef struct {
+    uint32_t offset; // Sample offset within the processed block
+    uint32_t power;  // Envelope power at the onset (LSB^2)
+} OnsetHit;
+
+class OnsetDetector {
+public:
+    // Applies a configuration and resets all state, including the noise floor.
+    void configure(const OnsetDetectorConfig& config);
+
+    // Changes the trigger levels without disturbing the learned noise floor.
+    void setThresholds(float thresholdDb, float hysteresisDb, float minRms);
+
+    // Clears trigger / lockout state; the noise floor is kept.
+    void rearm();
+
+    // Feeds a block of samples. Returns the number of onsets written to 'hits'.
+    // If 'envelopeOut' is given it receives the envelope after every sample.
+    size_t process(const int16_t* samples, size_t count, OnsetHit* hits, size_t maxHits, uint32_t* envelopeOut = nullptr);
+
+    float envelopeRms() const;
+    float noiseFloorRms() const;
+    float noiseFloorDb() const { return floorDb_; }
+    bool isActive() const { return active_; }
+
+private:
+    void updateFloor();
+    void updateLevels();
+
+    static const size_t kChunkSamples = 64;
+    static constexpr float kEchoConfirmAttacks = 4.0f; // Time an onset in the echo window has to reach the shot level
+
+    OnsetDetectorConfig config_ = {};
+    int32_t attackQ31_ = INT32_MAX;
+    int32_t releaseQ31_ = INT32_MAX;
+    float floorStepUpDb_ = 0.0f;
+    float floorStepDownDb_ = 0.0f;
+    uint32_t frameSamples_ = 16;
+    uint32_t lockoutSamples_ = 0;
+    uint32_t rearmQ16_ = 0;  // rearmFraction^2 (power ratio), Q16
+    uint32_t echoSamples_ = 0;
+    uint32_t echoQ16_ = 0;   // echoPeakRatio^2 (power ratio), Q16
+    uint32_t confirmSamples_ = 1;
+    uint32_t riseQ8_ = 256;  // hysteresisDb as a power ratio, Q8
+
+    uint32_t power_ = 0;     // Envelope (mean square, LSB^2)
+    float floorDb_ = 0.0f;   // Noise floor, dB re 1 LSB RMS
+    uint32_t onPower_ = 0;
+    uint32_t offPower_ = 0;
+    uint32_t minPower_ = 0;
+
+    uint32_t frameFill_ = 0;
+    uint32_t lockoutRemaining_ = 0;
+    uint32_t echoRemaining_ = 0;
+    uint32_t pendingRemaining_ = 0; // Onset in the echo window, not yet at the shot level
+    uint32_t shotPeak_ = 0;   // Highest envelope since the current onset
+    uint32_t valley_ = 0;     // Lowest envelope since re-arming
+    bool active_ = false;
+};
+
+#endif // ONSET_DETECTOR_H
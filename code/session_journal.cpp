@@ -0,0 +1,269 @@
+#include "session_journal.h"
+#include "config.h"
+#include <LittleFS.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+static_assert(MAX_SHOTS_LIMIT <= SESSION_RECORD_MAX_SHOTS, "A string must fit in one session record");
+
+static QueueHandle_t journalQueue = NULL;
+static SemaphoreHandle_t journalMutex = NULL; // Held around every access to the journal files
+static TaskHandle_t journalTaskHandle = NULL;
+static uint32_t nextSeq = 1;  // Only loop() appends
+static uint16_t bootId = 0;
+static uint32_t droppedSessions = 0;
+
+static bool readRecordAt(File& log, uint32_t offset, SessionRecord& record, size_t& recordBytes) {
+    uint8_t buffer[SESSION_RECORD_MAX_BYTES];
+    if (!log.seek(offset)) return false;
+    size_t length = log.read(buffer, sizeof(buffer));
+    return sessionRecordDecode(buffer, length, record, recordBytes);
+}
+
+// LittleFS files can't be truncated in place; copies the first 'bytes' over.
+static void truncateFile(const char* path, size_t bytes) {
+    String tmpPath = String(path) + ".tmp";
+    File in = LittleFS.open(path, FILE_READ);
+    File out = LittleFS.open(tmpPath, FILE_WRITE);
+    uint8_t buffer[128];
+    while (bytes > 0) {
+        size_t n = in.read(buffer, min(bytes, sizeof(buffer)));
+        if (n == 0) break;
+        out.write(buffer, n);
+        bytes -= n;
+    }
+    in.close();
+    out.close();
+    LittleFS.remove(path);
+    LittleFS.rename(tmpPath.c_str(), path);
+}
+
+// The record the last index entry of a generation points at.
+static bool lastIndexedRecord(const char* logPath, const char* indexPath, SessionRecord& record, uint32_t& endOffset) {
+    if (!LittleFS.exists(logPath) || !LittleFS.exists(indexPath)) return false;
+    File index = LittleFS.open(indexPath, FILE_READ);
+    File log = LittleFS.open(logPath, FILE_READ);
+    size_t entries = index.size() / SESSION_INDEX_ENTRY_BYTES;
+    uint8_t entry[SESSION_INDEX_ENTRY_BYTES];
+    if (entries == 0 ||
+        !index.seek((entries - 1) * SESSION_INDEX_ENTRY_BYTES) ||
+        index.read(entry, sizeof(entry)) != sizeof(entry)) {
+        return false;
+    }
+    uint32_t seq, offset;
+    size_t recordBytes;
+    sessionIndexDecode(entry, seq, offset);
+    if (!readRecordAt(log, offset, record, recordBytes) || record.seq != seq) return false;
+    endOffset = offset + recordBytes;
+    return true;
+}
+
+// The writer syncs the log before the index, so a reset in between leaves
+// records the index does not know about yet; a torn index entry is dropped.
+// Without an index at all, the whole log is indexed again.
+static bool recoverIndex(SessionRecord& last) {
+    if (!LittleFS.exists(SESSION_LOG_PATH)) {
+        LittleFS.remove(SESSION_INDEX_PATH);
+        return false;
+    }
+    if (LittleFS.exists(SESSION_INDEX_PATH)) {
+        File index = LittleFS.open(SESSION_INDEX_PATH, FILE_READ);
+        size_t indexBytes = index.size();
+        index.close();
+        if (indexBytes % SESSION_INDEX_ENTRY_BYTES != 0) {
+            truncateFile(SESSION_INDEX_PATH, indexBytes - indexBytes % SESSION_INDEX_ENTRY_BYTES);
+        }
+    }
+
+    File log = LittleFS.open(SESSION_LOG_PATH, FILE_READ);
+    uint32_t scanFrom = 0;
+    bool found = lastIndexedRecord(SESSION_LOG_PATH, SESSION_INDEX_PATH, last, scanFrom);
+    if (!found && LittleFS.exists(SESSION_INDEX_PATH)) {
+        File index = LittleFS.open(SESSION_INDEX_PATH, FILE_READ);
+        if (index.size() > 0) scanFrom = log.size(); // Damaged last record: don't guess past it
+    }
+
+    File index = LittleFS.open(SESSION_INDEX_PATH, FILE_APPEND);
+    SessionRecord record;
+    size_t recordBytes;
+    uint8_t entry[SESSION_INDEX_ENTRY_BYTES];
+    while (scanFrom < log.size() && readRecordAt(log, scanFrom, record, recordBytes)) {
+        sessionIndexEncode(record.seq, scanFrom, entry);
+        index.write(entry, sizeof(entry));
+        last = record;
+        found = true;
+        scanFrom += recordBytes;
+    }
+    return found;
+}
+
+// Open in the writer between records; both are only touched under journalMutex.
+static File journalLog;
+static File journalIndex;
+
+// Records encoded but not yet written, with their index entries.
+static uint8_t pendingLog[SESSION_JOURNAL_BUFFER_BYTES];
+static size_t pendingLogBytes = 0;
+static uint8_t pendingIndex[SESSION_JOURNAL_BUFFER_BYTES / SESSION_RECORD_HEADER_BYTES * SESSION_INDEX_ENTRY_BYTES];
+static size_t pendingIndexBytes = 0;
+
+static bool openJournal() {
+    if (!journalLog) journalLog = LittleFS.open(SESSION_LOG_PATH, FILE_APPEND);
+    if (!journalIndex) journalIndex = LittleFS.open(SESSION_INDEX_PATH, FILE_APPEND);
+    return journalLog && journalIndex;
+}
+
+// Writes and syncs the pending records, then their index entries. Log first:
+// an index entry must never point past the synced log.
+static void writePending() {
+    if (pendingLogBytes > 0 && openJournal() &&
+        journalLog.write(pendingLog, pendingLogBytes) == pendingLogBytes) {
+        journalLog.flush();
+        journalIndex.write(pendingIndex, pendingIndexBytes);
+        journalIndex.flush();
+    }
+    pendingLogBytes = 0;
+    pendingIndexBytes = 0;
+}
+
+static void sessionJournalTask(void *pvParameters) {
+    SessionRecord record;
+    uint8_t buffer[SESSION_RECORD_MAX_BYTES];
+
+    for (;;) {
+        if (xQueueReceive(journalQueue, &record, portMAX_DELAY) != pdPASS) {
+            continue;
+        }
+        size_t length = sessionRecordEncode(record, buffer);
+
+        xSemaphoreTake(journalMutex, portMAX_DELAY);
+        if (pendingLogBytes + length > sizeof(pendingLog) ||
+            pendingIndexBytes + SESSION_INDEX_ENTRY_BYTES > sizeof(pendingIndex)) {
+            writePending();
+        }
+        if (openJournal()) {
+            size_t logBytes = journalLog.size() + pendingLogBytes;
+            if (logBytes > 0 && logBytes + length > SESSION_LOG_MAX_BYTES) {
+                writePending();
+                journalLog.close();
+                journalIndex.close();
+                LittleFS.remove(SESSION_LOG_OLD_PATH);
+                LittleFS.remove(SESSION_INDEX_OLD_PATH);
+                LittleFS.rename(SESSION_LOG_PATH, SESSION_LOG_OLD_PATH);
+                LittleFS.rename(SESSION_INDEX_PATH, SESSION_INDEX_OLD_PATH);
+            }
+        }
+        if (openJournal()) {
+            sessionIndexEncode(record.seq, (uint32_t)(journalLog.size() + pendingLogBytes), pendingIndex + pendingIndexBytes);
+            pendingIndexBytes += SESSION_INDEX_ENTRY_BYTES;
+            memcpy(pendingLog + pendingLogBytes, buffer, length);
+            pendingLogBytes += length;
+            if (pendingLogBytes + SESSION_RECORD_HEADER_BYTES > sizeof(pendingLog)) {
+                writePending(); // Page full: not even a string without shots fits
+            }
+        }
+        xSemaphoreGive(journalMutex);
+    }
+}
+
+bool sessionJournalBegin() {
+    SessionRecord last;
+    uint32_t endOffset;
+    if (recoverIndex(last) ||
+        lastIndexedRecord(SESSION_LOG_OLD_PATH, SESSION_INDEX_OLD_PATH, last, endOffset)) {
+        nextSeq = last.seq + 1;
+        bootId = last.bootId + 1;
+    }
+
+    journalQueue = xQueueCreate(SESSION_JOURNAL_QUEUE_LENGTH, sizeof(SessionRecord));
+    journalMutex = xSemaphoreCreateMutex();
+    if (journalQueue == NULL || journalMutex == NULL) return false;
+    xTaskCreatePinnedToCore(
+        sessionJournalTask,
+        "SessionJournal",
+        SESSION_JOURNAL_TASK_STACK_SIZE,
+        NULL,
+        SESSION_JOURNAL_TASK_PRIORITY,
+        &journalTaskHandle,
+        SESSION_JOURNAL_TASK_CORE);
+    if (journalTaskHandle == NULL) {
+        journalQueue = NULL; // Appends become no-ops
+        return false;
+    }
+    return true;
+}
+
+void sessionJournalAppend(SessionRecord& record) {
+    if (journalQueue == NULL) return;
+    record.seq = nextSeq;
+    record.bootId = bootId;
+    if (xQueueSend(journalQueue, &record, 0) == pdPASS) {
+        nextSeq++;
+    } else {
+        droppedSessions++;
+    }
+}
+
+void sessionJournalFlush() {
+    if (journalMutex == NULL) return;
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    writePending();
+    xSemaphoreGive(journalMutex);
+}
+
+uint32_t getDroppedSessionCount() {
+    return droppedSessions;
+}
+
+// Up to 'count' records of one generation, newest first.
+static int readRecent(const char* logPath, const char* indexPath, SessionRecord* records, int count) {
+    if (count <= 0 || !LittleFS.exists(logPath) || !LittleFS.exists(indexPath)) return 0;
+    File index = LittleFS.open(indexPath, FILE_READ);
+    File log = LittleFS.open(logPath, FILE_READ);
+    int entries = (int)(index.size() / SESSION_INDEX_ENTRY_BYTES);
+    int read = 0;
+    uint8_t entry[SESSION_INDEX_ENTRY_BYTES];
+    for (int i = entries - 1; i >= 0 && read < count; --i) {
+        if (!index.seek((uint32_t)i * SESSION_INDEX_ENTRY_BYTES) || index.read(entry, sizeof(entry)) != sizeof(entry)) {
+            break;
+        }
+        uint32_t seq, offset;
+        size_t recordBytes;
+        sessionIndexDecode(entry, seq, offset);
+        if (readRecordAt(log, offset, records[read], recordBytes) && records[read].seq == seq) {
+            read++;
+        }
+    }
+    return read;
+}
+
+int sessionJournalRecent(SessionRecord* records, int count) {
+    if (journalMutex == NULL) return 0;
+    xSemaphoreTake(journalMutex, portMAX_DELAY);
+    writePending();
+    int read = readRecent(SESSION_LOG_PATH, SESSION_INDEX_PATH, records, count);
+    read += readRecent(SESSION_LOG_OLD_PATH, SESSION_INDEX_OLD_PATH, records + read, count - read);
+    xSemaphoreGive(journalMutex);
+    return read;
+}
+
+void dumpSessionJournal() {
+    static SessionRecord records[SESSION_DUMP_COUNT];
+    int count = sessionJournalRecent(records, SESSION_DUMP_COUNT);
+    Serial.printf("# sessions: last %d, %lu dropped\n", count, (unsigned long)droppedSessions);
+    Serial.println("seq,boot,mode,start_ms,settings,shots,splits_ms");
+    for (int i = count - 1; i >= 0; --i) {
+        const SessionRecord& r = records[i];
+        Serial.printf("%lu,%u,%u,%lu,%08lx,%u", (unsigned long)r.seq, (unsigned)r.bootId, (unsigned)r.mode,
+                      (unsigned long)r.startMs, (unsigned long)r.settingsHash, (unsigned)r.shotCount);
+        uint32_t previousMs = 0;
+        for (int s = 0; s < r.shotCount; ++s) {
+            Serial.printf(",%lu", (unsigned long)(r.shotMs[s] - previousMs));
+            previousMs = r.shotMs[s];
+        }
+        Serial.println();
+    }
+}
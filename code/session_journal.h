@@ -0,0 +1,39 @@
+#ifndef SESSION_JOURNAL_H
+#define SESSION_JOURNAL_H
+
+#include <Arduino.h>
+#include "session_log.h"
+
+// --- Session Journal ---
+// Every finished string is appended to an append-only log on LittleFS
+// (record format in session_log.h) by a low-priority writer task, so the
+// flash write never runs while a string is being timed. The writer collects
+// records in a SESSION_JOURNAL_BUFFER_BYTES buffer and writes them, then
+// their index entries, once it is full or sessionJournalFlush() is called:
+// a session of strings costs about one page write instead of a log and an
+// index sync per string. Past SESSION_LOG_MAX_BYTES the log and index move
+// to the .old files and a new pair starts, so at most two generations are
+// kept.
+
+// Call from setup() once LittleFS is mounted: indexes records the last boot
+// wrote but did not index, then starts the writer task.
+bool sessionJournalBegin();
+
+// Queues a finished string; seq and bootId are filled in. Never blocks: if
+// the writer has fallen SESSION_JOURNAL_QUEUE_LENGTH records behind, the
+// string is dropped and counted.
+void sessionJournalAppend(SessionRecord& record);
+uint32_t getDroppedSessionCount();
+
+// Writes the records still buffered. Called on leaving a mode and before the
+// device sleeps or powers off; a reset loses at most what is buffered.
+void sessionJournalFlush();
+
+// Reads up to 'count' of the latest sessions, newest first, through the
+// index. Returns how many were read.
+int sessionJournalRecent(SessionRecord* records, int count);
+
+// Writes the last SESSION_DUMP_COUNT sessions to Serial as CSV.
+void dumpSessionJournal();
+
+#endif // SESSION_JOURNAL_H
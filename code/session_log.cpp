@@ -0,0 +1,92 @@
+#include "session_log.h"
+#include "crc32.h"
+#include "le_bytes.h"
+#include <string.h>
+
+static size_t writeVarint(uint8_t* p, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns the bytes used, 0 if it runs past 'end' or is longer than 5 bytes.
+static size_t readVarint(const uint8_t* p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (size_t n = 0; n < 5 && p + n < end; ++n) {
+        v |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if ((p[n] & 0x80) == 0) return n + 1;
+    }
+    return 0;
+}
+
+size_t sessionRecordEncode(const SessionRecord& record, uint8_t* out) {
+    int shots = (record.shotCount <= SESSION_RECORD_MAX_SHOTS) ? record.shotCount : SESSION_RECORD_MAX_SHOTS;
+    uint8_t* payload = out + SESSION_RECORD_HEADER_BYTES;
+    size_t payloadBytes = 0;
+    uint32_t previousMs = 0;
+    for (int i = 0; i < shots; ++i) {
+        payloadBytes += writeVarint(payload + payloadBytes, record.shotMs[i] - previousMs);
+        previousMs = record.shotMs[i];
+    }
+
+    writeU16(out, SESSION_RECORD_MAGIC);
+    out[2] = SESSION_RECORD_VERSION;
+    out[3] = record.mode;
+    writeU32(out + 4, record.seq);
+    writeU32(out + 8, record.startMs);
+    writeU16(out + 12, record.bootId);
+    out[14] = (uint8_t)shots;
+    out[15] = (uint8_t)payloadBytes;
+    writeU32(out + 16, record.settingsHash);
+    uint32_t crc = crc32Update(crc32(out, 20), payload, payloadBytes);
+    writeU32(out + 20, crc);
+    return SESSION_RECORD_HEADER_BYTES + payloadBytes;
+}
+
+bool sessionRecordDecode(const uint8_t* data, size_t length, SessionRecord& record, size_t& recordBytes) {
+    if (length < SESSION_RECORD_HEADER_BYTES ||
+        readU16(data) != SESSION_RECORD_MAGIC ||
+        data[2] != SESSION_RECORD_VERSION ||
+        data[14] > SESSION_RECORD_MAX_SHOTS) {
+        return false;
+    }
+    size_t payloadBytes = data[15];
+    if (length < SESSION_RECORD_HEADER_BYTES + payloadBytes) return false;
+    const uint8_t* payload = data + SESSION_RECORD_HEADER_BYTES;
+    if (readU32(data + 20) != crc32Update(crc32(data, 20), payload, payloadBytes)) return false;
+
+    record.mode = data[3];
+    record.seq = readU32(data + 4);
+    record.startMs = readU32(data + 8);
+    record.bootId = readU16(data + 12);
+    record.shotCount = data[14];
+    record.settingsHash = readU32(data + 16);
+    const uint8_t* p = payload;
+    const uint8_t* end = payload + payloadBytes;
+    uint32_t shotMs = 0;
+    for (int i = 0; i < record.shotCount; ++i) {
+        uint32_t splitMs;
+        size_t used = readVarint(p, end, splitMs);
+        if (used == 0) return false;
+        p += used;
+        shotMs += splitMs;
+        record.shotMs[i] = shotMs;
+    }
+    if (p != end) return false;
+    recordBytes = SESSION_RECORD_HEADER_BYTES + payloadBytes;
+    return true;
+}
+
+void sessionIndexEncode(uint32_t seq, uint32_t offset, uint8_t* out) {
+    writeU32(out, seq);
+    writeU32(out + 4, offset);
+}
+
+void sessionIndexDecode(const uint8_t* data, uint32_t& seq, uint32_t& offset) {
+    seq = readU32(data);
+    offset = readU32(data + 4);
+}
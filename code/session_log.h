@@ -0,0 +1,57 @@
+#ifndef SESSION_LOG_H
+#define SESSION_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Session journal records: one per finished Live Fire / Noisy Range string,
+// appended to SESSION_LOG_PATH on LittleFS by session_journal.cpp, with an
+// index (SESSION_INDEX_PATH) to find the last N without scanning the log.
+//
+// Record layout (little-endian, SESSION_RECORD_HEADER_BYTES + payload):
+//   uint16_t magic         SESSION_RECORD_MAGIC
+//   uint8_t  version       SESSION_RECORD_VERSION
+//   uint8_t  mode          OperatingMode
+//   uint32_t seq           1, 2, ... over the life of the log
+//   uint32_t startMs       Uptime at the start beep
+//   uint16_t bootId        Records with the same bootId share the uptime clock
+//   uint8_t  shotCount
+//   uint8_t  payloadBytes
+//   uint32_t settingsHash  CRC-32 of the settings the string was shot with
+//   uint32_t crc32         CRC-32 of the header before it and the payload
+//   payload                Split of each shot in ms (first from the start
+//                          beep), as unsigned LEB128 varints
+//
+// Index layout: one SESSION_INDEX_ENTRY_BYTES entry per record, in log order:
+//   uint32_t seq
+//   uint32_t offset        Of the record in the log
+
+static const uint16_t SESSION_RECORD_MAGIC = 0x4C53; // "SL"
+static const uint8_t SESSION_RECORD_VERSION = 1;
+static const size_t SESSION_RECORD_HEADER_BYTES = 24;
+static const int SESSION_RECORD_MAX_SHOTS = 32;
+static const size_t SESSION_RECORD_MAX_BYTES = SESSION_RECORD_HEADER_BYTES + SESSION_RECORD_MAX_SHOTS * 5;
+static const size_t SESSION_INDEX_ENTRY_BYTES = 8;
+
+struct SessionRecord {
+    uint32_t seq;
+    uint32_t startMs;
+    uint32_t settingsHash;
+    uint16_t bootId;
+    uint8_t mode;
+    uint8_t shotCount;
+    uint32_t shotMs[SESSION_RECORD_MAX_SHOTS]; // From the start beep, in time order
+};
+
+// Writes the record to 'out' (SESSION_RECORD_MAX_BYTES). Returns its length.
+size_t sessionRecordEncode(const SessionRecord& record, uint8_t* out);
+
+// Decodes the record at the start of 'data' (which may run on past it) and
+// sets 'recordBytes' to its length. False if it is cut short, has the wrong
+// magic / version or fails the CRC.
+bool sessionRecordDecode(const uint8_t* data, size_t length, SessionRecord& record, size_t& recordBytes);
+
+void sessionIndexEncode(uint32_t seq, uint32_t offset, uint8_t* out);
+void sessionIndexDecode(const uint8_t* data, uint32_t& seq, uint32_t& offset);
+
+#endif // SESSION_LOG_H
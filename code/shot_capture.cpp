@@ -0,0 +1,235 @@
+#include "shot_capture.h"
+#include "globals.h"
+#include "config.h"
+#include "shot_config.h"
+#include "spsc_ring.h"
+#include "tone_burst_detector.h"
+#include "loop_events.h"
+#include "loop_profiler.h"
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <atomic>
+
+// Mic blocks handed to the M5 mic driver. The driver keeps two blocks in
+// flight, so queuing a third one returns once the oldest one is full.
+static int16_t captureBuffers[MIC_CAPTURE_BUFFER_COUNT][MIC_CAPTURE_BLOCK_SAMPLES];
+
+static SpscRing<ShotEvent, SHOT_EVENT_RING_SIZE> shotEventRing;
+
+// Written by the capture task while armed, read by the main loop once disarmed.
+static FeatureRing featureRing;
+static OnsetDetectorConfig rescoreConfig;
+
+// --- Shared between the capture task and the main loop ---
+static std::atomic<bool> captureArmed{false};
+static std::atomic<uint32_t> armRequestCount{0};
+static std::atomic<float> armedMinRms{0.0f};
+static std::atomic<float> armedMarginDb{0.0f};
+static std::atomic<float> capturePeakRms{0.0f};
+
+// Main loop only
+static int64_t armedFromUs = 0;
+
+// --- Latency probe ---
+// The window is written by the main loop before the state goes to REQUESTED
+// (never while a probe is pending or running), the result by the capture task
+// before it goes to DONE.
+enum LatencyProbeState : uint8_t { PROBE_IDLE, PROBE_REQUESTED, PROBE_RUNNING, PROBE_DONE };
+static std::atomic<uint8_t> latencyProbeState{PROBE_IDLE};
+static int64_t latencyProbeFromUs = 0;
+static int64_t latencyProbeToUs = 0;
+static int64_t latencyProbeOnsetUs = 0;
+static float latencyProbePeakToMean = 0.0f;
+static ToneBurstDetector latencyProbe; // Capture task only
+
+// --- Capture Task State (capture task only) ---
+static ShotDetector detector;
+static uint32_t seenArmRequest = 0;
+static bool clockAnchored = false;
+static int64_t sampleZeroUs = 0;
+static bool recordingFeatures = false;
+
+void shotCaptureBegin() {
+    seenArmRequest = armRequestCount.load(std::memory_order_acquire);
+    clockAnchored = false;
+    sampleZeroUs = 0;
+    recordingFeatures = false;
+
+    OnsetDetectorConfig onsetConfig = shotOnsetConfig(shotMarginDb, shotThresholdRms, shotLockoutMs);
+    detector.configure(onsetConfig);
+    rescoreConfig = onsetConfig;
+
+    // Feature history lives in PSRAM when there is some; re-scoring is simply
+    // unavailable if neither allocation succeeds.
+    const uint32_t hopUs = (uint32_t)(ShotDetector::kFeatureHopSamples * 1000000ULL / MIC_SAMPLE_RATE_HZ);
+    const uint32_t featureFrames = (uint32_t)(FEATURE_HISTORY_MS * 1000ULL / hopUs);
+    static FeatureFrame* featureStorage = NULL;
+    if (featureStorage == NULL) {
+        size_t featureBytes = featureFrames * sizeof(FeatureFrame);
+        featureStorage = (FeatureFrame*)heap_caps_malloc(featureBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (featureStorage == NULL) {
+            featureStorage = (FeatureFrame*)heap_caps_malloc(featureBytes, MALLOC_CAP_8BIT);
+        }
+    }
+    featureRing.attach(featureStorage, featureFrames, hopUs);
+
+    latencyProbe.configure(MIC_SAMPLE_RATE_HZ, (float)BT_LATENCY_BURST_HZ, (float)BT_LATENCY_BURST_MS);
+}
+
+void processMicBlock(const int16_t* samples, int64_t nowUs) {
+    PROFILE_SCOPE(PROFILE_MIC_BLOCK);
+
+    // The block has just been completed, so its last sample was taken at or
+    // before nowUs. Keep the lowest such estimate of sample 0's time (wake-up
+    // jitter only ever makes it later), slewing slowly so mic clock drift is followed.
+    uint64_t blockEnd = detector.samplesProcessed() + MIC_CAPTURE_BLOCK_SAMPLES;
+    int64_t candidateZeroUs = nowUs - (int64_t)((blockEnd * 1000000ULL) / MIC_SAMPLE_RATE_HZ);
+    if (!clockAnchored) {
+        sampleZeroUs = candidateZeroUs;
+        clockAnchored = true;
+    } else {
+        sampleZeroUs = min(sampleZeroUs + MIC_CLOCK_SLEW_US_PER_BLOCK, candidateZeroUs);
+    }
+    detector.setClockAnchor(sampleZeroUs);
+
+    uint32_t armRequest = armRequestCount.load(std::memory_order_acquire);
+    if (armRequest != seenArmRequest) {
+        seenArmRequest = armRequest;
+        // The noise floor keeps being tracked between strings; only the levels change.
+        detector.setThresholds(armedMarginDb.load(), ONSET_HYSTERESIS_DB, armedMinRms.load());
+        if (featureRing.isAttached()) {
+            featureRing.reset();
+            detector.setFeatureRing(&featureRing);
+            recordingFeatures = true;
+        }
+    }
+
+    bool armed = captureArmed.load(std::memory_order_acquire);
+    if (recordingFeatures && !armed) {
+        detector.setFeatureRing(NULL);
+        recordingFeatures = false;
+    }
+
+    uint8_t probeState = latencyProbeState.load(std::memory_order_acquire);
+    if (probeState == PROBE_REQUESTED) {
+        latencyProbe.reset();
+        latencyProbeState.store(PROBE_RUNNING, std::memory_order_relaxed);
+        probeState = PROBE_RUNNING;
+    }
+    if (probeState == PROBE_RUNNING) {
+        uint64_t blockStart = detector.samplesProcessed();
+        int64_t blockStartUs = detector.sampleToUs(blockStart);
+        int64_t blockEndUs = detector.sampleToUs(blockStart + MIC_CAPTURE_BLOCK_SAMPLES);
+        if (blockEndUs >= latencyProbeFromUs && blockStartUs <= latencyProbeToUs) {
+            latencyProbe.process(samples, MIC_CAPTURE_BLOCK_SAMPLES, blockStart);
+        }
+        if (blockEndUs > latencyProbeToUs) {
+            latencyProbeOnsetUs = detector.sampleToUs(latencyProbe.onsetSample());
+            latencyProbePeakToMean = latencyProbe.peakToMean();
+            latencyProbeState.store(PROBE_DONE, std::memory_order_release);
+        }
+    }
+
+    ShotEvent events[4];
+    size_t eventCount = detector.process(samples, MIC_CAPTURE_BLOCK_SAMPLES, events, 4);
+    if (armed && eventCount > 0) {
+        for (size_t i = 0; i < eventCount; ++i) {
+            shotEventRing.push(events[i]);
+        }
+        postLoopEvent(LOOP_EVENT_SHOT);
+    }
+
+    float blockPeak = detector.takePeakRms();
+    float storedPeak = capturePeakRms.load(std::memory_order_relaxed);
+    while (blockPeak > storedPeak && !capturePeakRms.compare_exchange_weak(storedPeak, blockPeak)) {
+    }
+}
+
+// --- Mic Capture Task (Runs on Core 0) ---
+void micCaptureTask(void *) {
+    shotCaptureBegin();
+
+    // Prime the driver so there is always a block in flight behind the one being filled.
+    for (int i = 0; i < MIC_CAPTURE_BUFFER_COUNT - 1; ++i) {
+        StickCP2.Mic.record(captureBuffers[i], MIC_CAPTURE_BLOCK_SAMPLES, MIC_SAMPLE_RATE_HZ);
+    }
+    int recordIdx = MIC_CAPTURE_BUFFER_COUNT - 1;
+
+    for (;;) {
+        if (!StickCP2.Mic.record(captureBuffers[recordIdx], MIC_CAPTURE_BLOCK_SAMPLES, MIC_SAMPLE_RATE_HZ)) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        int readyIdx = (recordIdx + 1) % MIC_CAPTURE_BUFFER_COUNT;
+        recordIdx = readyIdx;
+        processMicBlock(captureBuffers[readyIdx], esp_timer_get_time());
+    }
+}
+
+
+// --- Capture Control Functions (Called from Core 1) ---
+
+void armShotCapture() {
+    armedFromUs = esp_timer_get_time();
+    armedMinRms.store((float)shotThresholdRms);
+    armedMarginDb.store((float)shotMarginDb);
+    shotEventRing.clear();
+    captureArmed.store(true, std::memory_order_release);
+    armRequestCount.fetch_add(1, std::memory_order_release);
+}
+
+void disarmShotCapture() {
+    captureArmed.store(false, std::memory_order_release);
+}
+
+bool popShotEvent(ShotEvent &event) {
+    while (shotEventRing.pop(event)) {
+        if (event.timeUs >= armedFromUs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float takeCapturePeakRms() {
+    return capturePeakRms.exchange(0.0f);
+}
+
+uint32_t getDroppedShotEventCount() {
+    return shotEventRing.overflowCount();
+}
+
+size_t rescoreShotString(int marginDb, int64_t fromUs, int64_t* onsetUs, size_t maxOnsets) {
+    OnsetDetectorConfig config = rescoreConfig;
+    config.thresholdDb = (float)marginDb;
+    config.minRms = (float)shotThresholdRms;
+    return featureRing.rescore(config, fromUs, onsetUs, maxOnsets);
+}
+
+int64_t getShotStringHistoryStartUs() {
+    if (featureRing.size() == 0) return INT64_MAX;
+    return featureRing.oldestTimeUs();
+}
+
+bool requestLatencyProbe(int64_t fromUs, int64_t toUs) {
+    // Only this function leaves IDLE / DONE and only the capture task leaves
+    // REQUESTED / RUNNING, so in IDLE or DONE the window is ours to write.
+    uint8_t state = latencyProbeState.load(std::memory_order_acquire);
+    if (state == PROBE_REQUESTED || state == PROBE_RUNNING) {
+        return false;
+    }
+    latencyProbeFromUs = fromUs;
+    latencyProbeToUs = toUs;
+    latencyProbeState.store(PROBE_REQUESTED, std::memory_order_release);
+    return true;
+}
+
+bool takeLatencyProbeResult(int64_t &onsetUs, float &peakToMean) {
+    if (latencyProbeState.load(std::memory_order_acquire) != PROBE_DONE) {
+        return false;
+    }
+    onsetUs = latencyProbeOnsetUs;
+    peakToMean = latencyProbePeakToMean;
+    latencyProbeState.store(PROBE_IDLE, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef SHOT_CAPTURE_H
+#define SHOT_CAPTURE_H
+
+#include <Arduino.h>
+#include "shot_detector.h"
+
+// Mic capture task (Core 0). Continuously drains the mic DMA buffers, runs the
+// shot detector on every sample and pushes timestamped ShotEvents into a
+// lock-free ring for the timer modes to consume.
+void micCaptureTask(void *pvParameters);
+
+// The task's two halves, also called directly by the host simulation
+// (host/sim): shotCaptureBegin() configures the detector from the current
+// settings; processMicBlock() runs one completed MIC_CAPTURE_BLOCK_SAMPLES
+// block, whose last sample was taken at or before 'nowUs'.
+void shotCaptureBegin();
+void processMicBlock(const int16_t* samples, int64_t nowUs);
+
+// Starts detection with the current shot settings. Events stamped before
+// this call are discarded.
+void armShotCapture();
+
+// Stops detection; the task keeps draining the mic so the sample clock stays continuous.
+void disarmShotCapture();
+
+// Pops the next detected shot. Returns false when none are pending.
+bool popShotEvent(ShotEvent &event);
+
+// Returns the highest windowed RMS seen since the previous call and resets it.
+float takeCapturePeakRms();
+
+// Number of shot events dropped because the ring was full.
+uint32_t getDroppedShotEventCount();
+
+// --- Re-scoring ---
+// While armed, the capture task also records decimated detection features
+// (FEATURE_HISTORY_MS worth). Once disarmed, the string can be re-run with a
+// different shot margin. Returns the number of onset times (us) written.
+size_t rescoreShotString(int marginDb, int64_t fromUs, int64_t* onsetUs, size_t maxOnsets);
+
+// Start of the recorded feature history (us); earlier shots cannot be re-scored.
+// Returns INT64_MAX when nothing is recorded.
+int64_t getShotStringHistoryStartUs();
+
+// --- Latency probe ---
+// Runs a ToneBurstDetector over the mic samples stamped in [fromUs, toUs],
+// looking for a BT_LATENCY_BURST_HZ burst. Used by the Bluetooth latency
+// calibration; independent of shot detection. Returns false, leaving the
+// probe in progress alone, if the previous one has not finished yet; a
+// finished result nobody took is dropped.
+bool requestLatencyProbe(int64_t fromUs, int64_t toUs);
+
+// Returns true once the probe window has been fully processed. 'onsetUs' is the
+// burst onset, 'peakToMean' its matched filter peak over the mean.
+bool takeLatencyProbeResult(int64_t &onsetUs, float &peakToMean);
+
+#endif // SHOT_CAPTURE_H
@@ -0,0 +1,50 @@
+#ifndef SHOT_CONFIG_H
+#define SHOT_CONFIG_H
+
+#include "config.h"
+#include "onset_detector.h"
+
+// How the timer modes turn mic onsets into shots, shared with the host benches,
+// tests and the settings sweep so they score what the device runs.
+
+// The onset detector configuration the capture task runs with: the ONSET_* and
+// SHOT_* constants plus the three shot settings.
+inline OnsetDetectorConfig shotOnsetConfig(int marginDb, int thresholdRms, unsigned long lockoutMs) {
+    OnsetDetectorConfig config;
+    config.sampleRateHz = MIC_SAMPLE_RATE_HZ;
+    config.attackMs = ONSET_ATTACK_MS;
+    config.releaseMs = ONSET_RELEASE_MS;
+    config.thresholdDb = (float)marginDb;
+    config.hysteresisDb = ONSET_HYSTERESIS_DB;
+    config.minRms = (float)thresholdRms;
+    config.floorQuantile = ONSET_FLOOR_QUANTILE;
+    config.floorSlewDbPerSec = ONSET_FLOOR_SLEW_DB_PER_SEC;
+    config.initialFloorRms = ONSET_INITIAL_FLOOR_RMS;
+    config.lockoutMs = lockoutMs;
+    config.rearmFraction = SHOT_REARM_FRACTION;
+    config.echoWindowMs = SHOT_ECHO_WINDOW_MS;
+    config.echoPeakRatio = SHOT_ECHO_PEAK_RATIO;
+    return config;
+}
+
+// Listening starts (and the detector is re-armed) this long after the start
+// beep begins.
+inline unsigned long listenDelayMs(unsigned long beepDurationMs) {
+    return beepDurationMs + BEEP_LISTEN_GUARD_MS;
+}
+
+// Noisy Range: an onset is a shot if the peak |accel Z| over this window
+// around it is over recoilThreshold.
+inline int64_t recoilWindowStartUs(int64_t onsetUs) {
+    return onsetUs - (int64_t)RECOIL_PRE_ONSET_MS * 1000;
+}
+
+inline int64_t recoilWindowEndUs(int64_t onsetUs) {
+    return onsetUs + (int64_t)RECOIL_DETECTION_WINDOW_MS * 1000;
+}
+
+inline bool recoilConfirmsShot(float peakAbsAccelZ, float threshold) {
+    return peakAbsAccelZ > threshold;
+}
+
+#endif // SHOT_CONFIG_H
@@ -0,0 +1,96 @@
+#include "shot_detector.h"
+#include "dsp_kernels.h"
+#include <math.h>
+
+void ShotDetector::configure(const OnsetDetectorConfig& config) {
+    sampleRateHz_ = (config.sampleRateHz > 0) ? config.sampleRateHz : 16000;
+    onset_.configure(config);
+}
+
+void ShotDetector::setThresholds(float thresholdDb, float hysteresisDb, float minRms) {
+    onset_.setThresholds(thresholdDb, hysteresisDb, minRms);
+    onset_.rearm();
+}
+
+int64_t ShotDetector::sampleToUs(uint64_t sampleIndex) const {
+    return sampleZeroUs_ + (int64_t)((sampleIndex * 1000000ULL) / sampleRateHz_);
+}
+
+void ShotDetector::setFeatureRing(FeatureRing* ring) {
+    features_ = ring;
+    hopFill_ = 0;
+    hopEnvMax_ = 0;
+    hopEnvMin_ = UINT32_MAX;
+    hopPeak_ = 0;
+}
+
+size_t ShotDetector::process(const int16_t* samples, size_t count, ShotEvent* events, size_t maxEvents) {
+    OnsetHit hits[4];
+    size_t maxHits = (maxEvents < 4) ? maxEvents : 4;
+    size_t hitCount = (features_ != nullptr)
+        ? processWithFeatures(samples, count, hits, maxHits)
+        : onset_.process(samples, count, hits, maxHits);
+
+    for (size_t i = 0; i < hitCount; ++i) {
+        ShotEvent& ev = events[i];
+        ev.sampleIndex = sampleCount_ + hits[i].offset;
+        ev.timeUs = sampleToUs(ev.sampleIndex);
+        ev.peakRms = sqrtf((float)hits[i].power);
+    }
+
+    for (size_t offset = 0; offset < count; offset += kRmsWindowSamples) {
+        size_t len = (count - offset < kRmsWindowSamples) ? (count - offset) : kRmsWindowSamples;
+        float rms = dspStatsRms(dspBlockStats(samples + offset, len), len);
+        if (rms > peakRms_) peakRms_ = rms;
+    }
+
+    sampleCount_ += count;
+    return hitCount;
+}
+
+// Runs the onset detector hop by hop so the envelope of each hop can be
+// folded into a FeatureFrame.
+size_t ShotDetector::processWithFeatures(const int16_t* samples, size_t count, OnsetHit* hits, size_t maxHits) {
+    uint32_t env[kFeatureHopSamples];
+    size_t hitCount = 0;
+    size_t i = 0;
+
+    while (i < count) {
+        size_t len = kFeatureHopSamples - hopFill_;
+        if (len > count - i) len = count - i;
+
+        size_t n = onset_.process(samples + i, len, hits + hitCount, maxHits - hitCount, env);
+        for (size_t k = 0; k < n; ++k) hits[hitCount + k].offset += (uint32_t)i;
+        hitCount += n;
+
+        for (size_t k = 0; k < len; ++k) {
+            if (env[k] > hopEnvMax_) hopEnvMax_ = env[k];
+            if (env[k] < hopEnvMin_) hopEnvMin_ = env[k];
+        }
+        BlockStats stats = dspBlockStats(samples + i, len);
+        if (stats.peak > hopPeak_) hopPeak_ = stats.peak;
+
+        i += len;
+        hopFill_ += (uint32_t)len;
+        if (hopFill_ == kFeatureHopSamples) {
+            FeatureFrame frame;
+            frame.envMaxDbQ8 = FeatureRing::powerToDbQ8(hopEnvMax_);
+            frame.envMinDbQ8 = FeatureRing::powerToDbQ8(hopEnvMin_);
+            frame.floorDbQ8 = (uint16_t)(onset_.noiseFloorDb() * 256.0f);
+            frame.peakHalfDb = FeatureRing::amplitudeToHalfDb((float)hopPeak_);
+            uint64_t hopStart = sampleCount_ + i - kFeatureHopSamples;
+            features_->push(frame, sampleToUs(hopStart));
+            hopFill_ = 0;
+            hopEnvMax_ = 0;
+            hopEnvMin_ = UINT32_MAX;
+            hopPeak_ = 0;
+        }
+    }
+    return hitCount;
+}
+
+float ShotDetector::takePeakRms() {
+    float peak = peakRms_;
+    peakRms_ = 0.0f;
+    return peak;
+}
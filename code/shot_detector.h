@@ -0,0 +1,66 @@
+#ifndef SHOT_DETECTOR_H
+#define SHOT_DETECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "onset_detector.h"
+#include "feature_ring.h"
+
+// Block-based shot detector working on raw mic PCM.
+// Has no Arduino/M5 dependencies so the exact code that runs in the capture
+// task can also be fed synthetic PCM on a Linux host.
+
+// --- Shot Event (produced by the capture task, consumed by the timer modes) ---
+typedef struct {
+    uint64_t sampleIndex; // Onset sample, counted from the start of capture
+    int64_t timeUs;       // sampleIndex converted to the esp_timer/micros() timebase
+    float peakRms;        // Envelope RMS when the onset fired
+} ShotEvent;
+
+class ShotDetector {
+public:
+    // Full (re)configuration; also resets the learned noise floor.
+    void configure(const OnsetDetectorConfig& config);
+
+    // Updates trigger levels and re-arms, keeping the noise floor.
+    void setThresholds(float thresholdDb, float hysteresisDb, float minRms);
+
+    // Anchors sample 0 to a point on the microsecond clock.
+    void setClockAnchor(int64_t sampleZeroUs) { sampleZeroUs_ = sampleZeroUs; }
+    int64_t sampleToUs(uint64_t sampleIndex) const;
+
+    // Consumes one contiguous block of samples.
+    // Returns the number of events written to 'events' (at most maxEvents).
+    size_t process(const int16_t* samples, size_t count, ShotEvent* events, size_t maxEvents);
+
+    // While a ring is set, one FeatureFrame per kFeatureHopSamples is recorded
+    // into it (for re-scoring). Pass nullptr to stop recording.
+    void setFeatureRing(FeatureRing* ring);
+
+    static const size_t kFeatureHopSamples = 32;
+
+    uint64_t samplesProcessed() const { return sampleCount_; }
+    float noiseFloorRms() const { return onset_.noiseFloorRms(); }
+
+    // Highest windowed RMS seen since the previous call (used by calibration).
+    float takePeakRms();
+
+private:
+    static const size_t kRmsWindowSamples = 64;
+
+    size_t processWithFeatures(const int16_t* samples, size_t count, OnsetHit* hits, size_t maxHits);
+
+    OnsetDetector onset_;
+    uint32_t sampleRateHz_ = 16000;
+    int64_t sampleZeroUs_ = 0;
+    uint64_t sampleCount_ = 0;
+    float peakRms_ = 0.0f;
+
+    FeatureRing* features_ = nullptr;
+    uint32_t hopFill_ = 0;
+    uint32_t hopEnvMax_ = 0;
+    uint32_t hopEnvMin_ = UINT32_MAX;
+    int32_t hopPeak_ = 0;
+};
+
+#endif // SHOT_DETECTOR_H
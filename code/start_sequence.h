@@ -0,0 +1,88 @@
+#ifndef START_SEQUENCE_H
+#define START_SEQUENCE_H
+
+#include <stdint.h>
+
+// The Live Fire / Noisy Range start sequence, from the press on the ready
+// screen to listening for the first shot, as phases with deadlines instead of
+// delay() calls: the GET_READY handlers advance it every pass and act on the
+// phase, so buttons, the battery check and Bluetooth keep running and a
+// mistaken start can be cancelled at any point.
+//   START_READY_HOLD    "Ready..." for START_READY_HOLD_MS
+//   START_RANDOM_DELAY  Optional random wait (startRandomDelayMs setting)
+//   START_BEEP_DUE      The handler plays the start beep, then calls beepPlayed()
+//   START_LISTEN_ARM    In the TIMING state until the beep has ended (plus guard)
+//   START_LISTENING     Shot capture armed
+// Deadlines follow on from the previous one, not from the pass that noticed
+// it, so loop jitter does not add up along the sequence.
+enum StartPhase : uint8_t {
+    START_IDLE,
+    START_READY_HOLD,
+    START_RANDOM_DELAY,
+    START_BEEP_DUE,
+    START_LISTEN_ARM,
+    START_LISTENING
+};
+
+typedef struct {
+    uint32_t lastCycleMs;  // Press to listening, last completed start
+    uint32_t lastCancelUs; // Button edge to the start being abandoned
+    uint32_t maxCancelUs;
+    uint32_t cancels;
+} StartSequenceStats;
+
+class StartSequence {
+public:
+    // The start button was pressed at 'nowUs'.
+    void begin(int64_t nowUs, uint32_t holdMs, uint32_t randomDelayMs) {
+        pressUs_ = nowUs;
+        randomDelayUs_ = (int64_t)randomDelayMs * 1000;
+        deadlineUs_ = nowUs + (int64_t)holdMs * 1000;
+        phase_ = START_READY_HOLD;
+    }
+
+    // Steps past every deadline that has passed; returns the current phase.
+    StartPhase advance(int64_t nowUs) {
+        if (phase_ == START_READY_HOLD && nowUs >= deadlineUs_) {
+            phase_ = START_RANDOM_DELAY;
+            deadlineUs_ += randomDelayUs_;
+        }
+        if (phase_ == START_RANDOM_DELAY && nowUs >= deadlineUs_) {
+            phase_ = START_BEEP_DUE;
+        }
+        return phase_;
+    }
+
+    void beepPlayed() {
+        if (phase_ == START_BEEP_DUE) phase_ = START_LISTEN_ARM;
+    }
+
+    void listening(int64_t nowUs) {
+        if (phase_ != START_LISTEN_ARM) return;
+        phase_ = START_LISTENING;
+        stats_.lastCycleMs = (uint32_t)((nowUs - pressUs_) / 1000);
+    }
+
+    // Abandons the sequence, 'latencyUs' after the button that cancelled it went down.
+    void cancel(uint32_t latencyUs) {
+        abandon();
+        stats_.lastCancelUs = latencyUs;
+        if (latencyUs > stats_.maxCancelUs) stats_.maxCancelUs = latencyUs;
+        stats_.cancels++;
+    }
+
+    // Drops the sequence without counting it as a cancel (the state was left some other way).
+    void abandon() { phase_ = START_IDLE; }
+
+    StartPhase phase() const { return phase_; }
+    StartSequenceStats stats() const { return stats_; }
+
+private:
+    StartPhase phase_ = START_IDLE;
+    int64_t pressUs_ = 0;
+    int64_t deadlineUs_ = 0;
+    int64_t randomDelayUs_ = 0;
+    StartSequenceStats stats_ = {0, 0, 0, 0};
+};
+
+#endif // START_SEQUENCE_H
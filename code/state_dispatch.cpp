@@ -0,0 +1,158 @@
+#include "state_dispatch.h"
+#include "globals.h"
+#include "config.h"
+#include "audio_utils.h"
+#include "display_utils.h"
+#include "input_handler.h"
+#include "timer_modes.h"
+#include "bluetooth_utils.h"
+#include "ui_render.h"
+#include "system_utils.h"
+#include "session_journal.h"
+#include <esp_timer.h>
+
+static StateTrace<STATE_TRACE_SIZE> stateTrace;
+
+// --- Entry / Exit Actions ---
+
+// Mode selection opens on the mode in use, scrolled so it is on screen.
+static void enterModeSelection(TimerState, TimerState) {
+    sessionJournalFlush(); // A mode was left: write the strings it buffered
+    currentMenuSelection = (int)currentMode;
+    int rotation = uiRotation();
+    int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
+    menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
+}
+
+static constexpr StateHooks STATE_HOOKS[] = {
+    // state                   onExit              onEnter
+    {BOOT_SCREEN,             nullptr,            nullptr},
+    {BOOT_JPG_SEQUENCE,       nullptr,            nullptr},
+    {MODE_SELECTION,          nullptr,            enterModeSelection},
+    {LIVE_FIRE_READY,         nullptr,            nullptr},
+    {LIVE_FIRE_GET_READY,     exitGetReady,       nullptr},
+    {LIVE_FIRE_TIMING,        exitTiming,         nullptr},
+    {LIVE_FIRE_STOPPED,       exitStopped,        nullptr},
+    {DRY_FIRE_READY,          nullptr,            nullptr},
+    {DRY_FIRE_RUNNING,        exitDryFireRunning, nullptr},
+    {NOISY_RANGE_READY,       nullptr,            nullptr},
+    {NOISY_RANGE_GET_READY,   exitGetReady,       nullptr},
+    {NOISY_RANGE_TIMING,      exitTiming,         nullptr},
+    {SETTINGS_MENU_MAIN,      nullptr,            nullptr},
+    {SETTINGS_MENU_GENERAL,   nullptr,            nullptr},
+    {SETTINGS_MENU_BEEP,      nullptr,            nullptr},
+    {SETTINGS_MENU_DRYFIRE,   nullptr,            nullptr},
+    {SETTINGS_MENU_NOISY,     nullptr,            nullptr},
+    {SETTINGS_MENU_BLUETOOTH, nullptr,            nullptr},
+    {BLUETOOTH_SCANNING,      nullptr,            nullptr},
+    {DEVICE_STATUS,           nullptr,            nullptr},
+    {LIST_FILES,              nullptr,            nullptr},
+    {EDIT_SETTING,            nullptr,            nullptr},
+    {CALIBRATE_THRESHOLD,     nullptr,            nullptr},
+    {CALIBRATE_RECOIL,        nullptr,            nullptr},
+    {CALIBRATE_BT_LATENCY,    nullptr,            nullptr},
+};
+
+static_assert(rowsInStateOrder(STATE_HOOKS), "STATE_HOOKS rows must be in TimerState order");
+
+void setState(TimerState newState) {
+    TimerState from = currentState;
+    runTransition(STATE_HOOKS, from, newState, [&]() {
+        stateTrace.record(from, newState, esp_timer_get_time());
+        previousState = from;
+        currentState = newState;
+        redrawMenu = true;
+    });
+}
+
+bool dispatchStateEvent(StateEvent event) {
+    TimerState to = nextState(currentState, event);
+    if (to == TIMER_STATE_COUNT) return false;
+    setState(to);
+    return true;
+}
+
+void dumpStateTrace() {
+    Serial.printf("# state trace: %lu transitions since boot\n", (unsigned long)stateTrace.total());
+    Serial.println("time_us,from,to");
+    for (uint32_t i = 0; i < stateTrace.size(); ++i) {
+        const StateTransition& t = stateTrace.at(i);
+        Serial.printf("%lld,%s,%s\n", (long long)t.atUs, stateName((TimerState)t.from), stateName((TimerState)t.to));
+    }
+}
+
+// --- State Handlers ---
+
+static void handleCalibrateThreshold() { handleCalibrationInput(CALIBRATE_THRESHOLD); }
+static void handleCalibrateRecoil()    { handleCalibrationInput(CALIBRATE_RECOIL); }
+
+// loop() calls the current state's handler straight out of this table.
+struct StateHandlerRow {
+    TimerState state;
+    void (*handler)();
+};
+
+static constexpr StateHandlerRow STATE_HANDLERS[] = {
+    {BOOT_SCREEN,             nullptr},
+    {BOOT_JPG_SEQUENCE,       handleBootSequence},
+    {MODE_SELECTION,          handleModeSelectionInput},
+    {LIVE_FIRE_READY,         handleLiveFireReady},
+    {LIVE_FIRE_GET_READY,     handleLiveFireGetReady},
+    {LIVE_FIRE_TIMING,        handleLiveFireTiming},
+    {LIVE_FIRE_STOPPED,       handleLiveFireStopped},
+    {DRY_FIRE_READY,          handleDryFireReadyInput},
+    {DRY_FIRE_RUNNING,        handleDryFireRunning},
+    {NOISY_RANGE_READY,       handleNoisyRangeReadyInput},
+    {NOISY_RANGE_GET_READY,   handleNoisyRangeGetReady},
+    {NOISY_RANGE_TIMING,      handleNoisyRangeTiming},
+    {SETTINGS_MENU_MAIN,      handleSettingsInput},
+    {SETTINGS_MENU_GENERAL,   handleSettingsInput},
+    {SETTINGS_MENU_BEEP,      handleSettingsInput},
+    {SETTINGS_MENU_DRYFIRE,   handleSettingsInput},
+    {SETTINGS_MENU_NOISY,     handleSettingsInput},
+    {SETTINGS_MENU_BLUETOOTH, handleSettingsInput},
+    {BLUETOOTH_SCANNING,      handleBluetoothScanning},
+    {DEVICE_STATUS,           handleDeviceStatusInput},
+    {LIST_FILES,              handleListFilesInput},
+    {EDIT_SETTING,            handleEditSettingInput},
+    {CALIBRATE_THRESHOLD,     handleCalibrateThreshold},
+    {CALIBRATE_RECOIL,        handleCalibrateRecoil},
+    {CALIBRATE_BT_LATENCY,    handleBtLatencyCalibration},
+};
+
+static_assert(sizeof(STATE_HANDLERS) / sizeof(STATE_HANDLERS[0]) == TIMER_STATE_COUNT, "STATE_HANDLERS needs one row per TimerState");
+static_assert(rowsInStateOrder(STATE_HANDLERS), "STATE_HANDLERS rows must be in TimerState order");
+
+void runStateHandler() {
+    void (*handler)() = STATE_HANDLERS[stateInfo(currentState).state].handler;
+    if (handler) handler();
+}
+
+// Leaves the state as TRANSITION_TABLE says; the exit actions stop whatever
+// the drill had running.
+static void handleTopLongPress() {
+    if (!dispatchStateEvent(EVENT_TOP_LONG_PRESS)) return;
+    if (currentState == MODE_SELECTION) {
+        playUnsuccessBeeps(); // Drill abandoned
+    } else if (currentState == SETTINGS_MENU_MAIN) {
+        settingsMenuLevel = 0;
+        currentMenuSelection = 0;
+        menuScrollOffset = 0;
+    }
+}
+
+void serviceTopButton() {
+    unsigned long currentTime = millis();
+    if (StickCP2.BtnB.isPressed()) {
+        resetActivityTimer(); 
+        if (btnTopPressTime == 0) {
+            btnTopPressTime = currentTime;
+        } else if (!btnTopHeld && (currentTime - btnTopPressTime > LONG_PRESS_DURATION_MS)) {
+            btnTopHeld = true; 
+            handleTopLongPress();
+        }
+    } else {
+        btnTopPressTime = 0; 
+        btnTopHeld = false;  
+    }
+}
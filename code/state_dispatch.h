@@ -0,0 +1,28 @@
+#ifndef STATE_DISPATCH_H
+#define STATE_DISPATCH_H
+
+#include "config.h" // For TimerState, StateEvent
+
+// The firmware side of state_machine.h: every state's handler and its entry
+// and exit actions, and the one place the current state changes.
+
+// Switches state: runs the old state's exit action, records the transition
+// in the trace, then runs the new state's entry action.
+void setState(TimerState newState);
+
+// Moves on as TRANSITION_TABLE says for 'event'. Returns false, changing
+// nothing, if the current state ignores it.
+bool dispatchStateEvent(StateEvent event);
+
+// Runs the current state's handler (one pass of loop()).
+void runStateHandler();
+
+// BtnB (the top button): held past LONG_PRESS_DURATION_MS it is
+// EVENT_TOP_LONG_PRESS, once per press. Runs every pass, before the handler.
+void serviceTopButton();
+
+// Prints the last STATE_TRACE_SIZE transitions to Serial as CSV
+// (time_us,from,to), oldest first.
+void dumpStateTrace();
+
+#endif // STATE_DISPATCH_H
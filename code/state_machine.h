@@ -0,0 +1,293 @@
+#ifndef STATE_MACHINE_H
+#define STATE_MACHINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The UI state machine's states and what the main loop needs to know about
+// each one, as constant tables indexed by state: loop() looks a state up
+// instead of walking chains of comparisons, and adding a state without a
+// row fails to compile. The drill screens move on through a state x event
+// transition table, with entry and exit actions run around every change.
+
+// --- State Machine States ---
+enum TimerState {
+    BOOT_SCREEN,
+    BOOT_JPG_SEQUENCE,
+    MODE_SELECTION,
+    LIVE_FIRE_READY,
+    LIVE_FIRE_GET_READY,
+    LIVE_FIRE_TIMING,
+    LIVE_FIRE_STOPPED,
+    DRY_FIRE_READY,
+    DRY_FIRE_RUNNING,
+    NOISY_RANGE_READY,
+    NOISY_RANGE_GET_READY,
+    NOISY_RANGE_TIMING,
+    SETTINGS_MENU_MAIN,
+    SETTINGS_MENU_GENERAL,
+    SETTINGS_MENU_BEEP,
+    SETTINGS_MENU_DRYFIRE,
+    SETTINGS_MENU_NOISY,
+    SETTINGS_MENU_BLUETOOTH,
+    BLUETOOTH_SCANNING,
+    DEVICE_STATUS,
+    LIST_FILES,
+    EDIT_SETTING,
+    CALIBRATE_THRESHOLD,
+    CALIBRATE_RECOIL,
+    CALIBRATE_BT_LATENCY,
+    TIMER_STATE_COUNT
+};
+
+// Per-state flags.
+enum StateFlag : uint8_t {
+    STATE_NEEDS_TICKS = 1 << 0,     // Handler must run every LOOP_TICK_MS, not just on events
+    STATE_KEEPS_AWAKE = 1 << 1,     // Never auto-sleeps
+    STATE_BATTERY_REDRAW = 1 << 3,  // Shows the battery; redraw after each check
+    STATE_BLUETOOTH_REDRAW = 1 << 4, // Shows the BT link; redraw when it connects / drops
+    STATE_TIMED_WAKE = 1 << 5       // Live like a ticking state, but runs on events and at
+                                    // the deadline timingScreenWaitMs() gives, not every tick
+};
+
+struct StateInfo {
+    TimerState state;      // Must match the row's index
+    const char* name;      // For the transition trace
+    uint8_t flags;
+};
+
+static constexpr uint8_t STATE_TICKING = STATE_NEEDS_TICKS | STATE_KEEPS_AWAKE;
+static constexpr uint8_t STATE_LIVE_TIMED = STATE_TIMED_WAKE | STATE_KEEPS_AWAKE;
+
+static constexpr StateInfo STATE_TABLE[] = {
+    {BOOT_SCREEN,             "BOOT_SCREEN",             0},
+    {BOOT_JPG_SEQUENCE,       "BOOT_JPG_SEQUENCE",       STATE_TICKING},
+    {MODE_SELECTION,          "MODE_SELECTION",          STATE_BATTERY_REDRAW | STATE_BLUETOOTH_REDRAW},
+    {LIVE_FIRE_READY,         "LIVE_FIRE_READY",         0},
+    {LIVE_FIRE_GET_READY,     "LIVE_FIRE_GET_READY",     STATE_TICKING},
+    {LIVE_FIRE_TIMING,        "LIVE_FIRE_TIMING",        STATE_LIVE_TIMED},
+    {LIVE_FIRE_STOPPED,       "LIVE_FIRE_STOPPED",       0},
+    {DRY_FIRE_READY,          "DRY_FIRE_READY",          STATE_KEEPS_AWAKE},
+    {DRY_FIRE_RUNNING,        "DRY_FIRE_RUNNING",        STATE_TICKING},
+    {NOISY_RANGE_READY,       "NOISY_RANGE_READY",       STATE_KEEPS_AWAKE},
+    {NOISY_RANGE_GET_READY,   "NOISY_RANGE_GET_READY",   STATE_TICKING},
+    {NOISY_RANGE_TIMING,      "NOISY_RANGE_TIMING",      STATE_LIVE_TIMED},
+    {SETTINGS_MENU_MAIN,      "SETTINGS_MENU_MAIN",      STATE_KEEPS_AWAKE},
+    {SETTINGS_MENU_GENERAL,   "SETTINGS_MENU_GENERAL",   STATE_KEEPS_AWAKE},
+    {SETTINGS_MENU_BEEP,      "SETTINGS_MENU_BEEP",      STATE_KEEPS_AWAKE},
+    {SETTINGS_MENU_DRYFIRE,   "SETTINGS_MENU_DRYFIRE",   STATE_KEEPS_AWAKE},
+    {SETTINGS_MENU_NOISY,     "SETTINGS_MENU_NOISY",     STATE_KEEPS_AWAKE},
+    {SETTINGS_MENU_BLUETOOTH, "SETTINGS_MENU_BLUETOOTH", STATE_KEEPS_AWAKE | STATE_BATTERY_REDRAW | STATE_BLUETOOTH_REDRAW},
+    {BLUETOOTH_SCANNING,      "BLUETOOTH_SCANNING",      STATE_TICKING | STATE_BATTERY_REDRAW | STATE_BLUETOOTH_REDRAW},
+    {DEVICE_STATUS,           "DEVICE_STATUS",           STATE_KEEPS_AWAKE | STATE_BATTERY_REDRAW},
+    {LIST_FILES,              "LIST_FILES",              STATE_KEEPS_AWAKE | STATE_BATTERY_REDRAW},
+    {EDIT_SETTING,            "EDIT_SETTING",            STATE_KEEPS_AWAKE},
+    {CALIBRATE_THRESHOLD,     "CALIBRATE_THRESHOLD",     STATE_TICKING},
+    {CALIBRATE_RECOIL,        "CALIBRATE_RECOIL",        STATE_TICKING},
+    {CALIBRATE_BT_LATENCY,    "CALIBRATE_BT_LATENCY",    STATE_TICKING},
+};
+
+// True when row i of 'table' (and every row after it) has .state == i.
+// Used to check tables indexed by TimerState at compile time.
+template <typename Row, size_t N>
+constexpr bool rowsInStateOrder(const Row (&table)[N], size_t i = 0) {
+    return i == N || ((size_t)table[i].state == i && rowsInStateOrder(table, i + 1));
+}
+
+static_assert(sizeof(STATE_TABLE) / sizeof(STATE_TABLE[0]) == TIMER_STATE_COUNT, "STATE_TABLE needs one row per TimerState");
+static_assert(rowsInStateOrder(STATE_TABLE), "STATE_TABLE rows must be in TimerState order");
+
+inline const StateInfo& stateInfo(TimerState state) {
+    return STATE_TABLE[(state < TIMER_STATE_COUNT) ? state : BOOT_SCREEN];
+}
+
+inline bool stateHasFlag(TimerState state, StateFlag flag) {
+    return (stateInfo(state).flags & flag) != 0;
+}
+
+// A drill or calibration is running: ticking, or waking on its own deadlines.
+inline bool stateIsLive(TimerState state) {
+    return stateHasFlag(state, STATE_NEEDS_TICKS) || stateHasFlag(state, STATE_TIMED_WAKE);
+}
+
+inline const char* stateName(TimerState state) {
+    return (state < TIMER_STATE_COUNT) ? STATE_TABLE[state].name : "?";
+}
+
+// --- Transitions ---
+// What moves the drill screens on. The handlers report an event and
+// TRANSITION_TABLE says where it leads from the current state; an event with
+// no row for the state is ignored. Menus open the screen picked with a direct
+// setState(), as does the stopped screen (its next state depends on the mode).
+enum StateEvent : uint8_t {
+    EVENT_TOP_LONG_PRESS,  // BtnB held past LONG_PRESS_DURATION_MS
+    EVENT_SIDE_LONG_PRESS, // BtnA held past LONG_PRESS_DURATION_MS
+    EVENT_START,           // BtnA on a ready screen
+    EVENT_CANCEL,          // BtnA before the start beep
+    EVENT_BEEP,            // Start beep played
+    EVENT_STRING_DONE,     // String stopped, or the par run is over
+    STATE_EVENT_COUNT
+};
+
+struct StateTransitionRule {
+    TimerState from;
+    StateEvent event;
+    TimerState to;
+};
+
+static constexpr StateTransitionRule TRANSITION_TABLE[] = {
+    // BtnB long press: abandon the drill, or open the settings
+    {BOOT_SCREEN,           EVENT_TOP_LONG_PRESS,  SETTINGS_MENU_MAIN},
+    {MODE_SELECTION,        EVENT_TOP_LONG_PRESS,  SETTINGS_MENU_MAIN},
+    {LIVE_FIRE_READY,       EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {LIVE_FIRE_GET_READY,   EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {LIVE_FIRE_TIMING,      EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {LIVE_FIRE_STOPPED,     EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {DRY_FIRE_READY,        EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {DRY_FIRE_RUNNING,      EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {NOISY_RANGE_READY,     EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {NOISY_RANGE_GET_READY, EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+    {NOISY_RANGE_TIMING,    EVENT_TOP_LONG_PRESS,  MODE_SELECTION},
+
+    // Live Fire
+    {LIVE_FIRE_READY,       EVENT_START,           LIVE_FIRE_GET_READY},
+    {LIVE_FIRE_GET_READY,   EVENT_CANCEL,          LIVE_FIRE_READY},
+    {LIVE_FIRE_GET_READY,   EVENT_BEEP,            LIVE_FIRE_TIMING},
+    {LIVE_FIRE_TIMING,      EVENT_STRING_DONE,     LIVE_FIRE_STOPPED},
+
+    // Dry Fire
+    {DRY_FIRE_READY,        EVENT_SIDE_LONG_PRESS, MODE_SELECTION},
+    {DRY_FIRE_READY,        EVENT_START,           DRY_FIRE_RUNNING},
+    {DRY_FIRE_RUNNING,      EVENT_SIDE_LONG_PRESS, DRY_FIRE_READY},
+    {DRY_FIRE_RUNNING,      EVENT_STRING_DONE,     DRY_FIRE_READY},
+
+    // Noisy Range (strings end on the Live Fire stopped screen)
+    {NOISY_RANGE_READY,     EVENT_SIDE_LONG_PRESS, MODE_SELECTION},
+    {NOISY_RANGE_READY,     EVENT_START,           NOISY_RANGE_GET_READY},
+    {NOISY_RANGE_GET_READY, EVENT_CANCEL,          NOISY_RANGE_READY},
+    {NOISY_RANGE_GET_READY, EVENT_BEEP,            NOISY_RANGE_TIMING},
+    {NOISY_RANGE_TIMING,    EVENT_STRING_DONE,     LIVE_FIRE_STOPPED},
+};
+
+// TRANSITION_TABLE is the readable source; the lookup below is built from it
+// at compile time, so nextState() is a single indexed load.
+
+// Where 'event' leads from 'from' by rules [i, N), or TIMER_STATE_COUNT.
+template <size_t N>
+constexpr TimerState ruleTarget(const StateTransitionRule (&rules)[N], TimerState from, StateEvent event, size_t i = 0) {
+    return i == N ? TIMER_STATE_COUNT
+         : (rules[i].from == from && rules[i].event == event) ? rules[i].to
+         : ruleTarget(rules, from, event, i + 1);
+}
+
+// Rules [i, N) for 'from' and 'event'.
+template <size_t N>
+constexpr size_t rulesFor(const StateTransitionRule (&rules)[N], TimerState from, StateEvent event, size_t i = 0) {
+    return i == N ? 0 : (rules[i].from == from && rules[i].event == event) + rulesFor(rules, from, event, i + 1);
+}
+
+// True when no two rules from row i on share a state and an event.
+template <size_t N>
+constexpr bool rulesAreUnique(const StateTransitionRule (&rules)[N], size_t i = 0) {
+    return i == N || (rulesFor(rules, rules[i].from, rules[i].event) == 1 && rulesAreUnique(rules, i + 1));
+}
+
+static_assert(rulesAreUnique(TRANSITION_TABLE), "TRANSITION_TABLE has two rules for the same state and event");
+
+// 0 .. N-1 as a pack (the firmware is built as C++11: no std::index_sequence).
+template <size_t... I> struct IndexList {};
+template <size_t N, size_t... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+struct TransitionRow {
+    uint8_t to[STATE_EVENT_COUNT]; // TimerState per event, TIMER_STATE_COUNT for none
+};
+
+struct TransitionLookup {
+    TransitionRow from[TIMER_STATE_COUNT];
+};
+
+template <size_t... E>
+constexpr TransitionRow buildTransitionRow(TimerState from, IndexList<E...>) {
+    return TransitionRow{{(uint8_t)ruleTarget(TRANSITION_TABLE, from, (StateEvent)E)...}};
+}
+
+template <size_t... S>
+constexpr TransitionLookup buildTransitionLookup(IndexList<S...>) {
+    return TransitionLookup{{buildTransitionRow((TimerState)S, MakeIndexList<STATE_EVENT_COUNT>::type())...}};
+}
+
+static_assert(TIMER_STATE_COUNT <= UINT8_MAX, "TransitionRow stores states in a byte");
+static constexpr TransitionLookup TRANSITION_LOOKUP = buildTransitionLookup(MakeIndexList<TIMER_STATE_COUNT>::type());
+
+// Where 'event' leads from 'from', or TIMER_STATE_COUNT if it is ignored there.
+inline TimerState nextState(TimerState from, StateEvent event) {
+    if (from >= TIMER_STATE_COUNT || event >= STATE_EVENT_COUNT) return TIMER_STATE_COUNT;
+    return (TimerState)TRANSITION_LOOKUP.from[from].to[event];
+}
+
+// --- Entry / Exit Actions ---
+// One row per state, run by setState() around every change of state: the old
+// state's onExit, then the switch itself, then the new state's onEnter. Both
+// are told where the machine is coming from and going to, so an exit action
+// can tell a drill moving on from one being abandoned. nullptr for none.
+typedef void (*StateAction)(TimerState from, TimerState to);
+
+struct StateHooks {
+    TimerState state;
+    StateAction onExit;
+    StateAction onEnter;
+};
+
+// Runs the change from 'from' to 'to' with 'hooks' (one row per state, in
+// TimerState order): exit action, 'switchState()', entry action. Returns
+// false, running nothing, if there is no change.
+template <size_t N, typename Switch>
+bool runTransition(const StateHooks (&hooks)[N], TimerState from, TimerState to, Switch switchState) {
+    static_assert(N == TIMER_STATE_COUNT, "State hooks need one row per TimerState");
+    if (from == to || from >= TIMER_STATE_COUNT || to >= TIMER_STATE_COUNT) return false;
+    if (hooks[from].onExit) hooks[from].onExit(from, to);
+    switchState();
+    if (hooks[to].onEnter) hooks[to].onEnter(from, to);
+    return true;
+}
+
+// --- Transition Trace ---
+// The last Capacity transitions with the esp_timer time they happened at,
+// overwriting the oldest. Written and read by the main loop only.
+struct StateTransition {
+    int64_t atUs;
+    uint8_t from;   // TimerState
+    uint8_t to;
+};
+
+template <uint32_t Capacity>
+class StateTrace {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "StateTrace capacity must be a power of two");
+
+public:
+    void record(TimerState from, TimerState to, int64_t atUs) {
+        StateTransition& entry = entries_[total_ & (Capacity - 1)];
+        entry.atUs = atUs;
+        entry.from = (uint8_t)from;
+        entry.to = (uint8_t)to;
+        total_++;
+    }
+
+    // Transitions currently held, at most Capacity.
+    uint32_t size() const { return (total_ < Capacity) ? total_ : Capacity; }
+
+    // Transitions recorded since boot, including overwritten ones.
+    uint32_t total() const { return total_; }
+
+    // i = 0 is the oldest transition held, size() - 1 the latest.
+    const StateTransition& at(uint32_t i) const {
+        return entries_[(total_ - size() + i) & (Capacity - 1)];
+    }
+
+private:
+    StateTransition entries_[Capacity] = {};
+    uint32_t total_ = 0;
+};
+
+#endif // STATE_MACHINE_H
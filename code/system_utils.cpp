@@ -3,14 +3,7 @@
 #include "config.h"
 #include "audio_utils.h" // For playUnsuccessBeeps on low battery
 #include "nvs_utils.h"   // For savePeakVoltage
-
-void setState(TimerState newState) {
-    if (currentState != newState) {
-        previousState = currentState;
-        currentState = newState;
-        redrawMenu = true;
-    }
-}
+#include "timer_modes.h" // For timingScreenWaitMs
 
 void resetActivityTimer() {
     lastActivityTime = millis();
@@ -38,3 +31,39 @@ void checkBattery() {
     }
     lastBatteryCheckTime = millis();
 }
+
+// --- Loop Pacing ---
+// Ticking states (STATE_NEEDS_TICKS) draw or move on by themselves, so they
+// run every LOOP_TICK_MS. The timing screens (STATE_TIMED_WAKE) run on an
+// event (shot, start beep, button) or their own next deadline, the clock
+// redraw at the latest. The rest only run on an event or a deadline of the
+// loop's own. Now that passes only happen on events, which screens never
+// auto-sleep (STATE_KEEPS_AWAKE) is explicit in the table too.
+bool autoSleepArmed() {
+    return enableAutoSleep &&
+           currentState != BOOT_SCREEN &&
+           !stateHasFlag(currentState, STATE_KEEPS_AWAKE) &&
+           !a2dp_source.is_connected();
+}
+
+uint32_t loopWaitMs() {
+    static unsigned long lastButtonActivity = 0;
+    unsigned long now = millis();
+    if (StickCP2.BtnA.isPressed() || StickCP2.BtnB.isPressed() || M5.BtnPWR.isPressed() ||
+        !digitalRead(BTN_A_PIN) || !digitalRead(BTN_B_PIN) || !digitalRead(BTN_PWR_PIN)) {
+        lastButtonActivity = now;
+    }
+    if (stateHasFlag(currentState, STATE_NEEDS_TICKS) || now - lastButtonActivity < BUTTON_SETTLE_MS) {
+        return LOOP_TICK_MS;
+    }
+
+    unsigned long waitMs = BATTERY_CHECK_INTERVAL_MS - min(now - lastBatteryCheckTime, BATTERY_CHECK_INTERVAL_MS);
+    if (stateHasFlag(currentState, STATE_TIMED_WAKE)) {
+        return (uint32_t)min(waitMs + 1, (unsigned long)timingScreenWaitMs());
+    }
+    if (autoSleepArmed()) {
+        waitMs = min(waitMs, AUTO_SLEEP_TIMEOUT_MS - min(now - lastActivityTime, AUTO_SLEEP_TIMEOUT_MS));
+    }
+    waitMs = min(waitMs, (unsigned long)settingsSaveWaitMs());
+    return (uint32_t)max(waitMs + 1, LOOP_TICK_MS);
+}
@@ -6,11 +6,19 @@
 // For sleep functions
 #include "driver/rtc_io.h"
 #include "esp_sleep.h"
+#include "state_dispatch.h" // setState()
 
 
-void setState(TimerState newState);
 void resetActivityTimer();
 void checkBattery();
+
+// True when the current screen may auto-sleep after AUTO_SLEEP_TIMEOUT_MS.
+bool autoSleepArmed();
+
+// How long loop() may block in waitForLoopEvents(): one tick while a drill is
+// ticking or a button is (or just was) down, the timing screen's own deadline
+// there, otherwise until the battery check, auto-sleep or a settings save is due.
+uint32_t loopWaitMs();
 // setupSleep and wakeUp functions could be here if more complex
 
 #endif // SYSTEM_UTILS_H
@@ -4,6 +4,15 @@
 #include "display_utils.h"
 #include "audio_utils.h"
 #include "system_utils.h" 
+#include "shot_capture.h"
+#include "shot_config.h"
+#include "imu_pipeline.h"
+#include "ui_render.h"
+#include "loop_events.h"
+#include "start_sequence.h"
+#include "session_journal.h"
+#include "crc32.h"
+#include <esp_timer.h>
 
 void resetShotData() {
     shotCount = 0;
@@ -11,80 +20,198 @@ void resetShotData() {
     lastDetectionTime = 0;
     currentCyclePeakRMS = 0.0f;
     peakRMSOverall = 0.0f;
-    micPeakRMS.resetPeak();
     checkingForRecoil = false;
     lastSoundPeakTime = 0;
+    recoilOnsetUs = 0;
+    rescoreMarginDb = 0;
     for (int i = 0; i < MAX_SHOTS_LIMIT; ++i) {
         shotTimestamps[i] = 0;
         splitTimes[i] = 0.0f;
     }
 }
 
-void handleLiveFireReady() {
-    if (redrawMenu) {
-        displayTimingScreen(0.0, 0, 0.0);
-        redrawMenu = false;
+// --- String Screens ---
+// Drawn by the UI render task from a copy of the string; loop() only publishes.
+static void publishStringScreen(float elapsedTime, int count, float lastSplit, bool redraw) {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_TIMING;
+    snapshot.timing.elapsedTime = elapsedTime;
+    snapshot.timing.shotCount = count;
+    snapshot.timing.maxShots = currentMaxShots;
+    snapshot.timing.lastSplit = lastSplit;
+    publishUiSnapshot(snapshot, redraw);
+}
+
+void publishStoppedScreen() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_STOPPED;
+    snapshot.stopped.shotCount = shotCount;
+    snapshot.stopped.rescoreMarginDb = rescoreMarginDb;
+    for (int i = 0; i < MAX_SHOTS_LIMIT; ++i) {
+        snapshot.stopped.splits[i] = splitTimes[i];
     }
-    if (StickCP2.BtnA.wasClicked()) {
-        resetActivityTimer();
-        reset_bt_beep_state(); 
-        is_listening_active = false; 
-        setState(LIVE_FIRE_GET_READY);
-        StickCP2.Lcd.fillScreen(BLACK);
-        StickCP2.Lcd.setTextDatum(MC_DATUM);
-        StickCP2.Lcd.setTextFont(0);
-        StickCP2.Lcd.setTextSize(3);
-        StickCP2.Lcd.drawString("Ready...", StickCP2.Lcd.width()/2, StickCP2.Lcd.height()/2);
-        delay(1000); 
+    publishUiSnapshot(snapshot, true);
+}
+
+// Moves startTime (and the listen gate) onto the moment the start beep was
+// heard, as reported by the buzzer task or the A2DP frame clock plus the
+// speaker latency.
+static void applyStartBeepReport() {
+    int64_t emittedUs;
+    bool viaBluetooth;
+    if (takeStartBeepEmittedUs(emittedUs, viaBluetooth) && shotCount == 0) {
+        if (viaBluetooth) {
+            emittedUs += (int64_t)currentBluetoothAudioOffsetMs * 1000;
+        }
+        startTime = (unsigned long)(emittedUs / 1000);
+        beep_audio_end_time = startTime + listenDelayMs(currentBeepDuration);
     }
 }
 
-void handleLiveFireGetReady() {
+// --- Start Sequence ---
+// Press on the ready screen -> "Ready..." -> optional random delay -> start
+// beep -> TIMING, which arms listening once the beep is over. Pressing the
+// button again before the beep abandons the start.
+static StartSequence startSequence;
+
+StartSequenceStats getStartSequenceStats() {
+    return startSequence.stats();
+}
+
+static void beginStartSequence() {
     resetActivityTimer();
+    reset_bt_beep_state();
+    is_listening_active = false;
+    unsigned long randomDelayMs = 0;
+    if (startRandomDelayMs > 0) {
+        randomSeed(micros());
+        randomDelayMs = random(startRandomDelayMs / 2, startRandomDelayMs + 1);
+    }
+    startSequence.begin(esp_timer_get_time(), START_READY_HOLD_MS, randomDelayMs);
+    dispatchStateEvent(EVENT_START);
+    displayMessageScreen("Ready...", 3);
+}
+
+static void runStartSequence() {
+    resetActivityTimer();
+    if (StickCP2.BtnA.wasPressed()) {
+        startSequence.cancel((uint32_t)esp_timer_get_time() - lastButtonEdgeUs());
+        playUnsuccessBeeps();
+        dispatchStateEvent(EVENT_CANCEL);
+        redrawMenu = true;
+        return;
+    }
+    if (startSequence.advance(esp_timer_get_time()) != START_BEEP_DUE) return;
+
     unsigned long beepInitiationTime = millis();
     playTone(currentBeepToneHz, currentBeepDuration); // Only plays on BT if connected, otherwise queues for buzzer
-    
+
     // Calculate when the audio output (whichever is active) is expected to finish.
     // If BT connected, consider offset and duration. If buzzer, consider duration.
-    unsigned long audioDuration = currentBeepDuration;
     unsigned long audioStartTime = beepInitiationTime; // Buzzer starts now
     if (a2dp_source.is_connected()) {
-        audioStartTime = beepInitiationTime + currentBluetoothAudioOffsetMs; // BT starts later/earlier
+        audioStartTime = beepInitiationTime + currentBluetoothAudioOffsetMs; // Heard after the speaker latency
     }
-    // Use max to handle negative offsets correctly for end time calculation
-    beep_audio_end_time = max(beepInitiationTime, audioStartTime) + audioDuration + 150; // Add 150ms buffer
-
+    beep_audio_end_time = audioStartTime + listenDelayMs(currentBeepDuration);
     is_listening_active = false; // Don't listen until beep is finished
 
-    // Set timer start time relative to beep initiation + standard delay
-    startTime = beepInitiationTime + POST_BEEP_DELAY_MS; 
-    
-    delay(POST_BEEP_DELAY_MS); // Wait for the standard post-beep delay
-    
-    resetShotData(); 
+    // Expected beep start; replaced by the emitted time once the audio path reports it.
+    startTime = audioStartTime;
+    startSequence.beepPlayed();
+
+    resetShotData();
     lastDisplayUpdateTime = 0;
-    StickCP2.Lcd.fillScreen(BLACK);
-    setState(LIVE_FIRE_TIMING);
+    dispatchStateEvent(EVENT_BEEP);
+    redrawMenu = true;
+}
+
+// Exit action of the GET_READY states: leaving before the beep (cancelled,
+// or a long press) abandons the start, so nothing is left to play it.
+void exitGetReady(TimerState, TimerState) {
+    if (startSequence.phase() != START_LISTEN_ARM) {
+        startSequence.abandon();
+    }
+}
+
+void handleLiveFireReady() {
+    if (redrawMenu) {
+        publishStringScreen(0.0f, 0, 0.0f, true);
+        redrawMenu = false;
+    }
+    if (StickCP2.BtnA.wasClicked()) {
+        beginStartSequence();
+    }
+}
+
+void handleLiveFireGetReady() {
+    runStartSequence();
+}
+
+// What the string was shot with, for telling sessions apart in the journal.
+static uint32_t settingsHash() {
+    int32_t settings[] = {
+        shotThresholdRms, shotMarginDb, (int32_t)shotLockoutMs, (int32_t)(recoilThreshold * 100.0f),
+        currentMaxShots, (int32_t)currentBeepDuration, currentBeepToneHz, (int32_t)startRandomDelayMs,
+        currentBluetoothAudioOffsetMs,
+    };
+    return crc32((const uint8_t*)settings, sizeof(settings));
+}
+
+// The string on the stopped screen; journalled once it is left, after any
+// re-score.
+static SessionRecord stoppedString;
+static bool stoppedStringPending = false;
+
+// Ends the string being timed.
+static void stopString() {
+    stoppedString.mode = (currentState == NOISY_RANGE_TIMING) ? MODE_NOISY_RANGE : MODE_LIVE_FIRE;
+    stoppedString.startMs = (uint32_t)startTime;
+    stoppedString.settingsHash = settingsHash();
+    stoppedStringPending = true;
+
+    dispatchStateEvent(EVENT_STRING_DONE);
+    if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+}
+
+// Exit action of LIVE_FIRE_STOPPED: queues the string, as last re-scored,
+// for the session journal.
+void exitStopped(TimerState, TimerState) {
+    if (!stoppedStringPending) return;
+    stoppedStringPending = false;
+    stoppedString.shotCount = (uint8_t)shotCount;
+    for (int i = 0; i < shotCount; ++i) {
+        stoppedString.shotMs[i] = (uint32_t)(shotTimestamps[i] - startTime);
+    }
+    sessionJournalAppend(stoppedString);
+}
+
+// Exit action of the TIMING states, however the string ends.
+void exitTiming(TimerState, TimerState) {
+    is_listening_active = false;
+    disarmShotCapture();
 }
 
 void handleLiveFireTiming() {
     unsigned long currentTime = millis();
 
     if (currentState != LIVE_FIRE_TIMING) return; 
+    applyStartBeepReport();
 
     // --- Check if listening should become active ---
     if (!is_listening_active) {
         // Check if enough time has passed since the calculated end of beep audio
-        // AND ensure the timer has actually started (passed POST_BEEP_DELAY_MS)
+        // AND ensure the timer has actually started (the start beep has gone out)
         if (currentTime >= beep_audio_end_time && currentTime >= startTime) { 
             is_listening_active = true;
-            micPeakRMS.resetPeak(); // Reset peak *just* as listening starts
+            armShotCapture(); // Start detection *just* as listening starts
+            startSequence.listening(esp_timer_get_time());
+            rescoreMarginDb = shotMarginDb;
         } else {
             // Still waiting for beep audio to finish or for startTime, don't process mic input
              if (redrawMenu || currentTime - lastDisplayUpdateTime >= DISPLAY_UPDATE_INTERVAL_MS) {
                 float currentElapsedTime = (startTime > 0 && currentTime > startTime) ? (currentTime - startTime) / 1000.0f : 0.0f;
                 float lastSplit = (shotCount > 0) ? splitTimes[shotCount - 1] : 0.0f;
-                displayTimingScreen(currentElapsedTime, shotCount, lastSplit);
+                publishStringScreen(currentElapsedTime, shotCount, lastSplit, redrawMenu);
                 lastDisplayUpdateTime = currentTime;
                 redrawMenu = false; 
             }
@@ -94,29 +221,29 @@ void handleLiveFireTiming() {
 
     // --- Listening is Active ---
     float currentElapsedTime = (startTime > 0 && currentTime > startTime) ? (currentTime - startTime) / 1000.0f : 0.0f;
-    
-    micPeakRMS.update(); 
-    currentCyclePeakRMS = micPeakRMS.getPeakRMS(); 
-
-    if (currentCyclePeakRMS > peakRMSOverall) {
-        peakRMSOverall = currentCyclePeakRMS;
-    }
 
     if (redrawMenu || currentTime - lastDisplayUpdateTime >= DISPLAY_UPDATE_INTERVAL_MS) {
         float lastSplit = (shotCount > 0) ? splitTimes[shotCount - 1] : 0.0f;
-        displayTimingScreen(currentElapsedTime, shotCount, lastSplit);
+        publishStringScreen(currentElapsedTime, shotCount, lastSplit, redrawMenu);
         lastDisplayUpdateTime = currentTime;
         redrawMenu = false; 
     }
 
-    // Shot Detection Logic 
-    if (currentCyclePeakRMS > shotThresholdRms && 
-        currentTime - lastDetectionTime > SHOT_REFRACTORY_MS && 
-        shotCount < currentMaxShots && 
-        startTime > 0) 
+    // Shot Detection Logic: consume the shots detected and stamped by the capture task.
+    // Event times are on the esp_timer clock, which millis() is derived from.
+    ShotEvent shotEvent;
+    while (currentState == LIVE_FIRE_TIMING &&
+           shotCount < currentMaxShots &&
+           startTime > 0 &&
+           popShotEvent(shotEvent))
     {
-        unsigned long shotTimeMillis = currentTime; 
+        unsigned long shotTimeMillis = (unsigned long)(shotEvent.timeUs / 1000);
+        if (shotTimeMillis < startTime) continue;
         resetActivityTimer();
+        currentCyclePeakRMS = shotEvent.peakRms;
+        if (currentCyclePeakRMS > peakRMSOverall) {
+            peakRMSOverall = currentCyclePeakRMS;
+        }
         lastDetectionTime = shotTimeMillis; 
         shotTimestamps[shotCount] = shotTimeMillis; 
 
@@ -130,32 +257,19 @@ void handleLiveFireTiming() {
         splitTimes[shotCount] = currentSplit;
         shotCount++;
         
-        displayTimingScreen(currentElapsedTime, shotCount, currentSplit); 
+        publishStringScreen(currentElapsedTime, shotCount, currentSplit, false);
         lastDisplayUpdateTime = currentTime; 
 
         if (shotCount >= currentMaxShots) {
-            is_listening_active = false; 
-            setState(LIVE_FIRE_STOPPED);
-            StickCP2.Lcd.fillScreen(BLACK);
-            displayStoppedScreen();
-            if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+            stopString();
         }
-        // Don't reset peak here, let next cycle handle it
-    } 
-    // Reset peak at the end of the active listening cycle if no shot was detected
-    else if (is_listening_active) { 
-         micPeakRMS.resetPeak(); 
     }
 
 
     // Manual Stop
     if (currentState == LIVE_FIRE_TIMING && StickCP2.BtnA.wasClicked()) {
         resetActivityTimer();
-        is_listening_active = false; 
-        setState(LIVE_FIRE_STOPPED);
-        StickCP2.Lcd.fillScreen(BLACK);
-        displayStoppedScreen();
-        if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+        stopString();
     }
 
     // Timeout Stop
@@ -163,15 +277,96 @@ void handleLiveFireTiming() {
         unsigned long timeSinceEvent = (shotCount == 0) ? (currentTime - startTime) : (currentTime - lastShotTimestamp);
         bool hasStarted = (startTime > 0);
         if (hasStarted && timeSinceEvent > TIMEOUT_DURATION_MS) {
-            is_listening_active = false; 
-            setState(LIVE_FIRE_STOPPED);
-            StickCP2.Lcd.fillScreen(BLACK);
-            displayStoppedScreen();
-            if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+            stopString();
+        }
+    }
+}
+
+
+// Re-runs the recorded string with a different shot margin and rebuilds the
+// shot list. Shots older than the recorded history are kept as they were.
+static void rescoreLiveFireString(int marginDb) {
+    int64_t fromUs = max((int64_t)startTime * 1000, getShotStringHistoryStartUs());
+    int keptShots = 0;
+    while (keptShots < shotCount && (int64_t)shotTimestamps[keptShots] * 1000 < fromUs) {
+        keptShots++;
+    }
+
+    int64_t onsetUs[MAX_SHOTS_LIMIT];
+    size_t found = rescoreShotString(marginDb, fromUs, onsetUs, currentMaxShots - keptShots);
+
+    shotCount = keptShots;
+    lastShotTimestamp = (shotCount > 0) ? shotTimestamps[shotCount - 1] : 0;
+    for (size_t i = 0; i < found; ++i) {
+        unsigned long shotTimeMillis = (unsigned long)(onsetUs[i] / 1000);
+        shotTimestamps[shotCount] = shotTimeMillis;
+        splitTimes[shotCount] = (shotCount == 0) ? (shotTimeMillis - startTime) / 1000.0f
+                                                 : (shotTimeMillis - lastShotTimestamp) / 1000.0f;
+        lastShotTimestamp = shotTimeMillis;
+        shotCount++;
+    }
+    for (int i = shotCount; i < MAX_SHOTS_LIMIT; ++i) {
+        shotTimestamps[i] = 0;
+        splitTimes[i] = 0.0f;
+    }
+}
+
+void handleStoppedRescoreInput() {
+    if (rescoreMarginDb == 0 || getShotStringHistoryStartUs() == INT64_MAX) return;
+
+    int rotation = uiRotation();
+    bool upPressed = (rotation == 3) ? M5.BtnPWR.wasClicked() : StickCP2.BtnB.wasClicked();
+    bool downPressed = (rotation == 3) ? StickCP2.BtnB.wasClicked() : M5.BtnPWR.wasClicked();
+    if (!upPressed && !downPressed) return;
+
+    resetActivityTimer();
+    int margin = rescoreMarginDb + (upPressed ? 1 : -1);
+    if (margin < SHOT_MARGIN_DB_MIN || margin > SHOT_MARGIN_DB_MAX) return;
+
+    rescoreMarginDb = margin;
+    rescoreLiveFireString(margin);
+    publishStoppedScreen();
+}
+
+void handleLiveFireStopped() {
+    if (redrawMenu) {
+        publishStoppedScreen();
+        redrawMenu = false;
+    }
+    handleStoppedRescoreInput();
+    if (StickCP2.BtnA.wasClicked()) {
+        resetActivityTimer();
+        if (previousState == NOISY_RANGE_TIMING || previousState == NOISY_RANGE_GET_READY || currentMode == MODE_NOISY_RANGE) {
+             setState(NOISY_RANGE_READY);
+        } else if (previousState == DRY_FIRE_RUNNING || currentMode == MODE_DRY_FIRE) { 
+            setState(DRY_FIRE_READY); 
+        }
+        else { 
+            setState(LIVE_FIRE_READY);
         }
     }
 }
 
+// --- Dry Fire Par Schedule ---
+// Absolute beep times of the current par string, compiled when it starts:
+// beep 1 after the random delay, then one par time after another.
+static int64_t parBeepUs[MAX_PAR_BEEPS];
+static int parBeepCount = 0;
+
+static void compileParSchedule(int64_t firstBeepUs) {
+    ToneCommand tones[MAX_PAR_BEEPS];
+    parBeepCount = min(max(dryFireParBeepCount, 1), MAX_PAR_BEEPS);
+    int64_t beepUs = firstBeepUs;
+    for (int i = 0; i < parBeepCount; ++i) {
+        parBeepUs[i] = beepUs;
+        tones[i] = {};
+        tones[i].startUs = beepUs;
+        tones[i].frequency = (uint16_t)currentBeepToneHz;
+        tones[i].durationMs = (uint16_t)currentBeepDuration;
+        beepUs += (int64_t)(dryFireParTimesSec[i] * 1000000.0f + 0.5f);
+    }
+    scheduleTones(tones, parBeepCount);
+}
 
 void handleDryFireReadyInput() {
     resetActivityTimer();
@@ -181,172 +376,102 @@ void handleDryFireReadyInput() {
     }
 
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
-        setState(MODE_SELECTION);
-        currentMenuSelection = (int)MODE_DRY_FIRE;
-        int rotation = StickCP2.Lcd.getRotation();
-        int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
-        menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
-        StickCP2.Lcd.fillScreen(BLACK);
+        dispatchStateEvent(EVENT_SIDE_LONG_PRESS);
         return;
     }
 
     if (StickCP2.BtnA.wasClicked()) {
-        reset_bt_beep_state(); 
         randomSeed(micros());
         unsigned long randomDelay = random(DRY_FIRE_RANDOM_DELAY_MIN_MS, DRY_FIRE_RANDOM_DELAY_MAX_MS + 1);
+        compileParSchedule(esp_timer_get_time() + (int64_t)randomDelay * 1000);
 
-        randomDelayStartMs = millis();
-        parTimerStartTime = randomDelayStartMs + randomDelay; 
         beepSequenceStartTime = 0; 
         beepsPlayed = 0;
-        nextBeepTime = 0;
         lastBeepTime = 0;
 
-        setState(DRY_FIRE_RUNNING);
+        dispatchStateEvent(EVENT_START);
         redrawMenu = true; 
     }
 }
 
+// Exit action of DRY_FIRE_RUNNING: the par beeps still to come are dropped,
+// whether the run finished, was stopped or was abandoned with a long press.
+void exitDryFireRunning(TimerState, TimerState) {
+    reset_bt_beep_state();
+}
+
+// The beeps play on their own (see scheduleTones); this only follows progress.
 void handleDryFireRunning() {
     resetActivityTimer();
-    unsigned long currentTime = millis();
+    int64_t nowUs = esp_timer_get_time();
 
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
-        reset_bt_beep_state(); 
-        setState(DRY_FIRE_READY);
+        dispatchStateEvent(EVENT_SIDE_LONG_PRESS);
         playUnsuccessBeeps();
         redrawMenu = true; 
         return;
     }
 
-    if (beepSequenceStartTime == 0) { 
-        if (redrawMenu) {
-            displayDryFireRunningScreen(true, 0, dryFireParBeepCount); 
-        }
-        if (currentTime >= parTimerStartTime) { 
-            playTone(currentBeepToneHz, currentBeepDuration); 
-            beepSequenceStartTime = currentTime; 
-            lastBeepTime = beepSequenceStartTime; 
-            beepsPlayed = 1;
-            if (beepsPlayed < dryFireParBeepCount && dryFireParBeepCount > 0) {
-                 int parIndex = 0; 
-                 if (parIndex < MAX_PAR_BEEPS && parIndex < dryFireParBeepCount -1) { 
-                    nextBeepTime = beepSequenceStartTime + (unsigned long)(dryFireParTimesSec[parIndex] * 1000.0f);
-                 } else { 
-                    beepsPlayed = dryFireParBeepCount; 
-                 }
-            } else { 
-                 beepsPlayed = dryFireParBeepCount; 
-            }
-            redrawMenu = true;
-        }
+    int due = beepsPlayed;
+    while (due < parBeepCount && parBeepUs[due] <= nowUs) {
+        ++due;
     }
-    else { 
-         if (redrawMenu) {
-            displayDryFireRunningScreen(false, beepsPlayed, dryFireParBeepCount);
-         }
-        if (beepsPlayed >= dryFireParBeepCount) {
-            reset_bt_beep_state(); 
-            setState(DRY_FIRE_READY);
-            delay(500); 
-            redrawMenu = true;
-        }
-        else if (currentTime >= nextBeepTime && nextBeepTime > 0) {
-            playTone(currentBeepToneHz, currentBeepDuration);
-            lastBeepTime = currentTime; 
-            beepsPlayed++;
-            if (beepsPlayed < dryFireParBeepCount) {
-                int parIndex = beepsPlayed -1; 
-                unsigned long cumulativeParTimeMs = 0;
-                for(int k=0; k < beepsPlayed -1; ++k){ 
-                    if (k < MAX_PAR_BEEPS) {
-                         cumulativeParTimeMs += (unsigned long)(dryFireParTimesSec[k] * 1000.0f);
-                    }
-                }
-                 if (parIndex >= 0 && parIndex < MAX_PAR_BEEPS && parIndex < dryFireParBeepCount -1) {
-                    nextBeepTime = beepSequenceStartTime + cumulativeParTimeMs + (unsigned long)(dryFireParTimesSec[parIndex] * 1000.0f);
-                 } else {
-                    beepsPlayed = dryFireParBeepCount; 
-                    nextBeepTime = 0;
-                 }
-            } else {
-                nextBeepTime = 0; 
-            }
-            redrawMenu = true;
-        }
+    if (due != beepsPlayed) {
+        beepsPlayed = due;
+        beepSequenceStartTime = (unsigned long)(parBeepUs[0] / 1000);
+        lastBeepTime = (unsigned long)(parBeepUs[due - 1] / 1000);
+        redrawMenu = true;
+    }
+
+    if (redrawMenu) {
+        displayDryFireRunningScreen(beepsPlayed == 0, beepsPlayed, dryFireParBeepCount);
+    }
+
+    // Done a moment after the last beep has finished sounding.
+    int64_t doneUs = parBeepUs[parBeepCount - 1] + (int64_t)(currentBeepDuration + DRY_FIRE_DONE_HOLD_MS) * 1000;
+    if (beepsPlayed >= parBeepCount && nowUs >= doneUs) {
+        dispatchStateEvent(EVENT_STRING_DONE);
+        redrawMenu = true;
     }
 }
 
 void handleNoisyRangeReadyInput() {
     resetActivityTimer();
     if (redrawMenu) {
-        displayTimingScreen(0.0f, 0, 0.0f);
+        publishStringScreen(0.0f, 0, 0.0f, true);
         redrawMenu = false;
     }
     if (StickCP2.BtnA.pressedFor(LONG_PRESS_DURATION_MS)) {
-        setState(MODE_SELECTION);
-        currentMenuSelection = (int)MODE_NOISY_RANGE;
-        int rotation = StickCP2.Lcd.getRotation();
-        int itemsPerScreen = (rotation % 2 == 0) ? MENU_ITEMS_PER_SCREEN_PORTRAIT : MENU_ITEMS_PER_SCREEN_LANDSCAPE;
-        menuScrollOffset = max(0, currentMenuSelection - itemsPerScreen + 1);
-        StickCP2.Lcd.fillScreen(BLACK);
+        dispatchStateEvent(EVENT_SIDE_LONG_PRESS);
         return;
     }
     if (StickCP2.BtnA.wasClicked()) {
-        reset_bt_beep_state(); 
-        is_listening_active = false; 
-        setState(NOISY_RANGE_GET_READY);
-        StickCP2.Lcd.fillScreen(BLACK);
-        StickCP2.Lcd.setTextDatum(MC_DATUM);
-        StickCP2.Lcd.setTextFont(0);
-        StickCP2.Lcd.setTextSize(3);
-        StickCP2.Lcd.drawString("Ready...", StickCP2.Lcd.width()/2, StickCP2.Lcd.height()/2);
-        delay(1000);
+        beginStartSequence();
     }
 }
 
 void handleNoisyRangeGetReady() {
-    resetActivityTimer();
-    unsigned long beepInitiationTime = millis();
-    playTone(currentBeepToneHz, currentBeepDuration);
-    
-    // Calculate when the audio (BT or Buzzer) is expected to finish
-    unsigned long audioDuration = currentBeepDuration;
-    unsigned long audioStartTime = beepInitiationTime; // Buzzer starts now
-    if (a2dp_source.is_connected()) {
-        audioStartTime = beepInitiationTime + currentBluetoothAudioOffsetMs; // BT starts later/earlier
-    }
-    beep_audio_end_time = max(beepInitiationTime, audioStartTime) + audioDuration + 150; // Increased buffer
-    is_listening_active = false; 
-
-    startTime = beepInitiationTime + POST_BEEP_DELAY_MS; 
-
-    delay(POST_BEEP_DELAY_MS); 
-    
-    resetShotData();
-    lastDisplayUpdateTime = 0;
-    StickCP2.Lcd.fillScreen(BLACK);
-    setState(NOISY_RANGE_TIMING);
-    redrawMenu = true; 
+    runStartSequence();
 }
 
 void handleNoisyRangeTiming() {
     unsigned long currentTime = millis();
-    float accX, accY, accZ;
 
     if (currentState != NOISY_RANGE_TIMING) return;
+    applyStartBeepReport();
 
     // --- Check if listening should become active ---
      if (!is_listening_active) {
         if (currentTime >= beep_audio_end_time && currentTime >= startTime) {
             is_listening_active = true;
-            micPeakRMS.resetPeak(); // Start listening clean
+            armShotCapture(); // Start listening clean
+            startSequence.listening(esp_timer_get_time());
         } else {
             // Still waiting for beep audio to finish or for startTime, don't process mic/IMU
              if (redrawMenu || currentTime - lastDisplayUpdateTime >= DISPLAY_UPDATE_INTERVAL_MS) {
                 float currentElapsedTime = (startTime > 0 && currentTime > startTime) ? (currentTime - startTime) / 1000.0f : 0.0f;
                 float lastSplit = (shotCount > 0) ? splitTimes[shotCount - 1] : 0.0f;
-                displayTimingScreen(currentElapsedTime, shotCount, lastSplit);
+                publishStringScreen(currentElapsedTime, shotCount, lastSplit, redrawMenu);
                 lastDisplayUpdateTime = currentTime;
                 redrawMenu = false; 
             }
@@ -358,30 +483,32 @@ void handleNoisyRangeTiming() {
     float currentElapsedTime = (startTime > 0 && currentTime > startTime) ? (currentTime - startTime) / 1000.0f : 0.0f;
     if (redrawMenu || currentTime - lastDisplayUpdateTime >= DISPLAY_UPDATE_INTERVAL_MS) {
         float lastSplit = (shotCount > 0) ? splitTimes[shotCount - 1] : 0.0f;
-        displayTimingScreen(currentElapsedTime, shotCount, lastSplit);
+        publishStringScreen(currentElapsedTime, shotCount, lastSplit, redrawMenu);
         lastDisplayUpdateTime = currentTime;
         redrawMenu = false;
     }
 
-    micPeakRMS.update(); // Update mic only when listening
-    currentCyclePeakRMS = micPeakRMS.getPeakRMS();
-
+    // Sound onsets come stamped from the capture task; further onsets stay queued
+    // while the current one is being checked for recoil.
+    ShotEvent shotEvent;
     if (!checkingForRecoil &&
-        currentCyclePeakRMS > shotThresholdRms &&
-        currentTime - lastDetectionTime > SHOT_REFRACTORY_MS &&
         shotCount < currentMaxShots &&
-        startTime > 0) 
+        startTime > 0 &&
+        popShotEvent(shotEvent) &&
+        (unsigned long)(shotEvent.timeUs / 1000) >= startTime)
     {
-        lastSoundPeakTime = currentTime;
+        lastSoundPeakTime = (unsigned long)(shotEvent.timeUs / 1000);
+        recoilOnsetUs = shotEvent.timeUs;
+        currentCyclePeakRMS = shotEvent.peakRms;
         checkingForRecoil = true;
-        // Don't reset mic peak here, wait for recoil check
     }
 
     if (checkingForRecoil) {
-        StickCP2.Imu.getAccelData(&accX, &accY, &accZ);
-        float currentRecoil = abs(accZ);
+        // Search the IMU history around the onset rather than sampling from now on.
+        int64_t windowEndUs = recoilWindowEndUs(recoilOnsetUs);
+        float currentRecoil = imuPeakAbsAccelZ(recoilWindowStartUs(recoilOnsetUs), windowEndUs);
 
-        if (currentRecoil > recoilThreshold) {
+        if (recoilConfirmsShot(currentRecoil, recoilThreshold)) {
             unsigned long shotTimeMillis = lastSoundPeakTime; 
             resetActivityTimer();
             lastDetectionTime = shotTimeMillis; 
@@ -395,39 +522,30 @@ void handleNoisyRangeTiming() {
             lastShotTimestamp = shotTimeMillis;
             splitTimes[shotCount] = currentSplit;
             shotCount++;
-            displayTimingScreen(currentElapsedTime, shotCount, currentSplit); 
+            publishStringScreen(currentElapsedTime, shotCount, currentSplit, false);
             lastDisplayUpdateTime = currentTime;
 
             checkingForRecoil = false; 
             lastSoundPeakTime = 0;
-            micPeakRMS.resetPeak(); // Reset peak after successful shot registration
 
             if (shotCount >= currentMaxShots) {
-                is_listening_active = false;
-                setState(LIVE_FIRE_STOPPED); 
-                StickCP2.Lcd.fillScreen(BLACK);
-                displayStoppedScreen();
-                if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+                stopString();
                 return; 
             }
+            postLoopEvent(LOOP_EVENT_SHOT); // Onsets may be queued behind this one
         }
-        else if (currentTime - lastSoundPeakTime > RECOIL_DETECTION_WINDOW_MS) {
-            checkingForRecoil = false; 
+        else if (imuHistoryCovers(windowEndUs) ||
+                 esp_timer_get_time() - windowEndUs > (int64_t)IMU_DRAIN_LATENCY_MS * 1000) {
+            checkingForRecoil = false; // Recoil window expired (false alarm)
             lastSoundPeakTime = 0;
-            micPeakRMS.resetPeak(); // Reset peak if recoil window expired (false alarm)
+            postLoopEvent(LOOP_EVENT_SHOT);
         }
-    } else if (is_listening_active) { // Reset peak if not checking recoil and listening is active
-         micPeakRMS.resetPeak(); 
     }
 
     // Manual Stop
     if (currentState == NOISY_RANGE_TIMING && StickCP2.BtnA.wasClicked()) {
         resetActivityTimer();
-        is_listening_active = false;
-        setState(LIVE_FIRE_STOPPED); 
-        StickCP2.Lcd.fillScreen(BLACK);
-        displayStoppedScreen();
-        if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+        stopString();
         return; 
     }
 
@@ -436,11 +554,22 @@ void handleNoisyRangeTiming() {
         unsigned long timeSinceEvent = (shotCount == 0) ? (currentTime - startTime) : (currentTime - lastShotTimestamp);
         bool hasStarted = (startTime > 0);
         if (hasStarted && timeSinceEvent > TIMEOUT_DURATION_MS) {
-            is_listening_active = false;
-            setState(LIVE_FIRE_STOPPED); 
-            StickCP2.Lcd.fillScreen(BLACK);
-            displayStoppedScreen();
-            if (shotCount > 0) playSuccessBeeps(); else playUnsuccessBeeps();
+            stopString();
+        }
+    }
+}
+
+uint32_t timingScreenWaitMs() {
+    if (checkingForRecoil) return LOOP_TICK_MS; // Until the IMU history covers the window
+    if (redrawMenu) return 0;
+    unsigned long now = millis();
+    unsigned long dueMs = lastDisplayUpdateTime + DISPLAY_UPDATE_INTERVAL_MS;
+    if (startTime > 0) {
+        if (!is_listening_active) {
+            dueMs = min(dueMs, max((unsigned long)beep_audio_end_time, startTime));
         }
+        unsigned long lastEventMs = (shotCount == 0) ? startTime : lastShotTimestamp;
+        dueMs = min(dueMs, lastEventMs + TIMEOUT_DURATION_MS + 1);
     }
+    return (dueMs > now) ? (uint32_t)(dueMs - now) : 0;
 }
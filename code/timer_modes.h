@@ -2,11 +2,15 @@
 #define TIMER_MODES_H
 
 #include <M5StickCPlus2.h>
+#include "config.h" // For TimerState
+#include "start_sequence.h"
 
 void handleLiveFireReady();
 void handleLiveFireGetReady();
 void handleLiveFireTiming();
-// LIVE_FIRE_STOPPED is handled in main loop's state machine, but its display is in display_utils
+void handleLiveFireStopped();
+void publishStoppedScreen();      // Asks the render task to redraw the stopped screen
+void handleStoppedRescoreInput(); // Up/Down on the stopped screen re-scores a Live Fire string
 
 void handleDryFireReadyInput(); // Renamed from handleDryFireReady for consistency
 void handleDryFireRunning();
@@ -15,6 +19,19 @@ void handleNoisyRangeReadyInput(); // Renamed from handleNoisyRangeReady
 void handleNoisyRangeGetReady();
 void handleNoisyRangeTiming();
 
+// How long loop() may sleep on a timing screen (STATE_TIMED_WAKE) before its
+// handler has something to do: the next clock redraw, the start of listening
+// or the string timeout. Shots, the start beep and buttons wake it earlier.
+uint32_t timingScreenWaitMs();
+
+// Exit actions (STATE_HOOKS)
+void exitGetReady(TimerState from, TimerState to);       // Abandons the start unless the beep has played
+void exitTiming(TimerState from, TimerState to);         // Stops listening
+void exitStopped(TimerState from, TimerState to);        // Journals the string as last re-scored
+void exitDryFireRunning(TimerState from, TimerState to); // Drops the par beeps still to come
+
+StartSequenceStats getStartSequenceStats(); // Start cycle time and cancel latency
+
 void resetShotData();
 
 #endif // TIMER_MODES_H
@@ -0,0 +1,87 @@
+#include "tone_burst_detector.h"
+#include <math.h>
+
+void ToneBurstDetector::configure(uint32_t sampleRateHz, float frequencyHz, float burstMs) {
+    if (sampleRateHz == 0) sampleRateHz = 16000;
+    length_ = (uint32_t)(burstMs * (float)sampleRateHz / 1000.0f);
+    if (length_ < 1) length_ = 1;
+    if (length_ > kMaxBurstSamples) length_ = kMaxBurstSamples;
+    float w = 2.0f * (float)M_PI * frequencyHz / (float)sampleRateHz;
+    stepRe_ = cosf(w);
+    stepIm_ = -sinf(w);
+    reset();
+}
+
+void ToneBurstDetector::reset() {
+    for (size_t i = 0; i < length_; ++i) {
+        ringRe_[i] = 0.0f;
+        ringIm_[i] = 0.0f;
+    }
+    pos_ = 0;
+    filled_ = 0;
+    sumRe_ = 0.0f;
+    sumIm_ = 0.0f;
+    oscRe_ = 1.0f;
+    oscIm_ = 0.0f;
+    peakEnergy_ = 0.0f;
+    peakEndSample_ = 0;
+    energySum_ = 0.0;
+    energyCount_ = 0;
+}
+
+// Running sums pick up rounding error; rebuild them once per window.
+void ToneBurstDetector::resum() {
+    float re = 0.0f, im = 0.0f;
+    for (size_t i = 0; i < length_; ++i) {
+        re += ringRe_[i];
+        im += ringIm_[i];
+    }
+    sumRe_ = re;
+    sumIm_ = im;
+    // Keep the oscillator on the unit circle as well.
+    float mag = sqrtf(oscRe_ * oscRe_ + oscIm_ * oscIm_);
+    oscRe_ /= mag;
+    oscIm_ /= mag;
+}
+
+void ToneBurstDetector::process(const int16_t* samples, size_t count, uint64_t firstSampleIndex) {
+    for (size_t i = 0; i < count; ++i) {
+        float x = (float)samples[i];
+        float re = x * oscRe_;
+        float im = x * oscIm_;
+        sumRe_ += re - ringRe_[pos_];
+        sumIm_ += im - ringIm_[pos_];
+        ringRe_[pos_] = re;
+        ringIm_[pos_] = im;
+
+        float nextRe = oscRe_ * stepRe_ - oscIm_ * stepIm_;
+        oscIm_ = oscRe_ * stepIm_ + oscIm_ * stepRe_;
+        oscRe_ = nextRe;
+
+        if (++pos_ == length_) {
+            pos_ = 0;
+            resum();
+        }
+        if (filled_ < length_) {
+            ++filled_;
+            continue;
+        }
+
+        float energy = sumRe_ * sumRe_ + sumIm_ * sumIm_;
+        energySum_ += energy;
+        ++energyCount_;
+        if (energy > peakEnergy_) {
+            peakEnergy_ = energy;
+            peakEndSample_ = firstSampleIndex + i;
+        }
+    }
+}
+
+uint64_t ToneBurstDetector::onsetSample() const {
+    return (peakEndSample_ + 1 >= length_) ? peakEndSample_ + 1 - length_ : 0;
+}
+
+float ToneBurstDetector::peakToMean() const {
+    if (energyCount_ == 0 || energySum_ <= 0.0) return 0.0f;
+    return (float)(peakEnergy_ / (energySum_ / (double)energyCount_));
+}
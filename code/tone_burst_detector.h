@@ -0,0 +1,53 @@
+#ifndef TONE_BURST_DETECTOR_H
+#define TONE_BURST_DETECTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Matched filter for a constant-frequency tone burst of known length, used to
+// find our own calibration bursts in the mic signal. The input is mixed down
+// with a complex reference and summed over a sliding window one burst long;
+// the window energy peaks when it lines up with the burst, which gives the
+// burst onset to within a few samples even with noise well above the tone.
+
+class ToneBurstDetector {
+public:
+    static const size_t kMaxBurstSamples = 1024;
+
+    void configure(uint32_t sampleRateHz, float frequencyHz, float burstMs);
+
+    // Forgets the window contents and the peak found so far.
+    void reset();
+
+    // Feeds samples; 'firstSampleIndex' is the stream index of samples[0].
+    void process(const int16_t* samples, size_t count, uint64_t firstSampleIndex);
+
+    // Stream index of the first sample of the strongest burst seen since reset().
+    uint64_t onsetSample() const;
+
+    // Peak window energy over the mean window energy since reset().
+    float peakToMean() const;
+
+private:
+    void resum();
+
+    uint32_t length_ = 1;
+    float stepRe_ = 1.0f;
+    float stepIm_ = 0.0f;
+
+    float ringRe_[kMaxBurstSamples];
+    float ringIm_[kMaxBurstSamples];
+    size_t pos_ = 0;
+    size_t filled_ = 0;
+    float sumRe_ = 0.0f;
+    float sumIm_ = 0.0f;
+    float oscRe_ = 1.0f;
+    float oscIm_ = 0.0f;
+
+    float peakEnergy_ = 0.0f;
+    uint64_t peakEndSample_ = 0;
+    double energySum_ = 0.0;
+    uint64_t energyCount_ = 0;
+};
+
+#endif // TONE_BURST_DETECTOR_H
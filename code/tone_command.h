@@ -0,0 +1,15 @@
+#ifndef TONE_COMMAND_H
+#define TONE_COMMAND_H
+
+#include <stdint.h>
+
+// One tone for the A2DP callback, handed over through an SpscRing.
+typedef struct {
+    int64_t startUs;     // esp_timer time of the first frame; past times start at once
+    uint32_t generation; // Dropped once the cancel generation has moved past it
+    uint16_t frequency;
+    uint16_t durationMs;
+    bool reportStart;    // Report the emitted time (see takeStartBeepEmittedUs)
+} ToneCommand;
+
+#endif // TONE_COMMAND_H
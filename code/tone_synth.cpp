@@ -0,0 +1,77 @@
+#include "tone_synth.h"
+#include <math.h>
+
+int16_t ToneSynth::sineTable_[ToneSynth::kTableSize];
+bool ToneSynth::tableReady_ = false;
+
+void ToneSynth::begin(uint32_t sampleRateHz, float rampMs) {
+    if (!tableReady_) {
+        for (uint32_t i = 0; i < kTableSize; ++i) {
+            sineTable_[i] = (int16_t)lrintf(32767.0f * sinf(2.0f * (float)M_PI * (float)i / (float)kTableSize));
+        }
+        tableReady_ = true;
+    }
+    sampleRateHz_ = (sampleRateHz > 0) ? sampleRateHz : 44100;
+    rampSamples_ = (uint32_t)(rampMs * (float)sampleRateHz_ / 1000.0f);
+    if (rampSamples_ == 0) rampSamples_ = 1;
+    gainStep_ = (int32_t)((65536 + rampSamples_ - 1) / rampSamples_);
+    stage_ = STAGE_IDLE;
+    gain_ = 0;
+}
+
+void ToneSynth::start(uint32_t frequencyHz, int16_t amplitude, uint32_t durationSamples) {
+    if (frequencyHz == 0 || amplitude <= 0 || durationSamples == 0) {
+        stop();
+        return;
+    }
+    if (stage_ == STAGE_IDLE) phase_ = 0;
+    // 2^32 * f / fs, rounded.
+    phaseInc_ = (uint32_t)((((uint64_t)frequencyHz << 32) + sampleRateHz_ / 2) / sampleRateHz_);
+    amplitude_ = amplitude;
+    sustainLeft_ = durationSamples;
+    stage_ = STAGE_ATTACK;
+}
+
+void ToneSynth::stop() {
+    if (stage_ != STAGE_IDLE) stage_ = STAGE_RELEASE;
+}
+
+void ToneSynth::render(int16_t* stereo, size_t frames) {
+    size_t i = 0;
+    while (i < frames) {
+        if (stage_ == STAGE_IDLE) {
+            for (; i < frames; ++i) {
+                stereo[2 * i] = 0;
+                stereo[2 * i + 1] = 0;
+            }
+            break;
+        }
+
+        // Process in runs over which the ramp step stays constant.
+        size_t run = frames - i;
+        if (stage_ != STAGE_RELEASE && sustainLeft_ < run) run = sustainLeft_;
+        int32_t step = (stage_ == STAGE_ATTACK) ? gainStep_ : (stage_ == STAGE_RELEASE) ? -gainStep_ : 0;
+
+        for (size_t end = i + run; i < end; ++i) {
+            gain_ += step;
+            if (gain_ > 65536) gain_ = 65536;
+            if (gain_ < 0) gain_ = 0;
+            int32_t s = sineTable_[phase_ >> (32 - kTableBits)];
+            phase_ += phaseInc_;
+            int16_t out = (int16_t)((((s * amplitude_) >> 15) * gain_) >> 16);
+            stereo[2 * i] = out;
+            stereo[2 * i + 1] = out;
+            if (gain_ == 0) {
+                ++i;
+                stage_ = STAGE_IDLE;
+                break;
+            }
+        }
+
+        if (stage_ == STAGE_ATTACK || stage_ == STAGE_SUSTAIN) {
+            sustainLeft_ -= (uint32_t)run;
+            if (stage_ == STAGE_ATTACK && gain_ == 65536) stage_ = STAGE_SUSTAIN;
+            if (sustainLeft_ == 0) stage_ = STAGE_RELEASE;
+        }
+    }
+}
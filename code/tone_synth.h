@@ -0,0 +1,51 @@
+#ifndef TONE_SYNTH_H
+#define TONE_SYNTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sine tone generator for the A2DP data callback.
+// A 32-bit phase accumulator indexes a 1024-entry Q15 sine table, so the phase
+// never drifts or jumps on wrap, and a linear attack/release ramp keeps tone
+// edges click-free. render() does no allocation, no floating point and never
+// blocks.
+
+class ToneSynth {
+public:
+    // Builds the sine table (once) and sets the output rate and ramp length.
+    void begin(uint32_t sampleRateHz, float rampMs);
+
+    // Starts (or retriggers) a tone. The ramp starts from the current gain, so
+    // retriggering a sounding tone does not click. durationSamples includes
+    // the attack; the release follows it.
+    void start(uint32_t frequencyHz, int16_t amplitude, uint32_t durationSamples);
+
+    // Moves a sounding tone into its release ramp.
+    void stop();
+
+    // True until the release ramp has finished.
+    bool isActive() const { return stage_ != STAGE_IDLE; }
+
+    // Writes 'frames' interleaved stereo frames (same sample on both channels).
+    void render(int16_t* stereo, size_t frames);
+
+private:
+    enum Stage : uint8_t { STAGE_IDLE, STAGE_ATTACK, STAGE_SUSTAIN, STAGE_RELEASE };
+
+    static const int kTableBits = 10;
+    static const uint32_t kTableSize = 1u << kTableBits;
+    static int16_t sineTable_[kTableSize];
+    static bool tableReady_;
+
+    uint32_t sampleRateHz_ = 44100;
+    uint32_t rampSamples_ = 1;
+    uint32_t phase_ = 0;
+    uint32_t phaseInc_ = 0;
+    int32_t amplitude_ = 0;
+    int32_t gain_ = 0;          // Q16, 0..65536
+    int32_t gainStep_ = 65536;  // Per-sample ramp step, Q16
+    uint32_t sustainLeft_ = 0;  // Samples until the release starts
+    Stage stage_ = STAGE_IDLE;
+};
+
+#endif // TONE_SYNTH_H
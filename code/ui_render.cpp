@@ -0,0 +1,83 @@
+#include "ui_render.h"
+#include "globals.h"
+#include "display_utils.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+static QueueHandle_t uiSnapshotQueue = NULL;
+static SemaphoreHandle_t uiPanelAsleep = NULL;  // Given by the render task once the panel sleeps
+static uint32_t uiScreenSeq = 0;  // Only loop() publishes
+
+bool uiRenderBegin() {
+    uiSnapshotQueue = xQueueCreate(1, sizeof(UiSnapshot));
+    uiPanelAsleep = xSemaphoreCreateBinary();
+    return uiSnapshotQueue != NULL && uiPanelAsleep != NULL;
+}
+
+int uiRotation() {
+    if (currentState == EDIT_SETTING && settingBeingEdited == EDIT_ROTATION) {
+        return editingIntValue;
+    }
+    return screenRotationSetting;
+}
+
+void publishUiSnapshot(UiSnapshot &snapshot, bool redraw) {
+    if (redraw) {
+        uiScreenSeq++;
+    }
+    snapshot.screenSeq = uiScreenSeq;
+    snapshot.rotation = (uint8_t)uiRotation();
+    snapshot.lowBattery = lowBatteryWarning;
+    xQueueOverwrite(uiSnapshotQueue, &snapshot);
+}
+
+void uiRenderSleepDisplay() {
+    UiSnapshot snapshot;
+    snapshot.screen = UI_SCREEN_SLEEP;
+    publishUiSnapshot(snapshot, true);
+    xSemaphoreTake(uiPanelAsleep, portMAX_DELAY);
+}
+
+// --- UI Render Task (Runs on Core 1) ---
+void uiRenderTask(void *pvParameters) {
+    UiSnapshot snapshot;
+    uint32_t drawnScreenSeq = 0;
+    UiScreen drawnScreen = UI_SCREEN_MESSAGE;
+    bool drawnAny = false;
+    bool asleep = false;
+
+    for (;;) {
+        if (xQueueReceive(uiSnapshotQueue, &snapshot, portMAX_DELAY) != pdPASS) {
+            continue;
+        }
+        if (asleep) {
+            StickCP2.Lcd.wakeup();
+            asleep = false;
+        }
+        bool redraw = !drawnAny || snapshot.screenSeq != drawnScreenSeq || snapshot.screen != drawnScreen;
+        if (StickCP2.Lcd.getRotation() != snapshot.rotation) {
+            StickCP2.Lcd.waitDMA();
+            StickCP2.Lcd.setRotation(snapshot.rotation);
+            redraw = true;
+        }
+        if (snapshot.screen != UI_SCREEN_BOOT_FRAME && isBootAnimationOpen()) {
+            closeBootAnimation();
+        }
+
+        drawUiSnapshot(snapshot, redraw);
+        drawnScreenSeq = snapshot.screenSeq;
+        drawnScreen = snapshot.screen;
+        drawnAny = true;
+
+        if (snapshot.screen == UI_SCREEN_SLEEP) {
+            vTaskDelay(pdMS_TO_TICKS(SLEEP_MESSAGE_DELAY_MS));
+            StickCP2.Lcd.sleep();
+            StickCP2.Lcd.waitDisplay();
+            asleep = true;
+            drawnAny = false; // Start from a clear screen once awake
+            xSemaphoreGive(uiPanelAsleep);
+        }
+    }
+}
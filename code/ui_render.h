@@ -0,0 +1,158 @@
+#ifndef UI_RENDER_H
+#define UI_RENDER_H
+
+#include <Arduino.h>
+#include "config.h" // For TimerState, MAX_SHOTS_LIMIT, UI_* sizes
+
+// --- UI Render Task ---
+// Every screen is drawn by its own task from snapshots the main loop
+// publishes, so a redraw never holds up loop() and loop() never touches the
+// panel. setup() draws the boot screens itself, before the first snapshot.
+
+// Which screen a snapshot shows; the matching member of UiSnapshot holds it.
+typedef enum {
+    UI_SCREEN_MESSAGE,          // One centred line, or a blank screen
+    UI_SCREEN_SLEEP,            // "Sleeping...", then the panel is put to sleep
+    UI_SCREEN_BOOT_FRAME,
+    UI_SCREEN_MENU,
+    UI_SCREEN_TIMING,
+    UI_SCREEN_STOPPED,
+    UI_SCREEN_EDIT,
+    UI_SCREEN_CALIBRATION,
+    UI_SCREEN_BT_LATENCY,
+    UI_SCREEN_PAGE,             // Device Status and its Loop Profile page
+    UI_SCREEN_FILES,
+    UI_SCREEN_BT_SCAN,
+    UI_SCREEN_DRY_FIRE_READY,
+    UI_SCREEN_DRY_FIRE_RUNNING
+} UiScreen;
+
+typedef char UiText[UI_TEXT_CHARS];
+
+typedef struct {
+    UiText text;
+    uint8_t textSize;
+} UiMessageScreen;
+
+typedef struct {
+    int frame;                  // Frames are drawn in order; skipped ones are still decoded
+    bool jpg;                   // /<frame>.jpg rather than the packed animation
+} UiBootFrameScreen;
+
+typedef struct {
+    UiText title;
+    UiText corner;              // Top right (battery, link), or empty
+    UiText status;              // Under the title (Bluetooth link), or empty
+    uint16_t statusColor;
+    UiText rows[UI_LIST_ROWS];  // The items on screen, values filled in
+    int rowCount;
+    int selectedRow;            // Index into rows, or -1
+    bool moreAbove;
+    bool moreBelow;
+} UiMenuScreen;
+
+typedef struct {
+    float elapsedTime;
+    int shotCount;
+    int maxShots;
+    float lastSplit;
+} UiTimingScreen;
+
+typedef struct {
+    int shotCount;
+    int rescoreMarginDb;        // 0 when the string cannot be re-scored
+    float splits[MAX_SHOTS_LIMIT];
+} UiStoppedScreen;
+
+typedef struct {
+    UiText title;
+    UiText hint;                // Which buttons change the value
+    UiText value;
+    uint8_t valueFont;
+    bool msSuffix;
+} UiEditScreen;
+
+typedef struct {
+    UiText title;
+    UiText peak;
+    bool recoil;
+} UiCalibrationScreen;
+
+typedef struct {
+    int trial;
+    int totalTrials;
+    int lastLatencyMs;          // -1 when the last trial found nothing
+    int resultMs;               // -1 when the calibration failed
+    bool finished;
+} UiBtLatencyScreen;
+
+typedef struct {
+    UiText title;
+    UiText footer;
+    UiText lines[UI_PAGE_LINES]; // As many as fit are drawn
+    int lineCount;
+} UiPageScreen;
+
+typedef struct {
+    UiText rows[UI_LIST_ROWS];
+    int rowCount;               // 0: nothing listed (or no filesystem)
+    bool moreAbove;
+    bool moreBelow;
+} UiFilesScreen;
+
+typedef struct {
+    UiText rows[UI_LIST_ROWS];
+    int rowCount;
+    int selectedRow;
+    bool scanning;
+    bool moreAbove;
+    bool moreBelow;
+} UiScanScreen;
+
+typedef struct {
+    bool waiting;
+    int beepNum;
+    int totalBeeps;
+} UiDryFireRunningScreen;
+
+// Everything a screen shows, copied at publish time.
+typedef struct {
+    UiScreen screen;
+    uint32_t screenSeq;         // Set by publishUiSnapshot(); a change clears the screen
+    uint8_t rotation;           // Set by publishUiSnapshot() from uiRotation()
+    bool lowBattery;            // Set by publishUiSnapshot()
+    union {
+        UiMessageScreen message;
+        UiBootFrameScreen bootFrame;
+        UiMenuScreen menu;
+        UiTimingScreen timing;
+        UiStoppedScreen stopped;
+        UiEditScreen edit;
+        UiCalibrationScreen calibration;
+        UiBtLatencyScreen btLatency;
+        UiPageScreen page;
+        UiFilesScreen files;
+        UiScanScreen scan;
+        UiDryFireRunningScreen dryFireRunning;
+    };
+} UiSnapshot;
+
+void uiRenderTask(void *pvParameters);
+
+// Creates the snapshot queue. Call before starting the task.
+bool uiRenderBegin();
+
+// Hands a snapshot to the render task without blocking. Snapshots it has not
+// picked up yet are replaced, so it always draws the latest. 'redraw' clears
+// the screen first (also when an earlier, replaced snapshot asked for it).
+void publishUiSnapshot(UiSnapshot &snapshot, bool redraw);
+
+// The rotation screens are laid out for: the setting, or the one being tried
+// while Screen Rotation is edited. loop() lays out and maps buttons by it.
+int uiRotation();
+
+// Shows "Sleeping..." for SLEEP_MESSAGE_DELAY_MS and puts the panel to sleep;
+// returns once it is asleep. The next snapshot wakes it.
+void uiRenderSleepDisplay();
+
+#endif // UI_RENDER_H